@@ -0,0 +1,609 @@
+/*************************************************************************
+
+   Program:    benchgen
+   File:       benchgen.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Generate large synthetic PDB files for benchmarking
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Builds a solvated system of (about) the requested number of atoms
+   that looks like the output of an MD setup. The ATOM records of the
+   input PDB files are tiled on a lattice, each copy being given its
+   own chain label, until the polymer fraction of the atoms has been
+   used. The rest of the atoms are TIP3P waters on a lattice around
+   the polymer (avoiding clashes with it), with a sodium or chloride
+   ion in place of every ION_EVERY'th water.
+
+   A fraction of the waters have their two hydrogens placed on top of
+   each other to give fixoverlap something to do.
+
+   The output is streamed so memory use is small compared with the
+   programs being benchmarked. Atom numbers are written modulo 100000
+   and residue numbers modulo 10000 so the fixed PDB columns are kept.
+
+**************************************************************************
+
+   Usage:
+   ======
+   benchgen [-n natoms] [-p polyfrac] [-d dupfrac] in.pdb [in.pdb ...]
+            out.pdb
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "cellgrid.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define MAXINPUT        16
+#define TILEGAP       10.0    /* Gap between tiled copies               */
+#define WATERSPACING   3.1    /* Water lattice spacing                  */
+#define CLASHDIST      2.6    /* Closest a water may be to the polymer  */
+#define ION_EVERY       50    /* One ion per this many waters           */
+#define DEFNATOMS     1000
+#define DEFPOLYFRAC    0.2
+#define DEFDUPFRAC     0.01
+
+typedef struct
+{
+   PDB  *pdb;
+   REAL xmin, ymin, zmin,
+        xsize, ysize, zsize;
+   int  natoms;
+}  TEMPLATE;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int  main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, long *natoms, REAL *polyFrac,
+                  REAL *dupFrac, char infiles[MAXINPUT][MAXBUFF],
+                  int *ninfiles, char *outfile);
+void Usage(void);
+BOOL ReadTemplate(char *filename, TEMPLATE *t);
+REAL *WritePolymer(FILE *out, TEMPLATE *templates, int ntemplates,
+                   long target, long *natoms, REAL *box);
+BOOL WriteSolvent(FILE *out, REAL *coor, long npoly, REAL *box,
+                  long target, REAL dupFrac, long *natoms);
+void WriteAtom(FILE *out, char *record, long atnum, char *atnam,
+               char *resnam, char *chain, long resnum, REAL x, REAL y,
+               REAL z, char *element);
+void ChainLabel(int n, char *chain);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*/
+int main(int argc, char **argv)
+{
+   char     infiles[MAXINPUT][MAXBUFF],
+            outfile[MAXBUFF];
+   TEMPLATE templates[MAXINPUT];
+   FILE     *out = NULL;
+   long     target,
+            npoly = 0,
+            natoms;
+   REAL     polyFrac,
+            dupFrac,
+            *coor,
+            box[6];
+   int      ninfiles, i;
+
+   if(!ParseCmdLine(argc, argv, &target, &polyFrac, &dupFrac, infiles,
+                    &ninfiles, outfile))
+   {
+      Usage();
+      return(0);
+   }
+
+   for(i=0; i<ninfiles; i++)
+   {
+      if(!ReadTemplate(infiles[i], &(templates[i])))
+         return(1);
+   }
+
+   if((out=fopen(outfile, "w"))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to write %s\n", outfile);
+      return(1);
+   }
+
+   if((coor=WritePolymer(out, templates, ninfiles,
+                         (long)(target*polyFrac), &npoly, box))==NULL)
+   {
+      fprintf(stderr,"Error: No memory for polymer coordinates\n");
+      return(1);
+   }
+
+   natoms = npoly;
+   if(!WriteSolvent(out, coor, npoly, box, target, dupFrac, &natoms))
+   {
+      fprintf(stderr,"Error: No memory for solvent\n");
+      return(1);
+   }
+   fprintf(out, "END   \n");
+   fclose(out);
+
+   fprintf(stderr, "%ld atoms (%ld polymer)\n", natoms, npoly);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ReadTemplate(char *filename, TEMPLATE *t)
+   ----------------------------------------------
+*//**
+   \param[in]   *filename   PDB file
+   \param[out]  *t          The ATOM records and their bounding box
+   \return                  Success
+
+   Reads a PDB file keeping only the ATOM records
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ReadTemplate(char *filename, TEMPLATE *t)
+{
+   FILE *fp;
+   PDB  *pdb, *p, *prev = NULL, *next;
+   REAL xmax, ymax, zmax;
+   int  natoms;
+
+   if((fp=fopen(filename, "r"))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to open %s\n", filename);
+      return(FALSE);
+   }
+   if((pdb=blReadPDB(fp, &natoms))==NULL)
+   {
+      fprintf(stderr,"Error: No atoms read from %s\n", filename);
+      return(FALSE);
+   }
+   fclose(fp);
+
+   /* Remove the HETATMs                                                */
+   t->pdb    = NULL;
+   t->natoms = 0;
+   for(p=pdb; p!=NULL; p=next)
+   {
+      next = p->next;
+      if(strncmp(p->record_type, "ATOM  ", 6))
+      {
+         if(prev != NULL)
+            prev->next = next;
+         free(p);
+      }
+      else
+      {
+         if(t->pdb == NULL)
+            t->pdb = p;
+         prev = p;
+         t->natoms++;
+      }
+   }
+
+   if(t->pdb == NULL)
+   {
+      fprintf(stderr,"Error: No ATOM records in %s\n", filename);
+      return(FALSE);
+   }
+
+   t->xmin = xmax = t->pdb->x;
+   t->ymin = ymax = t->pdb->y;
+   t->zmin = zmax = t->pdb->z;
+   for(p=t->pdb; p!=NULL; NEXT(p))
+   {
+      t->xmin = MIN(t->xmin, p->x);   xmax = MAX(xmax, p->x);
+      t->ymin = MIN(t->ymin, p->y);   ymax = MAX(ymax, p->y);
+      t->zmin = MIN(t->zmin, p->z);   zmax = MAX(zmax, p->z);
+   }
+   t->xsize = xmax - t->xmin;
+   t->ysize = ymax - t->ymin;
+   t->zsize = zmax - t->zmin;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>REAL *WritePolymer(FILE *out, TEMPLATE *templates, int ntemplates,
+                      long target, long *natoms, REAL *box)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   *out          Output file
+   \param[in]   *templates    Input structures
+   \param[in]   ntemplates    Number of input structures
+   \param[in]   target        Number of polymer atoms wanted
+   \param[out]  *natoms       Number of polymer atoms written
+   \param[out]  *box          xmin,ymin,zmin,xmax,ymax,zmax of polymer
+   \return                    Packed coordinates of the polymer atoms
+
+   Writes copies of the templates, cycling through them, on a cubic
+   lattice until the target is reached. The last copy is cut at a
+   residue boundary. At least one residue is always written.
+
+-  19.10.26 Original   By: ACRM
+*/
+REAL *WritePolymer(FILE *out, TEMPLATE *templates, int ntemplates,
+                   long target, long *natoms, REAL *box)
+{
+   REAL     cell = 0.0,
+            *coor,
+            dx, dy, dz;
+   long     ncopies, copy;
+   int      perSide, i, resnum;
+   char     chain[8];
+   PDB      *p, *stop;
+   TEMPLATE *t;
+
+   for(i=0; i<ntemplates; i++)
+   {
+      cell = MAX(cell, templates[i].xsize);
+      cell = MAX(cell, templates[i].ysize);
+      cell = MAX(cell, templates[i].zsize);
+   }
+   cell += TILEGAP;
+
+   /* Enough copies to reach the target                                 */
+   ncopies = 1;
+   for(copy=0, i=0; i<target; copy++)
+      i += templates[copy%ntemplates].natoms;
+   if(copy > ncopies)
+      ncopies = copy;
+   for(perSide=1; (long)perSide*perSide*perSide < ncopies; perSide++);
+
+   if((coor=(REAL *)malloc(3*(target+templates[0].natoms+1)*
+                           sizeof(REAL)))==NULL)
+      return(NULL);
+
+   *natoms = 0;
+   for(i=0; i<6; i++)
+      box[i] = 0.0;
+
+   for(copy=0; copy<ncopies; copy++)
+   {
+      t  = &(templates[copy%ntemplates]);
+      dx = (copy % perSide) * cell - t->xmin;
+      dy = ((copy / perSide) % perSide) * cell - t->ymin;
+      dz = (copy / ((long)perSide*perSide)) * cell - t->zmin;
+      ChainLabel((int)copy, chain);
+
+      for(p=t->pdb, resnum=0; p!=NULL; p=stop)
+      {
+         stop = blFindNextResidue(p);
+         if(*natoms && (*natoms >= target))
+            break;
+         resnum++;
+         for(; p!=stop; NEXT(p))
+         {
+            REAL x = p->x + dx,
+                 y = p->y + dy,
+                 z = p->z + dz;
+
+            if(*natoms <= target + templates[0].natoms)
+            {
+               coor[3*(*natoms)]   = x;
+               coor[3*(*natoms)+1] = y;
+               coor[3*(*natoms)+2] = z;
+            }
+            (*natoms)++;
+
+            WriteAtom(out, "ATOM  ", *natoms, p->atnam_raw, p->resnam,
+                      chain, resnum, x, y, z, p->element);
+
+            box[3] = MAX(box[3], x);
+            box[4] = MAX(box[4], y);
+            box[5] = MAX(box[5], z);
+         }
+      }
+      fprintf(out, "TER   \n");
+   }
+
+   return(coor);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteSolvent(FILE *out, REAL *coor, long npoly, REAL *box,
+                     long target, REAL dupFrac, long *natoms)
+   --------------------------------------------------------------
+*//**
+   \param[in]      *out      Output file
+   \param[in]      *coor     Polymer coordinates
+   \param[in]      npoly     Number of polymer atoms
+   \param[in]      *box      Polymer bounding box
+   \param[in]      target    Total number of atoms wanted
+   \param[in]      dupFrac   Fraction of waters with duplicate
+                             hydrogens
+   \param[in,out]  *natoms   Number of atoms written
+
+   Fills a cube around the polymer with water and ions. The cube is
+   made big enough for the solvent and points too close to the polymer
+   are skipped. If the cube still fills up, it is enlarged.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WriteSolvent(FILE *out, REAL *coor, long npoly, REAL *box,
+                  long target, REAL dupFrac, long *natoms)
+{
+   CELLGRID *grid  = NULL;
+   long     nsolv  = 0,
+            nwater = 0,
+            resnum = 0,
+            npoints,
+            ix, iy, iz;
+   int      cells[MAXNEIGHBOURCELLS],
+            ncells, c, j,
+            nside;
+   REAL     side,
+            x, y, z,
+            ox = -WATERSPACING,
+            oy = -WATERSPACING,
+            oz = -WATERSPACING;
+   BOOL     clash;
+   int      dupEvery = (dupFrac > 0.0) ? (int)(1.0/dupFrac + 0.5) : 0;
+
+   if(npoly && ((grid=BuildCellGrid(coor, (int)npoly, CLASHDIST))==NULL))
+      return(FALSE);
+
+   /* Make the cube big enough for the polymer and twice the solvent    */
+   npoints = 2 * (target - npoly) / 3 + 1;
+   side    = MAX(MAX(box[3], box[4]), box[5]) + 2.0*WATERSPACING;
+   nside   = (int)(side / WATERSPACING) + 1;
+   while((long)nside*nside*nside < npoints + npoly/3)
+      nside++;
+
+   /* Scan the lattice. If it's full, carry on into an outer shell      */
+   for(ix=0; (*natoms < target); ix++)
+   {
+      for(iy=0; (iy<nside) && (*natoms < target); iy++)
+      {
+         for(iz=0; (iz<nside) && (*natoms < target); iz++)
+         {
+            x = ox + ix * WATERSPACING;
+            y = oy + iy * WATERSPACING;
+            z = oz + iz * WATERSPACING;
+
+            clash = FALSE;
+            if(grid != NULL)
+            {
+               ncells = GetNeighbourCells(grid,
+                                          GetCellIndex(grid, x, y, z),
+                                          cells);
+               for(c=0; (c<ncells) && !clash; c++)
+               {
+                  for(j=grid->head[cells[c]]; j!=(-1); j=grid->next[j])
+                  {
+                     REAL ddx = coor[3*j]   - x,
+                          ddy = coor[3*j+1] - y,
+                          ddz = coor[3*j+2] - z;
+                     if((ddx*ddx + ddy*ddy + ddz*ddz) <
+                        CLASHDIST*CLASHDIST)
+                     {
+                        clash = TRUE;
+                        break;
+                     }
+                  }
+               }
+            }
+            if(clash)
+               continue;
+
+            resnum++;
+            nsolv++;
+            if(((nsolv % ION_EVERY) == 0) || (target - *natoms < 3))
+            {
+               /* Alternate sodium and chloride                         */
+               if((nsolv / ION_EVERY) % 2)
+                  WriteAtom(out, "HETATM", ++(*natoms), "NA  ", "NA  ",
+                            "I", resnum, x, y, z, "NA");
+               else
+                  WriteAtom(out, "HETATM", ++(*natoms), "CL  ", "CL  ",
+                            "I", resnum, x, y, z, "CL");
+            }
+            else
+            {
+               nwater++;
+               WriteAtom(out, "HETATM", ++(*natoms), " O  ", "HOH ", "W",
+                         resnum, x, y, z, "O");
+               WriteAtom(out, "HETATM", ++(*natoms), " H1 ", "HOH ", "W",
+                         resnum, x+0.9572, y, z, "H");
+               if(dupEvery && ((nwater % dupEvery) == 0))
+                  WriteAtom(out, "HETATM", ++(*natoms), " H2 ", "HOH ",
+                            "W", resnum, x+0.9572, y, z, "H");
+               else
+                  WriteAtom(out, "HETATM", ++(*natoms), " H2 ", "HOH ",
+                            "W", resnum, x-0.2400, y+0.9266, z, "H");
+            }
+         }
+      }
+   }
+
+   if(grid != NULL)
+      FreeCellGrid(grid);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void WriteAtom(FILE *out, char *record, long atnum, char *atnam,
+                  char *resnam, char *chain, long resnum, REAL x, REAL y,
+                  REAL z, char *element)
+   ----------------------------------------------------------------------
+*//**
+   Writes a PDB ATOM or HETATM record with the atom number modulo
+   100000 and the residue number modulo 10000
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteAtom(FILE *out, char *record, long atnum, char *atnam,
+               char *resnam, char *chain, long resnum, REAL x, REAL y,
+               REAL z, char *element)
+{
+   fprintf(out, "%-6s%5ld %-4s %-4s%1s%4ld    %8.3f%8.3f%8.3f  1.00 \
+20.00          %2s\n",
+           record, atnum%100000, atnam, resnam, chain, resnum%10000,
+           x, y, z, element);
+}
+
+
+/************************************************************************/
+/*>void ChainLabel(int n, char *chain)
+   -----------------------------------
+*//**
+   Chain labels for the polymer copies cycle through A-V and a-z. W and
+   I are kept for water and ions.
+
+-  19.10.26 Original   By: ACRM
+*/
+void ChainLabel(int n, char *chain)
+{
+   n %= 48;
+   chain[0] = (n < 22) ? (char)('A' + n) : (char)('a' + n - 22);
+   chain[1] = '\0';
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*/
+void Usage(void)
+{
+   fprintf(stderr,"Usage: benchgen [-n natoms] [-p polyfrac] [-d dupfrac] \
+in.pdb [in.pdb ...] out.pdb\n");
+   fprintf(stderr,"       -n  Number of atoms (default %d)\n", DEFNATOMS);
+   fprintf(stderr,"       -p  Fraction of atoms in the polymer (default \
+%.2f)\n", DEFPOLYFRAC);
+   fprintf(stderr,"       -d  Fraction of waters with duplicate \
+hydrogens (default %.2f)\n", DEFDUPFRAC);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, long *natoms, REAL *polyFrac,
+                     REAL *dupFrac, char infiles[MAXINPUT][MAXBUFF],
+                     int *ninfiles, char *outfile)
+   ----------------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  long   *natoms       Number of atoms to generate
+            REAL   *polyFrac     Fraction of polymer atoms
+            REAL   *dupFrac      Fraction of waters with duplicate Hs
+            char   infiles[][]   Input PDB files
+            int    *ninfiles     Number of input files
+            char   *outfile      Output file
+   Returns: BOOL                 Success?
+
+   Parse the command line
+
+   19.10.26  Original   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, long *natoms, REAL *polyFrac,
+                  REAL *dupFrac, char infiles[MAXINPUT][MAXBUFF],
+                  int *ninfiles, char *outfile)
+{
+   argc--;
+   argv++;
+
+   *natoms   = DEFNATOMS;
+   *polyFrac = DEFPOLYFRAC;
+   *dupFrac  = DEFDUPFRAC;
+   *ninfiles = 0;
+   outfile[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+            return(FALSE);
+
+         switch(argv[0][1])
+         {
+         case 'n':
+            if(!(--argc) || (sscanf((++argv)[0], "%ld", natoms) != 1))
+               return(FALSE);
+            break;
+         case 'p':
+            if(!(--argc) || (sscanf((++argv)[0], "%lf", polyFrac) != 1))
+               return(FALSE);
+            break;
+         case 'd':
+            if(!(--argc) || (sscanf((++argv)[0], "%lf", dupFrac) != 1))
+               return(FALSE);
+            break;
+         default:
+            return(FALSE);
+            break;
+         }
+      }
+      else
+      {
+         /* At least one input and the output                           */
+         if((argc < 2) || (argc > MAXINPUT+1))
+            return(FALSE);
+
+         for(; argc > 1; argc--, argv++)
+         {
+            strncpy(infiles[*ninfiles], argv[0], MAXBUFF-1);
+            infiles[(*ninfiles)++][MAXBUFF-1] = '\0';
+         }
+         strncpy(outfile, argv[0], MAXBUFF-1);
+         outfile[MAXBUFF-1] = '\0';
+
+         return((*natoms > 0) && (*polyFrac >= 0.0) &&
+                (*polyFrac <= 1.0));
+      }
+
+      argc--;
+      argv++;
+   }
+   return(FALSE);
+}
@@ -0,0 +1,1024 @@
+/*************************************************************************
+
+   Program:    microbench
+   File:       microbench.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Benchmark the individual conversion kernels
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Times each kernel on its own using fixed data: the 'atom' records of
+   the Tinker parameter file and the ATOM records of a PDB file (by
+   default test/1yqv.pdb). Each kernel is run a number of times to warm
+   up and then a number of timed repetitions. Any per-repetition set-up
+   (such as copying the PDB list for the passes that change it) is not
+   timed.
+
+   For each kernel the minimum, median, mean and standard deviation of
+   the repetition time are given, together with the median time per
+   call (one call being one atom type, one line or one pass over the
+   structure as appropriate) and, where the perf counters are
+   available, the median cache misses per call.
+
+   For the passes from tinkerpdb the atom names have their digits
+   removed so that they look like the names coming from the Tinker
+   atom types. Each atom's Tinker type for NameTinkerAtom() is found
+   from these names. The Tinker XYZ data are made from the PDB file with
+   each atom connected to the one before and after it.
+
+   The number parsing kernels use the coordinates formatted as they
+   are in Tinker XYZ (%12.6f) and PDB (%8.3f) files. Before anything is
+   timed, ParseRealToken() is checked against strtod() for exact
+   equality on these and on a sweep of random values in each format;
+   any difference is an error.
+
+**************************************************************************
+
+   Usage:
+   ======
+   microbench [-w nwarm] [-r nrep] [-k kernel] param.prm [in.pdb]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added the number parsing and ReadPDBHy36() kernels
+                    and the check against strtod()   By: ACRM
+   V1.2   19.10.26  NameTinkerAtom() replaces the FixHydrogens() and
+                    FixAtomNames() kernels   By: ACRM
+
+*************************************************************************/
+/* clock_gettime() is not ANSI                                          */
+#define _POSIX_C_SOURCE 199309L
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "bioplib/general.h"
+#include "bioplib/fsscanf.h"
+#include "tinkertypes.h"
+#include "tinkerxyz.h"
+#include "pdbfixup.h"
+#include "perfcount.h"
+#include "numparse.h"
+#include "hybrid36.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define DEFWARMUP        3
+#define DEFREPEATS      25
+#define DEFDATASET    "../test/1yqv.pdb"
+#define TINKERDATA    "TINKERDATA"
+#define MAXNUMBER       16
+#define NCHECKNUMBERS 1000000
+
+typedef struct
+{
+   char *name;
+   void (*setup)(void);     /* Untimed, before each repetition          */
+   void (*run)(void);       /* Timed                                    */
+   void (*teardown)(void);  /* Untimed, after each repetition           */
+   long *ncalls;            /* Calls made by one run                    */
+}  KERNEL;
+
+
+/************************************************************************/
+/* Globals
+*/
+/* Fixed data                                                           */
+static char      **gTypeRecords = NULL;
+static char      (*gWords)[MAXWORDS][MAXTYPELABEL] = NULL;
+static int       *gNWords       = NULL;
+static long      gNTypes        = 0;
+static PDB       *gPDB          = NULL;
+static long      gNAtoms        = 0;
+static char      **gXYZLines    = NULL;
+static TINKERXYZ *gXYZ          = NULL;
+static char      gPDBFile[MAXBUFF];
+static char      (*gNumbers)[MAXNUMBER] = NULL;
+static long      gNNumbers      = 0;
+static long      gOne           = 1;
+static TINKERTYPES *gTypes      = NULL;
+static int       *gAtomTypes    = NULL;
+
+/* Working data for a repetition                                        */
+static PDB       *gWork         = NULL;
+static TINKERXYZ *gWorkXYZ      = NULL;
+static FILE      *gPDBFp        = NULL;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int  main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, int *nWarm, int *nRep,
+                  char *kernel, char *paramFile, char *pdbFile);
+void Usage(void);
+BOOL ReadTypeRecords(FILE *fp);
+BOOL ReadDataset(char *filename);
+BOOL BuildAtomTypes(FILE *fp);
+BOOL BuildXYZ(void);
+BOOL BuildNumbers(void);
+BOOL CheckNumber(char *string);
+BOOL CheckNumberParsing(void);
+PDB  *CopyPDBList(PDB *pdb);
+void StripNameDigits(PDB *pdb);
+void RunKernel(KERNEL *kernel, int nWarm, int nRep, double *times,
+               long *misses, BOOL perf);
+int  CompareDoubles(const void *a, const void *b);
+int  CompareLongs(const void *a, const void *b);
+double Now(void);
+
+void RunExtractTypes(void);
+void RunConvertDescription(void);
+void SetupPDB(void);
+void TeardownPDB(void);
+void RunNameTinkerAtom(void);
+void RunDoChain(void);
+void RunRenumberResidues(void);
+void SetupXYZ(void);
+void TeardownXYZ(void);
+void RunFixOverlaps(void);
+void RunParseXYZ(void);
+void RunParseRealToken(void);
+void RunStrtod(void);
+void SetupReadPDB(void);
+void RunReadPDB(void);
+void RunReadPDBHy36(void);
+void TeardownReadPDB(void);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*/
+int main(int argc, char **argv)
+{
+   KERNEL kernels[] =
+      {{"ExtractTypesFromTinkerAtomRecord", NULL, RunExtractTypes, NULL,
+        &gNTypes},
+       {"ConvertTinkerDescriptionToResnamAndAtnam", NULL,
+        RunConvertDescription, NULL, &gNTypes},
+       {"NameTinkerAtom",   SetupPDB, RunNameTinkerAtom, TeardownPDB,
+        &gNAtoms},
+       {"DoChain",          SetupPDB, RunDoChain, TeardownPDB, &gOne},
+       {"RenumberResidues", SetupPDB, RunRenumberResidues, TeardownPDB,
+        &gOne},
+       {"FixOverlaps",      SetupXYZ, RunFixOverlaps, TeardownXYZ,
+        &gOne},
+       {"ParseTinkerXYZAtom", NULL, RunParseXYZ, NULL, &gNAtoms},
+       {"ParseRealToken",   NULL, RunParseRealToken, NULL, &gNNumbers},
+       {"strtod",           NULL, RunStrtod, NULL, &gNNumbers},
+       {"blReadPDBAtoms",   SetupReadPDB, RunReadPDB, TeardownReadPDB,
+        &gNAtoms},
+       {"ReadPDBHy36",      SetupReadPDB, RunReadPDBHy36, TeardownReadPDB,
+        &gNAtoms},
+       {NULL, NULL, NULL, NULL, NULL}};
+   char   paramFile[MAXBUFF],
+          kernelName[MAXBUFF];
+   FILE   *pFp;
+   BOOL   noEnv = FALSE,
+          perf;
+   int    nWarm, nRep, i, k;
+   double *times,
+          mean, sd;
+   long   *misses;
+
+   if(!ParseCmdLine(argc, argv, &nWarm, &nRep, kernelName, paramFile,
+                    gPDBFile))
+   {
+      Usage();
+      return(0);
+   }
+
+   if((pFp=blOpenFile(paramFile, TINKERDATA, "r", &noEnv))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to open parameter file: %s\n",
+              paramFile);
+      if(noEnv)
+         fprintf(stderr,"       %s environment variable not set\n",
+                 TINKERDATA);
+      return(1);
+   }
+   if(!ReadTypeRecords(pFp) || !ReadDataset(gPDBFile) ||
+      !BuildAtomTypes(pFp) || !BuildXYZ() || !BuildNumbers() ||
+      !CheckNumberParsing())
+      return(1);
+   fclose(pFp);
+
+   if(((times=(double *)malloc(nRep*sizeof(double)))==NULL) ||
+      ((misses=(long *)malloc(nRep*sizeof(long)))==NULL))
+   {
+      fprintf(stderr,"Error: No memory for results\n");
+      return(1);
+   }
+
+   perf = PerfCountersOpen() && PerfCountersAvailable(PERF_CACHE_MISSES);
+
+   printf("# %ld atom types, %ld atoms from %s, %d warm-up, \
+%d repetitions\n", gNTypes, gNAtoms, gPDBFile, nWarm, nRep);
+   printf("# Times are per repetition in microseconds%s\n",
+          (perf?"":"; cache misses unavailable"));
+   printf("%-40s %8s %10s %10s %10s %9s %12s %12s\n",
+          "kernel", "calls", "min", "median", "mean", "sd",
+          "ns/call", "misses/call");
+
+   for(k=0; kernels[k].name!=NULL; k++)
+   {
+      if(kernelName[0] && strcmp(kernelName, kernels[k].name))
+         continue;
+
+      RunKernel(&(kernels[k]), nWarm, nRep, times, misses, perf);
+
+      for(i=0, mean=0.0; i<nRep; i++)
+         mean += times[i];
+      mean /= nRep;
+      for(i=0, sd=0.0; i<nRep; i++)
+         sd += (times[i] - mean) * (times[i] - mean);
+      sd = (nRep > 1) ? sqrt(sd / (nRep - 1)) : 0.0;
+
+      qsort(times,  nRep, sizeof(double), CompareDoubles);
+      qsort(misses, nRep, sizeof(long),   CompareLongs);
+
+      printf("%-40s %8ld %10.1f %10.1f %10.1f %9.1f %12.1f ",
+             kernels[k].name, *(kernels[k].ncalls),
+             times[0]*1.0e6, times[nRep/2]*1.0e6, mean*1.0e6, sd*1.0e6,
+             times[nRep/2]*1.0e9 / *(kernels[k].ncalls));
+      if(perf)
+         printf("%12.2f\n", (double)misses[nRep/2] / *(kernels[k].ncalls));
+      else
+         printf("%12s\n", "-");
+   }
+
+   PerfCountersClose();
+   return(0);
+}
+
+
+/************************************************************************/
+/*>void RunKernel(KERNEL *kernel, int nWarm, int nRep, double *times,
+                  long *misses, BOOL perf)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   *kernel   The kernel to run
+   \param[in]   nWarm     Number of untimed runs
+   \param[in]   nRep      Number of timed runs
+   \param[out]  *times    Time for each timed run (seconds)
+   \param[out]  *misses   Cache misses for each timed run
+   \param[in]   perf      Are the perf counters available?
+
+-  19.10.26 Original   By: ACRM
+*/
+void RunKernel(KERNEL *kernel, int nWarm, int nRep, double *times,
+               long *misses, BOOL perf)
+{
+   long   values[MAXPERFCOUNTERS];
+   double start;
+   int    i;
+
+   for(i=0; i<nWarm; i++)
+   {
+      if(kernel->setup != NULL)    (*kernel->setup)();
+      (*kernel->run)();
+      if(kernel->teardown != NULL) (*kernel->teardown)();
+   }
+
+   for(i=0; i<nRep; i++)
+   {
+      if(kernel->setup != NULL)
+         (*kernel->setup)();
+
+      if(perf)
+         PerfCountersStart();
+      start = Now();
+      (*kernel->run)();
+      times[i] = Now() - start;
+      if(perf)
+      {
+         PerfCountersStop(values);
+         misses[i] = values[PERF_CACHE_MISSES];
+      }
+      else
+      {
+         misses[i] = 0;
+      }
+
+      if(kernel->teardown != NULL)
+         (*kernel->teardown)();
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL ReadTypeRecords(FILE *fp)
+   ------------------------------
+*//**
+   \param[in]   *fp   Tinker parameter file
+   \return            Success
+
+   Stores the quoted descriptions from the 'atom' records as they are
+   passed to ExtractTypesFromTinkerAtomRecord() and split into words as
+   they are passed to ConvertTinkerDescriptionToResnamAndAtnam()
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ReadTypeRecords(FILE *fp)
+{
+   char buffer[MAXBUFF],
+        atomType[MAXTYPELABEL],
+        *ptr;
+   int  atnum;
+   long n = 0,
+        maxTypes = 0;
+
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      if(!strncmp(buffer, "atom   ", 7))
+         maxTypes++;
+   }
+   rewind(fp);
+
+   if((maxTypes == 0) ||
+      ((gTypeRecords=(char **)malloc(maxTypes*sizeof(char *)))==NULL) ||
+      ((gWords=malloc(maxTypes*sizeof(*gWords)))==NULL) ||
+      ((gNWords=(int *)malloc(maxTypes*sizeof(int)))==NULL))
+   {
+      fprintf(stderr,"Error: No atom types in parameter file\n");
+      return(FALSE);
+   }
+
+   while(fgets(buffer, MAXBUFF, fp) && (n < maxTypes))
+   {
+      if(strncmp(buffer, "atom   ", 7))
+         continue;
+
+      fsscanf(buffer, "%10x%5d%15x%27s", &atnum, atomType);
+      if((gTypeRecords[n]=(char *)malloc(MAXTYPELABEL))==NULL)
+         return(FALSE);
+      strcpy(gTypeRecords[n], atomType);
+
+      /* Split into words as ExtractTypesFromTinkerAtomRecord() does    */
+      for(gNWords[n]=0; gNWords[n]<MAXWORDS; gNWords[n]++)
+         gWords[n][gNWords[n]][0] = '\0';
+      ptr = atomType+1;
+      TERMAT(ptr, '"');
+      gNWords[n] = 0;
+      while((ptr=blGetWord(ptr, gWords[n][gNWords[n]], MAXTYPELABEL))
+            !=NULL)
+      {
+         if(gNWords[n] >= MAXWORDS)
+            break;
+         gNWords[n]++;
+      }
+      gNWords[n]++;
+      n++;
+   }
+   gNTypes = n;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL ReadDataset(char *filename)
+   --------------------------------
+*//**
+   \param[in]   *filename   PDB file
+   \return                  Success
+
+   Reads the ATOM records of the PDB file and strips the digits from the
+   atom names
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ReadDataset(char *filename)
+{
+   FILE *fp;
+   PDB  *pdb, *p;
+   int  natoms;
+
+   if((fp=fopen(filename, "r"))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to open PDB file: %s\n", filename);
+      return(FALSE);
+   }
+   pdb = blReadPDBAtoms(fp, &natoms);
+   fclose(fp);
+
+   if(pdb==NULL)
+   {
+      fprintf(stderr,"Error: No atoms read from PDB file\n");
+      return(FALSE);
+   }
+
+   gPDB    = pdb;
+   gNAtoms = 0;
+   for(p=pdb; p!=NULL; NEXT(p))
+      gNAtoms++;
+
+   StripNameDigits(gPDB);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL BuildAtomTypes(FILE *fp)
+   -----------------------------
+*//**
+   \param[in]   *fp   Tinker parameter file
+   \return            Success
+
+   Reads the atom types from the parameter file and finds the Tinker
+   type of each atom in the PDB data
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL BuildAtomTypes(FILE *fp)
+{
+   PDB  *p;
+   long i;
+
+   rewind(fp);
+   if(((gTypes=ReadTinkerAtomTypes(fp))==NULL) ||
+      ((gAtomTypes=(int *)malloc(gNAtoms*sizeof(int)))==NULL))
+   {
+      fprintf(stderr,"Error: No memory for atom types\n");
+      return(FALSE);
+   }
+
+   for(p=gPDB, i=0; p!=NULL; NEXT(p), i++)
+      gAtomTypes[i] = FindTinkerAtomType(gTypes, p->resnam, p->atnam,
+                                         TERM_NONE);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void StripNameDigits(PDB *pdb)
+   ------------------------------
+*//**
+   \param[in,out]  *pdb   PDB linked list
+
+   Removes digits from the atom names (e.g. HB2 becomes HB) so they look
+   like the names made from the Tinker atom types
+
+-  19.10.26 Original   By: ACRM
+*/
+void StripNameDigits(PDB *pdb)
+{
+   PDB  *p;
+   char *in, *out;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      for(in=out=p->atnam; *in; in++)
+      {
+         if(!isdigit((int)*in))
+            *(out++) = *in;
+      }
+      *out = '\0';
+      PADMINTERM(p->atnam, 4);
+
+      for(in=out=p->atnam_raw; *in; in++)
+      {
+         if(!isdigit((int)*in))
+            *(out++) = *in;
+      }
+      *out = '\0';
+      PADMINTERM(p->atnam_raw, 4);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL BuildXYZ(void)
+   -------------------
+*//**
+   \return   Success
+
+   Builds a Tinker XYZ list and the corresponding file lines from the
+   PDB data. Each atom is connected to its neighbours in the list.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL BuildXYZ(void)
+{
+   TINKERXYZ *t = NULL;
+   PDB       *p;
+   long      i;
+
+   if((gXYZLines=(char **)malloc(gNAtoms*sizeof(char *)))==NULL)
+      return(FALSE);
+
+   for(p=gPDB, i=0; p!=NULL; NEXT(p), i++)
+   {
+      if(gXYZ==NULL)
+      {
+         INIT(gXYZ, TINKERXYZ);
+         t = gXYZ;
+      }
+      else
+      {
+         ALLOCNEXT(t, TINKERXYZ);
+      }
+      if((t==NULL) ||
+         ((gXYZLines[i]=(char *)malloc(MAXXYZBUFF))==NULL))
+      {
+         fprintf(stderr,"Error: No memory for Tinker XYZ data\n");
+         return(FALSE);
+      }
+
+      t->atnum = (int)(i+1);
+      strncpy(t->atnam, p->element, MAXXYZLABEL-1);
+      t->atnam[MAXXYZLABEL-1] = '\0';
+      t->x     = p->x;
+      t->y     = p->y;
+      t->z     = p->z;
+      t->type  = 1;
+
+      sprintf(gXYZLines[i], "%6d  %-3s%12.6f%12.6f%12.6f%6d",
+              t->atnum, t->atnam, t->x, t->y, t->z, t->type);
+      if(i)
+         sprintf(gXYZLines[i]+strlen(gXYZLines[i]), "%6d", t->atnum-1);
+      if(p->next != NULL)
+         sprintf(gXYZLines[i]+strlen(gXYZLines[i]), "%6d", t->atnum+1);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL BuildNumbers(void)
+   -----------------------
+*//**
+   \return   Success
+
+   Formats each coordinate as it appears in a Tinker XYZ file (%12.6f)
+   and in a PDB file (%8.3f)
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL BuildNumbers(void)
+{
+   PDB  *p;
+   long n = 0;
+
+   if((gNumbers=malloc(6*gNAtoms*sizeof(*gNumbers)))==NULL)
+   {
+      fprintf(stderr,"Error: No memory for numbers\n");
+      return(FALSE);
+   }
+
+   for(p=gPDB; p!=NULL; NEXT(p))
+   {
+      sprintf(gNumbers[n++], "%12.6f", p->x);
+      sprintf(gNumbers[n++], "%12.6f", p->y);
+      sprintf(gNumbers[n++], "%12.6f", p->z);
+      sprintf(gNumbers[n++], "%8.3f",  p->x);
+      sprintf(gNumbers[n++], "%8.3f",  p->y);
+      sprintf(gNumbers[n++], "%8.3f",  p->z);
+   }
+   gNNumbers = n;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL CheckNumber(char *string)
+   ------------------------------
+*//**
+   \param[in]   *string   A number
+   \return                Do ParseRealToken() and strtod() agree 
+                          exactly on the value and the end of the
+                          number?
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL CheckNumber(char *string)
+{
+   REAL   value;
+   double expected;
+   char   *end, *expectedEnd;
+
+   end      = ParseRealToken(string, &value);
+   expected = strtod(string, &expectedEnd);
+
+   if((end != expectedEnd) ||
+      memcmp(&value, &expected, sizeof(double)))
+   {
+      fprintf(stderr,"Error: ParseRealToken() gives %.17g for '%s'; \
+strtod() gives %.17g\n", value, string, expected);
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL CheckNumberParsing(void)
+   -----------------------------
+*//**
+   \return   Does ParseRealToken() agree with strtod() on every number?
+
+   Checks the dataset numbers, some awkward cases and NCHECKNUMBERS
+   random values in each of the formats used in Tinker XYZ and PDB
+   files, across the range of magnitudes they can hold
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL CheckNumberParsing(void)
+{
+   static char *formats[] = {"%12.6f", "%8.3f", "%6.2f", NULL},
+               *awkward[] = {"0", "-0.000", "000123.4500", "1.5e3",
+                             "-.25", "7.", "+3.25", "-12.345x",
+                             "123456789012345678",
+                             "9007199254740993",
+                             "0.00000000000000000000000125",
+                             NULL};
+   static double scale[] = {1.0, 10.0, 100.0, 1000.0, 1.0e4, 1.0e5};
+   char   buffer[MAXBUFF];
+   long   i;
+   int    f;
+
+   for(i=0; i<gNNumbers; i++)
+   {
+      if(!CheckNumber(gNumbers[i]))
+         return(FALSE);
+   }
+   for(i=0; awkward[i]!=NULL; i++)
+   {
+      if(!CheckNumber(awkward[i]))
+         return(FALSE);
+   }
+
+   srand(1);
+   for(f=0; formats[f]!=NULL; f++)
+   {
+      for(i=0; i<NCHECKNUMBERS; i++)
+      {
+         sprintf(buffer, formats[f], 
+                 ((double)rand() / RAND_MAX - 0.5) * scale[i%6]);
+         if(!CheckNumber(buffer))
+            return(FALSE);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>PDB *CopyPDBList(PDB *pdb)
+   --------------------------
+*//**
+   \param[in]   *pdb   PDB linked list
+   \return             A copy of the list
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *CopyPDBList(PDB *pdb)
+{
+   PDB *copy = NULL,
+       *p, *q = NULL;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(copy==NULL)
+      {
+         INIT(copy, PDB);
+         q = copy;
+      }
+      else
+      {
+         ALLOCNEXT(q, PDB);
+      }
+      if(q==NULL)
+      {
+         fprintf(stderr,"Error: No memory to copy PDB data\n");
+         exit(1);
+      }
+      blCopyPDB(q, p);
+   }
+   return(copy);
+}
+
+
+/************************************************************************/
+/* The kernels. Each run() is timed; setup() and teardown() are not.
+*/
+void RunExtractTypes(void)
+{
+   char resnam[MAXLABEL],
+        atnam[MAXLABEL];
+   BOOL isHet;
+   int  terminus;
+   long i;
+
+   for(i=0; i<gNTypes; i++)
+      ExtractTypesFromTinkerAtomRecord(gTypeRecords[i], resnam, atnam,
+                                       &isHet, &terminus);
+}
+
+void RunConvertDescription(void)
+{
+   char resnam[MAXLABEL],
+        atnam[MAXLABEL];
+   BOOL isHet;
+   long i;
+
+   for(i=0; i<gNTypes; i++)
+      ConvertTinkerDescriptionToResnamAndAtnam(gWords[i], gNWords[i],
+                                               resnam, atnam, &isHet);
+}
+
+void SetupPDB(void)
+{
+   gWork = CopyPDBList(gPDB);
+}
+
+void TeardownPDB(void)
+{
+   FREELIST(gWork, PDB);
+   gWork = NULL;
+}
+
+void RunNameTinkerAtom(void)
+{
+   ATOMNAMER namer;
+   PDB       *p;
+   long      i;
+
+   InitAtomNamer(&namer);
+   for(p=gWork, i=0; p!=NULL; NEXT(p), i++)
+      strcpy(p->atnam_raw, NameTinkerAtom(gTypes, &namer, gAtomTypes[i],
+                                          p->resnam, p->resnum));
+}
+
+void RunDoChain(void)
+{
+   DoChain(gWork, NULL, FALSE);
+}
+
+void RunRenumberResidues(void)
+{
+   RenumberResidues(gWork);
+}
+
+void SetupXYZ(void)
+{
+   TINKERXYZ *t, *q = NULL;
+
+   gWorkXYZ = NULL;
+   for(t=gXYZ; t!=NULL; NEXT(t))
+   {
+      if(gWorkXYZ==NULL)
+      {
+         INIT(gWorkXYZ, TINKERXYZ);
+         q = gWorkXYZ;
+      }
+      else
+      {
+         ALLOCNEXT(q, TINKERXYZ);
+      }
+      if(q==NULL)
+      {
+         fprintf(stderr,"Error: No memory to copy Tinker XYZ data\n");
+         exit(1);
+      }
+      *q      = *t;
+      q->next = NULL;
+   }
+}
+
+void TeardownXYZ(void)
+{
+   FREELIST(gWorkXYZ, TINKERXYZ);
+   gWorkXYZ = NULL;
+}
+
+void RunFixOverlaps(void)
+{
+   FixOverlaps(gWorkXYZ, NULL);
+}
+
+void RunParseXYZ(void)
+{
+   TINKERXYZ t;
+   long      i;
+
+   for(i=0; i<gNAtoms; i++)
+      ParseTinkerXYZAtom(gXYZLines[i], &t);
+}
+
+void RunParseRealToken(void)
+{
+   REAL value;
+   long i;
+
+   for(i=0; i<gNNumbers; i++)
+      ParseRealToken(gNumbers[i], &value);
+}
+
+void RunStrtod(void)
+{
+   long i;
+
+   for(i=0; i<gNNumbers; i++)
+      strtod(gNumbers[i], NULL);
+}
+
+void SetupReadPDB(void)
+{
+   if((gPDBFp=fopen(gPDBFile, "r"))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to open PDB file: %s\n", gPDBFile);
+      exit(1);
+   }
+}
+
+void RunReadPDB(void)
+{
+   int natoms;
+   gWork = blReadPDBAtoms(gPDBFp, &natoms);
+}
+
+void RunReadPDBHy36(void)
+{
+   int natoms;
+   gWork = ReadPDBHy36(gPDBFp, &natoms);
+}
+
+void TeardownReadPDB(void)
+{
+   fclose(gPDBFp);
+   FREELIST(gWork, PDB);
+   gWork = NULL;
+}
+
+
+/************************************************************************/
+double Now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+}
+
+
+/************************************************************************/
+int CompareDoubles(const void *a, const void *b)
+{
+   double da = *(const double *)a,
+          db = *(const double *)b;
+   return((da < db) ? -1 : ((da > db) ? 1 : 0));
+}
+
+
+/************************************************************************/
+int CompareLongs(const void *a, const void *b)
+{
+   long la = *(const long *)a,
+        lb = *(const long *)b;
+   return((la < lb) ? -1 : ((la > lb) ? 1 : 0));
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*/
+void Usage(void)
+{
+   fprintf(stderr,"Usage: microbench [-w nwarm] [-r nrep] [-k kernel] \
+param.prm [in.pdb]\n");
+   fprintf(stderr,"       -w  Number of warm-up runs (default %d)\n",
+           DEFWARMUP);
+   fprintf(stderr,"       -r  Number of timed runs (default %d)\n",
+           DEFREPEATS);
+   fprintf(stderr,"       -k  Only run the named kernel\n");
+   fprintf(stderr,"in.pdb defaults to %s\n", DEFDATASET);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, int *nWarm, int *nRep,
+                     char *kernel, char *paramFile, char *pdbFile)
+   ---------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  int    *nWarm        Number of warm-up runs
+            int    *nRep         Number of timed runs
+            char   *kernel       Kernel to run (or blank string)
+            char   *paramFile    Tinker parameter file
+            char   *pdbFile      PDB file
+   Returns: BOOL                 Success?
+
+   Parse the command line
+
+   19.10.26  Original   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, int *nWarm, int *nRep,
+                  char *kernel, char *paramFile, char *pdbFile)
+{
+   argc--;
+   argv++;
+
+   *nWarm = DEFWARMUP;
+   *nRep  = DEFREPEATS;
+   kernel[0] = paramFile[0] = '\0';
+   strcpy(pdbFile, DEFDATASET);
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+            return(FALSE);
+
+         switch(argv[0][1])
+         {
+         case 'w':
+            if(!(--argc) || (sscanf((++argv)[0], "%d", nWarm) != 1) ||
+               (*nWarm < 0))
+               return(FALSE);
+            break;
+         case 'r':
+            if(!(--argc) || (sscanf((++argv)[0], "%d", nRep) != 1) ||
+               (*nRep < 1))
+               return(FALSE);
+            break;
+         case 'k':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(kernel, argv[0], MAXBUFF-1);
+            kernel[MAXBUFF-1] = '\0';
+            break;
+         default:
+            return(FALSE);
+            break;
+         }
+      }
+      else
+      {
+         /* Check that there are 1 or 2 arguments left                  */
+         if(argc > 2)
+            return(FALSE);
+
+         strncpy(paramFile, argv[0], MAXBUFF-1);
+         paramFile[MAXBUFF-1] = '\0';
+         if(argc == 2)
+         {
+            strncpy(pdbFile, argv[1], MAXBUFF-1);
+            pdbFile[MAXBUFF-1] = '\0';
+         }
+         return(TRUE);
+      }
+
+      argc--;
+      argv++;
+   }
+   return(FALSE);
+}
@@ -0,0 +1,150 @@
+#!/bin/sh
+# End-to-end benchmark of the conversion programs on synthetic solvated
+# structures built from the test PDB files by benchgen.
+#
+# Usage: runbench.sh [-u] [-l] [-p paramfile] [natoms ...]
+#        -u  Update the baseline rather than checking against it
+#        -l  Also run 1000000 and 10000000 atoms
+#        -p  Tinker parameter file (default ../../params/amber99.prm)
+#
+# Each program is run with -S and the wall time and peak memory are
+# taken from its statistics file. The best of BENCH_REPEAT (default 3)
+# runs is kept. Results are compared against
+# baseline.txt and the script fails if any program is more than
+# BENCH_TOLERANCE (default 0.25) slower or bigger than the baseline.
+# The baseline is only meaningful on the machine where it was recorded,
+# which is given at the top of baseline.txt. To record a new one, run
+# the script with -u (and -l to include the large sizes) on an idle
+# machine.
+#
+# Tinker XYZ files can't hold more than 999999 atoms, so above that size
+# only benchgen and tinkerpatch are run.
+
+bindir=..
+testdir=../test
+paramfile=../../params/amber99.prm
+baseline=baseline.txt
+tolerance=${BENCH_TOLERANCE:-0.25}
+repeat=${BENCH_REPEAT:-3}
+workdir=${BENCH_WORKDIR:-/tmp/tinkerbench.$$}
+update=0
+large=0
+
+while [ $# -gt 0 ]; do
+    case $1 in
+    -u) update=1; shift;;
+    -l) large=1; shift;;
+    -p) paramfile=$2; shift 2;;
+    -*) echo "Usage: runbench.sh [-u] [-l] [-p paramfile] [natoms ...]" >&2
+        exit 1;;
+    *)  break;;
+    esac
+done
+
+sizes=${*:-"1000 10000 100000"}
+[ $large -eq 1 ] && sizes="$sizes 1000000 10000000"
+mkdir -p $workdir
+results=$workdir/results.txt
+: > $results
+
+# Describes this machine for the top of the baseline
+machine()
+{
+    echo "`uname -n` `uname -sm`, \
+`sed -n 's/^model name[^:]*: *//p' /proc/cpuinfo 2>/dev/null | head -1`, \
+`getconf _NPROCESSORS_ONLN 2>/dev/null` CPUs"
+}
+
+# Pulls a top-level number out of a statistics file
+getstat()
+{
+    sed -n "s/^  \"$1\": \([0-9.]*\),*$/\1/p" $2
+}
+
+# Runs one program BENCH_REPEAT times and records the best atoms/s and
+# peak memory
+# Usage: run tool natoms arguments...
+run()
+{
+    tool=$1
+    natoms=$2
+    shift 2
+    rate=-
+    rss=-
+    i=0
+    while [ $i -lt $repeat ]; do
+        i=`expr $i + 1`
+        rm -f $workdir/$tool.json
+        if $bindir/$tool -S $workdir/$tool.json "$@" > $workdir/$tool.log 2>&1 &&
+           [ -s $workdir/$tool.json ]; then
+            wall=`getstat wall_time $workdir/$tool.json`
+            rss=`getstat peak_rss_kb $workdir/$tool.json`
+            rate=`echo "$natoms $wall $rate" | awk '{r=$1/($2>1e-6?$2:1e-6);
+                  if($3!="-" && $3>r) r=$3; printf "%.0f", r}'`
+        else
+            echo "$tool failed for $natoms atoms (see $workdir/$tool.log)" >&2
+            rate=-
+            rss=-
+            break
+        fi
+    done
+    printf "%-12s %10s %14s %12s\n" $tool $natoms $rate $rss
+    echo "$tool $natoms $rate $rss" >> $results
+}
+
+printf "%-12s %10s %14s %12s\n" program atoms atoms/s peak_rss_kb
+for natoms in $sizes; do
+    pdb=$workdir/bench$natoms.pdb
+    xyz=$workdir/bench$natoms.xyz
+    $bindir/bench/benchgen -n $natoms $testdir/1yqv.pdb $testdir/6fab0.pdb \
+        $pdb 2>/dev/null || exit 1
+
+    if [ $natoms -le 999999 ]; then
+        run pdbtinker   $natoms $paramfile $pdb $xyz
+        run fixoverlap  $natoms $xyz $xyz.fixed
+        run tinkerpdb   $natoms $paramfile $xyz.fixed $workdir/tinker.pdb
+        rm -f $xyz $xyz.fixed $workdir/tinker.pdb
+    fi
+    run tinkerpatch $natoms $pdb $pdb $workdir/patched.pdb
+    rm -f $pdb $workdir/patched.pdb
+done
+
+status=0
+if [ $update -eq 1 ]; then
+    {
+        echo "# Host: `machine`"
+        echo "# Recorded: `date -u '+%Y-%m-%d'` with $paramfile"
+        cat $results
+    } > $baseline
+    echo "Baseline updated"
+elif [ -f $baseline ]; then
+    recorded=`sed -n 's/^# Host: //p' $baseline`
+    if [ -z "$recorded" ]; then
+        echo "Warning: the baseline does not say where it was recorded" >&2
+    elif [ "$recorded" != "`machine`" ]; then
+        echo "Warning: the baseline was recorded on $recorded" >&2
+    fi
+
+    # Lower atoms/s or higher memory than the baseline allows is a
+    # regression. Entries not in the baseline are ignored.
+    awk -v tol=$tolerance '
+        /^#/    { next }
+        NR==FNR { rate[$1" "$2]=$3; rss[$1" "$2]=$4; next }
+        ($1" "$2) in rate {
+            key=$1" "$2
+            if($3 == "-" && rate[key] != "-") {
+                print "REGRESSION: " key " failed"; bad=1
+            } else if(rate[key] != "-" && $3 < rate[key]*(1-tol)) {
+                printf "REGRESSION: %s %s atoms/s (baseline %s)\n", \
+                       key, $3, rate[key]; bad=1
+            }
+            if(rss[key] != "-" && $4 != "-" && $4 > rss[key]*(1+tol)) {
+                printf "REGRESSION: %s %s kB (baseline %s)\n", \
+                       key, $4, rss[key]; bad=1
+            }
+        }
+        END { exit bad }' $baseline $results || status=1
+fi
+
+rm -rf $workdir
+exit $status
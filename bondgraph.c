@@ -0,0 +1,476 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       bondgraph.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Bond connectivity from Tinker XYZ files and its connected
+               components
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Tinker XYZ files give the bonds for each atom, so molecules and
+   chains can be found from the connectivity rather than guessed from
+   distances. The bonds are held in compressed sparse row form and the
+   connected components found by union-find.
+
+   For the union-find on several threads, the atoms are split into
+   contiguous ranges. Each thread joins the bonds lying within its range
+   so only ever touches its own part of the parent array. The few bonds
+   between ranges (atoms are numbered along the chain, so these are
+   mostly inter-chain links) are then joined on one thread. Each set is
+   represented by its lowest numbered atom, so the result does not
+   depend on the number of threads.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "bioplib/macros.h"
+#include "bondgraph.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MINTHREADATOMS 16384   /* Fewest atoms worth a thread           */
+
+/* The range of atoms handled by one thread                             */
+typedef struct
+{
+   BONDGRAPH  *graph;
+   BGLINKFUNC linked;
+   void       *data;
+   int        *parent,
+              *comp,
+              start,
+              stop;
+}  UFRANGE;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL ListsBond(TINKERXYZ *t, int atnum);
+static BOOL RunRanges(UFRANGE *range, int nranges, 
+                      void *(*func)(void *));
+static void *JoinRange(void *arg);
+static void *LabelRange(void *arg);
+static int  FindRoot(int *parent, int i);
+static void JoinSets(int *parent, int a, int b);
+
+
+/************************************************************************/
+/*>BONDGRAPH *BuildBondGraph(TINKERXYZ *xyz)
+   -----------------------------------------
+*//**
+   \param[in]   *xyz   Tinker XYZ linked list
+   \return             Bond graph (NULL if no memory or no atoms)
+
+   Collects the connections from the XYZ atoms. A bond is stored once
+   in each direction whether it is listed on one or both atoms.
+   Connections to atoms that don't exist are ignored.
+
+-  19.10.26 Original   By: ACRM
+*/
+BONDGRAPH *BuildBondGraph(TINKERXYZ *xyz)
+{
+   BONDGRAPH *graph;
+   TINKERXYZ **idx;
+   int       natoms,
+             i, j, k;
+
+   if((idx=IndexTinkerXYZ(xyz, &natoms))==NULL)
+      return(NULL);
+
+   if((graph=(BONDGRAPH *)malloc(sizeof(BONDGRAPH)))==NULL)
+   {
+      free(idx);
+      return(NULL);
+   }
+   graph->natoms  = natoms;
+   graph->nbonds  = 0;
+   graph->partner = NULL;
+   if((graph->first=(int *)calloc(natoms+1, sizeof(int)))==NULL)
+   {
+      free(idx);
+      FreeBondGraph(graph);
+      return(NULL);
+   }
+
+   /* Count the bonds of each atom. A bond is taken from the lower
+      numbered atom unless only the higher one lists it
+   */
+   for(i=0; i<natoms; i++)
+   {
+      for(k=0; (k<MAXXYZCONNECT) && idx[i]->connect[k]; k++)
+      {
+         j = idx[i]->connect[k] - 1;
+         if((j < 0) || (j >= natoms) || (j == i))
+            continue;
+         if((j > i) || !ListsBond(idx[j], i+1))
+         {
+            graph->first[i+1]++;
+            graph->first[j+1]++;
+            graph->nbonds++;
+         }
+      }
+   }
+   for(i=0; i<natoms; i++)
+      graph->first[i+1] += graph->first[i];
+
+   if((graph->partner=(int *)malloc((2*graph->nbonds+1) * sizeof(int)))
+      ==NULL)
+   {
+      free(idx);
+      FreeBondGraph(graph);
+      return(NULL);
+   }
+
+   /* Fill in the partners using first[] as the insertion point, which
+      leaves first[i] at the start of atom i+1
+   */
+   for(i=0; i<natoms; i++)
+   {
+      for(k=0; (k<MAXXYZCONNECT) && idx[i]->connect[k]; k++)
+      {
+         j = idx[i]->connect[k] - 1;
+         if((j < 0) || (j >= natoms) || (j == i))
+            continue;
+         if((j > i) || !ListsBond(idx[j], i+1))
+         {
+            graph->partner[graph->first[i]++] = j;
+            graph->partner[graph->first[j]++] = i;
+         }
+      }
+   }
+   for(i=natoms; i>0; i--)
+      graph->first[i] = graph->first[i-1];
+   graph->first[0] = 0;
+
+   free(idx);
+   return(graph);
+}
+
+
+/************************************************************************/
+/*>void FreeBondGraph(BONDGRAPH *graph)
+   ------------------------------------
+*//**
+   \param[in]   *graph   Bond graph to free (may be NULL)
+
+-  19.10.26 Original   By: ACRM
+*/
+void FreeBondGraph(BONDGRAPH *graph)
+{
+   if(graph != NULL)
+   {
+      if(graph->first != NULL)
+         free(graph->first);
+      if(graph->partner != NULL)
+         free(graph->partner);
+      free(graph);
+   }
+}
+
+
+/************************************************************************/
+/*>int *FindBondComponents(BONDGRAPH *graph, BGLINKFUNC linked, 
+                           void *data, int nthreads)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *graph     Bond graph
+   \param[in]   linked     Which bonds to follow (NULL for all of them)
+   \param[in]   *data      Passed to linked()
+   \param[in]   nthreads   Threads to use
+   \return                 Malloc'd array giving, for each atom, the 
+                           lowest numbered atom in its component (NULL
+                           if no memory)
+
+   Finds the connected components of the graph using only the bonds 
+   accepted by linked().
+
+-  19.10.26 Original   By: ACRM
+*/
+int *FindBondComponents(BONDGRAPH *graph, BGLINKFUNC linked, void *data,
+                        int nthreads)
+{
+   UFRANGE *range  = NULL;
+   int     *parent = NULL,
+           *comp   = NULL,
+           i, r, b;
+   BOOL    ok      = FALSE;
+
+   if(nthreads > graph->natoms / MINTHREADATOMS)
+      nthreads = graph->natoms / MINTHREADATOMS;
+   if(nthreads < 1)
+      nthreads = 1;
+
+   if(((parent=(int *)malloc((graph->natoms+1) * sizeof(int)))==NULL) ||
+      ((comp  =(int *)malloc((graph->natoms+1) * sizeof(int)))==NULL) ||
+      ((range =(UFRANGE *)malloc(nthreads * sizeof(UFRANGE)))==NULL))
+      goto cleanup;
+
+   for(i=0; i<graph->natoms; i++)
+      parent[i] = i;
+
+   for(r=0; r<nthreads; r++)
+   {
+      range[r].graph  = graph;
+      range[r].linked = linked;
+      range[r].data   = data;
+      range[r].parent = parent;
+      range[r].comp   = comp;
+      range[r].start  = (int)(((double)graph->natoms * r) / nthreads);
+      range[r].stop   = (int)(((double)graph->natoms * (r+1)) / nthreads);
+   }
+
+   /* Bonds within each range                                          */
+   if(!RunRanges(range, nthreads, JoinRange))
+      goto cleanup;
+
+   /* Bonds between ranges                                             */
+   if(nthreads > 1)
+   {
+      for(r=0; r<nthreads; r++)
+      {
+         for(i=range[r].start; i<range[r].stop; i++)
+         {
+            for(b=graph->first[i]; b<graph->first[i+1]; b++)
+            {
+               if((graph->partner[b] >= range[r].stop) &&
+                  ((linked == NULL) || 
+                   (*linked)(i, graph->partner[b], data)))
+                  JoinSets(parent, i, graph->partner[b]);
+            }
+         }
+      }
+   }
+
+   /* Label each atom with its set                                     */
+   ok = RunRanges(range, nthreads, LabelRange);
+
+cleanup:
+   if(parent != NULL)
+      free(parent);
+   if(range != NULL)
+      free(range);
+   if(!ok && (comp != NULL))
+   {
+      free(comp);
+      comp = NULL;
+   }
+   return(comp);
+}
+
+
+/************************************************************************/
+/*>static BOOL ListsBond(TINKERXYZ *t, int atnum)
+   ----------------------------------------------
+*//**
+   \param[in]   *t       Tinker XYZ atom
+   \param[in]   atnum    Atom number
+   \return               Is atnum among the atom's connections?
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL ListsBond(TINKERXYZ *t, int atnum)
+{
+   int k;
+   for(k=0; (k<MAXXYZCONNECT) && t->connect[k]; k++)
+   {
+      if(t->connect[k] == atnum)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunRanges(UFRANGE *range, int nranges, 
+                         void *(*func)(void *))
+   ---------------------------------------------------
+*//**
+   \param[in,out]  *range    The ranges
+   \param[in]      nranges   Number of ranges
+   \param[in]      func      Thread function
+   \return                   FALSE if a thread could not be started
+
+   Runs func() on each range, on the calling thread if there is only 
+   one.
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL RunRanges(UFRANGE *range, int nranges, 
+                      void *(*func)(void *))
+{
+   pthread_t *tid;
+   int       i,
+             nstarted = 0;
+   BOOL      ok       = TRUE;
+
+   if(nranges == 1)
+   {
+      (*func)((void *)range);
+      return(TRUE);
+   }
+
+   if((tid=(pthread_t *)malloc(nranges * sizeof(pthread_t)))==NULL)
+      return(FALSE);
+   
+   for(i=0; i<nranges; i++)
+   {
+      if(pthread_create(&(tid[i]), NULL, func, (void *)&(range[i])) != 0)
+      {
+         fprintf(stderr,"Error: Unable to start thread\n");
+         ok = FALSE;
+         break;
+      }
+      nstarted++;
+   }
+   for(i=0; i<nstarted; i++)
+      pthread_join(tid[i], NULL);
+
+   free(tid);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static void *JoinRange(void *arg)
+   ---------------------------------
+*//**
+   \param[in,out]  *arg   The UFRANGE to work on
+   \return                NULL
+
+   Thread function. Joins the sets of the atoms bonded within the range.
+   Only the range's part of the parent array is read or written.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *JoinRange(void *arg)
+{
+   UFRANGE   *range = (UFRANGE *)arg;
+   BONDGRAPH *graph = range->graph;
+   int       i, j, b;
+
+   for(i=range->start; i<range->stop; i++)
+   {
+      for(b=graph->first[i]; b<graph->first[i+1]; b++)
+      {
+         j = graph->partner[b];
+         if((j > i) && (j < range->stop) &&
+            ((range->linked == NULL) || (*range->linked)(i, j, range->data)))
+            JoinSets(range->parent, i, j);
+      }
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *LabelRange(void *arg)
+   ----------------------------------
+*//**
+   \param[in,out]  *arg   The UFRANGE to work on
+   \return                NULL
+
+   Thread function. Sets comp[] for the range to the root of each atom's
+   set. The parent array is only read so the paths are not compressed.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *LabelRange(void *arg)
+{
+   UFRANGE *range = (UFRANGE *)arg;
+   int     i, root;
+
+   for(i=range->start; i<range->stop; i++)
+   {
+      for(root=i; range->parent[root]!=root; root=range->parent[root]);
+      range->comp[i] = root;
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static int FindRoot(int *parent, int i)
+   ---------------------------------------
+*//**
+   \param[in,out]  *parent   Parent of each atom
+   \param[in]      i         Atom
+   \return                   Root of the atom's set
+
+   Finds the root, halving the path on the way.
+
+-  19.10.26 Original   By: ACRM
+*/
+static int FindRoot(int *parent, int i)
+{
+   while(parent[i] != i)
+   {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+   }
+   return(i);
+}
+
+
+/************************************************************************/
+/*>static void JoinSets(int *parent, int a, int b)
+   -----------------------------------------------
+*//**
+   \param[in,out]  *parent   Parent of each atom
+   \param[in]      a         Atom
+   \param[in]      b         Atom
+
+   Joins the sets containing a and b. The lower root becomes the root of
+   the combined set.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void JoinSets(int *parent, int a, int b)
+{
+   a = FindRoot(parent, a);
+   b = FindRoot(parent, b);
+   if(a < b)
+      parent[b] = a;
+   else if(b < a)
+      parent[a] = b;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       bondgraph.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Bond connectivity from Tinker XYZ files and its connected
+               components
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+#ifndef _BONDGRAPH_H
+#define _BONDGRAPH_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "tinkerxyz.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+
+/* Bonds in compressed sparse row form. Atoms are numbered from 0 in
+   file order. The atoms bonded to atom i are 
+   partner[first[i]] ... partner[first[i+1]-1]. Each bond is stored in 
+   both directions.
+*/
+typedef struct
+{
+   int natoms,
+       nbonds,
+       *first,
+       *partner;
+}  BONDGRAPH;
+
+/* Says whether a bond between atoms a and b should be followed when
+   finding components. Called on several threads at once
+*/
+typedef BOOL (*BGLINKFUNC)(int a, int b, void *data);
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BONDGRAPH *BuildBondGraph(TINKERXYZ *xyz);
+void FreeBondGraph(BONDGRAPH *graph);
+int *FindBondComponents(BONDGRAPH *graph, BGLINKFUNC linked, void *data,
+                        int nthreads);
+
+#endif
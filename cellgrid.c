@@ -0,0 +1,646 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       cellgrid.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Cell list for finding neighbouring atoms without an
+               all-pairs search
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Coordinates are passed as a packed array of x,y,z triplets. Any two
+   atoms closer than the cell size are guaranteed to be in the same or
+   adjacent cells, so a neighbour search only needs to look at the 27
+   cells around an atom.
+
+   Typical use:
+
+      grid = BuildCellGrid(coor, natoms, cutoff);
+      cell = GetCellIndex(grid, x, y, z);
+      ncells = GetNeighbourCells(grid, cell, cells);
+      for(i=0; i<ncells; i++)
+         for(j=grid->head[cells[i]]; j!=(-1); j=grid->next[j])
+            ...
+
+   For large structures, BuildSortedCellGrid() gives the same search
+   with the atoms reordered along a space-filling curve. The loop then
+   reads grid->coor[3*j] and maps back to the atom with grid->order[j].
+
+   If an atom is moved while the grid is in use, MoveCellGridAtom()
+   puts it in its new cell so later searches still find it.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added BuildSortedCellGrid()   By: ACRM
+   V1.2   19.10.26  Added BuildPeriodicCellGrid()   By: ACRM
+   V1.3   19.10.26  Added MoveCellGridAtom()   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "cellgrid.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXCELLSPERATOM 8     /* Grow the cells if the grid is sparser  */
+#define MORTONBITS     10     /* Bits per axis in a Morton key          */
+#define MORTONAXIS   (1 << MORTONBITS)
+#define MORTONRADIX  (1 << MORTONBITS)  /* One radix pass per axis bits */
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static CELLGRID *AllocCellGrid(REAL *coor, int natoms, REAL cellSize,
+                               REAL *box);
+static BOOL SortCellGrid(CELLGRID *grid, REAL *coor);
+static void BinAtoms(CELLGRID *grid, REAL *coor);
+static int  WrapCell(int i, int n);
+static unsigned long SpreadBits(int value);
+
+
+/************************************************************************/
+/*>CELLGRID *BuildCellGrid(REAL *coor, int natoms, REAL cellSize)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *coor      Packed x,y,z coordinates (3*natoms)
+   \param[in]   natoms     Number of atoms
+   \param[in]   cellSize   Minimum cell size (the search cutoff)
+   \return                 Cell grid (NULL if no memory)
+
+   Bins the atoms into cells. If the structure is very sparse the cells
+   are enlarged so that the grid never has many more cells than atoms.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Grid set up by AllocCellGrid()   By: ACRM
+*/
+CELLGRID *BuildCellGrid(REAL *coor, int natoms, REAL cellSize)
+{
+   CELLGRID *grid;
+
+   if((grid=AllocCellGrid(coor, natoms, cellSize, NULL))==NULL)
+      return(NULL);
+
+   BinAtoms(grid, coor);
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>CELLGRID *BuildSortedCellGrid(REAL *coor, int natoms, REAL cellSize)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *coor      Packed x,y,z coordinates (3*natoms)
+   \param[in]   natoms     Number of atoms
+   \param[in]   cellSize   Minimum cell size (the search cutoff)
+   \return                 Cell grid (NULL if no memory)
+
+   As BuildCellGrid() but the atoms are first sorted along a Morton
+   (Z-order) curve through the cells. grid->coor holds the sorted
+   coordinates and grid->order[] the original index of each sorted
+   atom; head[] and next[] refer to the sorted atoms. Atoms in the
+   same or nearby cells are then close together in memory, so a
+   neighbour search touches far fewer cache lines than it does with
+   the atoms in file order.
+
+   The sort is stable, so the atoms in a cell are still listed in
+   their original order and a search gives the same pairs in the same
+   order as with BuildCellGrid().
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Sorting split out as SortCellGrid()   By: ACRM
+*/
+CELLGRID *BuildSortedCellGrid(REAL *coor, int natoms, REAL cellSize)
+{
+   CELLGRID *grid;
+
+   if((grid=AllocCellGrid(coor, natoms, cellSize, NULL))==NULL)
+      return(NULL);
+
+   if(!SortCellGrid(grid, coor))
+   {
+      FreeCellGrid(grid);
+      return(NULL);
+   }
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>CELLGRID *BuildPeriodicCellGrid(REAL *coor, int natoms, REAL cellSize,
+                                   REAL *box)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]   *coor      Packed x,y,z coordinates (3*natoms)
+   \param[in]   natoms     Number of atoms
+   \param[in]   cellSize   Minimum cell size (the search cutoff)
+   \param[in]   *box       Box lengths along x, y and z
+   \return                 Cell grid (NULL if no memory)
+
+   As BuildSortedCellGrid() but the grid covers the box from the origin
+   to box[] whatever the coordinates. Each axis is split into a whole
+   number of equal cells, so the cells are at least cellSize across
+   and the last cell on each axis is next to the first. Coordinates
+   outside the box go in the cell of their image in the box and
+   GetNeighbourCells() wraps round the edges of the grid.
+
+   For a non-orthogonal cell, pass fractional coordinates scaled by
+   the cell edge lengths.
+
+-  19.10.26 Original   By: ACRM
+*/
+CELLGRID *BuildPeriodicCellGrid(REAL *coor, int natoms, REAL cellSize,
+                                REAL *box)
+{
+   CELLGRID *grid;
+
+   if((grid=AllocCellGrid(coor, natoms, cellSize, box))==NULL)
+      return(NULL);
+
+   if(!SortCellGrid(grid, coor))
+   {
+      FreeCellGrid(grid);
+      return(NULL);
+   }
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>static BOOL SortCellGrid(CELLGRID *grid, REAL *coor)
+   ----------------------------------------------------
+*//**
+   \param[in,out]  *grid   Cell grid with empty cells
+   \param[in]      *coor   Packed x,y,z coordinates
+   \return                 FALSE if no memory
+
+   Sorts the atoms along a Morton curve through the cells and bins them
+
+-  19.10.26 Original - split out of BuildSortedCellGrid()   By: ACRM
+*/
+static BOOL SortCellGrid(CELLGRID *grid, REAL *coor)
+{
+   unsigned long *key  = NULL;
+   int           *tmp  = NULL,
+                 count[MORTONRADIX],
+                 natoms = grid->natoms,
+                 shift = 0,
+                 pass,
+                 ix, iy, iz,
+                 i, k;
+
+   if(((grid->order=(int *)malloc((natoms+1) * sizeof(int)))==NULL) ||
+      ((grid->coor=(REAL *)malloc((3*natoms+1) * sizeof(REAL)))==NULL) ||
+      ((key=(unsigned long *)malloc((natoms+1) * 
+                                    sizeof(unsigned long)))==NULL) ||
+      ((tmp=(int *)malloc((natoms+1) * sizeof(int)))==NULL))
+   {
+      if(key != NULL) free(key);
+      return(FALSE);
+   }
+
+   /* Coarsen the cell coordinates if the grid is too long in any
+      direction for them to fit in the key
+   */
+   while(((grid->nx-1) >> shift) >= MORTONAXIS ||
+         ((grid->ny-1) >> shift) >= MORTONAXIS ||
+         ((grid->nz-1) >> shift) >= MORTONAXIS)
+      shift++;
+
+   for(i=0; i<natoms; i++)
+   {
+      k  = GetCellIndex(grid, coor[3*i], coor[3*i+1], coor[3*i+2]);
+      ix = k % grid->nx;
+      iy = (k / grid->nx) % grid->ny;
+      iz = k / (grid->nx * grid->ny);
+      key[i] = SpreadBits(ix >> shift)        |
+               (SpreadBits(iy >> shift) << 1) |
+               (SpreadBits(iz >> shift) << 2);
+      grid->order[i] = i;
+   }
+
+   /* Stable LSD radix sort of the atoms on their keys                  */
+   for(pass=0; pass<3; pass++)
+   {
+      int bits = pass * MORTONBITS;
+
+      for(k=0; k<MORTONRADIX; k++)
+         count[k] = 0;
+      for(i=0; i<natoms; i++)
+         count[(key[grid->order[i]] >> bits) & (MORTONRADIX-1)]++;
+      for(k=0, i=0; k<MORTONRADIX; k++)
+      {
+         int n = count[k];
+         count[k] = i;
+         i += n;
+      }
+      for(i=0; i<natoms; i++)
+      {
+         int a = grid->order[i];
+         tmp[count[(key[a] >> bits) & (MORTONRADIX-1)]++] = a;
+      }
+      for(i=0; i<natoms; i++)
+         grid->order[i] = tmp[i];
+   }
+   free(key);
+   free(tmp);
+
+   for(i=0; i<natoms; i++)
+   {
+      grid->coor[3*i]   = coor[3*grid->order[i]];
+      grid->coor[3*i+1] = coor[3*grid->order[i]+1];
+      grid->coor[3*i+2] = coor[3*grid->order[i]+2];
+   }
+
+   BinAtoms(grid, grid->coor);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static CELLGRID *AllocCellGrid(REAL *coor, int natoms, REAL cellSize,
+                                  REAL *box)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   *coor      Packed x,y,z coordinates (3*natoms)
+   \param[in]   natoms     Number of atoms
+   \param[in]   cellSize   Minimum cell size (the search cutoff)
+   \param[in]   *box       Periodic box lengths (NULL if not periodic)
+   \return                 Cell grid with empty cells (NULL if no
+                           memory)
+
+   Sizes the grid to the atoms' bounding box (or to the periodic box)
+   and allocates it
+
+-  19.10.26 Original - split out of BuildCellGrid()   By: ACRM
+-  19.10.26 Added box   By: ACRM
+*/
+static CELLGRID *AllocCellGrid(REAL *coor, int natoms, REAL cellSize,
+                               REAL *box)
+{
+   CELLGRID *grid;
+   REAL     xmax, ymax, zmax;
+   double   ncells;
+   int      i;
+
+   if((grid=(CELLGRID *)malloc(sizeof(CELLGRID)))==NULL)
+      return(NULL);
+
+   grid->natoms = natoms;
+   grid->head   = NULL;
+   grid->next   = NULL;
+   grid->order  = NULL;
+   grid->coor   = NULL;
+   grid->box[0] = grid->box[1] = grid->box[2] = 0.0;
+
+   /* Find the bounding box                                             */
+   grid->xmin = grid->ymin = grid->zmin = 0.0;
+   xmax = ymax = zmax = 0.0;
+   if(box != NULL)
+   {
+      for(i=0; i<3; i++)
+         grid->box[i] = box[i];
+      xmax = box[0];
+      ymax = box[1];
+      zmax = box[2];
+   }
+   else
+   {
+      for(i=0; i<natoms; i++)
+      {
+         REAL *c = coor + 3*i;
+
+         if(!i || c[0] < grid->xmin) grid->xmin = c[0];
+         if(!i || c[1] < grid->ymin) grid->ymin = c[1];
+         if(!i || c[2] < grid->zmin) grid->zmin = c[2];
+         if(!i || c[0] > xmax)       xmax       = c[0];
+         if(!i || c[1] > ymax)       ymax       = c[1];
+         if(!i || c[2] > zmax)       zmax       = c[2];
+      }
+   }
+
+   if(cellSize <= 0.0)
+      cellSize = 1.0;
+
+   /* Grow the cells until the grid is a sensible size                  */
+   for(;;)
+   {
+      grid->nx = 1 + (int)((xmax - grid->xmin) / cellSize);
+      grid->ny = 1 + (int)((ymax - grid->ymin) / cellSize);
+      grid->nz = 1 + (int)((zmax - grid->zmin) / cellSize);
+
+      /* Periodic cells must fit the box exactly so can't overhang it  */
+      if(box != NULL)
+      {
+         if(grid->nx > 1) grid->nx--;
+         if(grid->ny > 1) grid->ny--;
+         if(grid->nz > 1) grid->nz--;
+      }
+
+      ncells = (double)grid->nx * (double)grid->ny * (double)grid->nz;
+      if(ncells <= (double)MAXCELLSPERATOM * (natoms + 1))
+         break;
+      cellSize *= 1.5;
+   }
+   grid->cellSize = cellSize;
+
+   if(((grid->head=(int *)malloc((size_t)ncells * sizeof(int)))==NULL) ||
+      ((grid->next=(int *)malloc((natoms+1) * sizeof(int)))==NULL))
+   {
+      FreeCellGrid(grid);
+      return(NULL);
+   }
+
+   for(i=0; i<(int)ncells; i++)
+      grid->head[i] = (-1);
+
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>static void BinAtoms(CELLGRID *grid, REAL *coor)
+   ------------------------------------------------
+*//**
+   \param[in,out]  *grid   Cell grid with empty cells
+   \param[in]      *coor   Packed x,y,z coordinates
+
+   Fills in head[] and next[]
+
+-  19.10.26 Original - split out of BuildCellGrid()   By: ACRM
+*/
+static void BinAtoms(CELLGRID *grid, REAL *coor)
+{
+   int i, cell;
+
+   /* Add atoms in reverse so each cell lists them in input order       */
+   for(i=grid->natoms-1; i>=0; i--)
+   {
+      cell = GetCellIndex(grid, coor[3*i], coor[3*i+1], coor[3*i+2]);
+      grid->next[i]    = grid->head[cell];
+      grid->head[cell] = i;
+   }
+}
+
+
+/************************************************************************/
+/*>static unsigned long SpreadBits(int value)
+   ------------------------------------------
+*//**
+   \param[in]   value    Cell coordinate (less than MORTONAXIS)
+   \return               The bits of value spread out to every third
+                         bit, ready to be interleaved
+
+-  19.10.26 Original   By: ACRM
+*/
+static unsigned long SpreadBits(int value)
+{
+   unsigned long v = (unsigned long)value & (MORTONAXIS-1),
+                 spread = 0;
+   int           bit;
+
+   for(bit=0; bit<MORTONBITS; bit++)
+   {
+      if(v & (1UL << bit))
+         spread |= 1UL << (3*bit);
+   }
+   return(spread);
+}
+
+
+/************************************************************************/
+/*>void FreeCellGrid(CELLGRID *grid)
+   ---------------------------------
+*//**
+   \param[in]   *grid   Cell grid to free
+
+-  19.10.26 Original   By: ACRM
+*/
+void FreeCellGrid(CELLGRID *grid)
+{
+   if(grid != NULL)
+   {
+      if(grid->head  != NULL) free(grid->head);
+      if(grid->next  != NULL) free(grid->next);
+      if(grid->order != NULL) free(grid->order);
+      if(grid->coor  != NULL) free(grid->coor);
+      free(grid);
+   }
+}
+
+
+/************************************************************************/
+/*>int GetCellIndex(CELLGRID *grid, REAL x, REAL y, REAL z)
+   --------------------------------------------------------
+*//**
+   \param[in]   *grid     Cell grid
+   \param[in]   x,y,z     Coordinates
+   \return                Index of the cell containing the point.
+                          Points outside the grid go in the nearest
+                          edge cell, or for a periodic grid the cell
+                          containing their image in the box.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Handles periodic grids   By: ACRM
+*/
+int GetCellIndex(CELLGRID *grid, REAL x, REAL y, REAL z)
+{
+   int ix, iy, iz;
+
+   if(grid->box[0] > 0.0)
+   {
+      ix = WrapCell((int)floor(x * grid->nx / grid->box[0]), grid->nx);
+      iy = WrapCell((int)floor(y * grid->ny / grid->box[1]), grid->ny);
+      iz = WrapCell((int)floor(z * grid->nz / grid->box[2]), grid->nz);
+      return((iz * grid->ny + iy) * grid->nx + ix);
+   }
+
+   ix = (int)((x - grid->xmin) / grid->cellSize);
+   iy = (int)((y - grid->ymin) / grid->cellSize);
+   iz = (int)((z - grid->zmin) / grid->cellSize);
+
+   if(ix < 0) ix = 0; else if(ix >= grid->nx) ix = grid->nx - 1;
+   if(iy < 0) iy = 0; else if(iy >= grid->ny) iy = grid->ny - 1;
+   if(iz < 0) iz = 0; else if(iz >= grid->nz) iz = grid->nz - 1;
+
+   return((iz * grid->ny + iy) * grid->nx + ix);
+}
+
+
+/************************************************************************/
+/*>void MoveCellGridAtom(CELLGRID *grid, int atom, int from, int to)
+   -----------------------------------------------------------------
+*//**
+   \param[in,out]  *grid   Cell grid
+   \param[in]      atom    Atom (index into head[] and next[] lists)
+   \param[in]      from    Cell the atom is in
+   \param[in]      to      Cell the atom has moved to
+
+   Moves an atom from one cell to another, keeping each cell in input
+   order. The atom's next[] entry changes, so a loop over the cell it
+   came from must have fetched it already.
+
+-  19.10.26 Original   By: ACRM
+*/
+void MoveCellGridAtom(CELLGRID *grid, int atom, int from, int to)
+{
+   int *link;
+
+   if(from == to)
+      return;
+
+   for(link=grid->head+from; *link!=(-1); link=grid->next+(*link))
+   {
+      if(*link == atom)
+      {
+         *link = grid->next[atom];
+         break;
+      }
+   }
+
+   for(link=grid->head+to; (*link!=(-1)) && (*link<atom);
+       link=grid->next+(*link))
+      ;
+   grid->next[atom] = *link;
+   *link            = atom;
+}
+
+
+/************************************************************************/
+/*>int GetNeighbourCells(CELLGRID *grid, int cell, int *cells)
+   -----------------------------------------------------------
+*//**
+   \param[in]   *grid     Cell grid
+   \param[in]   cell      Cell index
+   \param[out]  *cells    The cell and its neighbours (room for
+                          MAXNEIGHBOURCELLS)
+   \return                Number of cells
+
+   In a periodic grid the neighbours wrap round the edges. Each cell is
+   only given once even if the grid is less than three cells across.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Handles periodic grids   By: ACRM
+*/
+int GetNeighbourCells(CELLGRID *grid, int cell, int *cells)
+{
+   int ix, iy, iz,
+       dx, dy, dz,
+       wx, wy, wz,
+       ncells   = 0;
+   BOOL periodic = (grid->box[0] > 0.0);
+
+   ix = cell % grid->nx;
+   iy = (cell / grid->nx) % grid->ny;
+   iz = cell / (grid->nx * grid->ny);
+
+   for(dz=iz-1; dz<=iz+1; dz++)
+   {
+      if(periodic)
+      {
+         if(dz-iz+1 >= grid->nz)
+            break;
+         wz = WrapCell(dz, grid->nz);
+      }
+      else if((dz < 0) || (dz >= grid->nz))
+      {
+         continue;
+      }
+      else
+      {
+         wz = dz;
+      }
+
+      for(dy=iy-1; dy<=iy+1; dy++)
+      {
+         if(periodic)
+         {
+            if(dy-iy+1 >= grid->ny)
+               break;
+            wy = WrapCell(dy, grid->ny);
+         }
+         else if((dy < 0) || (dy >= grid->ny))
+         {
+            continue;
+         }
+         else
+         {
+            wy = dy;
+         }
+
+         for(dx=ix-1; dx<=ix+1; dx++)
+         {
+            if(periodic)
+            {
+               if(dx-ix+1 >= grid->nx)
+                  break;
+               wx = WrapCell(dx, grid->nx);
+            }
+            else if((dx < 0) || (dx >= grid->nx))
+            {
+               continue;
+            }
+            else
+            {
+               wx = dx;
+            }
+            cells[ncells++] = (wz * grid->ny + wy) * grid->nx + wx;
+         }
+      }
+   }
+
+   return(ncells);
+}
+
+
+/************************************************************************/
+/*>static int WrapCell(int i, int n)
+   ---------------------------------
+*//**
+   \param[in]   i   Cell coordinate along an axis
+   \param[in]   n   Number of cells along the axis
+   \return          The cell coordinate wrapped into 0..n-1
+
+-  19.10.26 Original   By: ACRM
+*/
+static int WrapCell(int i, int n)
+{
+   i %= n;
+   return((i < 0) ? i+n : i);
+}
@@ -0,0 +1,93 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       cellgrid.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Cell list for finding neighbouring atoms without an
+               all-pairs search
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added BuildSortedCellGrid()   By: ACRM
+   V1.2   19.10.26  Added BuildPeriodicCellGrid()   By: ACRM
+   V1.3   19.10.26  Added MoveCellGridAtom()   By: ACRM
+
+*************************************************************************/
+#ifndef _CELLGRID_H
+#define _CELLGRID_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXNEIGHBOURCELLS 27
+
+/* Atoms are binned into cubic cells at least cellSize across. head[]
+   gives the first atom in each cell and next[] chains the atoms in a
+   cell together; both are terminated by -1. In a sorted grid, these
+   index the sorted atoms: order[] gives the original index of each and
+   coor[] their coordinates. Both are NULL in an unsorted grid.
+   A periodic grid exactly fills a box of size box[] from the origin
+   and its cells wrap around; box[0] is zero otherwise.
+*/
+typedef struct
+{
+   REAL xmin, ymin, zmin,
+        cellSize,
+        box[3],
+        *coor;
+   int  nx, ny, nz,
+        natoms,
+        *head,
+        *next,
+        *order;
+}  CELLGRID;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+CELLGRID *BuildCellGrid(REAL *coor, int natoms, REAL cellSize);
+CELLGRID *BuildSortedCellGrid(REAL *coor, int natoms, REAL cellSize);
+CELLGRID *BuildPeriodicCellGrid(REAL *coor, int natoms, REAL cellSize,
+                                REAL *box);
+void FreeCellGrid(CELLGRID *grid);
+int GetCellIndex(CELLGRID *grid, REAL x, REAL y, REAL z);
+int GetNeighbourCells(CELLGRID *grid, int cell, int *cells);
+void MoveCellGridAtom(CELLGRID *grid, int atom, int from, int to);
+
+#endif
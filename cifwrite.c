@@ -0,0 +1,486 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       cifwrite.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Streaming mmCIF atom_site writer
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes a structure as an mmCIF atom_site loop. Unlike fixed-column
+   PDB format there are no limits on the number of atoms, the length of
+   chain labels or the size of residue numbers, so this is the output
+   to use for very large systems.
+
+   Each row is formatted directly into a large buffer, without going
+   through printf(), and the buffer is written out in one go when it
+   fills. For a multi-model file, call WriteMMCIFHeader() once,
+   WriteMMCIFAtoms() for each model and then WriteMMCIFTrailer().
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/macros.h"
+#include "cifwrite.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CIFBUFFSIZE  1048576  /* Output buffer                          */
+#define MAXCIFLINE       512  /* Longest row we can write               */
+#define MAXFIELD          16
+
+/************************************************************************/
+/* Globals
+*/
+static char *sAtomSiteItems[] =
+{
+   "group_PDB",
+   "id",
+   "type_symbol",
+   "label_atom_id",
+   "label_alt_id",
+   "label_comp_id",
+   "label_asym_id",
+   "label_entity_id",
+   "label_seq_id",
+   "pdbx_PDB_ins_code",
+   "Cartn_x",
+   "Cartn_y",
+   "Cartn_z",
+   "occupancy",
+   "B_iso_or_equiv",
+   "pdbx_formal_charge",
+   "auth_seq_id",
+   "auth_comp_id",
+   "auth_asym_id",
+   "auth_atom_id",
+   "pdbx_PDB_model_num",
+   NULL
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static char *PutString(char *buf, char *value, int maxlen);
+static char *PutInt(char *buf, long value);
+static char *PutFixed(char *buf, REAL value, int ndp);
+static char *PutElement(char *buf, PDB *p);
+
+
+/************************************************************************/
+/*>BOOL IsMMCIFFilename(char *filename)
+   ------------------------------------
+*//**
+   \param[in]   *filename   A filename
+   \return                  Does it end in .cif (possibly followed by
+                            .gz or .zst)?
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL IsMMCIFFilename(char *filename)
+{
+   int len;
+
+   if(filename == NULL)
+      return(FALSE);
+
+   len = strlen(filename);
+   if((len > 3) && !strcmp(filename+len-3, ".gz"))
+      len -= 3;
+   else if((len > 4) && !strcmp(filename+len-4, ".zst"))
+      len -= 4;
+
+   return((BOOL)((len > 4) && !strncmp(filename+len-4, ".cif", 4)));
+}
+
+
+/************************************************************************/
+/*>void MMCIFBlockName(char *filename, char *name)
+   -----------------------------------------------
+*//**
+   \param[in]   *filename   A filename (or NULL or blank)
+   \param[out]  *name       Data block name (at least MAXCIFNAME)
+
+   Makes a data block name from the filename without its directory or
+   extensions. Blanks are not allowed so are replaced.
+
+-  19.10.26 Original   By: ACRM
+*/
+void MMCIFBlockName(char *filename, char *name)
+{
+   char *start;
+   int  i;
+
+   if((filename == NULL) || (filename[0] == '\0'))
+   {
+      strcpy(name, "structure");
+      return;
+   }
+
+   if((start=strrchr(filename, '/')) != NULL)
+      start++;
+   else
+      start = filename;
+
+   for(i=0; start[i] && (start[i] != '.') && (i < MAXCIFNAME-1); i++)
+      name[i] = isspace((int)start[i]) ? '_' : start[i];
+   name[i] = '\0';
+
+   if(name[0] == '\0')
+      strcpy(name, "structure");
+}
+
+
+/************************************************************************/
+/*>void WriteMMCIFHeader(FILE *fp, char *name)
+   -------------------------------------------
+*//**
+   \param[in]   *fp      Output file
+   \param[in]   *name    Data block name
+
+   Writes the data block and the start of the atom_site loop
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteMMCIFHeader(FILE *fp, char *name)
+{
+   int i;
+
+   fprintf(fp, "data_%s\n#\nloop_\n", name);
+   for(i=0; sAtomSiteItems[i]!=NULL; i++)
+      fprintf(fp, "_atom_site.%s\n", sAtomSiteItems[i]);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteMMCIFAtoms(FILE *fp, PDB *pdb, int model)
+   ---------------------------------------------------
+*//**
+   \param[in]   *fp      Output file
+   \param[in]   *pdb     PDB linked list
+   \param[in]   model    Model number
+   \return               FALSE if out of memory
+
+   Writes a row of the atom_site loop for each atom
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WriteMMCIFAtoms(FILE *fp, PDB *pdb, int model)
+{
+   PDB  *p;
+   char *buffer,
+        *b,
+        *end;
+   BOOL isHet;
+
+   if((buffer=(char *)malloc(CIFBUFFSIZE))==NULL)
+      return(FALSE);
+   end = buffer + CIFBUFFSIZE - MAXCIFLINE;
+
+   b = buffer;
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      isHet = (BOOL)!strncmp(p->record_type, "HETATM", 6);
+
+      b = PutString(b, isHet?"HETATM":"ATOM", 6);
+      b = PutInt(b, (long)p->atnum);
+      b = PutElement(b, p);
+      b = PutString(b, p->atnam, 4);
+      *(b++) = (p->altpos == ' ') ? '.' : p->altpos;
+      *(b++) = ' ';
+      b = PutString(b, p->resnam, 4);
+      b = PutString(b, p->chain, MAXFIELD);
+      *(b++) = '?';
+      *(b++) = ' ';
+      if(isHet)
+      {
+         *(b++) = '.';
+         *(b++) = ' ';
+      }
+      else
+      {
+         b = PutInt(b, (long)p->resnum);
+      }
+      *(b++) = ((p->insert[0] == ' ') || (p->insert[0] == '\0')) ?
+               '?' : p->insert[0];
+      *(b++) = ' ';
+      b = PutFixed(b, p->x, 3);
+      b = PutFixed(b, p->y, 3);
+      b = PutFixed(b, p->z, 3);
+      b = PutFixed(b, p->occ,  2);
+      b = PutFixed(b, p->bval, 2);
+      if(p->formal_charge)
+      {
+         b = PutInt(b, (long)p->formal_charge);
+      }
+      else
+      {
+         *(b++) = '?';
+         *(b++) = ' ';
+      }
+      b = PutInt(b, (long)p->resnum);
+      b = PutString(b, p->resnam, 4);
+      b = PutString(b, p->chain, MAXFIELD);
+      b = PutString(b, p->atnam, 4);
+      b = PutInt(b, (long)model);
+      b[-1] = '\n';
+
+      if(b >= end)
+      {
+         fwrite(buffer, 1, b-buffer, fp);
+         b = buffer;
+      }
+   }
+   fwrite(buffer, 1, b-buffer, fp);
+
+   free(buffer);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void WriteMMCIFTrailer(FILE *fp)
+   --------------------------------
+*//**
+   \param[in]   *fp      Output file
+
+   Ends the atom_site loop
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteMMCIFTrailer(FILE *fp)
+{
+   fprintf(fp, "#\n");
+}
+
+
+/************************************************************************/
+/*>BOOL WriteMMCIF(FILE *fp, PDB *pdb, char *name)
+   -----------------------------------------------
+*//**
+   \param[in]   *fp      Output file
+   \param[in]   *pdb     PDB linked list
+   \param[in]   *name    Data block name
+   \return               FALSE if out of memory
+
+   Writes a single-model mmCIF file
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WriteMMCIF(FILE *fp, PDB *pdb, char *name)
+{
+   BOOL ok;
+   
+   WriteMMCIFHeader(fp, name);
+   ok = WriteMMCIFAtoms(fp, pdb, 1);
+   WriteMMCIFTrailer(fp);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static char *PutString(char *buf, char *value, int maxlen)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *buf      Where to write
+   \param[in]   *value    String (may be blank padded)
+   \param[in]   maxlen    Maximum characters to take from value
+   \return                Position after the value and a space
+
+   Writes a string value without its padding, quoted if it contains
+   a quote or would otherwise be read as something else. Blank is
+   written as ?
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *PutString(char *buf, char *value, int maxlen)
+{
+   int  start, stop, i;
+   BOOL quote = FALSE;
+
+   for(start=0; (start<maxlen) && (value[start]==' '); start++);
+   for(stop=start; (stop<maxlen) && value[stop]; stop++);
+   while((stop > start) && (value[stop-1] == ' '))
+      stop--;
+
+   if(stop == start)
+   {
+      *(buf++) = '?';
+      *(buf++) = ' ';
+      return(buf);
+   }
+
+   if(strchr("_#$'\"[];", value[start]) ||
+      (((stop-start) == 1) && 
+       ((value[start] == '.') || (value[start] == '?'))))
+      quote = TRUE;
+   for(i=start; !quote && (i<stop); i++)
+   {
+      if((value[i] == ' ') || (value[i] == '\''))
+         quote = TRUE;
+   }
+
+   if(quote)
+      *(buf++) = '"';
+   for(i=start; i<stop; i++)
+      *(buf++) = value[i];
+   if(quote)
+      *(buf++) = '"';
+   *(buf++) = ' ';
+   
+   return(buf);
+}
+
+
+/************************************************************************/
+/*>static char *PutInt(char *buf, long value)
+   ------------------------------------------
+*//**
+   \param[in]   *buf      Where to write
+   \param[in]   value     Integer
+   \return                Position after the value and a space
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *PutInt(char *buf, long value)
+{
+   char          digits[24];
+   int           n = 0;
+   unsigned long v;
+
+   if(value < 0)
+   {
+      *(buf++) = '-';
+      v = (unsigned long)(-value);
+   }
+   else
+   {
+      v = (unsigned long)value;
+   }
+
+   do
+   {
+      digits[n++] = (char)('0' + (v % 10));
+      v /= 10;
+   }  while(v);
+
+   while(n)
+      *(buf++) = digits[--n];
+   *(buf++) = ' ';
+
+   return(buf);
+}
+
+
+/************************************************************************/
+/*>static char *PutFixed(char *buf, REAL value, int ndp)
+   -----------------------------------------------------
+*//**
+   \param[in]   *buf      Where to write
+   \param[in]   value     Number
+   \param[in]   ndp       Decimal places (1 to 6)
+   \return                Position after the value and a space
+
+   Fixed-point output rounded as %.*f would
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *PutFixed(char *buf, REAL value, int ndp)
+{
+   static long scale[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+   unsigned long scaled, whole, frac;
+   int           i;
+   char          *b;
+
+   if(value < 0.0)
+   {
+      scaled = (unsigned long)(-value * scale[ndp] + 0.5);
+      if(scaled)
+         *(buf++) = '-';
+   }
+   else
+   {
+      scaled = (unsigned long)(value * scale[ndp] + 0.5);
+   }
+   whole = scaled / scale[ndp];
+   frac  = scaled % scale[ndp];
+
+   buf = PutInt(buf, (long)whole);
+   buf[-1] = '.';
+   b = buf + ndp;
+   for(i=0; i<ndp; i++)
+   {
+      *(--b) = (char)('0' + (frac % 10));
+      frac /= 10;
+   }
+   buf += ndp;
+   *(buf++) = ' ';
+   
+   return(buf);
+}
+
+
+/************************************************************************/
+/*>static char *PutElement(char *buf, PDB *p)
+   ------------------------------------------
+*//**
+   \param[in]   *buf      Where to write
+   \param[in]   *p        Atom
+   \return                Position after the value and a space
+
+   Writes the element, taking it from the atom name if it isn't set
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *PutElement(char *buf, PDB *p)
+{
+   char *a;
+   
+   if((p->element[0] != '\0') && (p->element[0] != ' '))
+      return(PutString(buf, p->element, 2));
+
+   for(a=p->atnam; *a && !isalpha((int)*a); a++);
+   *(buf++) = *a ? *a : '?';
+   *(buf++) = ' ';
+   return(buf);
+}
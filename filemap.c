@@ -0,0 +1,147 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       filemap.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Whole files in memory, mapped where possible
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Description:
+   ============
+   Parsers that scan a file line by line (or split it between threads)
+   are simplest and fastest when the whole file is in memory. Regular
+   files are memory-mapped; anything else (e.g. a pipe from a
+   decompressor) is read into an allocated buffer.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of pdbresid.c   By: ACRM
+
+*************************************************************************/
+/* mmap(), fstat() and fileno() are not ANSI                            */
+#define _XOPEN_SOURCE 500
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "filemap.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define READCHUNK    65536
+
+
+/************************************************************************/
+/*>BOOL MapFile(FILE *fp, FILEMAP *fm)
+   -----------------------------------
+*//**
+   \param[in]   *fp    File opened for reading
+   \param[out]  *fm    The file contents
+   \return             FALSE if out of memory
+
+   Memory-maps the file. If it can't be mapped (e.g. it's a pipe) it is
+   read into an allocated buffer instead
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Moved from pdbresid.c   By: ACRM
+*/
+BOOL MapFile(FILE *fp, FILEMAP *fm)
+{
+   struct stat st;
+   char        *data;
+   size_t      nread;
+   long        maxsize = 0;
+
+   fm->data   = NULL;
+   fm->size   = 0;
+   fm->mapped = FALSE;
+
+   if((fstat(fileno(fp), &st) == 0) && S_ISREG(st.st_mode) &&
+      (st.st_size > 0) &&
+      ((data=(char *)mmap(NULL, (size_t)st.st_size, PROT_READ,
+                          MAP_PRIVATE, fileno(fp), 0)) != MAP_FAILED))
+   {
+      fm->data   = data;
+      fm->size   = (long)st.st_size;
+      fm->mapped = TRUE;
+      return(TRUE);
+   }
+
+   do
+   {
+      if(fm->size == maxsize)
+      {
+         maxsize = maxsize ? 2 * maxsize : READCHUNK;
+         if((data=(char *)realloc(fm->data, maxsize))==NULL)
+         {
+            UnmapFile(fm);
+            return(FALSE);
+         }
+         fm->data = data;
+      }
+      nread     = fread(fm->data + fm->size, 1, maxsize - fm->size, fp);
+      fm->size += (long)nread;
+   }  while(nread);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void UnmapFile(FILEMAP *fm)
+   ---------------------------
+*//**
+   \param[in,out]  *fm    File contents from MapFile()
+
+   Releases the file contents
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Moved from pdbresid.c   By: ACRM
+*/
+void UnmapFile(FILEMAP *fm)
+{
+   if(fm->data != NULL)
+   {
+      if(fm->mapped)
+         munmap(fm->data, (size_t)fm->size);
+      else
+         free(fm->data);
+   }
+   fm->data = NULL;
+   fm->size = 0;
+}
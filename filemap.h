@@ -0,0 +1,69 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       filemap.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Whole files in memory, mapped where possible
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of pdbresid.c   By: ACRM
+
+*************************************************************************/
+#ifndef _FILEMAP_H
+#define _FILEMAP_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+
+/* A file in memory, either mapped or read                              */
+typedef struct
+{
+   char *data;
+   long size;
+   BOOL mapped;
+}  FILEMAP;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL MapFile(FILE *fp, FILEMAP *fm);
+void UnmapFile(FILEMAP *fm);
+
+#endif
@@ -48,6 +48,22 @@
    Revision History:
    =================
    V1.0   19.12.19  Original   By: ACRM
+   V1.1   19.10.26  Tinker XYZ reading and writing moved to tinkerxyz.c.
+                    The title line is now kept   By: ACRM
+   V1.2   19.10.26  Added -r to relax the hydrogens after fixing
+                    overlaps   By: ACRM
+   V1.3   19.10.26  Added -S for timing statistics   By: ACRM
+   V1.4   19.10.26  FixOverlaps() moved to tinkerxyz.c   By: ACRM
+   V1.5   19.10.26  Added -P for hardware performance counters   By: ACRM
+   V1.6   19.10.26  Reads and writes gzip and zstd compressed files.
+                    Added -z   By: ACRM
+   V1.7   19.10.26  Added -t to read the Tinker XYZ file with several
+                    threads   By: ACRM
+   V1.8   19.10.26  -t also writes the output with several threads
+                    By: ACRM
+   V1.9   19.10.26  Keeps the periodic box and fixes overlaps between
+                    periodic images   By: ACRM
+   V1.10  19.10.26  -S and -P handled by StatsSetup()   By: ACRM
 
 *************************************************************************/
 /* Includes
@@ -57,34 +73,26 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/fsscanf.h"
+#include "tinkerxyz.h"
+#include "hrelax.h"
+#include "stats.h"
+#include "zstream.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF        240
-#define MAXLABEL         8
-#define MAXWORD         16
-#define SMALL      0.00001
-typedef struct _tinkerxyz
-{
-   struct _tinkerxyz *next;
-   REAL x,y,z;
-   int  atnum,
-        type,
-        connect[8];
-   char atnam[MAXLABEL];
-}  TINKERXYZ;
+#define MAXTHREADS     256
 
 
 /************************************************************************/
 /* Prototypes
 */
 int main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *relax, char *statsFile, BOOL *perfCounters,
+                  BOOL *compress, int *nthreads);
 void Usage(void);
-TINKERXYZ *ReadTinkerXYZ(FILE *fp, int *natoms);
-void WriteTinkerXYZ(FILE *fp, int natoms, TINKERXYZ *xyz);
-void FixOverlaps(TINKERXYZ *xyz);
 
 
 /************************************************************************/
@@ -94,27 +102,61 @@ void FixOverlaps(TINKERXYZ *xyz);
 int main(int argc, char **argv)
 {
    char infile[MAXBUFF],
-        outfile[MAXBUFF];
+        outfile[MAXBUFF],
+        statsFile[MAXBUFF],
+        title[MAXXYZBUFF];
    FILE *in      = stdin,
         *out     = stdout;
-   int  natoms;
+   int  natoms,
+        nthreads = 1;
+   BOOL relax    = FALSE,
+        perfCounters = FALSE,
+        compress     = FALSE;
    TINKERXYZ *xyz = NULL;
+   XYZBOX    box;
    
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   if(ParseCmdLine(argc, argv, infile, outfile, &relax, statsFile,
+                   &perfCounters, &compress, &nthreads))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(!StatsSetup("fixoverlap", statsFile, perfCounters))
+         return(1);
+
+      if(ZStreamOpenStdFiles(infile, outfile, &in, &out,
+                             compress?ZSTREAM_GZIP:ZSTREAM_PLAIN))
       {
-         
-         if((xyz=ReadTinkerXYZ(in, &natoms))==NULL)
+         StatsPhaseStart("ReadTinkerXYZ");
+         if((xyz=ReadTinkerXYZThreaded(in, &natoms, title, &box,
+                                       nthreads))==NULL)
          {
             fprintf(stderr,"Error: No atoms read from Tinker XYZ \
 file\n");
             return(1);
          }
+         StatsAddCount("atoms", natoms);
+
+         StatsPhaseStart("FixOverlaps");
+         FixOverlaps(xyz, &box);
 
-         FixOverlaps(xyz);
+         if(relax)
+         {
+            StatsPhaseStart("RelaxHydrogens");
+            if(!RelaxHydrogens(xyz, HRELAX_MAXITER, HRELAX_RMSGRAD,
+                               FALSE))
+            {
+               fprintf(stderr,"Error: No memory for hydrogen \
+relaxation\n");
+               return(1);
+            }
+         }
          
-         WriteTinkerXYZ(out, natoms, xyz);
+         StatsPhaseStart("WriteTinkerXYZ");
+         if(!WriteTinkerXYZThreaded(out, natoms, title, &box, xyz,
+                                    nthreads))
+            return(1);
+         StatsPhaseEnd();
+
+         if(!StatsReport())
+            return(1);
       }
       else
       {
@@ -131,145 +173,58 @@ file\n");
 }
 
 
-/************************************************************************/
-void FixOverlaps(TINKERXYZ *xyz)
-{
-   TINKERXYZ *a, *b;
-   for(a=xyz; a!=NULL; NEXT(a))
-   {
-      for(b=a->next; b!=NULL; NEXT(b))
-      {
-         if((ABS(a->x - b->x) < SMALL) &&
-            (ABS(a->y - b->y) < SMALL) &&
-            (ABS(a->z - b->z) < SMALL))
-         {
-            fprintf(stderr, "Fixing %d\n", b->atnum);
-            b->x += 1.0;
-         }
-      }
-   }
-}
-
-
-/************************************************************************/
-void WriteTinkerXYZ(FILE *fp, int natoms, TINKERXYZ *xyz)
-{
-   TINKERXYZ *t;
-   int i;
-   
-   
-   fprintf(fp, "%6d\n", natoms);
-   for(t=xyz; t!=NULL; NEXT(t))
-   {
-      fprintf(fp, "%6d  %-3s%12.6f%12.6f%12.6f%6d",
-              t->atnum, t->atnam,
-              t->x, t->y, t->z,
-              t->type);
-      for(i=0; i<4; i++)
-      {
-         if(!t->connect[i])
-            break;
-         
-         fprintf(fp, "%6d", t->connect[i]);
-      }
-      fprintf(fp, "\n");
-   }
-}
-
-
-/************************************************************************/
-TINKERXYZ *ReadTinkerXYZ(FILE *fp, int *natoms)
-{
-   TINKERXYZ *xyz = NULL,
-             *t   = NULL;
-   char      buffer[MAXBUFF],
-      *chp,
-      word[MAXWORD];
-   
-   int i;
-   
-   fgets(buffer, MAXBUFF, fp);
-   if(!sscanf(buffer, "%d", natoms))
-      return(NULL);
-
-   if(natoms)
-   {
-      while(fgets(buffer, MAXBUFF, fp))
-      {
-         TERMINATE(buffer);
-         
-         if(xyz==NULL)
-         {
-            INIT(xyz, TINKERXYZ);
-            t = xyz;
-         }
-         else
-         {
-            ALLOCNEXT(t, TINKERXYZ);
-         }
-         if(t==NULL)
-         {
-            FREELIST(xyz, TINKERXYZ);
-            return(NULL);
-         }
-
-         for(i=0; i<4; i++)
-         {
-            t->connect[i] = 0;
-         }
-
-         sscanf(buffer, "%d%s%lf%lf%lf%d",
-                &(t->atnum), t->atnam,
-                &(t->x), &(t->y), &(t->z),
-                &(t->type));
-
-         chp = buffer+53; /* Start of connects */
-         
-         i=0;
-         do
-         {
-            chp = blGetWord(chp, word, MAXWORD);
-            sscanf(word, "%d", &(t->connect[i++]));
-         } while(chp != NULL);
-         
-      }
-   }
-
-   return(xyz);
-}
-
-
 /************************************************************************/
 /*>void Usage(void)
    ----------------
 */
 void Usage(void)
 {
-   
+   fprintf(stderr,"Usage: fixoverlap [-r] [-S file] [-P] [-z] \
+[-t nthreads] [in.xyz [out.xyz]]\n");
+   fprintf(stderr,"       -r  Relax the hydrogen positions after fixing \
+overlaps\n");
+   StatsUsage();
+   ZStreamUsage();
+   fprintf(stderr,"       -t  Read and write the Tinker XYZ files using \
+this many threads\n");
 }
 
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, 
-                     char *infile, char *outfile)
+                     char *infile, char *outfile, BOOL *relax,
+                     char *statsFile, BOOL *perfCounters,
+                     BOOL *compress, int *nthreads)
    --------------------------------------------------------------
    Input:   int    argc          Argument count
             char   **argv        Argument array
    Output:  char   *infile       Input file (or blank string)
             char   *outfile      Output file (or blank string)
+            BOOL   *relax        Relax hydrogens
+            char   *statsFile    Statistics file (or blank string)
+            BOOL   *perfCounters Add hardware performance counters
+            BOOL   *compress     Compress output with no .gz/.zst name
+            int    *nthreads     Threads for reading and writing
    Returns: BOOL                 Success?
 
    Parse the command line
 
    19.12.19  Original   By: ACRM  
+   19.10.26  Added -r   By: ACRM
+   19.10.26  Added -S   By: ACRM
+   19.10.26  Added -P   By: ACRM
+   19.10.26  Added -z   By: ACRM
+   19.10.26  Added -t   By: ACRM
 */
 BOOL ParseCmdLine(int argc, char **argv, 
-                  char *infile, char *outfile)
+                  char *infile, char *outfile, BOOL *relax,
+                  char *statsFile, BOOL *perfCounters, BOOL *compress,
+                  int *nthreads)
 {
    argc--;
    argv++;
 
-   infile[0] = outfile[0] = '\0';
+   infile[0] = outfile[0] = statsFile[0] = '\0';
    
    if(argc < 1)
    {
@@ -291,6 +246,31 @@ BOOL ParseCmdLine(int argc, char **argv,
             case 'h':
                return(FALSE);
                break;
+            case 'r':
+               *relax = TRUE;
+               break;
+            case 'S':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(statsFile, argv[0], MAXBUFF-1);
+               statsFile[MAXBUFF-1] = '\0';
+               break;
+            case 'P':
+               *perfCounters = TRUE;
+               break;
+            case 'z':
+               *compress = TRUE;
+               break;
+            case 't':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%d", nthreads) || (*nthreads < 1))
+                  return(FALSE);
+               if(*nthreads > MAXTHREADS)
+                  *nthreads = MAXTHREADS;
+               break;
             default:
                return(FALSE);
                break;
@@ -0,0 +1,761 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       hrelax.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Fast in-process relaxation of hydrogen positions
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   This is NOT a force field. It is a quick way of putting hydrogens in
+   sensible places when a full Tinker minimization isn't needed. Heavy
+   atoms are fixed and only hydrogens (atoms whose Tinker name starts
+   with H) move. The energy has three terms:
+
+   - X-H bonds:   Kb (d - d0)^2 with d0 from the element of X
+   - angles:      Ka (cos(theta) - cos(theta0))^2 for each H-X-Y with
+                  theta0 from the number of atoms bonded to X
+   - repulsion:   Kr (r0 - r)^2 when r < r0 for pairs involving a
+                  hydrogen that are not 1-2 or 1-3 bonded. r0 for
+                  N and O partners is short enough to allow hydrogen
+                  bonds
+
+   The repulsive pairs are kept in a neighbour list built with the cell
+   grid. The list includes a skin and is rebuilt when a hydrogen has
+   moved more than half of that. The energy is minimized with L-BFGS.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Neighbour list built from a Morton sorted cell grid
+                    By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bioplib/macros.h"
+#include "hrelax.h"
+#include "cellgrid.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define KBOND      300.0      /* Force constants                        */
+#define KANGLE      50.0
+#define KREPEL      30.0
+#define RMAXREPEL    2.4      /* Largest r0 for repulsion               */
+#define SKIN         1.0      /* Neighbour list skin                    */
+#define MAXSTEP      0.3      /* Largest move of any atom in one step   */
+#define NMEMORY      7        /* L-BFGS history length                  */
+#define ARMIJO    1.0e-4
+#define MAXBACKTRACK 20
+#define COSTETRA  (-0.333333) /* cos(109.47)                            */
+#define COSTRIG   (-0.5)      /* cos(120.0)                             */
+#define COSWATER  (-0.250380) /* cos(104.5)                             */
+
+typedef struct
+{
+   TINKERXYZ **idx;
+   REAL      *coor,          /* All coordinates, packed x,y,z           */
+             *grad,          /* Gradient on all atoms                   */
+             *listCoor,      /* Movable coordinates at last list build  */
+             *bondLen,
+             *angleCos,
+             *nbR0;
+   int       natoms,
+             nmove,
+             *move,          /* Atom offset of each movable hydrogen    */
+             nbond,
+             *bond,          /* Pairs: hydrogen, partner                */
+             nangle,
+             *angle,         /* Triples: a, centre, b                   */
+             nnb,
+             maxnb,
+             *nb;            /* Pairs for repulsion                     */
+   char      *element;       /* H, C, N, O, S or X for other            */
+}  HRELAX;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static HRELAX *SetupRelax(TINKERXYZ *xyz);
+static void FreeRelax(HRELAX *h);
+static BOOL BuildTerms(HRELAX *h);
+static BOOL BuildNeighbourList(HRELAX *h);
+static BOOL Bonded13(HRELAX *h, int i, int j);
+static int  CountConnections(TINKERXYZ *t);
+static REAL Energy(HRELAX *h, REAL *x, REAL *g);
+static void Scatter(HRELAX *h, REAL *x);
+static REAL Dot(REAL *a, REAL *b, int n);
+static BOOL ListNeedsUpdate(HRELAX *h, REAL *x);
+
+
+/************************************************************************/
+/*>BOOL RelaxHydrogens(TINKERXYZ *xyz, int maxIter, REAL rmsGrad,
+                       BOOL verbose)
+   -------------------------------------------------------------
+*//**
+   \param[in,out]  *xyz      Tinker XYZ linked list. Hydrogen
+                             coordinates are updated
+   \param[in]      maxIter   Maximum L-BFGS iterations
+   \param[in]      rmsGrad   Converge when the RMS gradient on the
+                             hydrogens drops below this
+   \param[in]      verbose   Report progress on stderr
+   \return                   Success (FALSE if no memory)
+
+   Relaxes the hydrogen positions with the heavy atoms fixed.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL RelaxHydrogens(TINKERXYZ *xyz, int maxIter, REAL rmsGrad,
+                    BOOL verbose)
+{
+   HRELAX *h;
+   REAL   *x     = NULL,
+          *g     = NULL,
+          *xNew  = NULL,
+          *gNew  = NULL,
+          *d     = NULL,
+          *s     = NULL,
+          *y     = NULL,
+          rho[NMEMORY],
+          alpha[NMEMORY],
+          e, eNew, gd, step, dmax, rms, beta;
+   int    n, iter, i, k, m,
+          nhist  = 0,
+          newest = 0;
+   BOOL   ok     = FALSE;
+
+   if((h=SetupRelax(xyz))==NULL)
+      return(FALSE);
+
+   n = 3 * h->nmove;
+   if(n == 0)
+   {
+      FreeRelax(h);
+      return(TRUE);
+   }
+
+   if(((x=(REAL *)malloc(n*sizeof(REAL)))==NULL)    ||
+      ((g=(REAL *)malloc(n*sizeof(REAL)))==NULL)    ||
+      ((xNew=(REAL *)malloc(n*sizeof(REAL)))==NULL) ||
+      ((gNew=(REAL *)malloc(n*sizeof(REAL)))==NULL) ||
+      ((d=(REAL *)malloc(n*sizeof(REAL)))==NULL)    ||
+      ((s=(REAL *)malloc(NMEMORY*n*sizeof(REAL)))==NULL) ||
+      ((y=(REAL *)malloc(NMEMORY*n*sizeof(REAL)))==NULL))
+      goto cleanup;
+
+   for(i=0; i<h->nmove; i++)
+   {
+      for(k=0; k<3; k++)
+         x[3*i+k] = h->coor[3*h->move[i]+k];
+   }
+
+   e = Energy(h, x, g);
+
+   for(iter=0; iter<maxIter; iter++)
+   {
+      rms = sqrt(Dot(g, g, n) / h->nmove);
+      if(verbose)
+         fprintf(stderr, "Iteration %4d  Energy %12.4f  RMS gradient \
+%10.4f\n", iter, e, rms);
+      if(rms < rmsGrad)
+         break;
+
+      /* L-BFGS two-loop recursion for the search direction             */
+      for(i=0; i<n; i++)
+         d[i] = -g[i];
+      for(m=0; m<nhist; m++)
+      {
+         k        = (newest - m + NMEMORY) % NMEMORY;
+         alpha[k] = rho[k] * Dot(s+k*n, d, n);
+         for(i=0; i<n; i++)
+            d[i] -= alpha[k] * y[k*n+i];
+      }
+      if(nhist)
+      {
+         REAL gamma = Dot(s+newest*n, y+newest*n, n) /
+                      Dot(y+newest*n, y+newest*n, n);
+         for(i=0; i<n; i++)
+            d[i] *= gamma;
+      }
+      for(m=nhist-1; m>=0; m--)
+      {
+         k    = (newest - m + NMEMORY) % NMEMORY;
+         beta = rho[k] * Dot(y+k*n, d, n);
+         for(i=0; i<n; i++)
+            d[i] += (alpha[k] - beta) * s[k*n+i];
+      }
+
+      /* Fall back to steepest descent if this isn't downhill           */
+      if((gd=Dot(g, d, n)) >= 0.0)
+      {
+         for(i=0; i<n; i++)
+            d[i] = -g[i];
+         gd    = Dot(g, d, n);
+         nhist = 0;
+      }
+
+      /* Limit the largest atom move                                    */
+      for(i=0, dmax=0.0; i<h->nmove; i++)
+      {
+         REAL dd = d[3*i]*d[3*i] + d[3*i+1]*d[3*i+1] + d[3*i+2]*d[3*i+2];
+         if(dd > dmax)
+            dmax = dd;
+      }
+      dmax = sqrt(dmax);
+      step = (dmax > MAXSTEP) ? MAXSTEP/dmax : 1.0;
+
+      /* Backtracking line search                                       */
+      for(k=0; k<MAXBACKTRACK; k++)
+      {
+         for(i=0; i<n; i++)
+            xNew[i] = x[i] + step * d[i];
+         eNew = Energy(h, xNew, gNew);
+         if(eNew <= e + ARMIJO * step * gd)
+            break;
+         step *= 0.5;
+      }
+      if(k == MAXBACKTRACK)
+      {
+         if(!nhist)
+            break;           /* No progress even downhill - give up     */
+         nhist = 0;
+         continue;
+      }
+
+      /* Update the history                                             */
+      newest = (newest + 1) % NMEMORY;
+      for(i=0; i<n; i++)
+      {
+         s[newest*n+i] = xNew[i] - x[i];
+         y[newest*n+i] = gNew[i] - g[i];
+      }
+      beta = Dot(s+newest*n, y+newest*n, n);
+      if(beta > 1.0e-10)
+      {
+         rho[newest] = 1.0 / beta;
+         if(nhist < NMEMORY)
+            nhist++;
+      }
+      else
+      {
+         newest = (newest - 1 + NMEMORY) % NMEMORY;
+      }
+
+      memcpy(x, xNew, n*sizeof(REAL));
+      memcpy(g, gNew, n*sizeof(REAL));
+      e = eNew;
+
+      /* Rebuild the neighbour list if hydrogens have moved far enough  */
+      if(ListNeedsUpdate(h, x))
+      {
+         Scatter(h, x);
+         if(!BuildNeighbourList(h))
+            goto cleanup;
+         e = Energy(h, x, g);
+      }
+   }
+
+   /* Copy the results back into the linked list                        */
+   Scatter(h, x);
+   for(i=0; i<h->nmove; i++)
+   {
+      TINKERXYZ *t = h->idx[h->move[i]];
+      t->x = x[3*i];
+      t->y = x[3*i+1];
+      t->z = x[3*i+2];
+   }
+   ok = TRUE;
+
+cleanup:
+   if(x    != NULL) free(x);
+   if(g    != NULL) free(g);
+   if(xNew != NULL) free(xNew);
+   if(gNew != NULL) free(gNew);
+   if(d    != NULL) free(d);
+   if(s    != NULL) free(s);
+   if(y    != NULL) free(y);
+   FreeRelax(h);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static HRELAX *SetupRelax(TINKERXYZ *xyz)
+   -----------------------------------------
+*//**
+   Indexes the atoms, finds the movable hydrogens and builds the bond,
+   angle and neighbour lists.
+
+-  19.10.26 Original   By: ACRM
+*/
+static HRELAX *SetupRelax(TINKERXYZ *xyz)
+{
+   HRELAX *h;
+   int    i;
+
+   if((h=(HRELAX *)calloc(1, sizeof(HRELAX)))==NULL)
+      return(NULL);
+
+   if((h->idx=IndexTinkerXYZ(xyz, &(h->natoms)))==NULL)
+   {
+      FreeRelax(h);
+      return(NULL);
+   }
+
+   if(((h->coor=(REAL *)malloc(3*h->natoms*sizeof(REAL)))==NULL)  ||
+      ((h->grad=(REAL *)malloc(3*h->natoms*sizeof(REAL)))==NULL)  ||
+      ((h->move=(int *)malloc(h->natoms*sizeof(int)))==NULL)      ||
+      ((h->element=(char *)malloc(h->natoms*sizeof(char)))==NULL))
+   {
+      FreeRelax(h);
+      return(NULL);
+   }
+
+   for(i=0; i<h->natoms; i++)
+   {
+      TINKERXYZ *t = h->idx[i];
+      char      el = t->atnam[0];
+
+      h->coor[3*i]   = t->x;
+      h->coor[3*i+1] = t->y;
+      h->coor[3*i+2] = t->z;
+
+      /* Connections refer to atom numbers                              */
+      if(t->atnum != i+1)
+      {
+         fprintf(stderr,"Error: Tinker XYZ atoms are not numbered \
+sequentially at atom %d\n", t->atnum);
+         FreeRelax(h);
+         return(NULL);
+      }
+
+      h->element[i] = (strchr("HCNOS", el) && el) ? el : 'X';
+      if(el == 'H')
+         h->move[h->nmove++] = i;
+   }
+
+   if(((h->listCoor=(REAL *)malloc(3*(h->nmove+1)*sizeof(REAL)))==NULL) ||
+      !BuildTerms(h) || !BuildNeighbourList(h))
+   {
+      FreeRelax(h);
+      return(NULL);
+   }
+
+   return(h);
+}
+
+
+/************************************************************************/
+static void FreeRelax(HRELAX *h)
+{
+   if(h == NULL)
+      return;
+
+   if(h->idx      != NULL) free(h->idx);
+   if(h->coor     != NULL) free(h->coor);
+   if(h->grad     != NULL) free(h->grad);
+   if(h->listCoor != NULL) free(h->listCoor);
+   if(h->bondLen  != NULL) free(h->bondLen);
+   if(h->angleCos != NULL) free(h->angleCos);
+   if(h->nbR0     != NULL) free(h->nbR0);
+   if(h->move     != NULL) free(h->move);
+   if(h->bond     != NULL) free(h->bond);
+   if(h->angle    != NULL) free(h->angle);
+   if(h->nb       != NULL) free(h->nb);
+   if(h->element  != NULL) free(h->element);
+   free(h);
+}
+
+
+/************************************************************************/
+/*>static BOOL BuildTerms(HRELAX *h)
+   ---------------------------------
+*//**
+   Builds the X-H bonds and the H-X-Y angles. Angles with two hydrogens
+   are only stored once.
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL BuildTerms(HRELAX *h)
+{
+   int m, i, a, b, x, y, maxAngle;
+
+   maxAngle = h->nmove * MAXXYZCONNECT;
+
+   if(((h->bond=(int *)malloc(2*h->nmove*MAXXYZCONNECT*sizeof(int)))
+       ==NULL) ||
+      ((h->bondLen=(REAL *)malloc(h->nmove*MAXXYZCONNECT*sizeof(REAL)))
+       ==NULL) ||
+      ((h->angle=(int *)malloc(3*(maxAngle+1)*sizeof(int)))==NULL) ||
+      ((h->angleCos=(REAL *)malloc((maxAngle+1)*sizeof(REAL)))==NULL))
+      return(FALSE);
+
+   for(m=0; m<h->nmove; m++)
+   {
+      i = h->move[m];
+
+      for(a=0; (a<MAXXYZCONNECT) && (x=h->idx[i]->connect[a]); a++)
+      {
+         int  nconn;
+         REAL cos0;
+
+         x--;
+         if((x < 0) || (x >= h->natoms))
+            continue;
+
+         h->bond[2*h->nbond]   = i;
+         h->bond[2*h->nbond+1] = x;
+         switch(h->element[x])
+         {
+         case 'C': h->bondLen[h->nbond] = 1.09; break;
+         case 'N': h->bondLen[h->nbond] = 1.01; break;
+         case 'O': h->bondLen[h->nbond] = 0.96; break;
+         case 'S': h->bondLen[h->nbond] = 1.34; break;
+         default:  h->bondLen[h->nbond] = 1.00; break;
+         }
+         h->nbond++;
+
+         nconn = CountConnections(h->idx[x]);
+         if(nconn == 3)
+            cos0 = COSTRIG;
+         else if((nconn == 2) && (h->element[x] == 'O'))
+            cos0 = COSWATER;
+         else
+            cos0 = COSTETRA;
+
+         for(b=0; (b<MAXXYZCONNECT) && (y=h->idx[x]->connect[b]); b++)
+         {
+            y--;
+            if((y == i) || (y < 0) || (y >= h->natoms))
+               continue;
+
+            /* H-X-H angles only once                                   */
+            if((h->element[y] == 'H') && (y < i))
+               continue;
+
+            if(h->nangle >= maxAngle)
+               continue;
+
+            h->angle[3*h->nangle]   = i;
+            h->angle[3*h->nangle+1] = x;
+            h->angle[3*h->nangle+2] = y;
+            h->angleCos[h->nangle]  = cos0;
+            h->nangle++;
+         }
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+static int CountConnections(TINKERXYZ *t)
+{
+   int i;
+   for(i=0; (i<MAXXYZCONNECT) && t->connect[i]; i++);
+   return(i);
+}
+
+
+/************************************************************************/
+/*>static BOOL BuildNeighbourList(HRELAX *h)
+   -----------------------------------------
+*//**
+   Finds all pairs involving a movable hydrogen that are within
+   RMAXREPEL + SKIN and are not 1-2 or 1-3 bonded. Pairs of two
+   hydrogens are only stored once.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses BuildSortedCellGrid()   By: ACRM
+*/
+static BOOL BuildNeighbourList(HRELAX *h)
+{
+   CELLGRID *grid;
+   int      cells[MAXNEIGHBOURCELLS],
+            ncells, m, i, j, k, l;
+   REAL     cut   = RMAXREPEL + SKIN,
+            cutSq = cut * cut;
+
+   if((grid=BuildSortedCellGrid(h->coor, h->natoms, cut))==NULL)
+      return(FALSE);
+
+   h->nnb = 0;
+   for(m=0; m<h->nmove; m++)
+   {
+      i = h->move[m];
+      for(k=0; k<3; k++)
+         h->listCoor[3*m+k] = h->coor[3*i+k];
+
+      ncells = GetNeighbourCells(grid,
+                                 GetCellIndex(grid, h->coor[3*i],
+                                              h->coor[3*i+1],
+                                              h->coor[3*i+2]),
+                                 cells);
+      for(k=0; k<ncells; k++)
+      {
+         for(l=grid->head[cells[k]]; l!=(-1); l=grid->next[l])
+         {
+            REAL dx, dy, dz;
+
+            j = grid->order[l];
+            if((j == i) || ((h->element[j] == 'H') && (j < i)))
+               continue;
+
+            dx = h->coor[3*i]   - grid->coor[3*l];
+            dy = h->coor[3*i+1] - grid->coor[3*l+1];
+            dz = h->coor[3*i+2] - grid->coor[3*l+2];
+            if((dx*dx + dy*dy + dz*dz) > cutSq)
+               continue;
+
+            if(Bonded13(h, i, j))
+               continue;
+
+            if(h->nnb >= h->maxnb)
+            {
+               int  newMax = 2*h->maxnb + 1024,
+                    *nb;
+               REAL *r0;
+               if((nb=(int *)realloc(h->nb, 2*newMax*sizeof(int)))==NULL)
+               {
+                  FreeCellGrid(grid);
+                  return(FALSE);
+               }
+               h->nb = nb;
+               if((r0=(REAL *)realloc(h->nbR0, newMax*sizeof(REAL)))
+                  ==NULL)
+               {
+                  FreeCellGrid(grid);
+                  return(FALSE);
+               }
+               h->nbR0  = r0;
+               h->maxnb = newMax;
+            }
+
+            h->nb[2*h->nnb]   = i;
+            h->nb[2*h->nnb+1] = j;
+            switch(h->element[j])
+            {
+            case 'H':           h->nbR0[h->nnb] = 1.8; break;
+            case 'N': case 'O': h->nbR0[h->nnb] = 1.7; break;
+            default:            h->nbR0[h->nnb] = RMAXREPEL; break;
+            }
+            h->nnb++;
+         }
+      }
+   }
+
+   FreeCellGrid(grid);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+static BOOL Bonded13(HRELAX *h, int i, int j)
+{
+   int a, b, c;
+
+   for(a=0; (a<MAXXYZCONNECT) && (c=h->idx[i]->connect[a]); a++)
+   {
+      if(c == j+1)
+         return(TRUE);
+      if((c < 1) || (c > h->natoms))
+         continue;
+      for(b=0; (b<MAXXYZCONNECT) && h->idx[c-1]->connect[b]; b++)
+      {
+         if(h->idx[c-1]->connect[b] == j+1)
+            return(TRUE);
+      }
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+static BOOL ListNeedsUpdate(HRELAX *h, REAL *x)
+{
+   int  i;
+   REAL limitSq = 0.25 * SKIN * SKIN;
+
+   for(i=0; i<3*h->nmove; i+=3)
+   {
+      REAL dx = x[i]   - h->listCoor[i],
+           dy = x[i+1] - h->listCoor[i+1],
+           dz = x[i+2] - h->listCoor[i+2];
+      if((dx*dx + dy*dy + dz*dz) > limitSq)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/* Copies the movable coordinates into the full coordinate array        */
+static void Scatter(HRELAX *h, REAL *x)
+{
+   int m, k;
+   for(m=0; m<h->nmove; m++)
+   {
+      for(k=0; k<3; k++)
+         h->coor[3*h->move[m]+k] = x[3*m+k];
+   }
+}
+
+
+/************************************************************************/
+static REAL Dot(REAL *a, REAL *b, int n)
+{
+   REAL sum = 0.0;
+   int  i;
+   for(i=0; i<n; i++)
+      sum += a[i] * b[i];
+   return(sum);
+}
+
+
+/************************************************************************/
+/*>static REAL Energy(HRELAX *h, REAL *x, REAL *g)
+   -----------------------------------------------
+*//**
+   \param[in]   *h    Relaxation data
+   \param[in]   *x    Movable hydrogen coordinates
+   \param[out]  *g    Gradient on the movable hydrogens
+   \return            Energy
+
+-  19.10.26 Original   By: ACRM
+*/
+static REAL Energy(HRELAX *h, REAL *x, REAL *g)
+{
+   REAL *c = h->coor,
+        *G = h->grad,
+        e  = 0.0;
+   int  n, i, j, k, m;
+
+   Scatter(h, x);
+   for(i=0; i<3*h->natoms; i++)
+      G[i] = 0.0;
+
+   /* Bonds                                                             */
+   for(n=0; n<h->nbond; n++)
+   {
+      REAL d[3], r, f;
+      i = h->bond[2*n];
+      j = h->bond[2*n+1];
+      for(k=0; k<3; k++)
+         d[k] = c[3*i+k] - c[3*j+k];
+      r = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+      if(r < 1.0e-6)
+         continue;
+      e += KBOND * (r - h->bondLen[n]) * (r - h->bondLen[n]);
+      f  = 2.0 * KBOND * (r - h->bondLen[n]) / r;
+      for(k=0; k<3; k++)
+      {
+         G[3*i+k] += f * d[k];
+         G[3*j+k] -= f * d[k];
+      }
+   }
+
+   /* Angles                                                            */
+   for(n=0; n<h->nangle; n++)
+   {
+      REAL u[3], v[3], lu, lv, cs, f, du, dv;
+      int  a = h->angle[3*n],
+           x0 = h->angle[3*n+1],
+           b = h->angle[3*n+2];
+      for(k=0; k<3; k++)
+      {
+         u[k] = c[3*a+k] - c[3*x0+k];
+         v[k] = c[3*b+k] - c[3*x0+k];
+      }
+      lu = sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+      lv = sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+      if((lu < 1.0e-6) || (lv < 1.0e-6))
+         continue;
+      cs = (u[0]*v[0] + u[1]*v[1] + u[2]*v[2]) / (lu * lv);
+      e += KANGLE * (cs - h->angleCos[n]) * (cs - h->angleCos[n]);
+      f  = 2.0 * KANGLE * (cs - h->angleCos[n]);
+      for(k=0; k<3; k++)
+      {
+         du = f * (v[k]/(lu*lv) - cs*u[k]/(lu*lu));
+         dv = f * (u[k]/(lu*lv) - cs*v[k]/(lv*lv));
+         G[3*a+k]  += du;
+         G[3*b+k]  += dv;
+         G[3*x0+k] -= du + dv;
+      }
+   }
+
+   /* Repulsion                                                         */
+   for(n=0; n<h->nnb; n++)
+   {
+      REAL d[3], rSq, r, f, r0 = h->nbR0[n];
+      i = h->nb[2*n];
+      j = h->nb[2*n+1];
+      for(k=0; k<3; k++)
+         d[k] = c[3*i+k] - c[3*j+k];
+      rSq = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+      if(rSq >= r0*r0)
+         continue;
+      r = sqrt(rSq);
+      if(r < 1.0e-6)
+      {
+         /* Exactly overlapping - push apart along x                    */
+         d[0] = 1.0; d[1] = d[2] = 0.0;
+         r    = 1.0e-6;
+      }
+      e += KREPEL * (r0 - r) * (r0 - r);
+      f  = -2.0 * KREPEL * (r0 - r) / r;
+      for(k=0; k<3; k++)
+      {
+         G[3*i+k] += f * d[k];
+         G[3*j+k] -= f * d[k];
+      }
+   }
+
+   /* Gather the gradient on the movable atoms                          */
+   for(m=0; m<h->nmove; m++)
+   {
+      for(k=0; k<3; k++)
+         g[3*m+k] = G[3*h->move[m]+k];
+   }
+
+   return(e);
+}
@@ -0,0 +1,63 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       hrelax.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Fast in-process relaxation of hydrogen positions
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+#ifndef _HRELAX_H
+#define _HRELAX_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "tinkerxyz.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define HRELAX_MAXITER    500
+#define HRELAX_RMSGRAD    0.05
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL RelaxHydrogens(TINKERXYZ *xyz, int maxIter, REAL rmsGrad,
+                    BOOL verbose);
+
+#endif
@@ -0,0 +1,714 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       hybrid36.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Hybrid-36 atom serial and residue numbers in PDB files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Description:
+   ============
+   The PDB format has five columns for atom serial numbers and four for
+   residue numbers, so a solvated system with more than 99,999 atoms or
+   9,999 residues in a chain can't be written in plain decimal.
+   Hybrid-36 (as used by the CCTBX and PDB tools) extends the range of
+   a width-w field without changing its width: values that fit are
+   written in decimal as normal; the next 26*36^(w-1) values are
+   written in base 36 with upper case letters (A0000, A0001, ...) and
+   the next 26*36^(w-1) with lower case letters. Because a hybrid-36
+   field that needs letters always starts with one, a file can be
+   read without knowing in advance whether it uses the encoding.
+
+   This gives up to 87,440,031 atoms and 2,436,112 residues per chain.
+
+   WritePDBHy36() and WritePDBRecordHy36() write the same layout as
+   blWritePDB() and blWritePDBRecord(); ReadPDBHy36() reads the first
+   model in the same way as blReadPDB() but decodes the numbers.
+   WritePDBHy36Threaded() formats ranges of records on separate
+   threads.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Coordinates parsed with numparse.c   By: ACRM
+   V1.2   19.10.26  Added WritePDBHy36Threaded() and 
+                    FormatPDBRecordHy36()   By: ACRM
+   V1.3   19.10.26  Added WritePDBHy36Atoms() and FormatConectHy36()
+                    By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/macros.h"
+#include "hybrid36.h"
+#include "numparse.h"
+#include "parwrite.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF         240
+#define MAXFIELD         16
+
+static char *sUpperDigits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+            *sLowerDigits = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static int  IntPower(int base, int n);
+static BOOL DecodeBase36(char *field, int width, char *digits,
+                         int *value);
+static BOOL ParseAtomRecord(char *line, int len, PDB *p);
+static void CopyField(char *out, char *line, int len, int start,
+                      int width);
+static BOOL FormatPDBLine(void *items, long i, void *data, 
+                          char *buffer, int *length);
+static BOOL GetRealField(char *line, int len, int start, int width,
+                         REAL *value);
+
+
+/************************************************************************/
+/*>BOOL Hy36Encode(int width, int value, char *result)
+   ---------------------------------------------------
+*//**
+   \param[in]   width     Field width (4 or 5 for PDB files)
+   \param[in]   value     The number to encode
+   \param[out]  *result   The encoded field (width+1 characters)
+   \return                FALSE if the value is out of range
+
+   Encodes a number as a right-justified hybrid-36 field. If the value
+   is out of range the field is filled with asterisks.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL Hy36Encode(int width, int value, char *result)
+{
+   int  decimal = IntPower(10, width),
+        block   = 26 * IntPower(36, width-1),
+        i;
+   char *digits = sUpperDigits;
+
+   if((value > -IntPower(10, width-1)) && (value < decimal))
+   {
+      sprintf(result, "%*d", width, value);
+      return(TRUE);
+   }
+
+   value -= decimal;
+   if((value >= 0) && (value >= block))
+   {
+      value  -= block;
+      digits  = sLowerDigits;
+   }
+
+   if((value < 0) || (value >= block))
+   {
+      for(i=0; i<width; i++)
+         result[i] = '*';
+      result[width] = '\0';
+      return(FALSE);
+   }
+
+   /* Offset so that the leading digit is a letter                      */
+   value += 10 * IntPower(36, width-1);
+   for(i=width-1; i>=0; i--)
+   {
+      result[i] = digits[value % 36];
+      value    /= 36;
+   }
+   result[width] = '\0';
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL Hy36Decode(int width, char *field, int *value)
+   ---------------------------------------------------
+*//**
+   \param[in]   width     Field width
+   \param[in]   *field    The field (at least width characters)
+   \param[out]  *value    The decoded number
+   \return                FALSE if the field is not a valid number
+
+   Decodes a decimal or hybrid-36 field. A blank field is read as 0 as
+   blReadPDB() does.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL Hy36Decode(int width, char *field, int *value)
+{
+   int  block = 26 * IntPower(36, width-1),
+        i;
+   BOOL negative = FALSE,
+        digits   = FALSE;
+
+   *value = 0;
+
+   if(isupper(field[0]) || islower(field[0]))
+   {
+      if(!DecodeBase36(field, width, 
+                       (isupper(field[0]) ? sUpperDigits : sLowerDigits),
+                       value))
+         return(FALSE);
+      *value += IntPower(10, width) - 10 * IntPower(36, width-1);
+      if(islower(field[0]))
+         *value += block;
+      return(TRUE);
+   }
+
+   /* Plain decimal, right-justified with optional leading spaces       */
+   for(i=0; (i<width) && (field[i] == ' '); i++);
+   if((i<width) && (field[i] == '-'))
+   {
+      negative = TRUE;
+      i++;
+   }
+   for(; (i<width) && isdigit(field[i]); i++)
+   {
+      *value = 10 * (*value) + (field[i] - '0');
+      digits = TRUE;
+   }
+   for(; i<width; i++)
+   {
+      if(field[i] != ' ')
+         return(FALSE);
+   }
+   if(negative)
+   {
+      if(!digits)
+         return(FALSE);
+      *value = -(*value);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL WritePDBRecordHy36(FILE *fp, PDB *p)
+   -----------------------------------------
+*//**
+   \param[in]   *fp    Output file
+   \param[in]   *p     Atom to write
+   \return             FALSE if a number is too large even for
+                       hybrid-36 (it is written as asterisks)
+
+   Writes an ATOM or HETATM record in the same layout as
+   blWritePDBRecord() with the serial and residue numbers in hybrid-36
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Record formatted by FormatPDBRecordHy36()   By: ACRM
+*/
+BOOL WritePDBRecordHy36(FILE *fp, PDB *p)
+{
+   char buffer[PW_MAXLINE];
+   BOOL ok;
+
+   FormatPDBRecordHy36(buffer, p, &ok);
+   fputs(buffer, fp);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int FormatPDBRecordHy36(char *buffer, PDB *p, BOOL *ok)
+   -------------------------------------------------------
+*//**
+   \param[out]  *buffer  The record (at least PW_MAXLINE chars)
+   \param[in]   *p       Atom to format
+   \param[out]  *ok      FALSE if a number is too large even for
+                         hybrid-36 (it is written as asterisks)
+   \return               Length of the record
+
+   Formats an ATOM or HETATM record, including the newline, as
+   WritePDBRecordHy36() writes it
+
+-  19.10.26 Original - split out of WritePDBRecordHy36()   By: ACRM
+*/
+int FormatPDBRecordHy36(char *buffer, PDB *p, BOOL *ok)
+{
+   char serial[HY36_SERIALWIDTH+1],
+        resnum[HY36_RESNUMWIDTH+1],
+        charge[MAXFIELD];
+
+   *ok = Hy36Encode(HY36_SERIALWIDTH, p->atnum,  serial);
+   *ok = Hy36Encode(HY36_RESNUMWIDTH, p->resnum, resnum) && *ok;
+
+   charge[0] = '\0';
+   if(p->formal_charge)
+      sprintf(charge, "%d%c", abs(p->formal_charge),
+              (p->formal_charge > 0) ? '+' : '-');
+
+   return(sprintf(buffer, "%-6s%5s %-4s%c%-4s%1s%4s%1s   %8.3f%8.3f%8.3f\
+%6.2f%6.2f      %-4s%2s%-2s\n",
+                  p->record_type, serial, p->atnam_raw, p->altpos, 
+                  p->resnam, p->chain, resnum, p->insert, 
+                  p->x, p->y, p->z, p->occ, p->bval, 
+                  p->segid, p->element, charge));
+}
+
+
+/************************************************************************/
+/*>int FormatConectHy36(char *buffer, int atnum, int *bonded, 
+                         int nbonded, BOOL *ok)
+   ------------------------------------------------------------
+*//**
+   \param[out]  *buffer   The records (at least PW_MAXLINE chars)
+   \param[in]   atnum     Atom number
+   \param[in]   *bonded   Numbers of the atoms bonded to it
+   \param[in]   nbonded   Number of bonded atoms (at most 24)
+   \param[out]  *ok       FALSE if a number is too large even for
+                          hybrid-36 (it is written as asterisks)
+   \return                Length of the records (0 if no bonded atoms)
+
+   Formats the CONECT records for an atom, four bonded atoms to a
+   record, with hybrid-36 serial numbers
+
+-  19.10.26 Original   By: ACRM
+*/
+int FormatConectHy36(char *buffer, int atnum, int *bonded, int nbonded,
+                     BOOL *ok)
+{
+   char serial[HY36_SERIALWIDTH+1];
+   int  i,
+        length = 0;
+
+   *ok = TRUE;
+   for(i=0; i<nbonded; i++)
+   {
+      if(!(i%4))
+      {
+         if(i)
+            buffer[length++] = '\n';
+         *ok = Hy36Encode(HY36_SERIALWIDTH, atnum, serial) && *ok;
+         length += sprintf(buffer+length, "CONECT%s", serial);
+      }
+      *ok = Hy36Encode(HY36_SERIALWIDTH, bonded[i], serial) && *ok;
+      length += sprintf(buffer+length, "%s", serial);
+   }
+   if(length)
+      buffer[length++] = '\n';
+   buffer[length] = '\0';
+
+   return(length);
+}
+
+
+/************************************************************************/
+/*>BOOL WritePDBHy36(FILE *fp, PDB *pdb)
+   -------------------------------------
+*//**
+   \param[in]   *fp    Output file
+   \param[in]   *pdb   PDB linked list
+   \return             FALSE if any number was out of range
+
+   Writes a PDB linked list as blWritePDB() does, with TER records
+   between chains, using hybrid-36 numbers where needed
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Atoms written by WritePDBHy36Atoms()   By: ACRM
+*/
+BOOL WritePDBHy36(FILE *fp, PDB *pdb)
+{
+   BOOL ok;
+
+   ok = WritePDBHy36Atoms(fp, pdb, 1);
+   fprintf(fp, "END   \n");
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL WritePDBHy36Atoms(FILE *fp, PDB *pdb, int nthreads)
+   --------------------------------------------------------
+*//**
+   \param[in]   *fp        Output file
+   \param[in]   *pdb       PDB linked list
+   \param[in]   nthreads   Number of threads
+   \return                 FALSE if any number was out of range, out
+                           of memory or the write failed
+
+   Writes the ATOM and HETATM records with TER records between chains
+   and after the last one, but no END record, so CONECT records can
+   follow. With more than one thread, the records are formatted on
+   nthreads threads and written to their place in the file by
+   ParallelWriteLines()
+
+-  19.10.26 Original - split out of WritePDBHy36() and
+            WritePDBHy36Threaded()   By: ACRM
+*/
+BOOL WritePDBHy36Atoms(FILE *fp, PDB *pdb, int nthreads)
+{
+   PDB  *p,
+        **idx;
+   char *lastChain = NULL;
+   int  natoms;
+   BOOL formatOK,
+        ok = TRUE;
+
+   if((nthreads <= 1) || (pdb == NULL))
+   {
+      for(p=pdb; p!=NULL; NEXT(p))
+      {
+         if((lastChain != NULL) && !CHAINMATCH(lastChain, p->chain))
+            fprintf(fp, "TER   \n");
+         lastChain = p->chain;
+         if(!WritePDBRecordHy36(fp, p))
+            ok = FALSE;
+      }
+   }
+   else
+   {
+      if((idx=blIndexPDB(pdb, &natoms))==NULL)
+      {
+         fprintf(stderr,"Error: No memory for output\n");
+         return(FALSE);
+      }
+
+      ok = ParallelWriteLines(fp, (void *)idx, (long)natoms, 
+                              FormatPDBLine, NULL, nthreads, &formatOK)
+           && formatOK;
+      free(idx);
+   }
+   fprintf(fp, "TER   \n");
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL WritePDBHy36Threaded(FILE *fp, PDB *pdb, int nthreads)
+   -----------------------------------------------------------
+*//**
+   \param[in]   *fp        Output file
+   \param[in]   *pdb       PDB linked list
+   \param[in]   nthreads   Number of threads
+   \return                 FALSE if any number was out of range, out
+                           of memory or the write failed
+
+   As WritePDBHy36() but the records are formatted on nthreads threads
+   and written to their place in the file by ParallelWriteLines()
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Atoms written by WritePDBHy36Atoms()   By: ACRM
+*/
+BOOL WritePDBHy36Threaded(FILE *fp, PDB *pdb, int nthreads)
+{
+   BOOL ok;
+
+   ok = WritePDBHy36Atoms(fp, pdb, nthreads);
+   fprintf(fp, "END   \n");
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL FormatPDBLine(void *items, long i, void *data, 
+                             char *buffer, int *length)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *items    Index of PDB atoms
+   \param[in]   i         The atom to format
+   \param[in]   *data     Unused
+   \param[out]  *buffer   The record, preceded by a TER record if
+                          the chain has changed
+   \param[out]  *length   Length of the record(s)
+   \return                FALSE if a number was out of range
+
+   PWFORMATFUNC for ParallelWriteLines()
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL FormatPDBLine(void *items, long i, void *data, 
+                          char *buffer, int *length)
+{
+   PDB  **idx = (PDB **)items;
+   BOOL ok;
+
+   (void)data;
+   *length = 0;
+   if((i > 0) && !CHAINMATCH(idx[i-1]->chain, idx[i]->chain))
+   {
+      strcpy(buffer, "TER   \n");
+      *length = 7;
+   }
+   *length += FormatPDBRecordHy36(buffer + *length, idx[i], &ok);
+   
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>PDB *ReadPDBHy36(FILE *fp, int *natoms)
+   ---------------------------------------
+*//**
+   \param[in]   *fp       PDB file
+   \param[out]  *natoms   Number of atoms read
+   \return                PDB linked list (NULL if no atoms or on error)
+
+   Reads the ATOM and HETATM records of the first model, decoding
+   hybrid-36 serial and residue numbers. Where there are alternate
+   positions, only the first one seen is kept.
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *ReadPDBHy36(FILE *fp, int *natoms)
+{
+   char buffer[MAXBUFF],
+        altpos = ' ';
+   PDB  *pdb   = NULL,
+        *p     = NULL;
+   int  len;
+
+   *natoms = 0;
+
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      if(!strncmp(buffer, "ENDMDL", 6))
+         break;
+      if(strncmp(buffer, "ATOM  ", 6) && strncmp(buffer, "HETATM", 6))
+         continue;
+
+      TERMINATE(buffer);
+      len = strlen(buffer);
+
+      if((len > 16) && (buffer[16] != ' '))
+      {
+         if(altpos == ' ')
+            altpos = buffer[16];
+         else if(buffer[16] != altpos)
+            continue;
+      }
+
+      if(pdb == NULL)
+      {
+         INIT(pdb, PDB);
+         p = pdb;
+      }
+      else
+      {
+         ALLOCNEXT(p, PDB);
+      }
+      if(p == NULL)
+      {
+         FREELIST(pdb, PDB);
+         *natoms = 0;
+         return(NULL);
+      }
+
+      if(!ParseAtomRecord(buffer, len, p))
+      {
+         fprintf(stderr,"Error: Invalid number in record:\n%s\n",
+                 buffer);
+         FREELIST(pdb, PDB);
+         *natoms = 0;
+         return(NULL);
+      }
+      (*natoms)++;
+   }
+
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseAtomRecord(char *line, int len, PDB *p)
+   --------------------------------------------------------
+*//**
+   \param[in]   *line    An ATOM or HETATM record
+   \param[in]   len      Length of the line
+   \param[out]  *p       PDB record to fill in (next is preserved)
+   \return               FALSE if a number is invalid
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Checks the coordinates, occupancy and B-value   By: ACRM
+*/
+static BOOL ParseAtomRecord(char *line, int len, PDB *p)
+{
+   char field[MAXFIELD],
+        *chp;
+   PDB  *next = p->next;
+
+   CLEAR_PDB(p);
+   p->next = next;
+
+   CopyField(p->record_type, line, len,  0, 6);
+   CopyField(field,          line, len,  6, HY36_SERIALWIDTH);
+   if(!Hy36Decode(HY36_SERIALWIDTH, field, &(p->atnum)))
+      return(FALSE);
+
+   CopyField(p->atnam_raw,   line, len, 12, 4);
+   for(chp=p->atnam_raw; *chp==' '; chp++);
+   strcpy(p->atnam, chp);
+   PADMINTERM(p->atnam, 4);
+
+   p->altpos = (len > 16) ? line[16] : ' ';
+   CopyField(p->resnam,      line, len, 17, 4);
+   CopyField(p->chain,       line, len, 21, 1);
+   CopyField(field,          line, len, 22, HY36_RESNUMWIDTH);
+   if(!Hy36Decode(HY36_RESNUMWIDTH, field, &(p->resnum)))
+      return(FALSE);
+   CopyField(p->insert,      line, len, 26, 1);
+
+   if(!GetRealField(line, len, 30, 8, &(p->x))    ||
+      !GetRealField(line, len, 38, 8, &(p->y))    ||
+      !GetRealField(line, len, 46, 8, &(p->z))    ||
+      !GetRealField(line, len, 54, 6, &(p->occ))  ||
+      !GetRealField(line, len, 60, 6, &(p->bval)))
+      return(FALSE);
+
+   CopyField(field, line, len, 72, 4);
+   KILLTRAILSPACES(field);
+   strcpy(p->segid, field);
+
+   CopyField(field, line, len, 76, 2);
+   for(chp=field; *chp==' '; chp++);
+   KILLTRAILSPACES(chp);
+   strcpy(p->element, chp);
+
+   CopyField(field, line, len, 78, 2);
+   if(isdigit(field[0]))
+      p->formal_charge = (field[0] - '0') * ((field[1] == '-') ? -1 : 1);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL DecodeBase36(char *field, int width, char *digits,
+                            int *value)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *field    The field
+   \param[in]   width     Field width
+   \param[in]   *digits   The 36 digit characters
+   \param[out]  *value    The base 36 value
+   \return                FALSE if a character isn't a valid digit
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL DecodeBase36(char *field, int width, char *digits,
+                         int *value)
+{
+   char *chp;
+   int  i;
+
+   *value = 0;
+   for(i=0; i<width; i++)
+   {
+      if((field[i] == '\0') ||
+         ((chp = strchr(digits, field[i])) == NULL))
+         return(FALSE);
+      *value = 36 * (*value) + (int)(chp - digits);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int IntPower(int base, int n)
+   ------------------------------------
+*//**
+   \param[in]   base   Base
+   \param[in]   n      Non-negative exponent
+   \return             base^n
+
+-  19.10.26 Original   By: ACRM
+*/
+static int IntPower(int base, int n)
+{
+   int result = 1;
+
+   while(n-- > 0)
+      result *= base;
+   return(result);
+}
+
+
+/************************************************************************/
+/*>static void CopyField(char *out, char *line, int len, int start,
+                         int width)
+   ----------------------------------------------------------------
+*//**
+   Copies a fixed-width column, padding with blanks if the line is short
+
+-  19.10.26 Original   By: ACRM
+*/
+static void CopyField(char *out, char *line, int len, int start,
+                      int width)
+{
+   int i;
+
+   for(i=0; i<width; i++)
+      out[i] = ((start+i) < len) ? line[start+i] : ' ';
+   out[width] = '\0';
+}
+
+
+/************************************************************************/
+/*>static BOOL GetRealField(char *line, int len, int start, int width,
+                            REAL *value)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   *line    The line
+   \param[in]   len      Length of the line
+   \param[in]   start    First column
+   \param[in]   width    Field width
+   \param[out]  *value   The value (0.0 if the field is blank or
+                         missing)
+   \return               FALSE if the field is not a number
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses ParseRealField()   By: ACRM
+*/
+static BOOL GetRealField(char *line, int len, int start, int width,
+                         REAL *value)
+{
+   if(start >= len)
+   {
+      *value = (REAL)0.0;
+      return(TRUE);
+   }
+   if(start + width > len)
+      width = len - start;
+   return(ParseRealField(line+start, width, value));
+}
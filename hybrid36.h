@@ -0,0 +1,76 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       hybrid36.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Hybrid-36 atom serial and residue numbers in PDB files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added WritePDBHy36Threaded() and 
+                    FormatPDBRecordHy36()   By: ACRM
+   V1.2   19.10.26  Added WritePDBHy36Atoms() and FormatConectHy36()
+                    By: ACRM
+
+*************************************************************************/
+#ifndef _HYBRID36_H
+#define _HYBRID36_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define HY36_SERIALWIDTH   5
+#define HY36_RESNUMWIDTH   4
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL Hy36Encode(int width, int value, char *result);
+BOOL Hy36Decode(int width, char *field, int *value);
+BOOL WritePDBRecordHy36(FILE *fp, PDB *p);
+int  FormatPDBRecordHy36(char *buffer, PDB *p, BOOL *ok);
+BOOL WritePDBHy36(FILE *fp, PDB *pdb);
+BOOL WritePDBHy36Threaded(FILE *fp, PDB *pdb, int nthreads);
+BOOL WritePDBHy36Atoms(FILE *fp, PDB *pdb, int nthreads);
+int  FormatConectHy36(char *buffer, int atnum, int *bonded, int nbonded,
+                      BOOL *ok);
+PDB  *ReadPDBHy36(FILE *fp, int *natoms);
+
+#endif
@@ -0,0 +1,385 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       numparse.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Fast parsing of the fixed-format numbers in PDB and
+               Tinker XYZ files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Description:
+   ============
+   The numbers in PDB and Tinker XYZ files are always plain decimals
+   (%8.3f, %12.6f, %5d, %6d) so the generality of sscanf() and strtod()
+   (locales, exponents, hex, infinities) is wasted on them. These
+   routines collect the digits of a number, convert up to 16 of them to
+   an integer mantissa M and return M/10^k where k is the number of
+   digits after the decimal point. Since M < 2^53 and 10^k (k <= 22)
+   are both exact as doubles and IEEE division is correctly rounded,
+   the result is exactly what strtod() gives. Anything else (more
+   digits, an exponent) is passed to strtod().
+
+   Where SSE2 is available the 16 digits are converted in parallel by
+   repeated multiply-adds of neighbouring digits (pairs, then 4-digit
+   and then 8-digit groups). Compile with -DNO_SIMD to use the scalar
+   code.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "numparse.h"
+
+#if defined(__SSE2__) && !defined(NO_SIMD)
+#  define USE_SSE2
+#  include <emmintrin.h>
+#endif
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXDIGITS       16     /* Digits converted without strtod()     */
+#define MAXPOW10        22     /* Largest exact power of 10             */
+#define MAXFIELD        40
+#define MAXHIGH8  90071992     /* Top 8 digits keeping M below 2^53     */
+
+static double sPow10[MAXPOW10+1] =
+   {1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+    1.0e8,  1.0e9,  1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15,
+    1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22};
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static char *CollectDigits(char *string, char *digits, int *ndigits,
+                           int *nfrac, BOOL *negative, BOOL *isReal);
+static void ConvertDigits(char *digits, int ndigits, int *high8,
+                          int *low8);
+
+
+/************************************************************************/
+/*>char *ParseRealToken(char *string, REAL *value)
+   -----------------------------------------------
+*//**
+   \param[in]   *string   String starting with (optional) white space
+                          and a number
+   \param[out]  *value    The number (0.0 if there isn't one)
+   \return                Pointer to the character after the number
+                          (NULL if there isn't one)
+
+   Parses a floating point number as sscanf("%lf") does, giving exactly
+   the value strtod() would
+
+-  19.10.26 Original   By: ACRM
+*/
+char *ParseRealToken(char *string, REAL *value)
+{
+   char digits[MAXDIGITS],
+        *start,
+        *end;
+   int  ndigits, nfrac,
+        high8, low8;
+   BOOL negative, isReal;
+
+   *value = (REAL)0.0;
+   for(start=string; isspace(*start); start++);
+
+   if((end=CollectDigits(start, digits, &ndigits, &nfrac, &negative,
+                         &isReal))==NULL)
+      return(NULL);
+
+   if((ndigits > MAXDIGITS) || (nfrac > MAXPOW10) ||
+      (*end == 'e') || (*end == 'E'))
+   {
+      *value = (REAL)strtod(start, &end);
+      return(end);
+   }
+
+   ConvertDigits(digits, ndigits, &high8, &low8);
+   if(high8 >= MAXHIGH8)
+   {
+      *value = (REAL)strtod(start, &end);
+      return(end);
+   }
+
+   *value = (REAL)((high8 * 1.0e8 + low8) / sPow10[nfrac]);
+   if(negative)
+      *value = -(*value);
+
+   return(end);
+}
+
+
+/************************************************************************/
+/*>char *ParseIntToken(char *string, int *value)
+   ---------------------------------------------
+*//**
+   \param[in]   *string   String starting with (optional) white space
+                          and an integer
+   \param[out]  *value    The integer (0 if there isn't one)
+   \return                Pointer to the character after the integer
+                          (NULL if there isn't one)
+
+   Parses an integer as sscanf("%d") does
+
+-  19.10.26 Original   By: ACRM
+*/
+char *ParseIntToken(char *string, int *value)
+{
+   char digits[MAXDIGITS],
+        *start,
+        *end;
+   int  ndigits, nfrac,
+        high8, low8;
+   BOOL negative, isReal;
+
+   *value = 0;
+   for(start=string; isspace(*start); start++);
+
+   if((end=CollectDigits(start, digits, &ndigits, &nfrac, &negative,
+                         &isReal))==NULL)
+      return(NULL);
+
+   /* A decimal point ends an integer so leave strtol() to find the end
+      as it does for very long numbers
+   */
+   if(isReal || (ndigits > MAXDIGITS/2))
+   {
+      *value = (int)strtol(start, &end, 10);
+      return((end == start) ? NULL : end);
+   }
+
+   ConvertDigits(digits, ndigits, &high8, &low8);
+   *value = negative ? -low8 : low8;
+
+   return(end);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseRealField(char *field, int width, REAL *value)
+   --------------------------------------------------------
+*//**
+   \param[in]   *field    Fixed-width field (need not be terminated)
+   \param[in]   width     Width of the field
+   \param[out]  *value    The number (0.0 if the field is blank)
+   \return                FALSE if the field isn't blank or a number
+                          with optional surrounding blanks
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ParseRealField(char *field, int width, REAL *value)
+{
+   char buffer[MAXFIELD+1],
+        *end;
+   int  i;
+
+   for(i=0; (i<width) && (i<MAXFIELD) && field[i]; i++)
+      buffer[i] = field[i];
+   buffer[i] = '\0';
+
+   if((end=ParseRealToken(buffer, value))==NULL)
+      end = buffer;
+   for(; *end; end++)
+   {
+      if(!isspace(*end))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseIntField(char *field, int width, int *value)
+   ------------------------------------------------------
+*//**
+   \param[in]   *field    Fixed-width field (need not be terminated)
+   \param[in]   width     Width of the field
+   \param[out]  *value    The integer (0 if the field is blank)
+   \return                FALSE if the field isn't blank or an integer
+                          with optional surrounding blanks
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ParseIntField(char *field, int width, int *value)
+{
+   char buffer[MAXFIELD+1],
+        *end;
+   int  i;
+
+   for(i=0; (i<width) && (i<MAXFIELD) && field[i]; i++)
+      buffer[i] = field[i];
+   buffer[i] = '\0';
+
+   if((end=ParseIntToken(buffer, value))==NULL)
+      end = buffer;
+   for(; *end; end++)
+   {
+      if(!isspace(*end))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static char *CollectDigits(char *string, char *digits, int *ndigits,
+                              int *nfrac, BOOL *negative, BOOL *isReal)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *string     Start of the number
+   \param[out]  *digits     The first MAXDIGITS significant digits
+   \param[out]  *ndigits    Number of significant digits (may be more
+                            than MAXDIGITS)
+   \param[out]  *nfrac      Number of digits after the decimal point
+   \param[out]  *negative   Was there a minus sign?
+   \param[out]  *isReal     Was there a decimal point?
+   \return                  Character after the number (NULL if there
+                            were no digits)
+
+   Leading zeros are skipped so they don't count against MAXDIGITS
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *CollectDigits(char *string, char *digits, int *ndigits,
+                           int *nfrac, BOOL *negative, BOOL *isReal)
+{
+   BOOL gotDigit = FALSE;
+
+   *ndigits  = *nfrac = 0;
+   *negative = *isReal = FALSE;
+
+   if((*string == '-') || (*string == '+'))
+   {
+      *negative = (BOOL)(*string == '-');
+      string++;
+   }
+
+   for(; *string == '0'; string++)
+      gotDigit = TRUE;
+   for(; isdigit(*string); string++)
+   {
+      if(*ndigits < MAXDIGITS)
+         digits[*ndigits] = *string;
+      (*ndigits)++;
+      gotDigit = TRUE;
+   }
+
+   if(*string == '.')
+   {
+      *isReal = TRUE;
+      for(string++; isdigit(*string); string++)
+      {
+         /* Zeros before the first significant digit only scale M       */
+         if(*ndigits || (*string != '0'))
+         {
+            if(*ndigits < MAXDIGITS)
+               digits[*ndigits] = *string;
+            (*ndigits)++;
+         }
+         (*nfrac)++;
+         gotDigit = TRUE;
+      }
+   }
+
+   return(gotDigit ? string : NULL);
+}
+
+
+/************************************************************************/
+/*>static void ConvertDigits(char *digits, int ndigits, int *high8,
+                             int *low8)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   *digits    Up to 16 ASCII digits
+   \param[in]   ndigits    Number of digits
+   \param[out]  *high8     Value of all but the last 8 digits
+   \param[out]  *low8      Value of the last 8 digits
+
+-  19.10.26 Original   By: ACRM
+*/
+static void ConvertDigits(char *digits, int ndigits, int *high8,
+                          int *low8)
+{
+   char padded[MAXDIGITS];
+   int  pad = MAXDIGITS - ndigits;
+
+   /* Right-justify in a field of zeros                                 */
+   memset(padded, '0', pad);
+   memcpy(padded+pad, digits, ndigits);
+
+#ifdef USE_SSE2
+   {
+      __m128i zero = _mm_setzero_si128(),
+              v, lo, hi;
+
+      v  = _mm_loadu_si128((__m128i *)padded);
+      v  = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+
+      /* 10*d[i] + d[i+1] for each pair as 32-bit                       */
+      lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero),
+                          _mm_set_epi16(1,10,1,10,1,10,1,10));
+      hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero),
+                          _mm_set_epi16(1,10,1,10,1,10,1,10));
+
+      /* Pairs of pairs give 4-digit groups                             */
+      v  = _mm_madd_epi16(_mm_packs_epi32(lo, hi),
+                          _mm_set_epi16(1,100,1,100,1,100,1,100));
+
+      /* Pairs of 4-digit groups give the two 8-digit halves            */
+      v  = _mm_madd_epi16(_mm_packs_epi32(v, v),
+                          _mm_set_epi16(1,10000,1,10000,
+                                        1,10000,1,10000));
+
+      *high8 = _mm_cvtsi128_si32(v);
+      *low8  = _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+   }
+#else
+   {
+      int i;
+
+      *high8 = *low8 = 0;
+      for(i=0; i<MAXDIGITS/2; i++)
+         *high8 = 10 * (*high8) + (padded[i] - '0');
+      for(; i<MAXDIGITS; i++)
+         *low8  = 10 * (*low8)  + (padded[i] - '0');
+   }
+#endif
+}
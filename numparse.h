@@ -0,0 +1,59 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       numparse.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Fast parsing of the fixed-format numbers in PDB and
+               Tinker XYZ files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+#ifndef _NUMPARSE_H
+#define _NUMPARSE_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+char *ParseRealToken(char *string, REAL *value);
+char *ParseIntToken(char *string, int *value);
+BOOL ParseRealField(char *field, int width, REAL *value);
+BOOL ParseIntField(char *field, int width, int *value);
+
+#endif
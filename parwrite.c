@@ -0,0 +1,380 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       parwrite.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Writing line-based files from several threads
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Description:
+   ============
+   Tinker XYZ atom lines and PDB ATOM records are each formatted from
+   a single atom, so a large file can be formatted by several threads
+   at once. The items are handled in rounds of PWBLOCKLINES lines per
+   thread. Each thread formats a disjoint range of lines into its own
+   block and the block offsets in the file follow from a running sum
+   of the block lengths, so line lengths need not be fixed (e.g. the
+   number of connections in a Tinker XYZ file varies). The threads
+   then pwrite() their blocks straight to their place in the file.
+
+   If the output isn't a regular file (a pipe, or a compressed stream
+   which is a pipe to the compressor) the blocks are formatted in
+   parallel but written in order with fwrite().
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* pwrite(), fstat() and fileno() are not ANSI                          */
+#define _XOPEN_SOURCE 500
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "parwrite.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PWBLOCKLINES 65536     /* Lines formatted per thread per round  */
+#define PWLINEGUESS    96     /* Typical line length for allocation    */
+
+/* The lines handled by one thread in one round                         */
+typedef struct
+{
+   void         *items,        /* Items to be written                   */
+                *data;         /* Passed to the format function         */
+   PWFORMATFUNC format;
+   long         first,         /* Items in this block                   */
+                last;
+   char         *buffer;       /* The formatted block                   */
+   long         size,
+                maxsize;
+   int          fd;            /* File and offset for pwrite()          */
+   off_t        offset;
+   BOOL         formatOK,      /* All items formatted properly          */
+                writeOK;       /* Block written                         */
+}  PWBLOCK;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL RunBlocks(void *(*func)(void *), PWBLOCK *block, 
+                      pthread_t *tid, int nblocks);
+static void *FormatBlock(void *arg);
+static void *WriteBlock(void *arg);
+
+
+/************************************************************************/
+/*>BOOL ParallelWriteLines(FILE *fp, void *items, long nitems,
+                           PWFORMATFUNC format, void *data, int nthreads,
+                           BOOL *formatOK)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]   *fp        Output file pointer
+   \param[in]   *items     Items to write (passed to format)
+   \param[in]   nitems     Number of items
+   \param[in]   format     Function to format one item as a line
+   \param[in]   *data      Passed to format
+   \param[in]   nthreads   Number of threads
+   \param[out]  *formatOK  FALSE if format failed for any item
+   \return                 FALSE if out of memory or the write failed
+
+   Writes one line (or more) per item at the current position in the
+   file, formatting them on up to nthreads threads. Anything written
+   to fp before is flushed first and fp is left positioned after the
+   last line, so the caller can carry on with fprintf()
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ParallelWriteLines(FILE *fp, void *items, long nitems,
+                        PWFORMATFUNC format, void *data, int nthreads,
+                        BOOL *formatOK)
+{
+   PWBLOCK     *block;
+   pthread_t   *tid;
+   struct stat st;
+   off_t       offset     = 0;
+   long        first;
+   int         i,
+               nblocks,
+               fd         = fileno(fp);
+   BOOL        positional = FALSE,
+               memOK      = TRUE,
+               ok         = TRUE;
+
+   *formatOK = TRUE;
+   if(nthreads < 1)
+      nthreads = 1;
+   if(nthreads > (nitems + PWBLOCKLINES - 1) / PWBLOCKLINES)
+      nthreads = (int)((nitems + PWBLOCKLINES - 1) / PWBLOCKLINES);
+   if(nthreads == 0)
+      return(TRUE);
+
+   if(((block=(PWBLOCK *)calloc(nthreads, sizeof(PWBLOCK)))==NULL) ||
+      ((tid=(pthread_t *)malloc(nthreads * sizeof(pthread_t)))==NULL))
+   {
+      free(block);
+      fprintf(stderr,"Error: No memory for output\n");
+      return(FALSE);
+   }
+
+   /* Write in place if there is more than one thread and the output
+      is a regular file
+   */
+   if(fflush(fp) == 0)
+   {
+      if((nthreads > 1) && (fstat(fd, &st) == 0) && S_ISREG(st.st_mode) &&
+         ((offset=lseek(fd, 0, SEEK_CUR)) != (off_t)(-1)))
+         positional = TRUE;
+   }
+   else
+   {
+      ok = FALSE;
+   }
+
+   for(first=0; ok && (first<nitems); first+=nthreads*PWBLOCKLINES)
+   {
+      for(nblocks=0; nblocks<nthreads; nblocks++)
+      {
+         PWBLOCK *b = block + nblocks;
+         
+         b->first = first + nblocks * PWBLOCKLINES;
+         if(b->first >= nitems)
+            break;
+         b->last = b->first + PWBLOCKLINES;
+         if(b->last > nitems)
+            b->last = nitems;
+         b->items    = items;
+         b->data     = data;
+         b->format   = format;
+         b->fd       = fd;
+         b->formatOK = TRUE;
+         b->writeOK  = TRUE;
+      }
+      
+      if(!RunBlocks(FormatBlock, block, tid, nblocks))
+      {
+         ok = FALSE;
+         break;
+      }
+
+      /* The blocks follow each other in the file                       */
+      for(i=0; i<nblocks; i++)
+      {
+         if(block[i].buffer == NULL)
+            memOK = FALSE;
+         if(!block[i].formatOK)
+            *formatOK = FALSE;
+         block[i].offset  = offset;
+         offset          += (off_t)block[i].size;
+      }
+      if(!memOK)
+         break;
+
+      if(positional)
+      {
+         if(!RunBlocks(WriteBlock, block, tid, nblocks))
+            ok = FALSE;
+         for(i=0; i<nblocks; i++)
+         {
+            if(!block[i].writeOK)
+               ok = FALSE;
+         }
+      }
+      else
+      {
+         for(i=0; i<nblocks; i++)
+         {
+            if(fwrite(block[i].buffer, 1, (size_t)block[i].size, fp) !=
+               (size_t)block[i].size)
+               ok = FALSE;
+         }
+      }
+   }
+
+   /* Leave fp after what the threads wrote                             */
+   if(!memOK)
+      ok = FALSE;
+   else if(ok && positional && (fseek(fp, (long)offset, SEEK_SET) != 0))
+      ok = FALSE;
+
+   if(!memOK)
+      fprintf(stderr,"Error: No memory for output\n");
+   else if(!ok)
+      fprintf(stderr,"Error: Failed to write output\n");
+
+   for(i=0; i<nthreads; i++)
+   {
+      if(block[i].buffer != NULL)
+         free(block[i].buffer);
+   }
+   free(block);
+   free(tid);
+   
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunBlocks(void *(*func)(void *), PWBLOCK *block, 
+                         pthread_t *tid, int nblocks)
+   ------------------------------------------------------------
+*//**
+   \param[in]      func      Thread function
+   \param[in,out]  *block    Blocks to work on
+   \param[in]      *tid      Space for the thread IDs
+   \param[in]      nblocks   Number of blocks
+   \return                   FALSE if a thread couldn't be started
+
+   Runs func on each block, on the calling thread if there is only one
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL RunBlocks(void *(*func)(void *), PWBLOCK *block, 
+                      pthread_t *tid, int nblocks)
+{
+   int  i,
+        nstarted = 0;
+   BOOL ok       = TRUE;
+
+   if(nblocks == 1)
+   {
+      (*func)((void *)block);
+      return(TRUE);
+   }
+   
+   for(i=0; i<nblocks; i++)
+   {
+      if(pthread_create(&(tid[i]), NULL, func, (void *)&(block[i])) != 0)
+      {
+         fprintf(stderr,"Error: Unable to start thread\n");
+         ok = FALSE;
+         break;
+      }
+      nstarted++;
+   }
+   for(i=0; i<nstarted; i++)
+      pthread_join(tid[i], NULL);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static void *FormatBlock(void *arg)
+   -----------------------------------
+*//**
+   \param[in,out]  *arg   The PWBLOCK to work on
+   \return                NULL
+
+   Thread function. Formats the block's items into its buffer, growing
+   the buffer as needed. The buffer is kept between rounds. On running
+   out of memory the buffer is freed and left as NULL.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *FormatBlock(void *arg)
+{
+   PWBLOCK *block = (PWBLOCK *)arg;
+   char    *buffer;
+   long    i;
+   int     length;
+
+   block->size = 0;
+   for(i=block->first; i<block->last; i++)
+   {
+      if(block->size + PW_MAXLINE > block->maxsize)
+      {
+         long maxsize = 2 * block->maxsize + 
+                        (block->last - i) * PWLINEGUESS + PW_MAXLINE;
+         if((buffer=(char *)realloc(block->buffer, maxsize))==NULL)
+         {
+            free(block->buffer);
+            block->buffer  = NULL;
+            block->maxsize = 0;
+            return(NULL);
+         }
+         block->buffer  = buffer;
+         block->maxsize = maxsize;
+      }
+
+      length = 0;
+      if(!(*block->format)(block->items, i, block->data, 
+                           block->buffer + block->size, &length))
+         block->formatOK = FALSE;
+      block->size += length;
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *WriteBlock(void *arg)
+   ----------------------------------
+*//**
+   \param[in,out]  *arg   The PWBLOCK to work on
+   \return                NULL
+
+   Thread function. Writes the block's buffer at its offset in the file
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *WriteBlock(void *arg)
+{
+   PWBLOCK *block  = (PWBLOCK *)arg;
+   long    written = 0;
+   ssize_t nbytes;
+
+   while(written < block->size)
+   {
+      nbytes = pwrite(block->fd, block->buffer + written, 
+                      (size_t)(block->size - written), 
+                      block->offset + (off_t)written);
+      if(nbytes <= 0)
+      {
+         block->writeOK = FALSE;
+         break;
+      }
+      written += (long)nbytes;
+   }
+
+   return(NULL);
+}
@@ -0,0 +1,70 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       parwrite.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Writing line-based files from several threads
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+#ifndef _PARWRITE_H
+#define _PARWRITE_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PW_MAXLINE   512       /* Most a PWFORMATFUNC may write         */
+
+/* Formats item i of items into buffer, setting the number of characters
+   written. Returns FALSE if the item couldn't be represented properly
+   (the line is still written)
+*/
+typedef BOOL (*PWFORMATFUNC)(void *items, long i, void *data,
+                             char *buffer, int *length);
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL ParallelWriteLines(FILE *fp, void *items, long nitems,
+                        PWFORMATFUNC format, void *data, int nthreads,
+                        BOOL *formatOK);
+
+#endif
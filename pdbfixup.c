@@ -0,0 +1,529 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       pdbfixup.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Passes to tidy up a PDB linked list built from Tinker
+               atom names
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Tinker has no chains. These passes assign chains from the bonds
+   (or the backbone geometry) and renumber the residues within each
+   chain. The atoms are named from the templates in tinkertypes.c as
+   they are converted.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c   By: ACRM
+   V1.1   19.10.26  GetChainLabel() no longer uses a static buffer so
+                    the passes can run on several threads   By: ACRM
+   V1.2   19.10.26  Added ParseChainLabels()   By: ACRM
+   V1.3   19.10.26  Added DoChainFromBonds()   By: ACRM
+   V1.4   19.10.26  Removed FixHydrogens(), FixCterOxygens(),
+                    FixAtomNames() and FixILECD1() which are replaced
+                    by the naming templates   By: ACRM
+   V1.5   19.10.26  DoChainFromBonds() only follows backbone links
+                    between residues   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "pdbfixup.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXLABEL         8
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL PolymerBond(int a, int b, void *data);
+
+/************************************************************************/
+/*>void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out]  *pdb            PDB linked list
+   \param[in]      *chains         Chain labels (or blank string)
+   \param[in]      BumpChainOnHet  Bump the chain label when a HETATM
+                                   is found
+
+   Do the actual chain naming.
+
+   *** CODE TAKEN FROM pdbchain.c ***
+
+-  12.07.94 Original    By: ACRM
+-  25.07.94 Only increments ch if *ch != \0
+-  04.01.95 Added check on HETATM records
+-  27.01.95 ChainNum count now mod 26 so labels will cycle A-Z
+-  16.10.95 Handles BumpChainOnHet
+-  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  10.03.15 Chains is now an array
+*/
+void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet)
+{
+   PDB  *p,
+        *start,
+        *end,
+        *LastStart = NULL,
+        *N         = NULL,
+        *C         = NULL,
+        *CPrev     = NULL,
+        *CAPrev    = NULL,
+        *CA        = NULL;
+   int  ChainNum   = 0,
+        ChainIndex = 0;
+   char chain[MAXCHAINLABEL];
+   BOOL NewChain;
+   
+
+   if((chains!=NULL) && chains[ChainIndex][0])
+      strcpy(chain, chains[ChainIndex++]);
+   else
+      strcpy(chain, "A");
+   
+   for(start=pdb; start!=NULL; start=end)
+   {
+      NewChain = FALSE;
+      end = blFindNextResidue(start);
+
+      CA = N = C = NULL;
+      
+      for(p=start; p!=end; NEXT(p))
+      {
+         if(!strncmp(p->atnam,"CA  ",4)) CA  = p;
+         if(!strncmp(p->atnam,"N   ",4)) N   = p;
+         if(!strncmp(p->atnam,"C   ",4)) C   = p;
+      }
+
+      if(CPrev != NULL && N != NULL)
+      {
+         /* A C was defined in the last residue and an N in this one
+            Calc C-N distance
+         */
+         if(DISTSQ(CPrev, N) > CNDISTSQ)
+            NewChain = TRUE;
+      }
+      else if(CAPrev != NULL && CA != NULL)
+      {
+         /* No C-N connection, but a CAs found
+            Calc CA-CA distance
+         */
+         if(DISTSQ(CAPrev, CA) > CADISTSQ)
+            NewChain = TRUE;
+      }
+      else if(LastStart != NULL)
+      {
+         char buffer[80],
+              atoms[80];
+         
+         /* Build string specifying faulty residues                     */
+         if((CPrev == NULL || CAPrev == NULL) &&
+            (N     == NULL || CA     == NULL))
+            sprintf(buffer,"residues %s.%d%c and %s.%d%c",
+                    LastStart->chain,LastStart->resnum,
+                    LastStart->insert[0],
+                    start->chain,start->resnum,start->insert[0]);
+         else if(CPrev == NULL || CAPrev == NULL)
+            sprintf(buffer,"residue %s.%d%c",
+                    LastStart->chain,LastStart->resnum,
+                    LastStart->insert[0]);
+         else
+            sprintf(buffer,"residue %s.%d%c",
+                    start->chain,start->resnum,start->insert[0]);
+
+         /* Build string specifying faulty atoms                        */
+         atoms[0] = '\0';
+         if(CAPrev == NULL || CA == NULL) strcat(atoms,"CA ");
+         if(N      == NULL)               strcat(atoms,"N ");
+         if(CPrev  == NULL)               strcat(atoms,"C ");
+
+         /* Print warning message                                       */
+         if((LastStart != NULL && 
+             strncmp(LastStart->record_type, "HETATM", 6)) &&
+            (start     != NULL && 
+             strncmp(start->record_type,     "HETATM", 6)))
+            fprintf(stderr, "Warning: Atoms missing in %s: %s\n",
+                    buffer, atoms);
+
+         if(BumpChainOnHet &&
+            (LastStart != NULL && 
+             !strncmp(LastStart->record_type, "HETATM", 6)) &&
+            (start     != NULL && 
+             !strncmp(start->record_type,     "ATOM  ",6)))
+            NewChain = TRUE;
+      }
+
+      /* If we've changed chain, set the new chain name                 */
+      if(NewChain)
+      {
+         ChainNum++;
+         
+         if((chains!=NULL) && chains[ChainIndex][0])
+         {
+            strcpy(chain,chains[ChainIndex++]);
+         }
+         else
+         {
+            GetChainLabel(ChainNum, chain);
+         }
+      }
+
+      /* Copy the name into this residue                                */
+      for(p=start; p!=end; NEXT(p))
+         strcpy(p->chain, chain);
+      
+      /* Set pointers for next residue                                  */
+      CAPrev    = CA;
+      CPrev     = C;
+      LastStart = start;
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL DoChainFromBonds(PDB *pdb, BONDGRAPH *graph, char **chains,
+                         int nthreads)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out]  *pdb       PDB linked list of polymer atoms
+   \param[in]      *graph     Bonds from the Tinker XYZ file
+   \param[in]      **chains   Chain labels (or NULL)
+   \param[in]      nthreads   Threads for finding the components
+   \return                    FALSE if no memory or the atom numbers
+                              don't match the bond graph
+
+   Chain naming from the connectivity rather than the geometry as done
+   by DoChain(). Each connected component of the bond graph containing
+   ATOM records is a chain. Only bonds within a residue and backbone
+   links to the next residue are followed (see PolymerBond()), so
+   disulphides and contacts between chains don't join them. Components
+   made only of HETATMs (ligands) stay in the chain before them, as
+   they do with DoChain().
+
+   Chains are labelled in the order they are first met and a component
+   keeps its label if its residues are not contiguous.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Bonds between residues other than backbone links are not
+            followed   By: ACRM
+*/
+BOOL DoChainFromBonds(PDB *pdb, BONDGRAPH *graph, char **chains,
+                      int nthreads)
+{
+   PDB  **atoms,
+        *p,
+        *start,
+        *end;
+   int  *comp,
+        *chainOf,
+        root,
+        nlabels  = 0,
+        ChainNum = 0;
+   char *hasAtom,
+        chain[MAXCHAINLABEL];
+   BOOL used = FALSE;
+
+   if((atoms=(PDB **)calloc(graph->natoms+1, sizeof(PDB *)))==NULL)
+      return(FALSE);
+
+   /* Atom i in the graph has atom number i+1                           */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((p->atnum < 1) || (p->atnum > graph->natoms))
+      {
+         free(atoms);
+         return(FALSE);
+      }
+      atoms[p->atnum-1] = p;
+   }
+
+   if((comp=FindBondComponents(graph, PolymerBond, (void *)atoms, 
+                               nthreads))==NULL)
+   {
+      free(atoms);
+      return(FALSE);
+   }
+   if(((chainOf=(int *)malloc((graph->natoms+1) * sizeof(int)))==NULL) ||
+      ((hasAtom=(char *)calloc(graph->natoms+1, sizeof(char)))==NULL))
+   {
+      if(chainOf != NULL)
+         free(chainOf);
+      free(comp);
+      free(atoms);
+      return(FALSE);
+   }
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      chainOf[comp[p->atnum-1]] = (-1);
+      if(!strncmp(p->record_type, "ATOM  ", 6))
+         hasAtom[comp[p->atnum-1]] = 1;
+   }
+
+   if(chains != NULL)
+   {
+      while(chains[nlabels][0])
+         nlabels++;
+   }
+
+   for(start=pdb; start!=NULL; start=end)
+   {
+      end  = blFindNextResidue(start);
+      root = comp[start->atnum-1];
+
+      /* A new polymer chain moves on to the next label unless the
+         current one has only been given to ligands
+      */
+      if(chainOf[root] < 0)
+      {
+         if(hasAtom[root])
+         {
+            if(used)
+               ChainNum++;
+            used = TRUE;
+         }
+         chainOf[root] = ChainNum;
+      }
+
+      if(chainOf[root] < nlabels)
+         strcpy(chain, chains[chainOf[root]]);
+      else
+         GetChainLabel(chainOf[root], chain);
+
+      for(p=start; p!=end; NEXT(p))
+         strcpy(p->chain, chain);
+   }
+
+   free(hasAtom);
+   free(chainOf);
+   free(comp);
+   free(atoms);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL PolymerBond(int a, int b, void *data)
+   -------------------------------------------------
+*//**
+   \param[in]   a       Atom
+   \param[in]   b       Atom
+   \param[in]   *data   Array of PDB pointers for the graph's atoms
+   \return              Should the bond be followed?
+
+   BGLINKFUNC for DoChainFromBonds(). Follows bonds between polymer
+   atoms in the same residue and the backbone links to the next
+   residue: C to N for proteins and O3' to P for nucleic acids. Other
+   bonds between residues, such as disulphides or close contacts bonded
+   in error, would join chains.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Only follows backbone links between residues rather than
+            everything but S-S   By: ACRM
+*/
+static BOOL PolymerBond(int a, int b, void *data)
+{
+   PDB **atoms = (PDB **)data,
+       *pa,
+       *pb;
+
+   if((atoms[a] == NULL) || (atoms[b] == NULL))
+      return(FALSE);
+
+   /* Put the atoms in residue order                                    */
+   pa = atoms[a];
+   pb = atoms[b];
+   if(pb->resnum < pa->resnum)
+   {
+      pa = atoms[b];
+      pb = atoms[a];
+   }
+
+   if(!CHAINMATCH(pa->chain, pb->chain))
+      return(FALSE);
+   if((pa->resnum == pb->resnum) && INSERTMATCH(pa->insert, pb->insert))
+      return(TRUE);
+   if(pb->resnum != pa->resnum + 1)
+      return(FALSE);
+
+   if(!strncmp(pa->atnam, "C   ", 4) && !strncmp(pb->atnam, "N   ", 4))
+      return(TRUE);
+   if((!strncmp(pa->atnam, "O3' ", 4) || !strncmp(pa->atnam, "O3* ", 4))
+      && !strncmp(pb->atnam, "P   ", 4))
+      return(TRUE);
+
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>char *GetChainLabel(int ChainNum, char *chain)
+   ----------------------------------------------
+*//**
+   \param[in]  ChainNum    Chain number
+   \param[out] *chain      Chain label (MAXCHAINLABEL chars)
+   \return                 The chain label
+
+   Converts a chain number (>=0) into a chain label. Chain labels run
+   from A-Z, a-z, 1-9, 0, and then 63 onwards as multi-character strings
+
+   *** CODE TAKEN FROM pdbchain.c ***
+
+-  10.03.15 Original   By: ACRM
+-  19.10.26 Takes the output buffer rather than using a static one
+            By: ACRM
+*/
+char *GetChainLabel(int ChainNum, char *chain)
+{
+   if(ChainNum < 26)
+   {
+      chain[0] = (char)(65 + ChainNum);
+      chain[1] = '\0';
+   }
+   else if(ChainNum < 52)
+   {
+      chain[0] = (char)(97 + (ChainNum-26));
+      chain[1] = '\0';
+   }
+   else if(ChainNum < 61)
+   {
+      sprintf(chain,"%d", ChainNum-51);
+   }
+   else if(ChainNum == 61)
+   {
+      strcpy(chain,"0");
+   }
+   else
+   {
+      sprintf(chain,"%d", ChainNum);
+   }
+   
+   return(chain);
+}
+
+/************************************************************************/
+/*>int ParseChainLabels(char *spec, char labels[][MAXCHAINLABEL],
+                        char **chains, int maxchains)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   *spec       Comma-separated chain labels
+   \param[out]  labels      Space for maxchains+1 labels
+   \param[out]  **chains    Space for maxchains+1 pointers to the labels
+   \param[in]   maxchains   Most labels to take
+   \return                  Number of labels
+
+   Splits a -c chain label list as blSplitStringOnCommas() does, but
+   into space given by the caller so that nothing needs to be freed.
+   As DoChain() expects, the list is ended with a blank label. Labels
+   are truncated to MAXCHAINLABEL-1 characters.
+
+-  19.10.26 Original   By: ACRM
+*/
+int ParseChainLabels(char *spec, char labels[][MAXCHAINLABEL],
+                     char **chains, int maxchains)
+{
+   int n = 0,
+       i;
+
+   while(n < maxchains)
+   {
+      for(i=0; *spec && (*spec != ','); spec++)
+      {
+         if(i < MAXCHAINLABEL-1)
+            labels[n][i++] = *spec;
+      }
+      labels[n][i] = '\0';
+      chains[n]    = labels[n];
+      n++;
+
+      if(*spec != ',')
+         break;
+      spec++;
+   }
+   labels[n][0] = '\0';
+   chains[n]    = labels[n];
+
+   return(n);
+}
+
+
+/************************************************************************/
+void RenumberResidues(PDB *pdb)
+{
+   PDB  *p;
+   int  resnum   = 0,
+        LastRes;
+   char LastInsert[MAXLABEL],
+        LastChain[MAXCHAINLABEL];
+
+   LastRes       = (-9999);
+   LastInsert[0] = '\0';
+   LastChain[0]  = '\0';
+   
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      /* Increment resnum if we have changed residue                    */
+      if((p->resnum != LastRes) ||
+         !INSERTMATCH(p->insert, LastInsert))
+      {
+         LastRes = p->resnum;
+         strcpy(LastInsert, p->insert);
+         
+         resnum++;
+      }
+
+      /* See if we've changed chain                                     */
+      if(!CHAINMATCH(p->chain, LastChain))
+      {
+         resnum = 1;
+         strcpy(LastChain, p->chain);
+      }
+      
+      /* Set the residue number                                         */
+      p->resnum = resnum;
+
+      /* Set the insert code to a blank                                 */
+      strcpy(p->insert, " ");
+   }
+}
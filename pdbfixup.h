@@ -0,0 +1,75 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       pdbfixup.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Passes to tidy up a PDB linked list built from Tinker
+               atom names
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c   By: ACRM
+   V1.1   19.10.26  GetChainLabel() takes the output buffer   By: ACRM
+   V1.2   19.10.26  Added ParseChainLabels()   By: ACRM
+   V1.3   19.10.26  Added DoChainFromBonds()   By: ACRM
+   V1.4   19.10.26  Removed the atom naming passes   By: ACRM
+
+*************************************************************************/
+#ifndef _PDBFIXUP_H
+#define _PDBFIXUP_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/pdb.h"
+#include "bondgraph.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXCHAINLABEL    8
+#define CNDISTSQ       3.5
+#define CADISTSQ      16.0
+
+
+/************************************************************************/
+/* Prototypes
+*/
+char *GetChainLabel(int ChainNum, char *chain);
+int  ParseChainLabels(char *spec, char labels[][MAXCHAINLABEL],
+                      char **chains, int maxchains);
+void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet);
+BOOL DoChainFromBonds(PDB *pdb, BONDGRAPH *graph, char **chains,
+                      int nthreads);
+void RenumberResidues(PDB *pdb);
+
+#endif
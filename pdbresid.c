@@ -0,0 +1,657 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       pdbresid.c
+
+   Version:    V1.3
+   Date:       19.10.26
+   Function:   Fast reading of residue identities from a PDB file and
+               in-place patching of coordinates
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   When all that is needed from a PDB file is the residue name, chain,
+   residue number and insert code of each residue, building a full PDB
+   linked list is wasteful. This reads just those columns from the
+   ATOM and HETATM records and stores one entry each time the chain,
+   residue number or insert code changes, which is the same rule that
+   blFindNextResidue() uses. As with blReadPDB(), only the first model
+   is read.
+
+   PatchPDBCoordinates() copies a PDB file through unchanged except
+   for the x, y and z columns of atoms that have a match in a second
+   structure, so headers, remarks, CONECT records, serial numbers and
+   the layout of every other column are preserved. Residues are
+   matched in order, in the same way as PatchResidueIds() does, and atoms
+   by name within the residue. Optionally, atoms in the second
+   structure that have no match (normally the hydrogens added by
+   Tinker) are inserted after the last line of their residue.
+
+   Atom serial and residue numbers may be in hybrid-36 (see
+   hybrid36.c) as well as plain decimal.
+
+   The file is memory-mapped where possible; if it can't be (e.g. it's
+   a pipe) it is read into memory instead (see filemap.c).
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added PatchPDBCoordinates(). The fallback for files
+                    that can't be mapped reads the whole file   By: ACRM
+   V1.2   19.10.26  Reads and writes hybrid-36 numbers   By: ACRM
+   V1.3   19.10.26  MapFile() moved to filemap.c   By: ACRM
+   V1.4   19.10.26  PatchResidueIds() and FixResidueNames() moved here
+                    from tinkerpatch.c so tinkerd can share them
+                    By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/macros.h"
+#include "pdbresid.h"
+#include "hybrid36.h"
+#include "filemap.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define INITRESIDUES  1024
+#define COORDSTART      30     /* Columns of x, y and z                 */
+#define COORDWIDTH      24
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL AddResidueId(char *line, int len, PDBRESID **res, int *nres,
+                         int *maxres);
+static void CopyField(char *out, char *line, int len, int start,
+                      int width);
+static BOOL IsAtomRecord(char *line, int len);
+static int  MaxAtomSerial(FILEMAP *fm);
+static void WriteAddedHydrogens(FILE *out, PDB *start, PDB *stop,
+                                char *matched, char *origLine,
+                                int origLen, int *serial);
+static BOOL IsHydrogenName(char *atnam);
+
+
+/************************************************************************/
+/*>PDBRESID *ReadPDBResidueIds(FILE *fp, int *nres)
+   ------------------------------------------------
+*//**
+   \param[in]   *fp     PDB file opened for reading
+   \param[out]  *nres   Number of residues
+   \return              Array of residue identities (NULL if no memory
+                        or no residues)
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses MapFile()   By: ACRM
+*/
+PDBRESID *ReadPDBResidueIds(FILE *fp, int *nres)
+{
+   PDBRESID    *res   = NULL;
+   int         maxres = 0;
+   FILEMAP     fm;
+   char        *line, *end, *eol;
+   BOOL        ok     = TRUE;
+
+   *nres = 0;
+
+   if(!MapFile(fp, &fm))
+      return(NULL);
+
+   end = fm.data + fm.size;
+   for(line=fm.data; ok && (line<end); line=eol+1)
+   {
+      if((eol=memchr(line, '\n', end-line)) == NULL)
+         eol = end;
+      if(((end-line) >= 6) && !strncmp(line, "ENDMDL", 6))
+         break;
+      ok = AddResidueId(line, (int)(eol-line), &res, nres, &maxres);
+   }
+   UnmapFile(&fm);
+
+   if(!ok || !(*nres))
+   {
+      if(res != NULL)
+         free(res);
+      *nres = 0;
+      return(NULL);
+   }
+
+   return(res);
+}
+
+
+/************************************************************************/
+/*>BOOL PatchPDBCoordinates(FILE *out, FILE *fp, PDB *pdbNew,
+                            BOOL addHydrogens, int *npatched,
+                            int *nunmatched)
+   ------------------------------------------------------------
+*//**
+   \param[in]   *out           Output file
+   \param[in]   *fp            Original PDB file opened for reading
+   \param[in]   *pdbNew        Structure supplying the new coordinates
+   \param[in]   addHydrogens   Insert hydrogens from pdbNew that have
+                               no match in the original
+   \param[out]  *npatched      Number of atoms whose coordinates were
+                               replaced
+   \param[out]  *nunmatched    Number of atoms in the first model of
+                               the original that had no match
+   \return                     Success
+
+   Copies the original file to out, replacing the coordinates of each
+   ATOM and HETATM record in the first model with those of the matching
+   atom in pdbNew. Everything else is copied byte for byte. Where an
+   atom has alternate locations, only the first is patched.
+
+   Inserted hydrogens take the record type, residue name, chain,
+   residue number and insert code of the original residue and are
+   numbered on from the highest serial number in the original, so
+   existing CONECT records remain valid.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL PatchPDBCoordinates(FILE *out, FILE *fp, PDB *pdbNew,
+                         BOOL addHydrogens, int *npatched,
+                         int *nunmatched)
+{
+   FILEMAP fm;
+   PDB     *p,
+           *resStart  = NULL,
+           *resStop   = pdbNew;
+   char    *line, *end, *eol,
+           *copied,                /* Start of the text not yet written */
+           *matched   = NULL,      /* Flag for each atom of pdbNew      */
+           *resLine   = NULL,      /* First line of current residue     */
+           *name,
+           key[MAXRESIDLABEL],
+           resKey[MAXRESIDLABEL],
+           atnam[MAXRESIDLABEL],
+           coords[COORDWIDTH+8];
+   int     natoms     = 0,
+           resOffset  = 0,         /* Index in pdbNew of resStart       */
+           nextOffset = 0,
+           resLen     = 0,
+           serial     = 0,
+           len, n, i;
+   BOOL    pending    = FALSE,     /* Hydrogens still to be added       */
+           ok         = TRUE;
+
+   *npatched = *nunmatched = 0;
+   resKey[0] = '\0';
+
+   for(p=pdbNew; p!=NULL; NEXT(p))
+      natoms++;
+   if((natoms == 0) ||
+      ((matched=(char *)calloc(natoms, sizeof(char)))==NULL))
+      return(FALSE);
+
+   if(!MapFile(fp, &fm))
+   {
+      free(matched);
+      return(FALSE);
+   }
+   if(addHydrogens)
+      serial = MaxAtomSerial(&fm);
+
+   end    = fm.data + fm.size;
+   copied = fm.data;
+   for(line=fm.data; line<end; line=eol+1)
+   {
+      if((eol=memchr(line, '\n', end-line)) == NULL)
+         eol = end;
+      len = (int)(eol-line);
+
+      if(!IsAtomRecord(line, len))
+      {
+         /* These belong to the preceding atom                          */
+         if((len >= 6) && (!strncmp(line, "ANISOU", 6) ||
+                           !strncmp(line, "SIGATM", 6) ||
+                           !strncmp(line, "SIGUIJ", 6)))
+            continue;
+
+         if(pending)
+         {
+            fwrite(copied, 1, line-copied, out);
+            copied = line;
+            WriteAddedHydrogens(out, resStart, resStop,
+                                matched+resOffset, resLine, resLen,
+                                &serial);
+            pending = FALSE;
+         }
+
+         /* Later models are copied unchanged                           */
+         if((len >= 6) && !strncmp(line, "ENDMDL", 6))
+            break;
+         continue;
+      }
+
+      /* Start of a new residue                                         */
+      CopyField(key, line, len, 21, 6);
+      if(strcmp(key, resKey))
+      {
+         if(pending)
+         {
+            fwrite(copied, 1, line-copied, out);
+            copied = line;
+            WriteAddedHydrogens(out, resStart, resStop,
+                                matched+resOffset, resLine, resLen,
+                                &serial);
+            pending = FALSE;
+         }
+
+         strcpy(resKey, key);
+         resStart  = resStop;
+         resOffset = nextOffset;
+         if(resStart != NULL)
+         {
+            resStop = blFindNextResidue(resStart);
+            for(p=resStart; p!=resStop; NEXT(p))
+               nextOffset++;
+
+            CopyField(atnam, line, len, 17, 4);
+            if(strncmp(resStart->resnam, atnam, 4))
+            {
+               fprintf(stderr,"Error: residue names don't match!\n");
+               blWritePDBRecord(stderr, resStart);
+               fprintf(stderr,"Original: %.*s\n", len, line);
+               ok = FALSE;
+               break;
+            }
+
+            resLine = line;
+            resLen  = len;
+            pending = addHydrogens;
+         }
+      }
+
+      /* Find the atom by name among the unmatched atoms of the residue */
+      CopyField(atnam, line, len, 12, 4);
+      KILLLEADSPACES(name, atnam);
+      KILLTRAILSPACES(name);
+      n = strlen(name);
+      for(p=resStart, i=resOffset; p!=resStop; NEXT(p), i++)
+      {
+         if(!matched[i] && !strncmp(p->atnam, name, n) &&
+            ((p->atnam[n] == ' ') || (p->atnam[n] == '\0')))
+            break;
+      }
+
+      if((p == resStop) || (len < COORDSTART+COORDWIDTH))
+      {
+         if((len < 17) || (line[16] == ' ') || (line[16] == 'A'))
+            (*nunmatched)++;
+         continue;
+      }
+
+      sprintf(coords, "%8.3f%8.3f%8.3f", p->x, p->y, p->z);
+      if(strlen(coords) != COORDWIDTH)
+      {
+         fprintf(stderr,"Error: coordinates too large for PDB \
+format\n");
+         blWritePDBRecord(stderr, p);
+         ok = FALSE;
+         break;
+      }
+
+      fwrite(copied, 1, (line+COORDSTART)-copied, out);
+      fputs(coords, out);
+      copied     = line + COORDSTART + COORDWIDTH;
+      matched[i] = 1;
+      (*npatched)++;
+   }
+
+   if(ok)
+   {
+      /* Hydrogens for a residue that ends the file                     */
+      if(pending)
+      {
+         fwrite(copied, 1, end-copied, out);
+         copied = end;
+         if((end > fm.data) && (end[-1] != '\n'))
+            fputc('\n', out);
+         WriteAddedHydrogens(out, resStart, resStop, matched+resOffset,
+                             resLine, resLen, &serial);
+      }
+      fwrite(copied, 1, end-copied, out);
+
+      if(resStop != NULL)
+      {
+         fprintf(stderr,"Error: Original structure ran out of \
+residues!\n");
+         ok = FALSE;
+      }
+   }
+
+   UnmapFile(&fm);
+   free(matched);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddResidueId(char *line, int len, PDBRESID **res,
+                            int *nres, int *maxres)
+   -------------------------------------------------------------
+*//**
+   \param[in]      *line     A line from the PDB file (not terminated)
+   \param[in]      len       Length of the line
+   \param[in,out]  **res     Residue identities (grown as needed)
+   \param[in,out]  *nres     Number of residues
+   \param[in,out]  *maxres   Space allocated in res
+   \return                   FALSE if out of memory
+
+   If the line is an ATOM or HETATM record starting a new residue, adds
+   it to the array
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Decodes hybrid-36 residue numbers   By: ACRM
+*/
+static BOOL AddResidueId(char *line, int len, PDBRESID **res, int *nres,
+                         int *maxres)
+{
+   char     resnum[MAXRESIDLABEL],
+            chain[MAXRESIDLABEL],
+            insert[MAXRESIDLABEL];
+   PDBRESID *last,
+            *r;
+   int      num;
+
+   if((len < 26) ||
+      (strncmp(line, "ATOM  ", 6) && strncmp(line, "HETATM", 6)))
+      return(TRUE);
+
+   CopyField(chain,  line, len, 21, 1);
+   CopyField(resnum, line, len, 22, HY36_RESNUMWIDTH);
+   CopyField(insert, line, len, 26, 1);
+   if(!Hy36Decode(HY36_RESNUMWIDTH, resnum, &num))
+      num = atoi(resnum);
+
+   if(*nres)
+   {
+      last = (*res) + (*nres) - 1;
+      if((last->resnum == num) && !strcmp(last->chain, chain) &&
+         !strcmp(last->insert, insert))
+         return(TRUE);
+   }
+
+   if(*nres == *maxres)
+   {
+      int newmax = (*maxres) ? 2 * (*maxres) : INITRESIDUES;
+
+      if((r=(PDBRESID *)realloc(*res, newmax*sizeof(PDBRESID)))==NULL)
+         return(FALSE);
+      *res    = r;
+      *maxres = newmax;
+   }
+
+   r = (*res) + (*nres)++;
+   CopyField(r->resnam, line, len, 17, 4);
+   strcpy(r->chain,  chain);
+   strcpy(r->insert, insert);
+   r->resnum = num;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void CopyField(char *out, char *line, int len, int start,
+                         int width)
+   ----------------------------------------------------------------
+*//**
+   Copies a fixed-width column, padding with blanks if the line is short
+
+-  19.10.26 Original   By: ACRM
+*/
+static void CopyField(char *out, char *line, int len, int start,
+                      int width)
+{
+   int i;
+
+   for(i=0; i<width; i++)
+      out[i] = ((start+i) < len) ? line[start+i] : ' ';
+   out[width] = '\0';
+}
+
+
+/************************************************************************/
+/*>static BOOL IsAtomRecord(char *line, int len)
+   ---------------------------------------------
+*//**
+   \param[in]   *line    A line from the PDB file (not terminated)
+   \param[in]   len      Length of the line
+   \return               Is it an ATOM or HETATM record?
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL IsAtomRecord(char *line, int len)
+{
+   return((len >= 6) &&
+          (!strncmp(line, "ATOM  ", 6) || !strncmp(line, "HETATM", 6)));
+}
+
+
+/************************************************************************/
+/*>static int MaxAtomSerial(FILEMAP *fm)
+   -------------------------------------
+*//**
+   \param[in]   *fm    PDB file contents
+   \return             Highest ATOM or HETATM serial number
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Decodes hybrid-36 serial numbers   By: ACRM
+*/
+static int MaxAtomSerial(FILEMAP *fm)
+{
+   char *line, *end, *eol,
+        field[MAXRESIDLABEL];
+   int  len, serial,
+        maxSerial = 0;
+
+   end = fm->data + fm->size;
+   for(line=fm->data; line<end; line=eol+1)
+   {
+      if((eol=memchr(line, '\n', end-line)) == NULL)
+         eol = end;
+      len = (int)(eol-line);
+      if(IsAtomRecord(line, len))
+      {
+         CopyField(field, line, len, 6, HY36_SERIALWIDTH);
+         if(!Hy36Decode(HY36_SERIALWIDTH, field, &serial))
+            serial = atoi(field);
+         if(serial > maxSerial)
+            maxSerial = serial;
+      }
+   }
+   return(maxSerial);
+}
+
+
+/************************************************************************/
+/*>static void WriteAddedHydrogens(FILE *out, PDB *start, PDB *stop,
+                                   char *matched, char *origLine,
+                                   int origLen, int *serial)
+   -----------------------------------------------------------------
+*//**
+   \param[in]      *out        Output file
+   \param[in]      *start      First atom of the residue in pdbNew
+   \param[in]      *stop       Start of the next residue
+   \param[in]      *matched    Flags for atoms already patched
+   \param[in]      *origLine   First line of the original residue
+   \param[in]      origLen     Length of the line
+   \param[in,out]  *serial     Last serial number used
+
+   Writes the hydrogens in a residue that had no match in the original,
+   labelled with the original residue identity
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Hybrid-36 residue and serial numbers   By: ACRM
+*/
+static void WriteAddedHydrogens(FILE *out, PDB *start, PDB *stop,
+                                char *matched, char *origLine,
+                                int origLen, int *serial)
+{
+   PDB  h,
+        *p;
+   char field[MAXRESIDLABEL];
+   int  i;
+
+   for(p=start, i=0; p!=stop; NEXT(p), i++)
+   {
+      if(!matched[i] && IsHydrogenName(p->atnam))
+      {
+         blCopyPDB(&h, p);
+         CopyField(h.record_type, origLine, origLen,  0, 6);
+         CopyField(h.resnam,      origLine, origLen, 17, 4);
+         CopyField(h.chain,       origLine, origLen, 21, 1);
+         CopyField(field,         origLine, origLen, 22, 
+                   HY36_RESNUMWIDTH);
+         CopyField(h.insert,      origLine, origLen, 26, 1);
+         if(!Hy36Decode(HY36_RESNUMWIDTH, field, &(h.resnum)))
+            h.resnum = atoi(field);
+         h.atnum  = ++(*serial);
+         h.altpos = ' ';
+         h.next   = NULL;
+         WritePDBRecordHy36(out, &h);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL IsHydrogenName(char *atnam)
+   ---------------------------------------
+*//**
+   \param[in]   *atnam   Atom name
+   \return               Is it a hydrogen?
+
+   Skips any leading spaces and digits (as in 1HB) and checks for H
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL IsHydrogenName(char *atnam)
+{
+   while((*atnam == ' ') || isdigit(*atnam))
+      atnam++;
+   return(*atnam == 'H');
+}
+
+
+/************************************************************************/
+/*>BOOL PatchResidueIds(PDB *pdbNew, PDBRESID *resOld, int nresOld)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out]  *pdbNew    PDB linked list from Tinker
+   \param[in]      *resOld    Residues of the original structure
+   \param[in]      nresOld    Number of residues in the original
+   \return                    Success
+
+   Copies the chain label, residue number and insert code from each
+   original residue to the corresponding Tinker residue
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Takes the residue identities rather than the original PDB
+            linked list. Returns FALSE if the original runs out of
+            residues
+-  19.10.26 Moved from tinkerpatch.c and renamed from tinkerpatch()
+            By: ACRM
+*/
+BOOL PatchResidueIds(PDB *pdbNew, PDBRESID *resOld, int nresOld)
+{
+   PDB *p,
+       *pNewStart,
+       *pNewStop;
+   int atnum = 0,
+       res   = 0;
+   
+   FixResidueNames(pdbNew);
+   
+   for(pNewStart=pdbNew; pNewStart!=NULL; pNewStart=pNewStop, res++)
+   {
+      if(res >= nresOld)
+      {
+         fprintf(stderr,"Error: Original structure ran out of \
+residues!\n");
+         return(FALSE);
+      }
+      
+      pNewStop = blFindNextResidue(pNewStart);
+      for(p=pNewStart; p!=pNewStop; NEXT(p))
+      {
+         atnum++;
+         
+         if(strncmp(p->resnam, resOld[res].resnam, 4))
+         {
+            fprintf(stderr,"Error: residue names don't match!\n");
+            blWritePDBRecord(stderr, p);
+            fprintf(stderr,"Original: %s %s%d%s\n", resOld[res].resnam,
+                    resOld[res].chain, resOld[res].resnum,
+                    resOld[res].insert);
+            return(FALSE);
+         }
+            
+         strcpy(p->chain, resOld[res].chain);
+         p->resnum = resOld[res].resnum;
+         strcpy(p->insert, resOld[res].insert);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FixResidueNames(PDB *pdb)
+   ------------------------------
+*//**
+   \param[in,out]  *pdb   PDB linked list from Tinker
+
+   Converts Tinker's CYX back to CYS and sets the occupancies to 1.0
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Moved from tinkerpatch.c   By: ACRM
+*/
+void FixResidueNames(PDB *pdb)
+{
+   PDB *p;
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(!strncmp(p->resnam, "CYX", 3))
+         strcpy(p->resnam, "CYS ");
+      p->occ = 1.0;
+   }
+}
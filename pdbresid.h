@@ -0,0 +1,83 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       pdbresid.h
+
+   Version:    V1.1
+   Date:       19.10.26
+   Function:   Fast reading of residue identities from a PDB file and
+               in-place patching of coordinates
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added PatchPDBCoordinates()   By: ACRM
+   V1.2   19.10.26  Added PatchResidueIds() and FixResidueNames()
+                    By: ACRM
+
+*************************************************************************/
+#ifndef _PDBRESID_H
+#define _PDBRESID_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXRESIDLABEL    8
+
+/* The fields that identify a residue, padded as in the bioplib PDB
+   structure
+*/
+typedef struct
+{
+   char resnam[MAXRESIDLABEL],
+        chain[MAXRESIDLABEL],
+        insert[MAXRESIDLABEL];
+   int  resnum;
+}  PDBRESID;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+PDBRESID *ReadPDBResidueIds(FILE *fp, int *nres);
+BOOL PatchPDBCoordinates(FILE *out, FILE *fp, PDB *pdbNew,
+                         BOOL addHydrogens, int *npatched,
+                         int *nunmatched);
+BOOL PatchResidueIds(PDB *pdbNew, PDBRESID *resOld, int nresOld);
+void FixResidueNames(PDB *pdb);
+
+#endif
@@ -0,0 +1,976 @@
+/*************************************************************************
+
+   Program:    pdbtinker
+   File:       pdbtinker.c
+
+   Version:    V1.4
+   Date:       19.10.26
+   Function:   Convert a PDB file into a Tinker .xyz file (and .seq file)
+               without needing Tinker's pdbxyz
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   ONLY WORKS WITH THE AMBER99 PARAMETER FILE
+
+   This is the reverse of tinkerpdb. Each atom is given the Tinker atom
+   type whose description maps back to its residue and atom name (see
+   tinkertypes.c). Bonds are assigned from covalent radii, using a cell
+   grid so that only nearby atoms are compared. Bonds between residues
+   are only made for the peptide, nucleic acid backbone and disulphide
+   links; other close contacts between residues are reported.
+
+   Unlike pdbxyz, hydrogens are NOT built - the input must already
+   contain any hydrogens that are needed. Atoms for which no Tinker
+   type can be found are skipped with a warning.
+
+**************************************************************************
+
+   Usage:
+   ======
+   pdbtinker [-s seqfile] [-S statsfile] [-P] [-z] paramfile 
+             [in.pdb [out.xyz]]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added -S for timing statistics   By: ACRM
+   V1.2   19.10.26  Added -P for hardware performance counters   By: ACRM
+   V1.3   19.10.26  Reads and writes gzip and zstd compressed files.
+                    Added -z   By: ACRM
+   V1.4   19.10.26  Added -t to write the Tinker XYZ file with several
+                    threads   By: ACRM
+   V1.5   19.10.26  Bond search uses a Morton sorted cell grid   By: ACRM
+   V1.6   19.10.26  Only bonds between residues for polymer links
+                    By: ACRM
+   V1.7   19.10.26  A bond is left out of both atoms rather than one if
+                    either already has MAXXYZCONNECT   By: ACRM
+   V1.8   19.10.26  -S and -P handled by StatsSetup()   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "tinkertypes.h"
+#include "tinkerxyz.h"
+#include "cellgrid.h"
+#include "stats.h"
+#include "zstream.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define BONDTOL        0.4    /* Tolerance on sum of covalent radii     */
+#define MINBONDSQ      0.16   /* Closer than this is an overlap         */
+#define SEQPERLINE      15
+#define TINKERDATA    "TINKERDATA"
+#define MAXTHREADS     256
+
+typedef struct
+{
+   char *element;
+   REAL radius;
+}  COVRAD;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                  char *infile, char *outfile, char *seqFile,
+                  char *statsFile, BOOL *perfCounters, BOOL *compress,
+                  int *nthreads);
+void Usage(void);
+TINKERXYZ *ConvertPDBToTinkerXYZ(PDB *pdb, TINKERTYPES *types,
+                                 int *natoms);
+void AssignTermini(PDB *pdb, int *terminus);
+BOOL AssignBonds(TINKERXYZ *xyz, int natoms, REAL *radii, 
+                 int *residue);
+BOOL IsResidueLink(TINKERXYZ *a, int resA, TINKERXYZ *b, int resB);
+BOOL AddConnection(TINKERXYZ *a, TINKERXYZ *b);
+REAL GetCovalentRadius(PDB *p);
+void WriteTinkerSequence(FILE *fp, PDB *pdb);
+void DeriveSeqFilename(char *outfile, char *seqFile);
+
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   char        infile[MAXBUFF],
+               outfile[MAXBUFF],
+               paramFile[MAXBUFF],
+               seqFile[MAXBUFF],
+               statsFile[MAXBUFF];
+   FILE        *in     = stdin,
+               *out    = stdout,
+               *pFp    = NULL,
+               *seqFp  = NULL;
+   BOOL        noEnv   = FALSE,
+               perfCounters = FALSE,
+               compress     = FALSE;
+   PDB         *pdb    = NULL;
+   TINKERTYPES *types  = NULL;
+   TINKERXYZ   *xyz    = NULL;
+   int         natoms,
+               nthreads = 1;
+
+   if(ParseCmdLine(argc, argv, paramFile, infile, outfile, seqFile,
+                   statsFile, &perfCounters, &compress, &nthreads))
+   {
+      if(!StatsSetup("pdbtinker", statsFile, perfCounters))
+         return(1);
+
+      if((pFp=blOpenFile(paramFile, TINKERDATA, "r", &noEnv))==NULL)
+      {
+         fprintf(stderr,"Error: Unable to open Tinker parameter \
+file: %s\n", paramFile);
+         if(noEnv)
+         {
+            fprintf(stderr,"       Try setting %s environment \
+variable.\n", TINKERDATA);
+         }
+
+         return(1);
+      }
+
+      if(ZStreamOpenStdFiles(infile, outfile, &in, &out,
+                             compress?ZSTREAM_GZIP:ZSTREAM_PLAIN))
+      {
+         StatsPhaseStart("ReadTinkerAtomTypes");
+         if((types=ReadTinkerAtomTypes(pFp))==NULL)
+         {
+            fprintf(stderr,"Error: No memory for Tinker atom types\n");
+            return(1);
+         }
+
+         StatsPhaseStart("ReadPDB");
+         if((pdb=blReadPDB(in, &natoms))==NULL)
+         {
+            fprintf(stderr,"Error: No atoms read from PDB file\n");
+            return(1);
+         }
+         StatsAddCount("atoms", natoms);
+
+         StatsPhaseStart("ConvertPDBToTinkerXYZ");
+         if((xyz=ConvertPDBToTinkerXYZ(pdb, types, &natoms))==NULL)
+         {
+            fprintf(stderr,"Error: Conversion failed\n");
+            return(1);
+         }
+
+         StatsPhaseStart("WriteTinkerXYZ");
+         if(!WriteTinkerXYZThreaded(out, natoms, 
+                                    (infile[0]?infile:"stdin"), NULL, xyz,
+                                    nthreads))
+            return(1);
+
+         if(seqFile[0])
+         {
+            if((seqFp=fopen(seqFile, "w"))==NULL)
+            {
+               fprintf(stderr,"Error: Unable to open sequence file: \
+%s\n", seqFile);
+               return(1);
+            }
+            StatsPhaseStart("WriteTinkerSequence");
+            WriteTinkerSequence(seqFp, pdb);
+            fclose(seqFp);
+         }
+         StatsPhaseEnd();
+
+         if(!StatsReport())
+            return(1);
+      }
+      else
+      {
+         fprintf(stderr,"Error: Unable to open input of output file\n");
+         return(1);
+      }
+   }
+   else
+   {
+      Usage();
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                     char *infile, char *outfile, char *seqFile,
+                     char *statsFile, BOOL *perfCounters, BOOL *compress,
+                     int *nthreads)
+   --------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  char   *paramFile
+            char   *infile       Input file (or blank string)
+            char   *outfile      Output file (or blank string)
+            char   *seqFile      Tinker sequence file (or blank string)
+            char   *statsFile    Statistics file (or blank string)
+            BOOL   *perfCounters Add hardware performance counters
+            BOOL   *compress     Compress output with no .gz/.zst name
+            int    *nthreads     Threads for writing the XYZ file
+   Returns: BOOL                 Success?
+
+   Parse the command line. If no sequence file is given, but an output
+   file is, the sequence file name is derived from the output file.
+
+   19.10.26  Original   By: ACRM
+   19.10.26  Added -S   By: ACRM
+   19.10.26  Added -P   By: ACRM
+   19.10.26  Added -z   By: ACRM
+   19.10.26  Added -t   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                  char *infile, char *outfile, char *seqFile,
+                  char *statsFile, BOOL *perfCounters, BOOL *compress,
+                  int *nthreads)
+{
+   argc--;
+   argv++;
+
+   infile[0] = outfile[0] = paramFile[0] = seqFile[0] = 
+      statsFile[0] = '\0';
+
+   if(argc < 1)
+   {
+      return(FALSE);
+   }
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+         {
+           return(FALSE);
+         }
+         else
+         {
+            switch(argv[0][1])
+            {
+            case 'h':
+               return(FALSE);
+               break;
+            case 's':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(seqFile, argv[0], MAXBUFF-1);
+               seqFile[MAXBUFF-1] = '\0';
+               break;
+            case 'S':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(statsFile, argv[0], MAXBUFF-1);
+               statsFile[MAXBUFF-1] = '\0';
+               break;
+            case 'P':
+               *perfCounters = TRUE;
+               break;
+            case 'z':
+               *compress = TRUE;
+               break;
+            case 't':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%d", nthreads) || (*nthreads < 1))
+                  return(FALSE);
+               if(*nthreads > MAXTHREADS)
+                  *nthreads = MAXTHREADS;
+               break;
+            default:
+               return(FALSE);
+               break;
+            }
+         }
+      }
+      else
+      {
+         /* Check that there are 1, 2 or 3 arguments left               */
+         if(argc < 1 || argc > 3)
+            return(FALSE);
+
+         /* Copy the first to paramFile                                 */
+         strcpy(paramFile, argv[0]);
+         argc--;
+         argv++;
+
+         /* If there's another, copy it to infile                       */
+         if(argc)
+         {
+            strcpy(infile, argv[0]);
+            argc--;
+            argv++;
+         }
+
+         /* If there's another, copy it to outfile                      */
+         if(argc)
+         {
+            strcpy(outfile, argv[0]);
+            argc--;
+            argv++;
+
+            if(!seqFile[0])
+               DeriveSeqFilename(outfile, seqFile);
+         }
+
+         return(TRUE);
+      }
+
+      argc--;
+      argv++;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void DeriveSeqFilename(char *outfile, char *seqFile)
+   ----------------------------------------------------
+*//**
+   \param[in]   *outfile   Output .xyz filename
+   \param[out]  *seqFile   Matching .seq filename
+
+   Replaces the extension of the output file with .seq as pdbxyz does.
+   A compression extension is removed first.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Removes .gz or .zst   By: ACRM
+*/
+void DeriveSeqFilename(char *outfile, char *seqFile)
+{
+   char *dot,
+        *slash;
+
+   strncpy(seqFile, outfile, MAXBUFF-5);
+   seqFile[MAXBUFF-5] = '\0';
+
+   if(ZStreamFormat(seqFile) != ZSTREAM_PLAIN)
+      *strrchr(seqFile, '.') = '\0';
+
+   dot   = strrchr(seqFile, '.');
+   slash = strrchr(seqFile, '/');
+   if((dot != NULL) && ((slash == NULL) || (dot > slash)))
+      *dot = '\0';
+
+   strcat(seqFile, ".seq");
+}
+
+
+/************************************************************************/
+void Usage(void)
+{
+   fprintf(stderr,"\npdbtinker V1.4 (c) 2026 UCL, Prof. Andrew C.R. \
+Martin\n");
+
+   fprintf(stderr,"\nUsage: pdbtinker [-s seqfile] [-S statsfile] [-P] \
+[-z] [-t nthreads]\n");
+   fprintf(stderr,"                 paramfile [in.pdb [out.xyz]]\n");
+   fprintf(stderr,"       -s  Write the Tinker sequence file here \
+(default: out.seq\n");
+   fprintf(stderr,"           if an output file is given)\n");
+   StatsUsage();
+   ZStreamUsage();
+   fprintf(stderr,"       -t  Write the Tinker XYZ file using this many \
+threads\n");
+
+   fprintf(stderr,"\nConverts a PDB file to Tinker XYZ format, assigning \
+atom types from\n");
+   fprintf(stderr,"the (amber99) parameter file and bonds from covalent \
+radii. The\n");
+   fprintf(stderr,"parameter file is also looked for in the directory \
+given by the\n");
+   fprintf(stderr,"%s environment variable. Hydrogens are not added.\n\n",
+           TINKERDATA);
+}
+
+
+/************************************************************************/
+/*>TINKERXYZ *ConvertPDBToTinkerXYZ(PDB *pdb, TINKERTYPES *types,
+                                    int *natoms)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *pdb      PDB linked list
+   \param[in]   *types    Tinker atom types
+   \param[out]  *natoms   Number of atoms in the Tinker structure
+   \return                Tinker XYZ linked list with bonds assigned
+
+   Assigns a Tinker type to each PDB atom and builds the bond lists.
+   Atoms with no Tinker type are skipped with a warning.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Numbers the residues for AssignBonds()   By: ACRM
+*/
+TINKERXYZ *ConvertPDBToTinkerXYZ(PDB *pdb, TINKERTYPES *types,
+                                 int *natoms)
+{
+   TINKERXYZ *xyz = NULL,
+             *t   = NULL;
+   PDB       *p,
+             *prev     = NULL;
+   int       *terminus = NULL,
+             *residue  = NULL,
+             nPDB      = 0,
+             nres      = 0,
+             i,
+             type,
+             nSkipped  = 0;
+   REAL      *radii    = NULL;
+   char      atnam[MAXLABEL];
+
+   *natoms = 0;
+   for(p=pdb; p!=NULL; NEXT(p))
+      nPDB++;
+
+   if(((terminus=(int *)malloc(nPDB * sizeof(int)))==NULL) ||
+      ((residue=(int *)malloc(nPDB * sizeof(int)))==NULL)  ||
+      ((radii=(REAL *)malloc(nPDB * sizeof(REAL)))==NULL))
+   {
+      if(terminus != NULL) free(terminus);
+      if(residue  != NULL) free(residue);
+      return(NULL);
+   }
+
+   AssignTermini(pdb, terminus);
+
+   for(p=pdb, i=0; p!=NULL; prev=p, NEXT(p), i++)
+   {
+      type = 0;
+
+      /* Number the residues in file order                              */
+      if((prev == NULL) || !CHAINMATCH(p->chain, prev->chain) ||
+         (p->resnum != prev->resnum) ||
+         !INSERTMATCH(p->insert, prev->insert))
+         nres++;
+
+      /* Tinker names both C-terminal oxygens OXT                       */
+      if((terminus[i] == TERM_C) && !strncmp(p->atnam, "O   ", 4))
+         type = FindTinkerAtomType(types, p->resnam, "OXT", TERM_C);
+      if(!type)
+         type = FindTinkerAtomType(types, p->resnam, p->atnam,
+                                   terminus[i]);
+
+      if(!type)
+      {
+         fprintf(stderr,"Warning: No Tinker type for %s %s%d%s \
+%s - skipped\n", p->resnam, p->chain, p->resnum, p->insert, p->atnam);
+         nSkipped++;
+         continue;
+      }
+
+      if(xyz==NULL)
+      {
+         INIT(xyz, TINKERXYZ);
+         t = xyz;
+      }
+      else
+      {
+         ALLOCNEXT(t, TINKERXYZ);
+      }
+      if(t==NULL)
+      {
+         FREELIST(xyz, TINKERXYZ);
+         free(terminus);
+         free(residue);
+         free(radii);
+         return(NULL);
+      }
+
+      t->atnum = ++(*natoms);
+      t->type  = type;
+      t->x     = p->x;
+      t->y     = p->y;
+      t->z     = p->z;
+      for(type=0; type<MAXXYZCONNECT; type++)
+         t->connect[type] = 0;
+
+      /* Tinker names are at most 3 characters                          */
+      strcpy(atnam, p->atnam);
+      TERMAT(atnam, ' ');
+      atnam[3] = '\0';
+      strcpy(t->atnam, atnam);
+
+      radii[(*natoms)-1]   = GetCovalentRadius(p);
+      residue[(*natoms)-1] = nres;
+   }
+
+   if(nSkipped)
+      fprintf(stderr,"Warning: %d atoms had no Tinker type\n", nSkipped);
+
+   if((xyz != NULL) && !AssignBonds(xyz, *natoms, radii, residue))
+   {
+      FREELIST(xyz, TINKERXYZ);
+   }
+
+   free(terminus);
+   free(residue);
+   free(radii);
+
+   return(xyz);
+}
+
+
+/************************************************************************/
+/*>void AssignTermini(PDB *pdb, int *terminus)
+   -------------------------------------------
+*//**
+   \param[in]   *pdb        PDB linked list
+   \param[out]  *terminus   Terminus flag for each atom
+
+   Flags the atoms in the first and last residues of each chain of ATOM
+   records as N- or C-terminal. A single-residue chain is treated as
+   N-terminal except for its OXT.
+
+-  19.10.26 Original   By: ACRM
+*/
+void AssignTermini(PDB *pdb, int *terminus)
+{
+   PDB  *start,
+        *stop,
+        *p,
+        *prevStart = NULL;
+   int  i       = 0,
+        prevI   = 0;
+   BOOL isAtom,
+        newChain;
+
+   for(start=pdb; start!=NULL; start=stop)
+   {
+      stop   = blFindNextResidue(start);
+      isAtom = !strncmp(start->record_type, "ATOM  ", 6);
+
+      /* A new chain starts if the label changes or we go from HETATM to
+         ATOM
+      */
+      newChain = (prevStart == NULL) ||
+                 !CHAINMATCH(start->chain, prevStart->chain) ||
+                 strncmp(prevStart->record_type, "ATOM  ", 6);
+
+      /* The previous residue was the end of a chain                    */
+      if((prevStart != NULL) &&
+         !strncmp(prevStart->record_type, "ATOM  ", 6) &&
+         (newChain || !isAtom))
+      {
+         int j;
+         for(p=prevStart, j=prevI; p!=start; NEXT(p), j++)
+         {
+            if((terminus[j] == TERM_NONE) ||
+               !strncmp(p->atnam, "OXT ", 4))
+               terminus[j] = TERM_C;
+         }
+      }
+
+      prevI = i;
+      for(p=start; p!=stop; NEXT(p), i++)
+         terminus[i] = (isAtom && newChain) ? TERM_N : TERM_NONE;
+
+      prevStart = start;
+   }
+
+   /* And the last residue in the file                                  */
+   if((prevStart != NULL) && !strncmp(prevStart->record_type, "ATOM  ", 6))
+   {
+      for(p=prevStart; p!=NULL; NEXT(p), prevI++)
+      {
+         if((terminus[prevI] == TERM_NONE) ||
+            !strncmp(p->atnam, "OXT ", 4))
+            terminus[prevI] = TERM_C;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>REAL GetCovalentRadius(PDB *p)
+   ------------------------------
+*//**
+   \param[in]   *p     PDB atom
+   \return             Covalent radius (0.0 for atoms that should never
+                       be bonded, i.e. metal ions)
+
+   Gets the covalent radius from the element, or from the atom name if
+   the element isn't given.
+
+-  19.10.26 Original   By: ACRM
+*/
+REAL GetCovalentRadius(PDB *p)
+{
+   static COVRAD covrad[] = {{"H",  0.31},
+                             {"C",  0.76},
+                             {"N",  0.71},
+                             {"O",  0.66},
+                             {"S",  1.05},
+                             {"P",  1.07},
+                             {"F",  0.57},
+                             {"CL", 1.02},
+                             {"BR", 1.20},
+                             {"I",  1.39},
+                             {"SE", 1.20},
+                             {NULL, 0.0}};
+   char element[8],
+        *chp;
+   int  i;
+
+   if(p->element[0] && (p->element[0] != ' '))
+   {
+      strcpy(element, p->element);
+   }
+   else if(!strncmp(p->record_type, "HETATM", 6) &&
+           !strncmp(p->resnam, p->atnam, 3))
+   {
+      /* An ion, where the atom and residue names are both the element  */
+      strncpy(element, p->atnam, 2);
+      element[2] = '\0';
+   }
+   else
+   {
+      /* Hydrogens may have a leading digit (e.g. 1HB)                  */
+      for(chp=p->atnam_raw; *chp && !isalpha((int)*chp); chp++);
+      element[0] = *chp;
+      element[1] = '\0';
+   }
+   for(chp=element; *chp==' '; chp++);
+   TERMAT(chp, ' ');
+   UPPER(chp);
+
+   for(i=0; covrad[i].element!=NULL; i++)
+   {
+      if(!strcmp(covrad[i].element, chp))
+         return(covrad[i].radius);
+   }
+   return(0.0);
+}
+
+
+/************************************************************************/
+/*>BOOL AssignBonds(TINKERXYZ *xyz, int natoms, REAL *radii, 
+                    int *residue)
+   ----------------------------------------------------------
+*//**
+   \param[in,out]  *xyz      Tinker XYZ linked list
+   \param[in]      natoms    Number of atoms
+   \param[in]      *radii    Covalent radius of each atom
+   \param[in]      *residue  Residue number of each atom (counted from
+                             the start of the file)
+   \return                   Success (FALSE if no memory)
+
+   Two atoms are bonded if they are within the sum of their covalent
+   radii plus BONDTOL. Only atoms in neighbouring cells of a grid
+   are compared. A hydrogen is only bonded to its nearest partner in
+   the same residue. Atoms in different residues are only bonded if
+   IsResidueLink() says they form a polymer link; other heavy atoms
+   that close are reported as a clash.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses BuildSortedCellGrid()   By: ACRM
+-  19.10.26 Added residue. Only bonds between residues for polymer 
+            links   By: ACRM
+-  19.10.26 Reports bonds that AddConnection() couldn't make   By: ACRM
+*/
+BOOL AssignBonds(TINKERXYZ *xyz, int natoms, REAL *radii, 
+                 int *residue)
+{
+   TINKERXYZ **idx   = NULL,
+             *t;
+   CELLGRID  *grid   = NULL;
+   REAL      *coor   = NULL,
+             *bestSq = NULL,
+             maxRad  = 0.0;
+   int       *best   = NULL,
+             nDropped = 0,
+             cells[MAXNEIGHBOURCELLS],
+             ncells,
+             i, j, k, l;
+   BOOL      ok      = FALSE;
+
+   if(((idx=(TINKERXYZ **)malloc(natoms*sizeof(TINKERXYZ *)))==NULL) ||
+      ((coor=(REAL *)malloc(3*natoms*sizeof(REAL)))==NULL)          ||
+      ((bestSq=(REAL *)malloc(natoms*sizeof(REAL)))==NULL)          ||
+      ((best=(int *)malloc(natoms*sizeof(int)))==NULL))
+      goto cleanup;
+
+   for(t=xyz, i=0; t!=NULL; NEXT(t), i++)
+   {
+      idx[i]      = t;
+      coor[3*i]   = t->x;
+      coor[3*i+1] = t->y;
+      coor[3*i+2] = t->z;
+      best[i]     = (-1);
+      if(radii[i] > maxRad)
+         maxRad = radii[i];
+   }
+
+   if((grid=BuildSortedCellGrid(coor, natoms, 2.0*maxRad + BONDTOL))
+      ==NULL)
+      goto cleanup;
+
+   for(i=0; i<natoms; i++)
+   {
+      if(radii[i] == 0.0)
+         continue;
+
+      ncells = GetNeighbourCells(grid,
+                                 GetCellIndex(grid, coor[3*i],
+                                              coor[3*i+1], coor[3*i+2]),
+                                 cells);
+      for(k=0; k<ncells; k++)
+      {
+         for(l=grid->head[cells[k]]; l!=(-1); l=grid->next[l])
+         {
+            REAL dx, dy, dz, dSq, cut;
+            BOOL iIsH, jIsH;
+
+            /* Each pair is only considered once                        */
+            j = grid->order[l];
+            if((j <= i) || (radii[j] == 0.0))
+               continue;
+
+            dx  = coor[3*i]   - grid->coor[3*l];
+            dy  = coor[3*i+1] - grid->coor[3*l+1];
+            dz  = coor[3*i+2] - grid->coor[3*l+2];
+            dSq = dx*dx + dy*dy + dz*dz;
+            cut = radii[i] + radii[j] + BONDTOL;
+
+            if((dSq > cut*cut) || (dSq < MINBONDSQ))
+               continue;
+
+            iIsH = (idx[i]->atnam[0] == 'H');
+            jIsH = (idx[j]->atnam[0] == 'H');
+
+            if(iIsH && jIsH)
+               continue;
+
+            if((residue[i] != residue[j]) &&
+               !IsResidueLink(idx[i], residue[i], idx[j], residue[j]))
+            {
+               if(!iIsH && !jIsH)
+                  fprintf(stderr,"Warning: Atoms %d and %d in different \
+residues are within bonding distance - not bonded\n", 
+                          idx[i]->atnum, idx[j]->atnum);
+               continue;
+            }
+
+            /* Hydrogens are bonded to their nearest heavy atom         */
+            if(iIsH || jIsH)
+            {
+               int h = iIsH ? i : j,
+                   x = iIsH ? j : i;
+               if((best[h] == (-1)) || (dSq < bestSq[h]))
+               {
+                  best[h]   = x;
+                  bestSq[h] = dSq;
+               }
+            }
+            else if(!AddConnection(idx[i], idx[j]))
+            {
+               nDropped++;
+            }
+         }
+      }
+   }
+
+   for(i=0; i<natoms; i++)
+   {
+      if((best[i] != (-1)) && !AddConnection(idx[i], idx[best[i]]))
+         nDropped++;
+   }
+   if(nDropped)
+      fprintf(stderr,"Warning: %d bonds were left out as atoms can have \
+at most %d\n", nDropped, MAXXYZCONNECT);
+   ok = TRUE;
+
+cleanup:
+   if(idx    != NULL) free(idx);
+   if(coor   != NULL) free(coor);
+   if(bestSq != NULL) free(bestSq);
+   if(best   != NULL) free(best);
+   FreeCellGrid(grid);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL IsResidueLink(TINKERXYZ *a, int resA, TINKERXYZ *b, int resB)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   *a      First atom
+   \param[in]   resA    Residue number of the first atom
+   \param[in]   *b      Second atom
+   \param[in]   resB    Residue number of the second atom
+   \return              Can these atoms be bonded between residues?
+
+   The links between residues are the peptide bond (C to the N of the
+   next residue), the nucleic acid backbone (O3' to the P of the next
+   residue) and disulphides (SG to SG in any residues)
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL IsResidueLink(TINKERXYZ *a, int resA, TINKERXYZ *b, int resB)
+{
+   /* Put the atoms in file order                                       */
+   if(resB < resA)
+   {
+      TINKERXYZ *t = a;
+      int       r  = resA;
+      a    = b;
+      b    = t;
+      resA = resB;
+      resB = r;
+   }
+
+   if(!strcmp(a->atnam, "SG") && !strcmp(b->atnam, "SG"))
+      return(TRUE);
+
+   if(resB != resA+1)
+      return(FALSE);
+
+   if(!strcmp(a->atnam, "C") && !strcmp(b->atnam, "N"))
+      return(TRUE);
+   if((!strcmp(a->atnam, "O3'") || !strcmp(a->atnam, "O3*")) &&
+      !strcmp(b->atnam, "P"))
+      return(TRUE);
+
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>BOOL AddConnection(TINKERXYZ *a, TINKERXYZ *b)
+   ----------------------------------------------
+*//**
+   \param[in,out]  *a    First atom
+   \param[in,out]  *b    Second atom
+   \return               Success (FALSE if too many connections)
+
+   Adds a bond to both atoms keeping the connection lists sorted.
+   Neither atom is changed if either is full.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Checks both atoms have room before adding the bond
+            By: ACRM
+*/
+BOOL AddConnection(TINKERXYZ *a, TINKERXYZ *b)
+{
+   TINKERXYZ *pair[2];
+   int       i, j, k;
+
+   pair[0] = a;
+   pair[1] = b;
+
+   /* Check both atoms have room first so a bond is never one-sided     */
+   for(k=0; k<2; k++)
+   {
+      if(pair[k]->connect[MAXXYZCONNECT-1])
+      {
+         fprintf(stderr,"Warning: Too many bonds to atom %d - bond to \
+atom %d not made\n", pair[k]->atnum, pair[1-k]->atnum);
+         return(FALSE);
+      }
+   }
+
+   for(k=0; k<2; k++)
+   {
+      TINKERXYZ *t     = pair[k];
+      int       partner = pair[1-k]->atnum;
+
+      for(i=0; (i<MAXXYZCONNECT) && t->connect[i]; i++);
+      for(j=i; (j>0) && (t->connect[j-1] > partner); j--)
+         t->connect[j] = t->connect[j-1];
+      t->connect[j] = partner;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void WriteTinkerSequence(FILE *fp, PDB *pdb)
+   --------------------------------------------
+*//**
+   \param[in]   *fp     Output file pointer
+   \param[in]   *pdb    PDB linked list
+
+   Writes a Tinker .seq file for the ATOM records, in the format used
+   by Tinker's prtseq: chain label, number of the first residue on the
+   line, then up to 15 residue names.
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteTinkerSequence(FILE *fp, PDB *pdb)
+{
+   PDB  *start,
+        *stop;
+   char lastChain[blMAXCHAINLABEL],
+        resnam[MAXLABEL];
+   int  nres = 0;
+
+   lastChain[0] = '\0';
+
+   for(start=pdb; start!=NULL; start=stop)
+   {
+      stop = blFindNextResidue(start);
+      if(strncmp(start->record_type, "ATOM  ", 6))
+         continue;
+
+      if(!CHAINMATCH(start->chain, lastChain))
+      {
+         if(nres % SEQPERLINE)
+            fprintf(fp, "\n");
+         strcpy(lastChain, start->chain);
+         nres = 0;
+      }
+
+      if(!(nres % SEQPERLINE))
+         fprintf(fp, " %c%6d ", start->chain[0], nres+1);
+
+      strcpy(resnam, start->resnam);
+      resnam[3] = '\0';
+      fprintf(fp, " %-3s", resnam);
+
+      if(!(++nres % SEQPERLINE))
+         fprintf(fp, "\n");
+   }
+   if(nres % SEQPERLINE)
+      fprintf(fp, "\n");
+}
@@ -0,0 +1,239 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       perfcount.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Hardware performance counters via perf_event_open()
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Counts CPU cycles, instructions, cache misses and branch misses for
+   this process (user space only). The counters are inherited, so
+   threads started after PerfCountersOpen() are included in the counts.
+   perf_event_open() is Linux-specific and may be refused (e.g. by
+   /proc/sys/kernel/perf_event_paranoid or inside a container);
+   counters that can't be opened are simply reported as unavailable
+   and read as -1. On other systems nothing is available.
+
+      if(PerfCountersOpen())
+      {
+         PerfCountersStart();
+         ...
+         PerfCountersStop(values);
+         PerfCountersClose();
+      }
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added branch misses. Counts are scaled if the kernel
+                    had to multiplex the counters   By: ACRM
+   V1.2   19.10.26  Counters are inherited by new threads so the -t
+                    worker threads are counted   By: ACRM
+
+*************************************************************************/
+/* syscall() is not ANSI                                                */
+#define _GNU_SOURCE
+
+/* Includes
+*/
+#include <stdio.h>
+#include <string.h>
+#include "perfcount.h"
+
+#ifdef __linux__
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+#endif
+
+/************************************************************************/
+/* Globals
+*/
+static int sFd[MAXPERFCOUNTERS] = {-1, -1, -1, -1};
+
+
+/************************************************************************/
+/*>BOOL PerfCountersOpen(void)
+   ---------------------------
+*//**
+   \return   Could any counters be opened?
+
+   Opens the counters. They are not counting until PerfCountersStart()
+   is called. Call this before starting any threads that should be
+   counted.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Set inherit so that new threads are counted   By: ACRM
+*/
+BOOL PerfCountersOpen(void)
+{
+   BOOL ok = FALSE;
+#ifdef __linux__
+   static unsigned long long config[MAXPERFCOUNTERS] =
+      {PERF_COUNT_HW_CPU_CYCLES,
+       PERF_COUNT_HW_INSTRUCTIONS,
+       PERF_COUNT_HW_CACHE_MISSES,
+       PERF_COUNT_HW_BRANCH_MISSES};
+   struct perf_event_attr attr;
+   int i;
+
+   for(i=0; i<MAXPERFCOUNTERS; i++)
+   {
+      memset(&attr, 0, sizeof(attr));
+      attr.type           = PERF_TYPE_HARDWARE;
+      attr.size           = sizeof(attr);
+      attr.config         = config[i];
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.inherit        = 1;
+      attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      sFd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+      if(sFd[i] >= 0)
+         ok = TRUE;
+   }
+#endif
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL PerfCountersAvailable(int counter)
+   ---------------------------------------
+*//**
+   \param[in]   counter   PERF_CYCLES, PERF_INSTRUCTIONS,
+                          PERF_CACHE_MISSES or PERF_BRANCH_MISSES
+   \return                Was the counter opened?
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL PerfCountersAvailable(int counter)
+{
+   return((counter >= 0) && (counter < MAXPERFCOUNTERS) &&
+          (sFd[counter] >= 0));
+}
+
+
+/************************************************************************/
+/*>void PerfCountersStart(void)
+   ----------------------------
+*//**
+   Zeros the counters and starts counting
+
+-  19.10.26 Original   By: ACRM
+*/
+void PerfCountersStart(void)
+{
+#ifdef __linux__
+   int i;
+
+   for(i=0; i<MAXPERFCOUNTERS; i++)
+   {
+      if(sFd[i] >= 0)
+      {
+         ioctl(sFd[i], PERF_EVENT_IOC_RESET,  0);
+         ioctl(sFd[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+   }
+#endif
+}
+
+
+/************************************************************************/
+/*>void PerfCountersStop(long *values)
+   -----------------------------------
+*//**
+   \param[out]  *values   MAXPERFCOUNTERS counts since
+                          PerfCountersStart() (-1 if unavailable)
+
+   Stops counting and reads the counters. If there were more counters
+   than the hardware could count at once, the kernel will have shared
+   them out and the counts are scaled up by the fraction of time each
+   was actually counting.
+
+-  19.10.26 Original   By: ACRM
+*/
+void PerfCountersStop(long *values)
+{
+   int i;
+
+   for(i=0; i<MAXPERFCOUNTERS; i++)
+   {
+      values[i] = (-1);
+#ifdef __linux__
+      if(sFd[i] >= 0)
+      {
+         unsigned long long data[3];   /* Count, enabled, running     */
+
+         ioctl(sFd[i], PERF_EVENT_IOC_DISABLE, 0);
+         if(read(sFd[i], data, sizeof(data)) == sizeof(data))
+         {
+            if(data[2] == data[1])
+               values[i] = (long)data[0];
+            else if(data[2] != 0)
+               values[i] = (long)((double)data[0] *
+                                  (double)data[1] / (double)data[2]);
+            /* Otherwise it never got a turn and stays unavailable      */
+         }
+      }
+#endif
+   }
+}
+
+
+/************************************************************************/
+/*>void PerfCountersClose(void)
+   ----------------------------
+*//**
+   Closes the counters
+
+-  19.10.26 Original   By: ACRM
+*/
+void PerfCountersClose(void)
+{
+   int i;
+
+   for(i=0; i<MAXPERFCOUNTERS; i++)
+   {
+#ifdef __linux__
+      if(sFd[i] >= 0)
+         close(sFd[i]);
+#endif
+      sFd[i] = (-1);
+   }
+}
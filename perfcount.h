@@ -0,0 +1,71 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       perfcount.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Hardware performance counters via perf_event_open()
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added branch misses   By: ACRM
+
+*************************************************************************/
+#ifndef _PERFCOUNT_H
+#define _PERFCOUNT_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+/* Indexes into the array of counter values                             */
+#define PERF_CYCLES          0
+#define PERF_INSTRUCTIONS    1
+#define PERF_CACHE_MISSES    2
+#define PERF_BRANCH_MISSES   3
+#define MAXPERFCOUNTERS      4
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL PerfCountersOpen(void);
+BOOL PerfCountersAvailable(int counter);
+void PerfCountersStart(void);
+void PerfCountersStop(long *values);
+void PerfCountersClose(void);
+
+#endif
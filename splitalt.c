@@ -0,0 +1,376 @@
+/*************************************************************************
+
+   Program:    splitalt
+   File:       splitalt.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Split a PDB file with alternate locations into one file
+               per conformer
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Tinker can't handle alternate locations, so each conformer has to
+   be run through the pipeline on its own. This program finds all the
+   alternate location labels in a PDB file and writes one file for each
+   (stem_A.pdb, stem_B.pdb, ...) containing the atoms with no alternate
+   location plus those for that label. The alternate location labels
+   are blanked in the output files.
+
+   Where a residue doesn't have a given label (e.g. only some residues
+   have a conformer C) the first label that residue does have is used.
+
+   The labels are listed on standard output, one per line, so that a
+   script can run the conformers and merge them back together with
+   tinkerpatch -a. If there are no alternate locations then nothing is
+   written.
+
+**************************************************************************
+
+   Usage:
+   ======
+   splitalt in.pdb stem
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define MAXALTLABELS    62    /* A-Z, a-z, 0-9                          */
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *stem);
+void Usage(void);
+int  FindAltLabels(PDB *pdb, char *labels);
+BOOL WriteConformer(FILE *out, PDB *pdb, char label);
+char ResidueAltLabel(PDB *start, PDB *stop, char label);
+BOOL KeepAtom(PDB *start, PDB *stop, PDB *p, char label);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*/
+int main(int argc, char **argv)
+{
+   char infile[MAXBUFF],
+        stem[MAXBUFF],
+        outfile[MAXBUFF+8],
+        labels[MAXALTLABELS+1];
+   FILE *in  = NULL,
+        *out = NULL;
+   PDB  *pdb = NULL;
+   int  natoms, nlabels, i;
+
+   if(ParseCmdLine(argc, argv, infile, stem))
+   {
+      if((in=fopen(infile, "r"))==NULL)
+      {
+         fprintf(stderr,"Error: Unable to open PDB file: %s\n", infile);
+         return(1);
+      }
+
+      if((pdb=blReadPDBAll(in, &natoms))==NULL)
+      {
+         fprintf(stderr,"Error: No atoms read from PDB file\n");
+         return(1);
+      }
+      fclose(in);
+
+      if((nlabels=FindAltLabels(pdb, labels)) < 0)
+      {
+         fprintf(stderr,"Error: More than %d alternate location \
+labels\n", MAXALTLABELS);
+         return(1);
+      }
+
+      for(i=0; i<nlabels; i++)
+      {
+         sprintf(outfile, "%s_%c.pdb", stem, labels[i]);
+         if((out=fopen(outfile, "w"))==NULL)
+         {
+            fprintf(stderr,"Error: Unable to write %s\n", outfile);
+            return(1);
+         }
+         WriteConformer(out, pdb, labels[i]);
+         fclose(out);
+         printf("%c\n", labels[i]);
+      }
+   }
+   else
+   {
+      Usage();
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>int FindAltLabels(PDB *pdb, char *labels)
+   -----------------------------------------
+*//**
+   \param[in]   *pdb      PDB linked list
+   \param[out]  *labels   Alternate location labels in the order first
+                          seen
+   \return                Number of labels (-1 if too many)
+
+   Finds the alternate location labels used in a structure
+
+-  19.10.26 Original   By: ACRM
+*/
+int FindAltLabels(PDB *pdb, char *labels)
+{
+   PDB *p;
+   int nlabels = 0;
+
+   labels[0] = '\0';
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((p->altpos != ' ') && (p->altpos != '\0') &&
+         (strchr(labels, p->altpos) == NULL))
+      {
+         if(nlabels >= MAXALTLABELS)
+            return(-1);
+         labels[nlabels++] = p->altpos;
+         labels[nlabels]   = '\0';
+      }
+   }
+   return(nlabels);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteConformer(FILE *out, PDB *pdb, char label)
+   ----------------------------------------------------
+*//**
+   \param[in]   *out    Output file pointer
+   \param[in]   *pdb    PDB linked list with alternate locations
+   \param[in]   label   Conformer to write
+   \return              Were any atoms written?
+
+   Writes the atoms for one conformer with the alternate location labels
+   blanked
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WriteConformer(FILE *out, PDB *pdb, char label)
+{
+   PDB  *start,
+        *stop,
+        *p;
+   char resLabel,
+        altpos;
+   int  atnum = 0;
+
+   for(start=pdb; start!=NULL; start=stop)
+   {
+      stop     = blFindNextResidue(start);
+      resLabel = ResidueAltLabel(start, stop, label);
+
+      for(p=start; p!=stop; NEXT(p))
+      {
+         if(KeepAtom(start, stop, p, resLabel))
+         {
+            altpos    = p->altpos;
+            p->altpos = ' ';
+            p->atnum  = ++atnum;
+            blWritePDBRecord(out, p);
+            p->altpos = altpos;
+         }
+      }
+   }
+   fprintf(out, "END   \n");
+
+   return(atnum != 0);
+}
+
+
+/************************************************************************/
+/*>char ResidueAltLabel(PDB *start, PDB *stop, char label)
+   -------------------------------------------------------
+*//**
+   \param[in]   *start   Start of residue
+   \param[in]   *stop    Start of next residue
+   \param[in]   label    Requested alternate location
+   \return               The label to use for this residue
+
+   Returns label if any atom in the residue has it, otherwise the first
+   alternate location label in the residue (or a blank if there is none)
+
+-  19.10.26 Original   By: ACRM
+*/
+char ResidueAltLabel(PDB *start, PDB *stop, char label)
+{
+   PDB  *p;
+   char first = ' ';
+
+   for(p=start; p!=stop; NEXT(p))
+   {
+      if(p->altpos == label)
+         return(label);
+      if((first == ' ') && (p->altpos != '\0'))
+         first = p->altpos;
+   }
+   return(first);
+}
+
+
+/************************************************************************/
+/*>BOOL KeepAtom(PDB *start, PDB *stop, PDB *p, char label)
+   --------------------------------------------------------
+*//**
+   \param[in]   *start   Start of residue
+   \param[in]   *stop    Start of next residue
+   \param[in]   *p       Atom to test
+   \param[in]   label    Alternate location for this residue
+   \return               Should the atom be written?
+
+   An atom is kept if it has no alternate location or has the requested
+   one. If an atom name doesn't have the requested label at all, the
+   first alternate position for that name is kept instead.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL KeepAtom(PDB *start, PDB *stop, PDB *p, char label)
+{
+   PDB *q;
+
+   if((p->altpos == ' ') || (p->altpos == '\0') || (p->altpos == label))
+      return(TRUE);
+
+   for(q=start; q!=stop; NEXT(q))
+   {
+      if(!strcmp(q->atnam, p->atnam))
+      {
+         if(q->altpos == label)
+            return(FALSE);
+      }
+   }
+
+   /* No atom of this name has the label so keep the first one          */
+   for(q=start; q!=p; NEXT(q))
+   {
+      if(!strcmp(q->atnam, p->atnam))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*/
+void Usage(void)
+{
+   fprintf(stderr,"Usage: splitalt in.pdb stem\n");
+   fprintf(stderr,"Writes stem_A.pdb, stem_B.pdb, ... for each alternate \
+location label\n");
+   fprintf(stderr,"and lists the labels on standard output.\n");
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *stem)
+   ------------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  char   *infile       Input file
+            char   *stem         Stem for output files
+   Returns: BOOL                 Success?
+
+   Parse the command line
+
+   19.10.26  Original   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *stem)
+{
+   argc--;
+   argv++;
+
+   infile[0] = stem[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+         {
+           return(FALSE);
+         }
+         else
+         {
+            switch(argv[0][1])
+            {
+            case 'h':
+               return(FALSE);
+               break;
+            default:
+               return(FALSE);
+               break;
+            }
+         }
+      }
+      else
+      {
+         /* Check that there are exactly 2 arguments left               */
+         if(argc != 2)
+            return(FALSE);
+
+         strcpy(infile, argv[0]);
+         strcpy(stem,   argv[1]);
+
+         return(TRUE);
+      }
+
+      argc--;
+      argv++;
+   }
+   return(FALSE);
+}
@@ -0,0 +1,477 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       stats.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Timing, memory and count statistics for the programs
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Nothing is recorded unless StatsInit() has been called, so the calls
+   can be left in the code at no real cost. Typical use:
+
+      StatsInit("tinkerpdb", "stats.json");
+      StatsPhaseStart("ReadTinkerAtomTypes");
+      ...
+      StatsPhaseEnd();
+      StatsAddCount("atoms", natoms);
+      StatsReport();
+
+   Phases are accumulated by name so a phase may be entered more than
+   once; they do not nest. The report is written as JSON to the file
+   given to StatsInit() or to stderr if that is "-". It contains the
+   total and per-phase wall and CPU times, the counts and the peak
+   resident set size.
+
+   If StatsUsePerfCounters() is called after StatsInit() then each
+   phase also records cycles, instructions, cache misses and branch
+   misses, summed over all the threads of the process. Counters that
+   the system won't give us are written as null.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Optional hardware performance counters per phase
+                    By: ACRM
+   V1.2   19.10.26  Added StatsSetup() and StatsUsage() for the -S and -P
+                    options shared by the programs   By: ACRM
+
+*************************************************************************/
+/* gettimeofday() and getrusage() are not ANSI                          */
+#define _XOPEN_SOURCE 500
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "perfcount.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSTATFILE    240
+
+typedef struct
+{
+   char   name[MAXSTATNAME];
+   double wall,
+          cpu;
+   long   perf[MAXPERFCOUNTERS];
+   int    calls;
+}  STATPHASE;
+
+typedef struct
+{
+   char   name[MAXSTATNAME];
+   long   value;
+}  STATCOUNT;
+
+/************************************************************************/
+/* Globals
+*/
+static BOOL      sEnabled  = FALSE,
+                 sPerf     = FALSE;
+static char      sProgram[MAXSTATNAME],
+                 sFile[MAXSTATFILE];
+static STATPHASE sPhase[MAXSTATPHASES];
+static STATCOUNT sCount[MAXSTATCOUNTS];
+static int       sNPhases  = 0,
+                 sNCounts  = 0,
+                 sCurrent  = (-1);
+static double    sStartWall,
+                 sStartCPU,
+                 sPhaseWall,
+                 sPhaseCPU;
+
+/************************************************************************/
+/* Prototypes
+*/
+static double WallTime(void);
+static double CPUTime(void);
+static long   PeakRSS(void);
+
+
+/************************************************************************/
+/*>BOOL StatsInit(char *program, char *filename)
+   ---------------------------------------------
+*//**
+   \param[in]   *program    Program name for the report
+   \param[in]   *filename   File for the report ("-" for stderr)
+   \return                  Success
+
+   Switches on statistics collection
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL StatsInit(char *program, char *filename)
+{
+   if((filename == NULL) || (filename[0] == '\0') ||
+      (strlen(filename) >= MAXSTATFILE))
+      return(FALSE);
+
+   strncpy(sProgram, program, MAXSTATNAME-1);
+   sProgram[MAXSTATNAME-1] = '\0';
+   strcpy(sFile, filename);
+
+   sNPhases   = sNCounts = 0;
+   sCurrent   = (-1);
+   sPerf      = FALSE;
+   sStartWall = WallTime();
+   sStartCPU  = CPUTime();
+   sEnabled   = TRUE;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL StatsEnabled(void)
+   -----------------------
+*//**
+   \return   Is statistics collection switched on?
+
+   Used to skip work (such as counting residues) that is only needed
+   for the report
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL StatsEnabled(void)
+{
+   return(sEnabled);
+}
+
+
+/************************************************************************/
+/*>BOOL StatsUsePerfCounters(void)
+   -------------------------------
+*//**
+   \return   Are any performance counters available?
+
+   Switches on the hardware performance counters for each phase. If
+   none can be opened the report just says so.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL StatsUsePerfCounters(void)
+{
+   if(!sEnabled)
+      return(FALSE);
+
+   sPerf = PerfCountersOpen();
+   return(sPerf);
+}
+
+
+/************************************************************************/
+/*>BOOL StatsSetup(char *program, char *statsFile, BOOL perfCounters)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   *program       Program name for the report
+   \param[in]   *statsFile     File from -S (or blank string)
+   \param[in]   perfCounters   -P was given
+   \return                     FALSE if the statistics file is invalid
+
+   Handles the -S and -P options in the same way for all the programs.
+   -P on its own reports to stderr. Not having the performance counters
+   is just a warning.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL StatsSetup(char *program, char *statsFile, BOOL perfCounters)
+{
+   if(perfCounters && !statsFile[0])
+      statsFile = "-";
+   
+   if(statsFile[0] && !StatsInit(program, statsFile))
+   {
+      fprintf(stderr,"Error: Invalid statistics file: %s\n", statsFile);
+      return(FALSE);
+   }
+   
+   if(perfCounters && !StatsUsePerfCounters())
+      fprintf(stderr,"Warning: Hardware performance counters are not \
+available\n");
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void StatsUsage(void)
+   ---------------------
+*//**
+   Prints the usage lines for -S and -P
+
+-  19.10.26 Original   By: ACRM
+*/
+void StatsUsage(void)
+{
+   fprintf(stderr,"       -S  Write timing statistics as JSON to file \
+(- for stderr)\n");
+   fprintf(stderr,"       -P  Add hardware performance counters to the \
+statistics\n");
+}
+
+
+/************************************************************************/
+/*>void StatsPhaseStart(char *phase)
+   ---------------------------------
+*//**
+   \param[in]   *phase   Name of the phase
+
+   Starts timing a phase. Any phase already being timed is ended.
+
+-  19.10.26 Original   By: ACRM
+*/
+void StatsPhaseStart(char *phase)
+{
+   int i, j;
+
+   if(!sEnabled)
+      return;
+
+   if(sCurrent >= 0)
+      StatsPhaseEnd();
+
+   for(i=0; i<sNPhases; i++)
+   {
+      if(!strncmp(sPhase[i].name, phase, MAXSTATNAME-1))
+         break;
+   }
+
+   if(i == sNPhases)
+   {
+      if(sNPhases >= MAXSTATPHASES)
+         return;
+      strncpy(sPhase[i].name, phase, MAXSTATNAME-1);
+      sPhase[i].name[MAXSTATNAME-1] = '\0';
+      sPhase[i].wall  = sPhase[i].cpu = 0.0;
+      sPhase[i].calls = 0;
+      for(j=0; j<MAXPERFCOUNTERS; j++)
+         sPhase[i].perf[j] = 0;
+      sNPhases++;
+   }
+
+   sCurrent   = i;
+   sPhaseWall = WallTime();
+   sPhaseCPU  = CPUTime();
+   if(sPerf)
+      PerfCountersStart();
+}
+
+
+/************************************************************************/
+/*>void StatsPhaseEnd(void)
+   ------------------------
+*//**
+   Stops timing the current phase
+
+-  19.10.26 Original   By: ACRM
+*/
+void StatsPhaseEnd(void)
+{
+   long values[MAXPERFCOUNTERS];
+   int  i;
+
+   if(!sEnabled || (sCurrent < 0))
+      return;
+
+   if(sPerf)
+   {
+      PerfCountersStop(values);
+      for(i=0; i<MAXPERFCOUNTERS; i++)
+      {
+         if(values[i] < 0)
+            sPhase[sCurrent].perf[i] = (-1);
+         else if(sPhase[sCurrent].perf[i] >= 0)
+            sPhase[sCurrent].perf[i] += values[i];
+      }
+   }
+
+   sPhase[sCurrent].wall += WallTime() - sPhaseWall;
+   sPhase[sCurrent].cpu  += CPUTime()  - sPhaseCPU;
+   sPhase[sCurrent].calls++;
+   sCurrent = (-1);
+}
+
+
+/************************************************************************/
+/*>void StatsAddCount(char *name, long value)
+   ------------------------------------------
+*//**
+   \param[in]   *name    Name of the count
+   \param[in]   value    Value to add
+
+   Adds to a named count, creating it if needed
+
+-  19.10.26 Original   By: ACRM
+*/
+void StatsAddCount(char *name, long value)
+{
+   int i;
+
+   if(!sEnabled)
+      return;
+
+   for(i=0; i<sNCounts; i++)
+   {
+      if(!strncmp(sCount[i].name, name, MAXSTATNAME-1))
+      {
+         sCount[i].value += value;
+         return;
+      }
+   }
+
+   if(sNCounts < MAXSTATCOUNTS)
+   {
+      strncpy(sCount[sNCounts].name, name, MAXSTATNAME-1);
+      sCount[sNCounts].name[MAXSTATNAME-1] = '\0';
+      sCount[sNCounts].value = value;
+      sNCounts++;
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL StatsReport(void)
+   ----------------------
+*//**
+   \return   Success (TRUE if statistics are not switched on)
+
+   Writes the JSON report
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL StatsReport(void)
+{
+   static char *perfName[MAXPERFCOUNTERS] =
+      {"cycles", "instructions", "cache_misses", "branch_misses"};
+   FILE *fp;
+   int  i, j;
+
+   if(!sEnabled)
+      return(TRUE);
+
+   StatsPhaseEnd();
+
+   if(!strcmp(sFile, "-"))
+   {
+      fp = stderr;
+   }
+   else if((fp=fopen(sFile, "w"))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to write statistics file: %s\n",
+              sFile);
+      return(FALSE);
+   }
+
+   fprintf(fp, "{\n");
+   fprintf(fp, "  \"program\": \"%s\",\n", sProgram);
+   fprintf(fp, "  \"wall_time\": %.6f,\n", WallTime() - sStartWall);
+   fprintf(fp, "  \"cpu_time\": %.6f,\n",  CPUTime()  - sStartCPU);
+   fprintf(fp, "  \"peak_rss_kb\": %ld,\n", PeakRSS());
+   fprintf(fp, "  \"perf_counters\": %s,\n", (sPerf?"true":"false"));
+
+   fprintf(fp, "  \"phases\": [");
+   for(i=0; i<sNPhases; i++)
+   {
+      fprintf(fp, "%s\n    {\"name\": \"%s\", \"wall_time\": %.6f, \
+\"cpu_time\": %.6f, \"calls\": %d",
+              (i?",":""), sPhase[i].name, sPhase[i].wall, sPhase[i].cpu,
+              sPhase[i].calls);
+      if(sPerf)
+      {
+         for(j=0; j<MAXPERFCOUNTERS; j++)
+         {
+            if(sPhase[i].perf[j] < 0)
+               fprintf(fp, ", \"%s\": null", perfName[j]);
+            else
+               fprintf(fp, ", \"%s\": %ld", perfName[j],
+                       sPhase[i].perf[j]);
+         }
+      }
+      fprintf(fp, "}");
+   }
+   fprintf(fp, "%s],\n", (sNPhases?"\n  ":""));
+
+   fprintf(fp, "  \"counts\": {");
+   for(i=0; i<sNCounts; i++)
+   {
+      fprintf(fp, "%s\n    \"%s\": %ld", (i?",":""), sCount[i].name,
+              sCount[i].value);
+   }
+   fprintf(fp, "%s}\n", (sNCounts?"\n  ":""));
+   fprintf(fp, "}\n");
+
+   if(fp != stderr)
+      fclose(fp);
+
+   if(sPerf)
+      PerfCountersClose();
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+static double WallTime(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return((double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6);
+}
+
+
+/************************************************************************/
+static double CPUTime(void)
+{
+   struct rusage ru;
+   getrusage(RUSAGE_SELF, &ru);
+   return((double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec*1.0e-6 +
+          (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec*1.0e-6);
+}
+
+
+/************************************************************************/
+/* ru_maxrss is in kilobytes on Linux                                   */
+static long PeakRSS(void)
+{
+   struct rusage ru;
+   getrusage(RUSAGE_SELF, &ru);
+   return((long)ru.ru_maxrss);
+}
@@ -0,0 +1,73 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       stats.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Timing, memory and count statistics for the programs
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added StatsUsePerfCounters()   By: ACRM
+   V1.2   19.10.26  Added StatsSetup() and StatsUsage()   By: ACRM
+
+*************************************************************************/
+#ifndef _STATS_H
+#define _STATS_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSTATNAME     32
+#define MAXSTATPHASES   32
+#define MAXSTATCOUNTS   16
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL StatsInit(char *program, char *filename);
+BOOL StatsEnabled(void);
+BOOL StatsUsePerfCounters(void);
+BOOL StatsSetup(char *program, char *statsFile, BOOL perfCounters);
+void StatsUsage(void);
+void StatsPhaseStart(char *phase);
+void StatsPhaseEnd(void);
+void StatsAddCount(char *name, long value);
+BOOL StatsReport(void);
+
+#endif
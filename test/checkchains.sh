@@ -0,0 +1,81 @@
+#!/bin/sh
+# Checks the chains that tinkerpdb finds from the Tinker bonds.
+#
+# Usage: checkchains.sh [-p paramfile] [file ...]
+#        -p  Tinker parameter file (default ../../params/amber99.prm)
+#
+# A PDB file is round tripped through pdbtinker and tinkerpdb. A Tinker
+# XYZ file is converted with tinkerpdb and checked against name.chains.
+# Tinker has no chains, so tinkerpdb labels them afresh; the chains are
+# compared by giving each residue the number of its chain in order of
+# appearance. The script fails if any residue comes back in a different
+# chain. disulphide.xyz has a disulphide bond between its two chains.
+
+bindir=..
+paramfile=../../params/amber99.prm
+workdir=${CHECK_WORKDIR:-/tmp/tinkercheck.$$}
+
+while [ $# -gt 0 ]; do
+    case $1 in
+    -p) paramfile=$2; shift 2;;
+    -*) echo "Usage: checkchains.sh [-p paramfile] [file ...]" >&2
+        exit 1;;
+    *)  break;;
+    esac
+done
+
+files=${*:-"test.pdb 1yqv.pdb 6fab0.pdb disulphide.xyz"}
+mkdir -p $workdir
+
+# Lists the residue name and chain number of each residue in the ATOM
+# records of a PDB file
+chainmap()
+{
+    awk '/^ATOM  /{
+        res = substr($0,18,10)
+        if(res != last)
+        {
+            chain = substr($0,22,1)
+            if(!(chain in number)) number[chain] = ++nchains
+            print substr($0,18,3), number[chain]
+            last = res
+        }
+    }' $1
+}
+
+status=0
+for file in $files; do
+    ok=true
+    case $file in
+    *.xyz) name=`basename $file .xyz`
+           expected=`dirname $file`/$name.chains
+           xyz=$file;;
+    *)     name=`basename $file .pdb`
+           chainmap $file > $workdir/$name.chains
+           expected=$workdir/$name.chains
+           xyz=$workdir/$name.xyz
+           $bindir/pdbtinker $paramfile $file $xyz 2> $workdir/$name.log ||
+               ok=false;;
+    esac
+    if $ok && $bindir/tinkerpdb $paramfile $xyz $workdir/$name.pdb \
+           2>> $workdir/$name.log; then
+        chainmap $workdir/$name.pdb > $workdir/$name.found
+        if diff $expected $workdir/$name.found > $workdir/$name.diff; then
+            echo "$name: `tail -1 $workdir/$name.found | cut -d' ' -f2` \
+chains"
+        else
+            echo "FAIL: $name has residues in the wrong chain (see \
+$workdir/$name.diff)"
+            status=1
+            continue
+        fi
+    else
+        echo "FAIL: $name could not be converted (see $workdir/$name.log)"
+        status=1
+        continue
+    fi
+    rm -f $workdir/$name.*
+done
+
+[ $status -eq 0 ] && rm -rf $workdir
+exit $status
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Runs fixoverlap on the overlap test structures and checks the result
+# against the expected output.
+#
+# Usage: checkoverlaps.sh [xyzfile ...]
+#
+# Each name.xyz is compared with name_fixed.xyz. cascade.xyz has atoms
+# that only overlap once an earlier overlap has been fixed and
+# cascadebox.xyz does the same across the edges of a periodic box,
+# given without its angles as Tinker writes a rectangular box.
+
+bindir=..
+workdir=${CHECK_WORKDIR:-/tmp/tinkercheck.$$}
+
+while [ $# -gt 0 ]; do
+    case $1 in
+    -*) echo "Usage: checkoverlaps.sh [xyzfile ...]" >&2
+        exit 1;;
+    *)  break;;
+    esac
+done
+
+files=${*:-"cascade.xyz cascadebox.xyz"}
+mkdir -p $workdir
+
+status=0
+for xyz in $files; do
+    name=`basename $xyz .xyz`
+    if $bindir/fixoverlap $xyz $workdir/$name.xyz 2> $workdir/$name.log
+    then
+        if cmp -s `dirname $xyz`/${name}_fixed.xyz $workdir/$name.xyz; then
+            echo "$name: `grep -c Fixing $workdir/$name.log` fixes"
+        else
+            echo "FAIL: $name does not match ${name}_fixed.xyz"
+            status=1
+            continue
+        fi
+    else
+        echo "FAIL: $name could not be fixed (see $workdir/$name.log)"
+        status=1
+        continue
+    fi
+    rm -f $workdir/$name.xyz $workdir/$name.log
+done
+
+[ $status -eq 0 ] && rm -rf $workdir
+exit $status
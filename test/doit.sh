@@ -1,4 +1,7 @@
 file=$1
+# Give "fast" as a second argument to relax the hydrogens in-process
+# rather than running Tinker minimize
+mode=$2
 
 params=amber99
 
@@ -8,34 +11,78 @@ paramdir=$tinkerdir/params
 paramfile=$paramdir/$params
 pdbhstrip=pdbhstrip
 tinkerpatch=./tinkerpatch
+pdbtinker=./pdbtinker
+tinkerkey=./tinkerkey
+tinkerpdb=./tinkerpdb
+splitalt=./splitalt
 
 basefile=`basename $file .pdb`
 basefile=`basename $basefile .ent`
-\rm -f $basefile.xyz* $basefile.pdb_* $basefile.seq* foo.*
 seqfile=$basefile.seq
 xyzfile=$basefile.xyz
 xyz2file=${xyzfile}_2
+keyfile=$basefile.key
 resultfile=${basefile}_result.pdb
+# Temporary files are named from the input so that conformers can be
+# run at the same time
+tmpfile=${basefile}_tmp
+\rm -f $basefile.xyz* $basefile.pdb_* $basefile.seq* $keyfile $tmpfile.*
 
 
 pdbxyz=$bindir/pdbxyz
 minimize=$bindir/minimize
 xyzpdb=$bindir/xyzpdb
 
+# Structures with alternate locations are split into one file per
+# conformer. These are run in parallel through this script and merged
+# back together with their labels and occupancies restored
+labels=`$splitalt $file $basefile`
+if [ "X$labels" != "X" ]; then
+    merge=""
+    for label in $labels; do
+        sh $0 ${basefile}_$label.pdb $mode &
+        merge="$merge,$label=${basefile}_${label}_result.pdb"
+    done
+    wait
+    merge=`echo $merge | sed 's/^,//'`
+    $tinkerpatch -a $merge $file $resultfile
+    for label in $labels; do
+        rm -f ${basefile}_$label.pdb ${basefile}_${label}_result.pdb
+    done
+    exit 0
+fi
+
 # Convert to xyz
-### We need to check for alternate occupancies first ###
-$pdbxyz $file ALL ALL $paramfile
+# pdbtinker avoids running pdbxyz but does not build hydrogens, so only
+# use it if the file already has them
+if awk '/^(ATOM  |HETATM)/ { n=substr($0,13,4); gsub(/[ 0-9]/,"",n);
+                              if(n ~ /^H/) { found=1; exit } }
+        END { exit !found }' $file; then
+    $pdbtinker $paramfile.prm $file $xyzfile
+else
+    $pdbxyz $file ALL ALL $paramfile
+fi
+
+if [ "X$mode" = "Xfast" ]; then
+    # Relax the hydrogens while converting back to PDB
+    $tinkerpdb -r $paramfile.prm $xyzfile $tmpfile.pdb
+    $tinkerpatch $file $tmpfile.pdb | $pdbhstrip > $resultfile
+    rm -f $tmpfile.pdb $xyzfile $seqfile
+    exit 0
+fi
 
-# Cartesian minimization
-$minimize $xyzfile $paramfile 2
+# Cartesian minimization of the hydrogens only - the key file makes
+# the heavy atoms inactive and names the parameter file
+$tinkerkey -p $paramfile $xyzfile $keyfile
+$minimize $xyzfile -k $keyfile 2
 
 # Convert results to pdb
-cp $xyz2file foo.xyz
-cp $seqfile  foo.seq
-$xyzpdb foo.xyz $paramfile
-$tinkerpatch $file foo.pdb | $pdbhstrip > $resultfile
-rm -f foo.xyz foo.seq foo.pdb
+cp $xyz2file $tmpfile.xyz
+cp $seqfile  $tmpfile.seq
+$xyzpdb $tmpfile.xyz $paramfile
+$tinkerpatch $file $tmpfile.pdb | $pdbhstrip > $resultfile
+rm -f $tmpfile.xyz $tmpfile.seq $tmpfile.pdb
 
 # Remove intermediate files
-rm $xyzfile $xyz2file $seqfile
+rm $xyzfile $xyz2file $seqfile $keyfile
 
@@ -0,0 +1,1260 @@
+/*************************************************************************
+
+   Program:    tinkerd
+   File:       tinkerd.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Resident server for tinkerpdb, tinkerpatch and fixoverlap
+               requests
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   When many small structures are converted, most of the time taken by
+   each tinkerpdb run goes on starting the program and reading the
+   Tinker parameter file. tinkerd stays resident, listening on a Unix
+   domain socket, and keeps the atom types from each parameter file
+   once it has been read (or preloaded with -p).
+
+   Connections are handed to a pool of worker threads. Each connection
+   may send any number of requests, one per line, and gets a one-line
+   reply to each: 'OK' or 'ERROR' followed by a message. Details of
+   any error are written to tinkerd's standard error. The requests
+   take the same options and files as the programs:
+
+      tinkerpdb [-c chain[,chain...]] [-r] [-C] [-k|-K] paramfile 
+                in.xyz out.pdb
+      tinkerpatch [-C] orig.pdb tinker.pdb out.pdb
+      fixoverlap [-r] in.xyz out.xyz
+      ping
+
+   Files are named by path (which should be absolute since tinkerd's
+   working directory may differ from the client's) and may be gzip or
+   zstd compressed as usual. Paths may not contain spaces. To pass
+   structures in memory, use files in /dev/shm.
+
+   tinkerd -c sends a single request from the command line and exits
+   with 0 if the reply was OK.
+
+**************************************************************************
+
+   Usage:
+   ======
+   tinkerd [-t nthreads] [-p paramfile]... socket
+   tinkerd -c socket request [arguments...]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  tinkerpdb requests take -k and -K for CONECT 
+                    records   By: ACRM
+   V1.2   19.10.26  fixoverlap requests keep the periodic box   By: ACRM
+   V1.3   19.10.26  Parameter files pushed out of the cache are freed
+                    By: ACRM
+   V1.4   19.10.26  Parameter files are read outside the cache lock and
+                    the least recently used one is pushed out   By: ACRM
+
+*************************************************************************/
+/* Sockets, signals and pthreads are not ANSI                           */
+#define _XOPEN_SOURCE 500
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "bioplib/general.h"
+#include "tinkertypes.h"
+#include "tinkerxyz.h"
+#include "hrelax.h"
+#include "pdbfixup.h"
+#include "pdbresid.h"
+#include "zstream.h"
+#include "cifwrite.h"
+#include "hybrid36.h"
+#include "xyzpdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define MAXREQUEST    4096     /* Longest request line                  */
+#define MAXREPLY       320
+#define MAXREQARGS      32
+#define MAXREQCHAINS    64
+#define MAXPARAMFILES   16     /* Parameter files kept in the cache     */
+#define MAXTHREADS     256
+#define DEFTHREADS       4
+#define CONNQUEUE      256     /* Connections waiting for a worker      */
+#define TINKERDATA    "TINKERDATA"
+
+/* Atom types read from one parameter file. The cache and each request
+   using the types hold a reference
+*/
+typedef struct
+{
+   char        paramFile[MAXBUFF];
+   TINKERTYPES *types;
+   int         refs;
+}  TYPECACHE;
+
+/* State shared between the listener and the worker threads             */
+typedef struct
+{
+   int             conn[CONNQUEUE],  /* Accepted connections            */
+                   head,
+                   nconn,
+                   ncached;
+   TYPECACHE       *cache[MAXPARAMFILES];
+   pthread_mutex_t connLock,
+                   cacheLock;
+   pthread_cond_t  connReady,
+                   connSpace;
+}  TINKERD;
+
+/************************************************************************/
+/* Globals
+*/
+static char sSocketName[MAXBUFF];
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *nthreads, char ***paramFiles, int *nParamFiles,
+                  BOOL *client, char ***request, int *nRequest);
+void Usage(void);
+BOOL RunServer(char *socketName, int nthreads, char **paramFiles,
+               int nParamFiles);
+int RunClient(char *socketName, char **request, int nRequest);
+int OpenSocket(char *socketName, BOOL listening);
+void *WorkerThread(void *arg);
+void ServeConnection(TINKERD *tinkerd, int fd);
+BOOL HandleRequest(TINKERD *tinkerd, char *line, char *reply);
+int SplitRequest(char *line, char **words);
+BOOL RequestTinkerPDB(TINKERD *tinkerd, int nwords, char **words,
+                      char *reply);
+BOOL RequestTinkerPatch(int nwords, char **words, char *reply);
+BOOL RequestFixOverlap(int nwords, char **words, char *reply);
+TYPECACHE *GetAtomTypes(TINKERD *tinkerd, char *paramFile);
+TYPECACHE *FindAtomTypes(TINKERD *tinkerd, char *paramFile);
+TYPECACHE *ReadAtomTypes(char *paramFile);
+void ReleaseAtomTypes(TINKERD *tinkerd, TYPECACHE *entry);
+void DropAtomTypes(TYPECACHE *entry);
+BOOL OpenRequestFiles(char *infile, char *outfile, FILE **in,
+                      FILE **out, char *reply);
+BOOL CloseRequestFiles(FILE *in, FILE *out, char *reply);
+void RemoveSocket(int sig);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*/
+int main(int argc, char **argv)
+{
+   char socketName[MAXBUFF],
+        **paramFiles = NULL,
+        **request    = NULL;
+   int  nthreads     = DEFTHREADS,
+        nParamFiles  = 0,
+        nRequest     = 0;
+   BOOL client       = FALSE;
+
+   if(ParseCmdLine(argc, argv, socketName, &nthreads, &paramFiles,
+                   &nParamFiles, &client, &request, &nRequest))
+   {
+      if(client)
+         return(RunClient(socketName, request, nRequest));
+
+      if(!RunServer(socketName, nthreads, paramFiles, nParamFiles))
+         return(1);
+   }
+   else
+   {
+      Usage();
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                     int *nthreads, char ***paramFiles, int *nParamFiles,
+                     BOOL *client, char ***request, int *nRequest)
+   ----------------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  char   *socketName   Unix domain socket
+            int    *nthreads     Number of worker threads
+            char   ***paramFiles Parameter files to preload (points
+                                 into argv)
+            int    *nParamFiles  Number of parameter files to preload
+            BOOL   *client       Send a request rather than serving
+            char   ***request    Request to send (points into argv)
+            int    *nRequest     Number of words in the request
+   Returns: BOOL                 Success?
+
+   Parse the command line. -p may be given more than once; the
+   parameter file names are gathered at the start of argv.
+
+   19.10.26  Original   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *nthreads, char ***paramFiles, int *nParamFiles,
+                  BOOL *client, char ***request, int *nRequest)
+{
+   argc--;
+   argv++;
+
+   socketName[0] = '\0';
+   *paramFiles   = argv;
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+         {
+           return(FALSE);
+         }
+         else
+         {
+            switch(argv[0][1])
+            {
+            case 'h':
+               return(FALSE);
+               break;
+            case 'c':
+               *client = TRUE;
+               break;
+            case 'p':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               (*paramFiles)[(*nParamFiles)++] = argv[0];
+               break;
+            case 't':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%d", nthreads) || (*nthreads < 1))
+                  return(FALSE);
+               if(*nthreads > MAXTHREADS)
+                  *nthreads = MAXTHREADS;
+               break;
+            default:
+               return(FALSE);
+               break;
+            }
+         }
+      }
+      else
+      {
+         if(strlen(argv[0]) >= MAXBUFF)
+            return(FALSE);
+         strcpy(socketName, argv[0]);
+         argc--;
+         argv++;
+
+         /* A client sends the rest as the request; a server takes
+            nothing else
+         */
+         if(*client)
+         {
+            if((argc < 1) || *nParamFiles)
+               return(FALSE);
+            *request  = argv;
+            *nRequest = argc;
+            return(TRUE);
+         }
+         return(argc == 0);
+      }
+
+      argc--;
+      argv++;
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\ntinkerd V1.0 (c) 2026 UCL, Prof. Andrew C.R. \
+Martin\n");
+   fprintf(stderr,"\nUsage: tinkerd [-t nthreads] [-p paramfile]... \
+socket\n");
+   fprintf(stderr,"       tinkerd -c socket request [arguments...]\n");
+   fprintf(stderr,"       -t  Number of worker threads (default %d)\n",
+           DEFTHREADS);
+   fprintf(stderr,"       -p  Read the atom types from this Tinker \
+parameter file at start-up\n");
+   fprintf(stderr,"       -c  Send one request to a running tinkerd \
+and print the reply\n");
+
+   fprintf(stderr,"\nListens on a Unix domain socket for requests, one \
+per line:\n");
+   fprintf(stderr,"   tinkerpdb [-c chain[,chain...]] [-r] [-C] [-k|-K] \
+paramfile in.xyz out.pdb\n");
+   fprintf(stderr,"   tinkerpatch [-C] orig.pdb tinker.pdb out.pdb\n");
+   fprintf(stderr,"   fixoverlap [-r] in.xyz out.xyz\n");
+   fprintf(stderr,"   ping\n");
+   fprintf(stderr,"Each gets a reply of OK or ERROR and a message. The \
+options are as for\n");
+   fprintf(stderr,"the programs. Use absolute paths. Atom types are \
+kept once a parameter\n");
+   fprintf(stderr,"file has been read (also looked for in the \
+directory given by the\n");
+   fprintf(stderr,"%s environment variable).\n\n", TINKERDATA);
+}
+
+
+/************************************************************************/
+/*>BOOL RunServer(char *socketName, int nthreads, char **paramFiles,
+                  int nParamFiles)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   *socketName    Unix domain socket to listen on
+   \param[in]   nthreads       Number of worker threads
+   \param[in]   **paramFiles   Parameter files to preload
+   \param[in]   nParamFiles    Number of parameter files to preload
+   \return                     FALSE if the server couldn't be started
+
+   Preloads the parameter files, starts the workers and then accepts
+   connections until killed
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL RunServer(char *socketName, int nthreads, char **paramFiles,
+               int nParamFiles)
+{
+   TINKERD   *tinkerd;
+   TYPECACHE *entry;
+   pthread_t tid;
+   int       i,
+             sock,
+             fd;
+
+   if((tinkerd=(TINKERD *)calloc(1, sizeof(TINKERD)))==NULL)
+   {
+      fprintf(stderr,"Error: No memory for server\n");
+      return(FALSE);
+   }
+   pthread_mutex_init(&tinkerd->connLock,  NULL);
+   pthread_mutex_init(&tinkerd->cacheLock, NULL);
+   pthread_cond_init(&tinkerd->connReady,  NULL);
+   pthread_cond_init(&tinkerd->connSpace,  NULL);
+
+   for(i=0; i<nParamFiles; i++)
+   {
+      if((entry=GetAtomTypes(tinkerd, paramFiles[i])) == NULL)
+         return(FALSE);
+      ReleaseAtomTypes(tinkerd, entry);
+   }
+
+   /* A client that goes away mustn't kill the server                   */
+   signal(SIGPIPE, SIG_IGN);
+
+   if((sock=OpenSocket(socketName, TRUE)) < 0)
+      return(FALSE);
+   strcpy(sSocketName, socketName);
+   signal(SIGINT,  RemoveSocket);
+   signal(SIGTERM, RemoveSocket);
+
+   for(i=0; i<nthreads; i++)
+   {
+      if(pthread_create(&tid, NULL, WorkerThread, (void *)tinkerd) != 0)
+      {
+         fprintf(stderr,"Error: Unable to start thread\n");
+         unlink(socketName);
+         return(FALSE);
+      }
+      pthread_detach(tid);
+   }
+
+   for(;;)
+   {
+      if((fd=accept(sock, NULL, NULL)) < 0)
+      {
+         if((errno == EINTR) || (errno == ECONNABORTED))
+            continue;
+         fprintf(stderr,"Error: Unable to accept connection (%s)\n",
+                 strerror(errno));
+         unlink(socketName);
+         return(FALSE);
+      }
+
+      pthread_mutex_lock(&tinkerd->connLock);
+      while(tinkerd->nconn == CONNQUEUE)
+         pthread_cond_wait(&tinkerd->connSpace, &tinkerd->connLock);
+      tinkerd->conn[(tinkerd->head + tinkerd->nconn) % CONNQUEUE] = fd;
+      tinkerd->nconn++;
+      pthread_cond_signal(&tinkerd->connReady);
+      pthread_mutex_unlock(&tinkerd->connLock);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int RunClient(char *socketName, char **request, int nRequest)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *socketName   Unix domain socket of the server
+   \param[in]   **request     Words of the request
+   \param[in]   nRequest      Number of words
+   \return                    Exit status: 0 if the reply was OK
+
+   Sends one request and prints the reply
+
+-  19.10.26 Original   By: ACRM
+*/
+int RunClient(char *socketName, char **request, int nRequest)
+{
+   FILE *fp;
+   char reply[MAXREPLY];
+   int  i,
+        sock;
+
+   if((sock=OpenSocket(socketName, FALSE)) < 0)
+      return(1);
+   if((fp=fdopen(sock, "r+"))==NULL)
+   {
+      close(sock);
+      return(1);
+   }
+
+   for(i=0; i<nRequest; i++)
+      fprintf(fp, "%s%s", (i?" ":""), request[i]);
+   fprintf(fp, "\n");
+   fflush(fp);
+
+   /* A stream opened for update needs a seek between writing and
+      reading
+   */
+   fseek(fp, 0L, SEEK_CUR);
+   if(fgets(reply, MAXREPLY, fp) == NULL)
+   {
+      fprintf(stderr,"Error: No reply from tinkerd\n");
+      fclose(fp);
+      return(1);
+   }
+   fclose(fp);
+
+   fputs(reply, stdout);
+   return(strncmp(reply, "OK", 2) ? 1 : 0);
+}
+
+
+/************************************************************************/
+/*>int OpenSocket(char *socketName, BOOL listening)
+   ------------------------------------------------
+*//**
+   \param[in]   *socketName   Unix domain socket
+   \param[in]   listening     Listen on the socket rather than connect
+   \return                    Socket file descriptor (-1 on error)
+
+   A listening socket replaces any socket file left by a server that
+   was killed, but won't replace anything else
+
+-  19.10.26 Original   By: ACRM
+*/
+int OpenSocket(char *socketName, BOOL listening)
+{
+   struct sockaddr_un addr;
+   struct stat        st;
+   int                sock;
+
+   if(strlen(socketName) >= sizeof(addr.sun_path))
+   {
+      fprintf(stderr,"Error: Socket name is too long: %s\n", socketName);
+      return(-1);
+   }
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strcpy(addr.sun_path, socketName);
+
+   if((sock=socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+   {
+      fprintf(stderr,"Error: Unable to create socket (%s)\n",
+              strerror(errno));
+      return(-1);
+   }
+
+   if(listening)
+   {
+      if((stat(socketName, &st) == 0) && S_ISSOCK(st.st_mode) &&
+         (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0))
+      {
+         close(sock);
+         unlink(socketName);
+         if((sock=socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+            return(-1);
+      }
+      if((bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+         (listen(sock, SOMAXCONN) < 0))
+      {
+         fprintf(stderr,"Error: Unable to listen on socket: %s (%s)\n",
+                 socketName, strerror(errno));
+         close(sock);
+         return(-1);
+      }
+   }
+   else if(connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+   {
+      fprintf(stderr,"Error: Unable to connect to socket: %s (%s)\n",
+              socketName, strerror(errno));
+      close(sock);
+      return(-1);
+   }
+
+   return(sock);
+}
+
+
+/************************************************************************/
+/*>void *WorkerThread(void *arg)
+   -----------------------------
+*//**
+   \param[in]   *arg   The TINKERD server state
+   \return             NULL (never returns)
+
+   Takes connections from the queue and serves each until the client
+   closes it
+
+-  19.10.26 Original   By: ACRM
+*/
+void *WorkerThread(void *arg)
+{
+   TINKERD *tinkerd = (TINKERD *)arg;
+   int     fd;
+
+   for(;;)
+   {
+      pthread_mutex_lock(&tinkerd->connLock);
+      while(tinkerd->nconn == 0)
+         pthread_cond_wait(&tinkerd->connReady, &tinkerd->connLock);
+      fd            = tinkerd->conn[tinkerd->head];
+      tinkerd->head = (tinkerd->head + 1) % CONNQUEUE;
+      tinkerd->nconn--;
+      pthread_cond_signal(&tinkerd->connSpace);
+      pthread_mutex_unlock(&tinkerd->connLock);
+
+      ServeConnection(tinkerd, fd);
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>void ServeConnection(TINKERD *tinkerd, int fd)
+   ----------------------------------------------
+*//**
+   \param[in]   *tinkerd   Server state
+   \param[in]   fd         Connection from a client
+
+   Reads requests from the connection, replying to each, until the
+   client closes it. The connection is then closed.
+
+-  19.10.26 Original   By: ACRM
+*/
+void ServeConnection(TINKERD *tinkerd, int fd)
+{
+   FILE *in  = NULL,
+        *out = NULL;
+   char *line,
+        reply[MAXREPLY];
+   int  len,
+        fd2;
+
+   if((line=(char *)malloc(MAXREQUEST))==NULL)
+   {
+      close(fd);
+      return;
+   }
+   if((fd2=dup(fd)) < 0)
+   {
+      free(line);
+      close(fd);
+      return;
+   }
+   if(((in=fdopen(fd, "r"))==NULL) || ((out=fdopen(fd2, "w"))==NULL))
+   {
+      if(in != NULL)
+         fclose(in);
+      else
+         close(fd);
+      close(fd2);
+      free(line);
+      return;
+   }
+
+   while(fgets(line, MAXREQUEST, in) != NULL)
+   {
+      len = strlen(line);
+      if((len == 0) || (line[len-1] != '\n'))
+      {
+         /* Skip the rest of an over-long line                          */
+         if(len == MAXREQUEST-1)
+         {
+            int c;
+            while(((c=getc(in)) != EOF) && (c != '\n'))
+               continue;
+         }
+         strcpy(reply, "Request is too long");
+         fprintf(out, "ERROR %s\n", reply);
+      }
+      else
+      {
+         fprintf(out, "%s %s\n",
+                 (HandleRequest(tinkerd, line, reply)?"OK":"ERROR"),
+                 reply);
+      }
+      if(fflush(out) != 0)
+         break;
+   }
+
+   fclose(in);
+   fclose(out);
+   free(line);
+}
+
+
+/************************************************************************/
+/*>BOOL HandleRequest(TINKERD *tinkerd, char *line, char *reply)
+   -------------------------------------------------------------
+*//**
+   \param[in]      *tinkerd   Server state
+   \param[in,out]  *line      The request (split into words)
+   \param[out]     *reply     Message for the reply
+   \return                    Success
+
+   Runs one request
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL HandleRequest(TINKERD *tinkerd, char *line, char *reply)
+{
+   char *words[MAXREQARGS];
+   int  nwords;
+
+   if((nwords=SplitRequest(line, words)) < 1)
+   {
+      strcpy(reply, "Empty or over-long request");
+      return(FALSE);
+   }
+
+   if(!strcmp(words[0], "tinkerpdb"))
+      return(RequestTinkerPDB(tinkerd, nwords-1, words+1, reply));
+   if(!strcmp(words[0], "tinkerpatch"))
+      return(RequestTinkerPatch(nwords-1, words+1, reply));
+   if(!strcmp(words[0], "fixoverlap"))
+      return(RequestFixOverlap(nwords-1, words+1, reply));
+   if(!strcmp(words[0], "ping") && (nwords == 1))
+   {
+      strcpy(reply, "tinkerd");
+      return(TRUE);
+   }
+
+   sprintf(reply, "Unknown request: %.*s", MAXREPLY-32, words[0]);
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>int SplitRequest(char *line, char **words)
+   ------------------------------------------
+*//**
+   \param[in,out]  *line    The request
+   \param[out]     **words  Pointers to the words (in line)
+   \return                  Number of words (-1 if more than
+                            MAXREQARGS)
+
+   Splits a request at white space, terminating each word in place
+
+-  19.10.26 Original   By: ACRM
+*/
+int SplitRequest(char *line, char **words)
+{
+   int nwords = 0;
+
+   for(;;)
+   {
+      while(isspace(*line))
+         line++;
+      if(*line == '\0')
+         break;
+      if(nwords == MAXREQARGS)
+         return(-1);
+      words[nwords++] = line;
+      while(*line && !isspace(*line))
+         line++;
+      if(*line)
+         *(line++) = '\0';
+   }
+
+   return(nwords);
+}
+
+
+/************************************************************************/
+/*>BOOL RequestTinkerPDB(TINKERD *tinkerd, int nwords, char **words,
+                         char *reply)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   *tinkerd   Server state
+   \param[in]   nwords     Number of arguments
+   \param[in]   **words    Arguments
+   \param[out]  *reply     Message for the reply
+   \return                 Success
+
+   tinkerpdb [-c chain[,chain...]] [-r] [-C] [-k|-K] paramfile 
+             in.xyz out.pdb
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Added -k and -K   By: ACRM
+-  19.10.26 Releases the atom types   By: ACRM
+*/
+BOOL RequestTinkerPDB(TINKERD *tinkerd, int nwords, char **words,
+                      char *reply)
+{
+   char        chainLabels[MAXREQCHAINS+1][MAXCHAINLABEL],
+               *chains[MAXREQCHAINS+1],
+               cifName[MAXCIFNAME];
+   TYPECACHE   *entry;
+   FILE        *in,
+               *out;
+   int         nchains = 0,
+               conect  = CONECT_NONE;
+   BOOL        relax   = FALSE,
+               cif     = FALSE,
+               ok;
+
+   for(; (nwords > 3) && (words[0][0] == '-'); nwords--, words++)
+   {
+      if(!strcmp(words[0], "-r"))
+      {
+         relax = TRUE;
+      }
+      else if(!strcmp(words[0], "-C"))
+      {
+         cif = TRUE;
+      }
+      else if(!strcmp(words[0], "-k"))
+      {
+         conect = CONECT_HET;
+      }
+      else if(!strcmp(words[0], "-K"))
+      {
+         conect = CONECT_ALL;
+      }
+      else if(!strcmp(words[0], "-c"))
+      {
+         nwords--;
+         words++;
+         nchains = ParseChainLabels(words[0], chainLabels, chains,
+                                    MAXREQCHAINS);
+      }
+      else
+      {
+         break;
+      }
+   }
+   if((nwords != 3) || (words[0][0] == '-'))
+   {
+      strcpy(reply, "Usage: tinkerpdb [-c chain[,chain...]] [-r] [-C] \
+[-k|-K] paramfile in.xyz out.pdb");
+      return(FALSE);
+   }
+   if((entry=GetAtomTypes(tinkerd, words[0]))==NULL)
+   {
+      sprintf(reply, "Unable to read Tinker parameter file");
+      return(FALSE);
+   }
+
+   if(!OpenRequestFiles(words[1], words[2], &in, &out, reply))
+   {
+      ReleaseAtomTypes(tinkerd, entry);
+      return(FALSE);
+   }
+
+   if(cif || IsMMCIFFilename(words[2]))
+      MMCIFBlockName(words[1], cifName);
+   else
+      cifName[0] = '\0';
+
+   ok = tinker2pdb(in, entry->types, (nchains?chains:NULL), relax,
+                   conect, out, (cifName[0]?cifName:NULL), 1);
+   ReleaseAtomTypes(tinkerd, entry);
+   if(!CloseRequestFiles(in, out, reply))
+      return(FALSE);
+   if(!ok)
+   {
+      strcpy(reply, "Conversion failed");
+      return(FALSE);
+   }
+
+   strcpy(reply, "Converted");
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL RequestTinkerPatch(int nwords, char **words, char *reply)
+   --------------------------------------------------------------
+*//**
+   \param[in]   nwords     Number of arguments
+   \param[in]   **words    Arguments
+   \param[out]  *reply     Message for the reply
+   \return                 Success
+
+   tinkerpatch [-C] orig.pdb tinker.pdb out.pdb
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL RequestTinkerPatch(int nwords, char **words, char *reply)
+{
+   char     cifName[MAXCIFNAME];
+   FILE     *fp,
+            *in,
+            *out;
+   PDB      *pdbNew;
+   PDBRESID *resOrig;
+   int      natoms,
+            nres;
+   BOOL     cif = FALSE,
+            ok  = FALSE;
+
+   if((nwords == 4) && !strcmp(words[0], "-C"))
+   {
+      cif = TRUE;
+      nwords--;
+      words++;
+   }
+   if((nwords != 3) || (words[0][0] == '-'))
+   {
+      strcpy(reply, "Usage: tinkerpatch [-C] orig.pdb tinker.pdb \
+out.pdb");
+      return(FALSE);
+   }
+
+   if((fp=ZStreamOpen(words[0], "r", ZSTREAM_PLAIN))==NULL)
+   {
+      strcpy(reply, "Unable to open original PDB file");
+      return(FALSE);
+   }
+   resOrig = ReadPDBResidueIds(fp, &nres);
+   ZStreamClose(fp);
+   if(resOrig == NULL)
+   {
+      strcpy(reply, "No atoms read from original PDB file");
+      return(FALSE);
+   }
+
+   if(!OpenRequestFiles(words[1], words[2], &in, &out, reply))
+   {
+      free(resOrig);
+      return(FALSE);
+   }
+
+   strcpy(reply, "No atoms read from minimized PDB file");
+   if((pdbNew=ReadPDBHy36(in, &natoms))!=NULL)
+   {
+      strcpy(reply, "Patching failed");
+      if(PatchResidueIds(pdbNew, resOrig, nres))
+      {
+         if(cif || IsMMCIFFilename(words[2]))
+         {
+            MMCIFBlockName(words[0], cifName);
+            ok = WriteMMCIF(out, pdbNew, cifName);
+         }
+         else
+         {
+            ok = WritePDBHy36(out, pdbNew);
+         }
+         strcpy(reply, ok ? "Patched" : "Unable to write output");
+      }
+      FREELIST(pdbNew, PDB);
+   }
+   free(resOrig);
+
+   if(!CloseRequestFiles(in, out, reply))
+      return(FALSE);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL RequestFixOverlap(int nwords, char **words, char *reply)
+   -------------------------------------------------------------
+*//**
+   \param[in]   nwords     Number of arguments
+   \param[in]   **words    Arguments
+   \param[out]  *reply     Message for the reply
+   \return                 Success
+
+   fixoverlap [-r] in.xyz out.xyz
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Keeps the periodic box   By: ACRM
+*/
+BOOL RequestFixOverlap(int nwords, char **words, char *reply)
+{
+   char      title[MAXXYZBUFF];
+   FILE      *in,
+             *out;
+   TINKERXYZ *xyz;
+   XYZBOX    box;
+   int       natoms;
+   BOOL      relax = FALSE;
+
+   if((nwords == 3) && !strcmp(words[0], "-r"))
+   {
+      relax = TRUE;
+      nwords--;
+      words++;
+   }
+   if((nwords != 2) || (words[0][0] == '-'))
+   {
+      strcpy(reply, "Usage: fixoverlap [-r] in.xyz out.xyz");
+      return(FALSE);
+   }
+
+   if(!OpenRequestFiles(words[0], words[1], &in, &out, reply))
+      return(FALSE);
+
+   if((xyz=ReadTinkerXYZThreaded(in, &natoms, title, &box, 1))==NULL)
+   {
+      CloseRequestFiles(in, out, reply);
+      strcpy(reply, "No atoms read from Tinker XYZ file");
+      return(FALSE);
+   }
+
+   FixOverlaps(xyz, &box);
+   if(relax && !RelaxHydrogens(xyz, HRELAX_MAXITER, HRELAX_RMSGRAD,
+                               FALSE))
+      fprintf(stderr,"Warning: Hydrogen relaxation failed\n");
+   WriteTinkerXYZ(out, natoms, title, &box, xyz);
+   FreeTinkerXYZ(xyz);
+
+   if(!CloseRequestFiles(in, out, reply))
+      return(FALSE);
+   strcpy(reply, "Fixed");
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>TYPECACHE *GetAtomTypes(TINKERD *tinkerd, char *paramFile)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *tinkerd     Server state
+   \param[in]   *paramFile   Tinker parameter file
+   \return                   Cache entry holding the atom types (NULL on
+                             error)
+
+   Returns the atom types from a parameter file, reading them the first
+   time the file is used. The file is read without holding the cache
+   lock so that other requests are not held up; if two requests read
+   the same file at once, the first to finish goes into the cache and
+   the other copy is thrown away. Once the cache is full, the least
+   recently used file is pushed out. The caller gets a reference to the
+   entry and must give it up with ReleaseAtomTypes(), so an entry
+   pushed out of the cache is freed when the last request using it
+   finishes.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Returns a reference counted cache entry   By: ACRM
+-  19.10.26 Reads the file outside the lock. Least recently used
+            eviction   By: ACRM
+*/
+TYPECACHE *GetAtomTypes(TINKERD *tinkerd, char *paramFile)
+{
+   TYPECACHE *entry,
+             *loaded;
+   int       i;
+
+   if(strlen(paramFile) >= MAXBUFF)
+      return(NULL);
+
+   pthread_mutex_lock(&tinkerd->cacheLock);
+   entry = FindAtomTypes(tinkerd, paramFile);
+   pthread_mutex_unlock(&tinkerd->cacheLock);
+   if(entry != NULL)
+      return(entry);
+
+   if((loaded=ReadAtomTypes(paramFile))==NULL)
+      return(NULL);
+
+   pthread_mutex_lock(&tinkerd->cacheLock);
+   if((entry=FindAtomTypes(tinkerd, paramFile))!=NULL)
+   {
+      /* Another request read it while we were                          */
+      DropAtomTypes(loaded);
+   }
+   else
+   {
+      /* Most recently used first, so the last one is pushed out        */
+      if(tinkerd->ncached < MAXPARAMFILES)
+         tinkerd->ncached++;
+      else
+         DropAtomTypes(tinkerd->cache[MAXPARAMFILES-1]);
+      for(i=tinkerd->ncached-1; i>0; i--)
+         tinkerd->cache[i] = tinkerd->cache[i-1];
+      tinkerd->cache[0] = loaded;
+      loaded->refs++;                    /* The cache's reference       */
+      entry = loaded;
+   }
+   pthread_mutex_unlock(&tinkerd->cacheLock);
+
+   return(entry);
+}
+
+
+/************************************************************************/
+/*>TYPECACHE *FindAtomTypes(TINKERD *tinkerd, char *paramFile)
+   -----------------------------------------------------------
+*//**
+   \param[in,out]  *tinkerd     Server state
+   \param[in]      *paramFile   Tinker parameter file
+   \return                      Cache entry (NULL if not cached)
+
+   Looks for a parameter file in the cache. If it is there, it is moved
+   to the front as the most recently used and the caller gets a
+   reference to it. The cache lock must be held.
+
+-  19.10.26 Original   By: ACRM
+*/
+TYPECACHE *FindAtomTypes(TINKERD *tinkerd, char *paramFile)
+{
+   TYPECACHE *entry;
+   int       i;
+
+   for(i=0; i<tinkerd->ncached; i++)
+   {
+      if(!strcmp(tinkerd->cache[i]->paramFile, paramFile))
+      {
+         entry = tinkerd->cache[i];
+         for(; i>0; i--)
+            tinkerd->cache[i] = tinkerd->cache[i-1];
+         tinkerd->cache[0] = entry;
+         entry->refs++;
+         return(entry);
+      }
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>TYPECACHE *ReadAtomTypes(char *paramFile)
+   -----------------------------------------
+*//**
+   \param[in]   *paramFile   Tinker parameter file
+   \return                   New cache entry with one reference (NULL
+                             on error)
+
+   Reads the atom types from a parameter file into a cache entry that
+   is not yet in the cache
+
+-  19.10.26 Original   By: ACRM
+*/
+TYPECACHE *ReadAtomTypes(char *paramFile)
+{
+   TYPECACHE   *entry = NULL;
+   TINKERTYPES *types = NULL;
+   FILE        *fp;
+   BOOL        noEnv  = FALSE;
+
+   if((fp=blOpenFile(paramFile, TINKERDATA, "r", &noEnv))==NULL)
+   {
+      fprintf(stderr,"Error: Unable to open Tinker parameter \
+file: %s\n", paramFile);
+      return(NULL);
+   }
+
+   if(((types=ReadTinkerAtomTypes(fp))==NULL) ||
+      ((entry=(TYPECACHE *)malloc(sizeof(TYPECACHE)))==NULL))
+   {
+      if(types != NULL) free(types);
+      fprintf(stderr,"Error: No memory for Tinker atom types\n");
+   }
+   else
+   {
+      strcpy(entry->paramFile, paramFile);
+      entry->types = types;
+      entry->refs  = 1;
+   }
+   fclose(fp);
+
+   return(entry);
+}
+
+
+/************************************************************************/
+/*>void ReleaseAtomTypes(TINKERD *tinkerd, TYPECACHE *entry)
+   ---------------------------------------------------------
+*//**
+   \param[in]      *tinkerd   Server state
+   \param[in,out]  *entry     Cache entry from GetAtomTypes()
+
+   Gives up a reference to a cache entry
+
+-  19.10.26 Original   By: ACRM
+*/
+void ReleaseAtomTypes(TINKERD *tinkerd, TYPECACHE *entry)
+{
+   pthread_mutex_lock(&tinkerd->cacheLock);
+   DropAtomTypes(entry);
+   pthread_mutex_unlock(&tinkerd->cacheLock);
+}
+
+
+/************************************************************************/
+/*>void DropAtomTypes(TYPECACHE *entry)
+   ------------------------------------
+*//**
+   \param[in,out]  *entry     Cache entry
+
+   Drops a reference to a cache entry, freeing it if that was the last
+   one. The cache lock must be held.
+
+-  19.10.26 Original   By: ACRM
+*/
+void DropAtomTypes(TYPECACHE *entry)
+{
+   if(--(entry->refs) == 0)
+   {
+      free(entry->types);
+      free(entry);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL OpenRequestFiles(char *infile, char *outfile, FILE **in,
+                         FILE **out, char *reply)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *infile    Input file
+   \param[in]   *outfile   Output file
+   \param[out]  **in       Input stream
+   \param[out]  **out      Output stream
+   \param[out]  *reply     Message for the reply on failure
+   \return                 Success
+
+   Opens the files for a request. Unlike the programs, standard input
+   and output can't be used.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL OpenRequestFiles(char *infile, char *outfile, FILE **in,
+                      FILE **out, char *reply)
+{
+   if(!strcmp(infile, "-") || !strcmp(outfile, "-"))
+   {
+      strcpy(reply, "Files must be named");
+      return(FALSE);
+   }
+   if((*in=ZStreamOpen(infile, "r", ZSTREAM_PLAIN))==NULL)
+   {
+      strcpy(reply, "Unable to open input file");
+      return(FALSE);
+   }
+   if((*out=ZStreamOpen(outfile, "w", ZSTREAM_PLAIN))==NULL)
+   {
+      ZStreamClose(*in);
+      strcpy(reply, "Unable to open output file");
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL CloseRequestFiles(FILE *in, FILE *out, char *reply)
+   --------------------------------------------------------
+*//**
+   \param[in]   *in       Input stream
+   \param[in]   *out      Output stream
+   \param[out]  *reply    Message for the reply on failure
+   \return                FALSE if the output couldn't be completed
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL CloseRequestFiles(FILE *in, FILE *out, char *reply)
+{
+   ZStreamClose(in);
+   if(!ZStreamClose(out))
+   {
+      strcpy(reply, "Unable to write output file");
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void RemoveSocket(int sig)
+   --------------------------
+*//**
+   \param[in]   sig    Signal number
+
+   Signal handler to remove the socket file when the server is stopped
+
+-  19.10.26 Original   By: ACRM
+*/
+void RemoveSocket(int sig)
+{
+   (void)sig;
+   unlink(sSocketName);
+   _exit(0);
+}
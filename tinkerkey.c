@@ -0,0 +1,572 @@
+/*************************************************************************
+
+   Program:    tinkerkey
+   File:       tinkerkey.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Write a Tinker .key file that restricts minimization to
+               the hydrogens of a Tinker XYZ file
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The heavy atoms come from the crystal structure, so there is no
+   point in letting Tinker's minimize move them. By default they are
+   made inactive; with -r they are held with position restraints
+   instead.
+
+   With -s, only hydrogens within the given distance of a clash are
+   left active. A clash is a pair of atoms that are neither bonded nor
+   bonded to a common atom, but are closer than the clash distance.
+
+   Hydrogens are recognised by their Tinker atom name starting with H.
+
+**************************************************************************
+
+   Usage:
+   ======
+   tinkerkey [-p paramfile] [-r force] [-s shell] [-c clash]
+             [in.xyz [out.key]]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Clash search uses a Morton sorted cell grid   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "tinkerxyz.h"
+#include "cellgrid.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define DEFCLASH       2.0    /* Default clash distance                 */
+#define PERLINE          8    /* Atom numbers per key file line         */
+#define ISHYDROGEN(t)  ((t)->atnam[0] == 'H')
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                  REAL *force, REAL *shell, REAL *clash,
+                  char *infile, char *outfile);
+void Usage(void);
+BOOL FlagClashShell(TINKERXYZ **idx, int natoms, REAL clash,
+                    REAL shell, BOOL *active);
+BOOL CloselyBonded(TINKERXYZ **idx, int natoms, int i, int j);
+void WriteTinkerKey(FILE *fp, char *paramFile, TINKERXYZ **idx,
+                    int natoms, BOOL *active, REAL force);
+void WriteAtomList(FILE *fp, char *keyword, BOOL *flags, BOOL value,
+                   int natoms);
+
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   char      infile[MAXBUFF],
+             outfile[MAXBUFF],
+             paramFile[MAXBUFF],
+             title[MAXXYZBUFF];
+   FILE      *in     = stdin,
+             *out    = stdout;
+   REAL      force   = 0.0,
+             shell   = 0.0,
+             clash   = DEFCLASH;
+   TINKERXYZ *xyz    = NULL,
+             **idx   = NULL;
+   BOOL      *active = NULL;
+   int       natoms,
+             i;
+
+   if(ParseCmdLine(argc, argv, paramFile, &force, &shell, &clash,
+                   infile, outfile))
+   {
+      if(blOpenStdFiles(infile, outfile, &in, &out))
+      {
+         if(((xyz=ReadTinkerXYZ(in, &natoms, title))==NULL) ||
+            ((idx=IndexTinkerXYZ(xyz, &natoms))==NULL))
+         {
+            fprintf(stderr,"Error: No atoms read from Tinker XYZ \
+file\n");
+            return(1);
+         }
+
+         /* Connections refer to atom numbers so these must be
+            sequential
+         */
+         for(i=0; i<natoms; i++)
+         {
+            if(idx[i]->atnum != i+1)
+            {
+               fprintf(stderr,"Error: Tinker XYZ atoms are not numbered \
+sequentially at atom %d\n", idx[i]->atnum);
+               return(1);
+            }
+         }
+
+         if((active=(BOOL *)malloc(natoms * sizeof(BOOL)))==NULL)
+         {
+            fprintf(stderr,"Error: No memory for atom flags\n");
+            return(1);
+         }
+
+         for(i=0; i<natoms; i++)
+            active[i] = ISHYDROGEN(idx[i]);
+
+         if(shell > 0.0)
+         {
+            if(!FlagClashShell(idx, natoms, clash, shell, active))
+            {
+               fprintf(stderr,"Error: No memory for clash search\n");
+               return(1);
+            }
+         }
+
+         WriteTinkerKey(out, paramFile, idx, natoms, active, force);
+      }
+      else
+      {
+         fprintf(stderr,"Error: Unable to open input of output file\n");
+         return(1);
+      }
+   }
+   else
+   {
+      Usage();
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                     REAL *force, REAL *shell, REAL *clash,
+                     char *infile, char *outfile)
+   -------------------------------------------------------------
+   Input:   int    argc          Argument count
+            char   **argv        Argument array
+   Output:  char   *paramFile    Parameter file for the key (or blank)
+            REAL   *force        Restraint force constant (0 = inactive)
+            REAL   *shell        Shell around clashes (0 = all H)
+            REAL   *clash        Clash distance
+            char   *infile       Input file (or blank string)
+            char   *outfile      Output file (or blank string)
+   Returns: BOOL                 Success?
+
+   Parse the command line
+
+   19.10.26  Original   By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
+                  REAL *force, REAL *shell, REAL *clash,
+                  char *infile, char *outfile)
+{
+   argc--;
+   argv++;
+
+   infile[0] = outfile[0] = paramFile[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][2]!='\0')
+         {
+           return(FALSE);
+         }
+         else
+         {
+            switch(argv[0][1])
+            {
+            case 'h':
+               return(FALSE);
+               break;
+            case 'p':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(paramFile, argv[0], MAXBUFF-1);
+               paramFile[MAXBUFF-1] = '\0';
+               break;
+            case 'r':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%lf", force) || (*force <= 0.0))
+                  return(FALSE);
+               break;
+            case 's':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%lf", shell) || (*shell <= 0.0))
+                  return(FALSE);
+               break;
+            case 'c':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%lf", clash) || (*clash <= 0.0))
+                  return(FALSE);
+               break;
+            default:
+               return(FALSE);
+               break;
+            }
+         }
+      }
+      else
+      {
+         /* Check that there are 0-2 arguments left                     */
+         if(argc > 2)
+            return(FALSE);
+
+         /* If there's another, copy it to infile                       */
+         if(argc)
+         {
+            strcpy(infile, argv[0]);
+            argc--;
+            argv++;
+         }
+
+         /* If there's another, copy it to outfile                      */
+         if(argc)
+         {
+            strcpy(outfile, argv[0]);
+            argc--;
+            argv++;
+         }
+
+         return(TRUE);
+      }
+
+      argc--;
+      argv++;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+void Usage(void)
+{
+   fprintf(stderr,"\ntinkerkey V1.0 (c) 2026 UCL, Prof. Andrew C.R. \
+Martin\n");
+
+   fprintf(stderr,"\nUsage: tinkerkey [-p paramfile] [-r force] [-s shell] \
+[-c clash]\n");
+   fprintf(stderr,"                 [in.xyz [out.key]]\n");
+   fprintf(stderr,"       -p  Add a 'parameters' line for this file\n");
+   fprintf(stderr,"       -r  Restrain heavy atoms with this force \
+constant rather\n");
+   fprintf(stderr,"           than making them inactive\n");
+   fprintf(stderr,"       -s  Only hydrogens within this distance of a \
+clash are active\n");
+   fprintf(stderr,"       -c  Clash distance for -s (default: %.1f)\n",
+           DEFCLASH);
+
+   fprintf(stderr,"\nWrites a Tinker key file so that minimize only moves \
+the hydrogens of\n");
+   fprintf(stderr,"a Tinker XYZ file. Use it with: minimize file.xyz -k \
+file.key\n\n");
+}
+
+
+/************************************************************************/
+/*>BOOL FlagClashShell(TINKERXYZ **idx, int natoms, REAL clash,
+                       REAL shell, BOOL *active)
+   ------------------------------------------------------------
+*//**
+   \param[in]      **idx     Indexed Tinker XYZ atoms
+   \param[in]      natoms    Number of atoms
+   \param[in]      clash     Clash distance
+   \param[in]      shell     Shell distance around clashing atoms
+   \param[in,out]  *active   On input, TRUE for atoms that may move.
+                             On output, only those within the shell of
+                             a clashing atom remain TRUE
+   \return                   Success (FALSE if no memory)
+
+   Finds clashes with a cell grid and then keeps only those atoms within
+   the shell distance of a clashing atom active.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses BuildSortedCellGrid()   By: ACRM
+*/
+BOOL FlagClashShell(TINKERXYZ **idx, int natoms, REAL clash,
+                    REAL shell, BOOL *active)
+{
+   CELLGRID *grid     = NULL;
+   REAL     *coor     = NULL,
+            cutSq;
+   BOOL     *clashing = NULL,
+            ok        = FALSE;
+   int      cells[MAXNEIGHBOURCELLS],
+            ncells,
+            nclash    = 0,
+            pass,
+            i, j, k, l;
+
+   if(((coor=(REAL *)malloc(3*natoms*sizeof(REAL)))==NULL) ||
+      ((clashing=(BOOL *)malloc(natoms*sizeof(BOOL)))==NULL))
+      goto cleanup;
+
+   for(i=0; i<natoms; i++)
+   {
+      coor[3*i]   = idx[i]->x;
+      coor[3*i+1] = idx[i]->y;
+      coor[3*i+2] = idx[i]->z;
+      clashing[i] = FALSE;
+   }
+
+   if((grid=BuildSortedCellGrid(coor, natoms, MAX(clash, shell)))==NULL)
+      goto cleanup;
+
+   /* Pass 0 finds clashing atoms; pass 1 finds atoms near to them      */
+   for(pass=0; pass<2; pass++)
+   {
+      cutSq = (pass ? shell*shell : clash*clash);
+
+      for(i=0; i<natoms; i++)
+      {
+         BOOL nearClash = FALSE;
+
+         /* In the second pass we only care about movable atoms         */
+         if(pass && !active[i])
+            continue;
+
+         ncells = GetNeighbourCells(grid,
+                                    GetCellIndex(grid, coor[3*i],
+                                                 coor[3*i+1],
+                                                 coor[3*i+2]),
+                                    cells);
+         for(k=0; k<ncells && !nearClash; k++)
+         {
+            for(l=grid->head[cells[k]]; l!=(-1); l=grid->next[l])
+            {
+               REAL dx, dy, dz;
+
+               j = grid->order[l];
+               if(pass ? !clashing[j] : (j <= i))
+                  continue;
+
+               dx = coor[3*i]   - grid->coor[3*l];
+               dy = coor[3*i+1] - grid->coor[3*l+1];
+               dz = coor[3*i+2] - grid->coor[3*l+2];
+               if((dx*dx + dy*dy + dz*dz) > cutSq)
+                  continue;
+
+               if(pass)
+               {
+                  nearClash = TRUE;
+                  break;
+               }
+               else if(!CloselyBonded(idx, natoms, i, j))
+               {
+                  clashing[i] = clashing[j] = TRUE;
+               }
+            }
+         }
+
+         if(pass)
+            active[i] = nearClash;
+      }
+
+      if(!pass)
+      {
+         for(i=0; i<natoms; i++)
+            if(clashing[i]) nclash++;
+         if(!nclash)
+            fprintf(stderr,"Warning: No clashes found - no atoms will \
+be minimized\n");
+      }
+   }
+   ok = TRUE;
+
+cleanup:
+   if(coor     != NULL) free(coor);
+   if(clashing != NULL) free(clashing);
+   FreeCellGrid(grid);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL CloselyBonded(TINKERXYZ **idx, int natoms, int i, int j)
+   -------------------------------------------------------------
+*//**
+   \param[in]   **idx     Indexed Tinker XYZ atoms
+   \param[in]   natoms    Number of atoms
+   \param[in]   i, j      Offsets of the two atoms
+   \return                Are the atoms 1-2 or 1-3 bonded?
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL CloselyBonded(TINKERXYZ **idx, int natoms, int i, int j)
+{
+   int a, b, c;
+
+   for(a=0; (a<MAXXYZCONNECT) && (c=idx[i]->connect[a]); a++)
+   {
+      if(c == j+1)
+         return(TRUE);
+
+      if((c < 1) || (c > natoms))
+         continue;
+
+      for(b=0; (b<MAXXYZCONNECT) && idx[c-1]->connect[b]; b++)
+      {
+         if(idx[c-1]->connect[b] == j+1)
+            return(TRUE);
+      }
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>void WriteTinkerKey(FILE *fp, char *paramFile, TINKERXYZ **idx,
+                       int natoms, BOOL *active, REAL force)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   *fp          Output file
+   \param[in]   *paramFile   Parameter file (or blank string)
+   \param[in]   **idx        Indexed Tinker XYZ atoms
+   \param[in]   natoms       Number of atoms
+   \param[in]   *active      Atoms that may move
+   \param[in]   force        Restraint force constant for heavy atoms
+                             (0.0 to make them inactive)
+
+   Writes the key file. Heavy atoms are either restrained at their
+   current positions, or are inactive along with any hydrogens that
+   aren't to be moved.
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteTinkerKey(FILE *fp, char *paramFile, TINKERXYZ **idx,
+                    int natoms, BOOL *active, REAL force)
+{
+   int i;
+
+   if(paramFile[0])
+      fprintf(fp, "parameters  %s\n", paramFile);
+
+   if(force > 0.0)
+   {
+      /* Heavy atoms stay active, but restrained                        */
+      for(i=0; i<natoms; i++)
+      {
+         if(!ISHYDROGEN(idx[i]))
+         {
+            active[i] = TRUE;
+            fprintf(fp, "restrain-position  %6d %12.6f %12.6f %12.6f \
+%8.2f  0.0\n",
+                    idx[i]->atnum, idx[i]->x, idx[i]->y, idx[i]->z,
+                    force);
+         }
+      }
+   }
+
+   WriteAtomList(fp, "inactive", active, FALSE, natoms);
+}
+
+
+/************************************************************************/
+/*>void WriteAtomList(FILE *fp, char *keyword, BOOL *flags, BOOL value,
+                      int natoms)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *fp        Output file
+   \param[in]   *keyword   Tinker keyword
+   \param[in]   *flags     Per-atom flags
+   \param[in]   value      Flag value of the atoms to list
+   \param[in]   natoms     Number of atoms
+
+   Writes the atoms whose flag matches value using Tinker's range
+   notation: a negative number followed by a positive one gives an
+   inclusive range.
+
+-  19.10.26 Original   By: ACRM
+*/
+void WriteAtomList(FILE *fp, char *keyword, BOOL *flags, BOOL value,
+                   int natoms)
+{
+   int i, j,
+       nOnLine = 0;
+
+   for(i=0; i<natoms; i=j)
+   {
+      if((flags[i] != FALSE) != (value != FALSE))
+      {
+         j = i+1;
+         continue;
+      }
+
+      /* Find the end of this run                                       */
+      for(j=i+1; (j<natoms) && ((flags[j] != FALSE) == (value != FALSE));
+          j++);
+
+      if(!nOnLine)
+         fprintf(fp, "%s", keyword);
+
+      if(j-1 > i)
+      {
+         fprintf(fp, " %6d %6d", -(i+1), j);
+         nOnLine += 2;
+      }
+      else
+      {
+         fprintf(fp, " %6d", i+1);
+         nOnLine++;
+      }
+
+      if(nOnLine >= PERLINE)
+      {
+         fprintf(fp, "\n");
+         nOnLine = 0;
+      }
+   }
+
+   if(nOnLine)
+      fprintf(fp, "\n");
+}
@@ -37,42 +37,153 @@
 
    Description:
    ============
+   Normal use patches the chain labels, residue numbers and insert codes
+   in the PDB file produced from Tinker with those from the original
+   PDB file.
+
+   With -a, the conformers that splitalt produced from a structure
+   with alternate locations are merged back together. Each conformer
+   should already have been patched. Where an atom has alternate
+   locations in the original file (or, for added hydrogens, where its
+   position differs between conformers), one copy from each conformer
+   is written with the alternate location label and occupancy from the
+   original. Other atoms are written once.
+
+   With -i, the original file is copied through unchanged except for
+   the x, y and z columns of each atom, which are replaced by the
+   coordinates of the matching atom from Tinker. Headers, remarks,
+   serial numbers, CONECT records and everything else in the original
+   are kept. Hydrogens added by Tinker are only inserted if -H is also
+   given.
+
+   With -m, any number of minimized structures (for example different
+   protonation states or random seeds) are patched against the one
+   original. Each minimized file may contain several MODELs and the
+   standard input is read if none is given. The residue identities of
+   the original are read only once and the models may be patched in
+   parallel with -t. The result is a multi-MODEL PDB file on standard
+   output or, with -o, a separate file for each model.
+
+   With -C, or if the output file ends in .cif, the output is written
+   as mmCIF rather than PDB (except with -i which always keeps the
+   format of the original).
 
 **************************************************************************
 
    Usage:
    ======
+   tinkerpatch [-S file] [-P] [-z] [-C] orig.pdb [tinker.pdb [out.pdb]]
+   tinkerpatch [-S file] [-P] [-z] -i [-H] orig.pdb [tinker.pdb 
+               [out.pdb]]
+   tinkerpatch [-S file] [-P] [-z] [-C] -m [-t nthreads] [-o prefix] 
+               orig.pdb [tinker.pdb ...]
+   tinkerpatch [-S file] [-P] [-z] [-C] -a A=confA.pdb,B=confB.pdb[,...] 
+               orig.pdb [out.pdb]
 
 **************************************************************************
 
    Revision History:
    =================
    V1.0   17.09.15  Original   By: ACRM
+   V1.1   19.10.26  Added -a to merge alternate conformers   By: ACRM
+   V1.2   19.10.26  Added -S for timing statistics   By: ACRM
+   V1.3   19.10.26  Added -P for hardware performance counters   By: ACRM
+   V1.4   19.10.26  Only the residue identities are read from the
+                    original file when patching. Stops if the original
+                    runs out of residues   By: ACRM
+   V1.5   19.10.26  Added -i to patch the coordinates into a copy of the
+                    original file and -H to add hydrogens   By: ACRM
+   V1.6   19.10.26  Added -m, -t and -o to patch many minimized models
+                    against one original   By: ACRM
+   V1.7   19.10.26  Reads and writes gzip and zstd compressed files.
+                    Added -z   By: ACRM
+   V1.8   19.10.26  Added -C for mmCIF output   By: ACRM
+   V1.9   19.10.26  Reads and writes hybrid-36 atom serial and residue
+                    numbers so large systems can be handled   By: ACRM
+   V1.10  19.10.26  Residue patching moved to pdbresid.c as
+                    PatchResidueIds() so tinkerd can share it   By: ACRM
+   V1.11  19.10.26  -S and -P handled by StatsSetup()   By: ACRM
 
 *************************************************************************/
+/* pthreads are not ANSI                                                */
+#define _XOPEN_SOURCE 500
+
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/fsscanf.h"
+#include "pdbresid.h"
+#include "stats.h"
+#include "zstream.h"
+#include "cifwrite.h"
+#include "hybrid36.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF        240
 #define MAXLABEL         8
+#define MAXCONF         62
+#define ALTDISTSQ    1.0e-6    /* Squared distance for atoms to differ */
+#define MAXTHREADS     256
+
+/* A minimized model to be patched                                      */
+typedef struct
+{
+   FILE *in,              /* The model, copied to a temporary file      */
+        *out;             /* Where the patched model is written         */
+   int  natoms;
+   BOOL ok;
+}  MODELJOB;
+
+/* The models shared between the threads that patch them               */
+typedef struct
+{
+   MODELJOB        *jobs;
+   PDBRESID        *resOrig;
+   int             njobs,
+                   nres,
+                   next;
+   BOOL            separate;
+   char            *cifName;     /* NULL for PDB output                */
+   pthread_mutex_t lock;
+}  MODELQUEUE;
 
 /************************************************************************/
 /* Prototypes
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *paramFile, 
-                  char *infile, char *outfile);
+                  char *infile, char *outfile, char *mergeSpec,
+                  char *statsFile, BOOL *perfCounters, BOOL *inPlace,
+                  BOOL *addHydrogens, BOOL *multi, char *outPrefix,
+                  int *nthreads, char ***modelFiles, int *nModelFiles,
+                  BOOL *compress, BOOL *cif);
+void CountStats(PDB *pdb);
 void Usage(void);
-BOOL tinkerpatch(PDB *pdbNew, PDB *pdbOld);
-void FixResidueNames(PDB *pdb);
+int  ReadConformers(char *mergeSpec, PDB **conf, char *labels);
+PDB *MergeConformers(PDB *orig, PDB **conf, char *labels, int nconf);
+BOOL SameResidue(PDB *p, PDB *q);
+PDB *FindOrigResidue(PDB *orig, PDB *from, PDB *res);
+PDB *FindAtomInResidue(PDB *start, PDB *stop, char *atnam, char altpos);
+BOOL IsAltAtom(PDB *origStart, PDB *origStop, PDB **start, PDB **stop,
+               int nconf, char *atnam);
+REAL AltOccupancy(PDB *origStart, PDB *origStop, char *atnam, 
+                  char label, int nconf);
+PDB *AppendAtom(PDB **pdb, PDB **last, PDB *p, char altpos, REAL occ);
+BOOL PatchModels(FILE *fpOrig, char **files, int nfiles, FILE *out,
+                 char *outPrefix, int nthreads, int format, 
+                 char *cifName);
+int  SplitModels(char **files, int nfiles, MODELJOB **jobs);
+MODELJOB *AddModelJob(MODELJOB **jobs, int *njobs, int *maxjobs);
+void *PatchModelThread(void *arg);
+BOOL WriteModel(FILE *out, PDB *pdb, int model);
+BOOL WritePatched(FILE *out, PDB *pdb, char *cifName);
 
 
 /************************************************************************/
@@ -83,34 +194,154 @@ int main(int argc, char **argv)
 {
    char origFile[MAXBUFF],
         infile[MAXBUFF],
-        outfile[MAXBUFF];
+        outfile[MAXBUFF],
+        mergeSpec[MAXBUFF],
+        statsFile[MAXBUFF],
+        outPrefix[MAXBUFF],
+        cifName[MAXCIFNAME],
+        labels[MAXCONF+1],
+        **modelFiles = NULL;
    FILE *in      = stdin,
         *out     = stdout,
         *fp      = NULL;
    PDB  *pdbOrig = NULL,
-        *pdbNew  = NULL;
-   int  natoms;
+        *pdbNew  = NULL,
+        *conf[MAXCONF];
+   PDBRESID *resOrig = NULL;
+   int  natoms, 
+        nconf,
+        nres,
+        npatched,
+        nunmatched,
+        nthreads     = 1,
+        nModelFiles  = 0;
+   BOOL perfCounters = FALSE,
+        inPlace      = FALSE,
+        addHydrogens = FALSE,
+        multi        = FALSE,
+        compress     = FALSE,
+        cif          = FALSE;
+   int  format;
     
-   if(ParseCmdLine(argc, argv, origFile, infile, outfile))
+   if(ParseCmdLine(argc, argv, origFile, infile, outfile, mergeSpec,
+                   statsFile, &perfCounters, &inPlace, &addHydrogens,
+                   &multi, outPrefix, &nthreads, &modelFiles,
+                   &nModelFiles, &compress, &cif))
    {
-      if((fp=fopen(origFile, "r"))==NULL)
+      format = compress ? ZSTREAM_GZIP : ZSTREAM_PLAIN;
+      cifName[0] = '\0';
+      if(cif || IsMMCIFFilename(outfile))
+      {
+         if(inPlace)
+         {
+            fprintf(stderr,"Error: -i can only write PDB format\n");
+            return(1);
+         }
+         MMCIFBlockName(origFile, cifName);
+      }
+
+      if(!StatsSetup("tinkerpatch", statsFile, perfCounters))
+         return(1);
+
+      if((fp=ZStreamOpen(origFile, "r", ZSTREAM_PLAIN))==NULL)
       {
          fprintf(stderr,"Error: Unable to open original PDB \
 file: %s\n", origFile);
          
          return(1);
       }
+
+      if(multi)
+      {
+         if(!outPrefix[0] && ((out=ZStreamOpen(NULL, "w", format))==NULL))
+         {
+            fprintf(stderr,"Error: Unable to open output file\n");
+            return(1);
+         }
+         if(!PatchModels(fp, modelFiles, nModelFiles, out, outPrefix,
+                         nthreads, format, (cifName[0]?cifName:NULL)))
+            return(1);
+         return(StatsReport()?0:1);
+      }
+
+      if(mergeSpec[0])
+      {
+         StatsPhaseStart("ReadPDB");
+         if((nconf=ReadConformers(mergeSpec, conf, labels))==0)
+            return(1);
+
+         if((pdbOrig=blReadPDBAll(fp, &natoms))==NULL)
+         {
+            fprintf(stderr,"Error: No atoms read from original PDB \
+file\n");
+            return(1);
+         }
+
+         if(!ZStreamOpenStdFiles(NULL, outfile, &in, &out, format))
+         {
+            fprintf(stderr,"Error: Unable to open output file\n");
+            return(1);
+         }
+
+         StatsPhaseStart("MergeConformers");
+         if((pdbNew=MergeConformers(pdbOrig, conf, labels, nconf))
+            ==NULL)
+         {
+            fprintf(stderr,"Error: Merging conformers failed\n");
+            return(1);
+         }
+
+         if(!WritePatched(out, pdbNew, (cifName[0]?cifName:NULL)))
+            return(1);
+         CountStats(pdbNew);
+         return(StatsReport()?0:1);
+      }
       
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(inPlace)
       {
-         if((pdbOrig=blReadPDB(fp, &natoms))==NULL)
+         if(!ZStreamOpenStdFiles(infile, outfile, &in, &out, format))
+         {
+            fprintf(stderr,"Error: Unable to open input or output \
+file\n");
+            return(1);
+         }
+
+         StatsPhaseStart("ReadPDB");
+         if((pdbNew=ReadPDBHy36(in, &natoms))==NULL)
+         {
+            fprintf(stderr,"Error: No atoms read from minimized PDB \
+file\n");
+            return(1);
+         }
+         FixResidueNames(pdbNew);
+
+         StatsPhaseStart("PatchCoordinates");
+         if(!PatchPDBCoordinates(out, fp, pdbNew, addHydrogens,
+                                 &npatched, &nunmatched))
+         {
+            fprintf(stderr,"Error: Patching failed\n");
+            return(1);
+         }
+         StatsPhaseEnd();
+         if(nunmatched)
+            fprintf(stderr,"Warning: %d atoms in the original PDB file \
+were not matched\n", nunmatched);
+         CountStats(pdbNew);
+         StatsAddCount("patched_atoms", npatched);
+         return(StatsReport()?0:1);
+      }
+
+      if(ZStreamOpenStdFiles(infile, outfile, &in, &out, format))
+      {
+         StatsPhaseStart("ReadPDB");
+         if((resOrig=ReadPDBResidueIds(fp, &nres))==NULL)
          {
             fprintf(stderr,"Error: No atoms read from original PDB \
 file\n");
             return(1);
          }
 
-         if((pdbNew=blReadPDB(in, &natoms))==NULL)
+         if((pdbNew=ReadPDBHy36(in, &natoms))==NULL)
          {
             fprintf(stderr,"Error: No atoms read from minimized PDB \
 file\n");
@@ -118,13 +349,18 @@ file\n");
          }
          
             
-         if(!tinkerpatch(pdbNew, pdbOrig))
+         StatsPhaseStart("Patch");
+         if(!PatchResidueIds(pdbNew, resOrig, nres))
          {
             fprintf(stderr,"Error: Patching failed\n");
             return(1);
          }
 
-         blWritePDB(out, pdbNew);
+         if(!WritePatched(out, pdbNew, (cifName[0]?cifName:NULL)))
+            return(1);
+         CountStats(pdbNew);
+         if(!StatsReport())
+            return(1);
       }
       else
       {
@@ -142,84 +378,96 @@ file\n");
 }
 
 
-/************************************************************************/
-/*>BOOL tinkerpatch(PDB *pdbNew, PDB *pdbOld)
-   ------------------------------------------
-*/
-BOOL tinkerpatch(PDB *pdbNew, PDB *pdbOld)
-{
-   PDB *p,
-       *pNewStart,
-       *pNewStop,
-       *pOldStart;
-   int atnum = 0;
-   
-   FixResidueNames(pdbNew);
-   
-   pOldStart = pdbOld;
-   for(pNewStart=pdbNew; pNewStart!=NULL; pNewStart=pNewStop)
-   {
-      if(pOldStart == NULL)
-      {
-         fprintf(stderr,"Error: Original structure ran out of \
-residues!\n");
-      }
-      
-      pNewStop = blFindNextResidue(pNewStart);
-      for(p=pNewStart; p!=pNewStop; NEXT(p))
-      {
-         atnum++;
-         
-         if(strncmp(p->resnam, pOldStart->resnam, 4))
-         {
-            fprintf(stderr,"Error: residue names don't match!\n");
-            blWritePDBRecord(stderr, p);
-            blWritePDBRecord(stderr, pOldStart);
-            return(FALSE);
-         }
-            
-         strcpy(p->chain, pOldStart->chain);
-         p->resnum = pOldStart->resnum;
-         strcpy(p->insert, pOldStart->insert);
-      }
-      pOldStart = blFindNextResidue(pOldStart);
-   }
-
-   return(TRUE);
-}
-
 /************************************************************************/
 /*>void Usage(void)
    ----------------
 */
 void Usage(void)
 {
-   
+   fprintf(stderr,"Usage: tinkerpatch [-S file] [-P] [-z] [-C] orig.pdb \
+[tinker.pdb [out.pdb]]\n");
+   fprintf(stderr,"       tinkerpatch [-S file] [-P] [-z] -i [-H] orig.pdb \
+[tinker.pdb [out.pdb]]\n");
+   fprintf(stderr,"       tinkerpatch [-S file] [-P] [-z] [-C] -m \
+[-t nthreads] [-o prefix] orig.pdb\n");
+   fprintf(stderr,"                   [tinker.pdb ...]\n");
+   fprintf(stderr,"       tinkerpatch [-S file] [-P] [-z] [-C] -a \
+A=confA.pdb,B=confB.pdb[,...] orig.pdb [out.pdb]\n");
+   fprintf(stderr,"       -a  Merge patched conformers written by \
+splitalt, restoring the\n");
+   fprintf(stderr,"           alternate location labels and occupancies \
+from orig.pdb\n");
+   fprintf(stderr,"       -i  Copy orig.pdb replacing only the \
+coordinates\n");
+   fprintf(stderr,"       -H  With -i, also add the hydrogens from \
+tinker.pdb\n");
+   fprintf(stderr,"       -m  Patch each model in the tinker.pdb files \
+(or stdin) and write\n");
+   fprintf(stderr,"           a multi-MODEL PDB file to stdout\n");
+   fprintf(stderr,"       -t  With -m, patch the models using this many \
+threads\n");
+   fprintf(stderr,"       -o  With -m, write each model to \
+prefixN.pdb instead\n");
+   StatsUsage();
+   ZStreamUsage();
+   fprintf(stderr,"       -C  Write mmCIF rather than PDB (the default \
+if out.pdb ends in .cif)\n");
 }
 
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *origFile, 
-                     char *infile, char *outfile)
+                     char *infile, char *outfile, char *mergeSpec,
+                     char *statsFile, BOOL *perfCounters,
+                     BOOL *inPlace, BOOL *addHydrogens, BOOL *multi,
+                     char *outPrefix, int *nthreads, 
+                     char ***modelFiles, int *nModelFiles,
+                     BOOL *compress, BOOL *cif)
    --------------------------------------------------------------
    Input:   int    argc          Argument count
             char   **argv        Argument array
    Output:  char   *origFile
             char   *infile       Input file (or blank string)
             char   *outfile      Output file (or blank string)
+            char   *mergeSpec    Conformers to merge (or blank string)
+            char   *statsFile    Statistics file (or blank string)
+            BOOL   *perfCounters Add hardware performance counters
+            BOOL   *inPlace      Patch coordinates into the original
+            BOOL   *addHydrogens Add hydrogens when patching in place
+            BOOL   *multi        Patch many minimized models
+            char   *outPrefix    Prefix for separate model files (or
+                                 blank string)
+            int    *nthreads     Number of threads for patching models
+            char   ***modelFiles Minimized model files (points into
+                                 argv)
+            int    *nModelFiles  Number of minimized model files
+            BOOL   *compress     Compress output with no .gz/.zst name
+            BOOL   *cif          Write mmCIF rather than PDB
    Returns: BOOL                 Success?
 
    Parse the command line
 
    17.09.15  Original   By: ACRM  
+   19.10.26  Added -a   By: ACRM
+   19.10.26  Added -S   By: ACRM
+   19.10.26  Added -P   By: ACRM
+   19.10.26  Added -i and -H   By: ACRM
+   19.10.26  Added -m, -t and -o   By: ACRM
+   19.10.26  Added -z   By: ACRM
+   19.10.26  Added -C   By: ACRM
 */
 BOOL ParseCmdLine(int argc, char **argv, char *origFile, 
-                  char *infile, char *outfile)
+                  char *infile, char *outfile, char *mergeSpec,
+                  char *statsFile, BOOL *perfCounters, BOOL *inPlace,
+                  BOOL *addHydrogens, BOOL *multi, char *outPrefix,
+                  int *nthreads, char ***modelFiles, int *nModelFiles,
+                  BOOL *compress, BOOL *cif)
 {
    argc--;
    argv++;
 
-   infile[0] = outfile[0] = origFile[0] = '\0';
+   infile[0] = outfile[0] = origFile[0] = mergeSpec[0] = 
+      statsFile[0] = outPrefix[0] = '\0';
    
    if(argc < 1)
    {
@@ -241,6 +489,54 @@ BOOL ParseCmdLine(int argc, char **argv, char *origFile,
             case 'h':
                return(FALSE);
                break;
+            case 'a':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(mergeSpec, argv[0], MAXBUFF-1);
+               mergeSpec[MAXBUFF-1] = '\0';
+               break;
+            case 'S':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(statsFile, argv[0], MAXBUFF-1);
+               statsFile[MAXBUFF-1] = '\0';
+               break;
+            case 'P':
+               *perfCounters = TRUE;
+               break;
+            case 'i':
+               *inPlace = TRUE;
+               break;
+            case 'H':
+               *addHydrogens = TRUE;
+               break;
+            case 'm':
+               *multi = TRUE;
+               break;
+            case 'z':
+               *compress = TRUE;
+               break;
+            case 'C':
+               *cif = TRUE;
+               break;
+            case 'o':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(outPrefix, argv[0], MAXBUFF-1);
+               outPrefix[MAXBUFF-1] = '\0';
+               break;
+            case 't':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%d", nthreads) || (*nthreads < 1))
+                  return(FALSE);
+               if(*nthreads > MAXTHREADS)
+                  *nthreads = MAXTHREADS;
+               break;
             default:
                return(FALSE);
                break;
@@ -249,15 +545,44 @@ BOOL ParseCmdLine(int argc, char **argv, char *origFile,
       }
       else
       {
+         /* -t and -o only apply to -m which is a separate mode         */
+         if(((*nthreads > 1) || outPrefix[0]) && !(*multi))
+            return(FALSE);
+         if(*multi && (*inPlace || *addHydrogens || mergeSpec[0]))
+            return(FALSE);
+
+         /* With -m, the rest are all minimized models                  */
+         if(*multi)
+         {
+            strcpy(origFile, argv[0]);
+            *modelFiles  = argv + 1;
+            *nModelFiles = argc - 1;
+            return(TRUE);
+         }
+
          /* Check that there are 1, 2 or 3 arguments left               */
          if(argc < 1 || argc > 3)
             return(FALSE);
+
+         /* -H only applies to -i which can't be used with -a           */
+         if((*addHydrogens && !(*inPlace)) || (*inPlace && mergeSpec[0]))
+            return(FALSE);
          
          /* Copy the first to origFile                                 */
          strcpy(origFile, argv[0]);
          argc--;
          argv++;
 
+         /* When merging the next is the output file                   */
+         if(mergeSpec[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            if(argc)
+               strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* If there's another, copy it to infile                       */
          if(argc)
          {
@@ -285,18 +610,851 @@ BOOL ParseCmdLine(int argc, char **argv, char *origFile,
 
 
 /************************************************************************/
-/*>void FixResidueNames(PDB *pdb)
-   ------------------------------
+/*>int ReadConformers(char *mergeSpec, PDB **conf, char *labels)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *mergeSpec   Comma-separated list of label=file
+   \param[out]  **conf       PDB linked list for each conformer
+   \param[out]  *labels      Alternate location label for each
+   \return                   Number of conformers read (0 on error)
+
+   Reads the conformer files named in the -a option
+
+-  19.10.26 Original   By: ACRM
 */
-void FixResidueNames(PDB *pdb)
+int ReadConformers(char *mergeSpec, PDB **conf, char *labels)
+{
+   char **items;
+   int  nconf = 0,
+        natoms, 
+        i;
+   FILE *fp;
+
+   if((items=blSplitStringOnCommas(mergeSpec, MAXLABEL))==NULL)
+   {
+      fprintf(stderr,"Error: No memory for conformer list\n");
+      return(0);
+   }
+
+   for(i=0; items[i][0]; i++)
+   {
+      if((items[i][1] != '=') || (items[i][2] == '\0'))
+      {
+         fprintf(stderr,"Error: Conformers must be given as \
+label=file: %s\n", items[i]);
+         return(0);
+      }
+      if(nconf >= MAXCONF)
+      {
+         fprintf(stderr,"Error: Too many conformers\n");
+         return(0);
+      }
+      if((fp=ZStreamOpen(items[i]+2, "r", ZSTREAM_PLAIN))==NULL)
+      {
+         fprintf(stderr,"Error: Unable to open conformer file: %s\n",
+                 items[i]+2);
+         return(0);
+      }
+      if((conf[nconf]=ReadPDBHy36(fp, &natoms))==NULL)
+      {
+         fprintf(stderr,"Error: No atoms read from conformer file: \
+%s\n", items[i]+2);
+         return(0);
+      }
+      ZStreamClose(fp);
+      labels[nconf++] = items[i][0];
+   }
+   labels[nconf] = '\0';
+
+   return(nconf);
+}
+
+
+/************************************************************************/
+/*>PDB *MergeConformers(PDB *orig, PDB **conf, char *labels, int nconf)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *orig     Original PDB with alternate locations
+   \param[in]   **conf    Patched conformers
+   \param[in]   *labels   Alternate location label for each conformer
+   \param[in]   nconf     Number of conformers
+   \return                Merged PDB linked list
+
+   Merges the conformers back into a single structure. The conformers
+   must all contain the same residues in the same order. Residues with
+   no alternate locations in the original are taken from the first
+   conformer. If the conformers have different residue names (micro-
+   heterogeneity) then each conformer's copy of the whole residue is
+   written.
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *MergeConformers(PDB *orig, PDB **conf, char *labels, int nconf)
+{
+   PDB  *merged    = NULL,
+        *last      = NULL,
+        *origStart = NULL,
+        *origStop  = NULL,
+        *start[MAXCONF],
+        *stop[MAXCONF],
+        *p, *q;
+   int  i, 
+        atnum = 0;
+   BOOL hasAlt, 
+        sameNames;
+
+   for(i=0; i<nconf; i++)
+      start[i] = conf[i];
+
+   while(start[0] != NULL)
+   {
+      for(i=0; i<nconf; i++)
+      {
+         if((start[i] == NULL) || !SameResidue(start[0], start[i]))
+         {
+            fprintf(stderr,"Error: Conformer %c does not match \
+conformer %c at residue %s%d%s\n", labels[i], labels[0], 
+                    start[0]->chain, start[0]->resnum, start[0]->insert);
+            FREELIST(merged, PDB);
+            return(NULL);
+         }
+         stop[i] = blFindNextResidue(start[i]);
+      }
+
+      /* Find the residue in the original                               */
+      if((origStart = FindOrigResidue(orig, origStop, start[0]))!=NULL)
+         origStop = blFindNextResidue(origStart);
+
+      hasAlt    = FALSE;
+      for(p=origStart; p!=origStop; NEXT(p))
+      {
+         if((p->altpos != ' ') && (p->altpos != '\0'))
+         {
+            hasAlt = TRUE;
+            break;
+         }
+      }
+
+      sameNames = TRUE;
+      for(i=1; i<nconf; i++)
+      {
+         if(strncmp(start[0]->resnam, start[i]->resnam, 4))
+            sameNames = FALSE;
+      }
+
+      if(!hasAlt)
+      {
+         for(p=start[0]; p!=stop[0]; NEXT(p))
+         {
+            if(AppendAtom(&merged, &last, p, ' ', p->occ)==NULL)
+               return(NULL);
+         }
+      }
+      else if(!sameNames)
+      {
+         for(i=0; i<nconf; i++)
+         {
+            for(p=start[i]; p!=stop[i]; NEXT(p))
+            {
+               if(AppendAtom(&merged, &last, p, labels[i],
+                             AltOccupancy(origStart, origStop, p->atnam,
+                                          labels[i], nconf))==NULL)
+                  return(NULL);
+            }
+         }
+      }
+      else
+      {
+         for(p=start[0]; p!=stop[0]; NEXT(p))
+         {
+            if(!IsAltAtom(origStart, origStop, start, stop, nconf, 
+                          p->atnam))
+            {
+               q = FindAtomInResidue(origStart, origStop, p->atnam, ' ');
+               if(AppendAtom(&merged, &last, p, ' ', 
+                             (q==NULL)?1.0:q->occ)==NULL)
+                  return(NULL);
+            }
+            else
+            {
+               for(i=0; i<nconf; i++)
+               {
+                  if((q=FindAtomInResidue(start[i], stop[i], p->atnam,
+                                          '\0'))!=NULL)
+                  {
+                     if(AppendAtom(&merged, &last, q, labels[i],
+                                   AltOccupancy(origStart, origStop, 
+                                                p->atnam, labels[i],
+                                                nconf))==NULL)
+                        return(NULL);
+                  }
+               }
+            }
+         }
+      }
+
+      for(i=0; i<nconf; i++)
+         start[i] = stop[i];
+   }
+
+   for(p=merged; p!=NULL; NEXT(p))
+      p->atnum = ++atnum;
+
+   return(merged);
+}
+
+
+/************************************************************************/
+/*>BOOL SameResidue(PDB *p, PDB *q)
+   --------------------------------
+*//**
+   Do two atoms have the same chain, residue number and insert code?
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL SameResidue(PDB *p, PDB *q)
+{
+   return((p->resnum == q->resnum) &&
+          !strcmp(p->chain, q->chain) &&
+          (p->insert[0] == q->insert[0]));
+}
+
+
+/************************************************************************/
+/*>PDB *FindOrigResidue(PDB *orig, PDB *from, PDB *res)
+   ----------------------------------------------------
+*//**
+   \param[in]   *orig   Original PDB linked list
+   \param[in]   *from   Where to start looking (may be NULL)
+   \param[in]   *res    Atom from the residue to find
+   \return              Start of the residue in the original (or NULL)
+
+   Residues normally come in the same order so the search starts from
+   the end of the last residue found and only wraps back to the start
+   if needed.
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *FindOrigResidue(PDB *orig, PDB *from, PDB *res)
+{
+   PDB *p;
+
+   for(p=from; p!=NULL; NEXT(p))
+   {
+      if(SameResidue(p, res))
+         return(p);
+   }
+   for(p=orig; p!=from; NEXT(p))
+   {
+      if(SameResidue(p, res))
+         return(p);
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>PDB *FindAtomInResidue(PDB *start, PDB *stop, char *atnam, 
+                          char altpos)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *start   Start of residue
+   \param[in]   *stop    Start of next residue
+   \param[in]   *atnam   Atom name
+   \param[in]   altpos   Alternate location ('\\0' matches any)
+   \return               The atom (or NULL)
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *FindAtomInResidue(PDB *start, PDB *stop, char *atnam, char altpos)
 {
    PDB *p;
+
+   for(p=start; p!=stop; NEXT(p))
+   {
+      if(!strcmp(p->atnam, atnam) &&
+         ((altpos == '\0') || (p->altpos == altpos)))
+         return(p);
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>BOOL IsAltAtom(PDB *origStart, PDB *origStop, PDB **start, 
+                  PDB **stop, int nconf, char *atnam)
+   -----------------------------------------------------------
+*//**
+   \param[in]   *origStart   Start of residue in original
+   \param[in]   *origStop    Start of next residue in original
+   \param[in]   **start      Start of residue in each conformer
+   \param[in]   **stop       Start of next residue in each conformer
+   \param[in]   nconf        Number of conformers
+   \param[in]   *atnam       Atom name
+   \return                   Should the atom be written once per 
+                             conformer?
+
+   If the atom is in the original, it is alternate if it has an
+   alternate location label there. Atoms that were added (hydrogens)
+   are alternate if they moved between conformers.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL IsAltAtom(PDB *origStart, PDB *origStop, PDB **start, PDB **stop,
+               int nconf, char *atnam)
+{
+   PDB *p, *q;
+   int i;
+
+   if((p=FindAtomInResidue(origStart, origStop, atnam, '\0'))!=NULL)
+   {
+      for(; p!=origStop; NEXT(p))
+      {
+         if(!strcmp(p->atnam, atnam) && (p->altpos != ' ') &&
+            (p->altpos != '\0'))
+            return(TRUE);
+      }
+      return(FALSE);
+   }
+
+   p = FindAtomInResidue(start[0], stop[0], atnam, '\0');
+   for(i=1; i<nconf; i++)
+   {
+      if(((q=FindAtomInResidue(start[i], stop[i], atnam, '\0'))==NULL) ||
+         (DISTSQ(p, q) > ALTDISTSQ))
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>REAL AltOccupancy(PDB *origStart, PDB *origStop, char *atnam,
+                     char label, int nconf)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *origStart   Start of residue in original
+   \param[in]   *origStop    Start of next residue in original
+   \param[in]   *atnam       Atom name
+   \param[in]   label        Alternate location label
+   \param[in]   nconf        Number of conformers
+   \return                   Occupancy
+
+   Finds the occupancy of an atom in a given alternate location. Added
+   atoms take the occupancy of any atom in the residue with that label.
+   If the label isn't in the residue, the occupancy is shared equally.
+
+-  19.10.26 Original   By: ACRM
+*/
+REAL AltOccupancy(PDB *origStart, PDB *origStop, char *atnam, 
+                  char label, int nconf)
+{
+   PDB *p;
+
+   if((p=FindAtomInResidue(origStart, origStop, atnam, label))!=NULL)
+      return(p->occ);
+
+   for(p=origStart; p!=origStop; NEXT(p))
+   {
+      if(p->altpos == label)
+         return(p->occ);
+   }
+   return(1.0/nconf);
+}
+
+
+/************************************************************************/
+/*>PDB *AppendAtom(PDB **pdb, PDB **last, PDB *p, char altpos, REAL occ)
+   ---------------------------------------------------------------------
+*//**
+   \param[in,out]  **pdb    Linked list being built
+   \param[in,out]  **last   Last item in the list
+   \param[in]      *p       Atom to copy
+   \param[in]      altpos   Alternate location label to set
+   \param[in]      occ      Occupancy to set
+   \return                  The new atom (NULL and list freed if no
+                            memory)
+
+   Appends a copy of an atom to a linked list
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *AppendAtom(PDB **pdb, PDB **last, PDB *p, char altpos, REAL occ)
+{
+   PDB *q;
+
+   if(*pdb == NULL)
+   {
+      INIT(q, PDB);
+      *pdb = q;
+   }
+   else
+   {
+      q = *last;
+      ALLOCNEXT(q, PDB);
+   }
+
+   if(q == NULL)
+   {
+      fprintf(stderr,"Error: No memory for merged structure\n");
+      FREELIST(*pdb, PDB);
+      return(NULL);
+   }
+
+   blCopyPDB(q, p);
+   q->altpos = altpos;
+   q->occ    = occ;
+   *last     = q;
+
+   return(q);
+}
+
+
+/************************************************************************/
+/*>void CountStats(PDB *pdb)
+   -------------------------
+*//**
+   \param[in]   *pdb   Output PDB linked list
+
+   Records the atom and residue counts for the statistics report
+
+-  19.10.26 Original   By: ACRM
+*/
+void CountStats(PDB *pdb)
+{
+   PDB  *p;
+   long natoms = 0,
+        nres   = 0;
+
+   if(!StatsEnabled())
+      return;
+
+   for(p=pdb; p!=NULL; p=blFindNextResidue(p))
+      nres++;
    for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+
+   StatsAddCount("atoms", natoms);
+   StatsAddCount("residues", nres);
+}
+
+
+/************************************************************************/
+/*>BOOL PatchModels(FILE *fpOrig, char **files, int nfiles, FILE *out,
+                    char *outPrefix, int nthreads, int format)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   *fpOrig      Original PDB file
+   \param[in]   **files      Minimized PDB files
+   \param[in]   nfiles       Number of minimized files (0 for stdin)
+   \param[in]   *out         Output for a multi-MODEL file
+   \param[in]   *outPrefix   Prefix for separate output files (or
+                             blank string for a multi-MODEL file)
+   \param[in]   nthreads     Number of threads
+   \param[in]   format       Compression for separate output files
+   \param[in]   *cifName     mmCIF data block name (NULL for PDB)
+   \return                   Success
+
+   Patches every model in the minimized files against the residue
+   identities of the original, which are read only once. Each thread
+   takes the next model, patches it and writes it to a temporary file.
+   The temporary files are then copied in order to the multi-MODEL
+   output or to their own files.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Added out and format. Separate files are also written via
+            temporary files   By: ACRM
+-  19.10.26 Added cifName   By: ACRM
+*/
+BOOL PatchModels(FILE *fpOrig, char **files, int nfiles, FILE *out,
+                 char *outPrefix, int nthreads, int format, 
+                 char *cifName)
+{
+   MODELQUEUE queue;
+   pthread_t  threads[MAXTHREADS];
+   char       filename[MAXBUFF+16],
+              buffer[MAXBUFF];
+   FILE       *fp;
+   size_t     nread;
+   long       natoms  = 0;
+   int        i, 
+              nstarted = 0;
+   BOOL       ok       = TRUE;
+
+   StatsPhaseStart("ReadPDB");
+   if((queue.resOrig=ReadPDBResidueIds(fpOrig, &queue.nres))==NULL)
+   {
+      fprintf(stderr,"Error: No atoms read from original PDB file\n");
+      return(FALSE);
+   }
+
+   StatsPhaseStart("SplitModels");
+   if((queue.njobs=SplitModels(files, nfiles, &queue.jobs))==0)
+      return(FALSE);
+
+   for(i=0; i<queue.njobs; i++)
+   {
+      if((queue.jobs[i].out=tmpfile()) == NULL)
+      {
+         fprintf(stderr,"Error: Unable to create temporary file\n");
+         return(FALSE);
+      }
+   }
+   
+   StatsPhaseStart("PatchModels");
+   queue.next     = 0;
+   queue.separate = (BOOL)(outPrefix[0] != '\0');
+   queue.cifName  = cifName;
+   pthread_mutex_init(&queue.lock, NULL);
+   if(nthreads > queue.njobs)
+      nthreads = queue.njobs;
+   
+   /* The calling thread does its share too                            */
+   for(i=1; i<nthreads; i++)
+   {
+      if(pthread_create(&threads[nstarted], NULL, PatchModelThread, 
+                        (void *)&queue))
+         break;
+      nstarted++;
+   }
+   PatchModelThread((void *)&queue);
+   for(i=0; i<nstarted; i++)
+      pthread_join(threads[i], NULL);
+   pthread_mutex_destroy(&queue.lock);
+   
+   for(i=0; i<queue.njobs; i++)
+   {
+      if(!queue.jobs[i].ok)
+         ok = FALSE;
+      natoms += queue.jobs[i].natoms;
+      fclose(queue.jobs[i].in);
+   }
+
+   StatsPhaseStart("WritePDB");
+   if(!queue.separate && (cifName != NULL))
+      WriteMMCIFHeader(out, cifName);
+   for(i=0; ok && (i<queue.njobs); i++)
+   {
+      fp = out;
+      if(queue.separate)
+      {
+         sprintf(filename, "%s%d.%s%s", outPrefix, i+1, 
+                 (cifName!=NULL)?"cif":"pdb",
+                 (format==ZSTREAM_GZIP)?".gz":"");
+         if((fp=ZStreamOpen(filename, "w", format)) == NULL)
+         {
+            fprintf(stderr,"Error: Unable to open output file: %s\n",
+                    filename);
+            return(FALSE);
+         }
+      }
+
+      rewind(queue.jobs[i].out);
+      while((nread=fread(buffer, 1, MAXBUFF, queue.jobs[i].out)) > 0)
+         fwrite(buffer, 1, nread, fp);
+      fclose(queue.jobs[i].out);
+
+      if(queue.separate && !ZStreamClose(fp))
+         ok = FALSE;
+   }
+   if(!queue.separate)
    {
-      if(!strncmp(p->resnam, "CYX", 3))
-         strcpy(p->resnam, "CYS ");
-      p->occ = 1.0;
+      if(cifName != NULL)
+         WriteMMCIFTrailer(out);
+      else
+         fprintf(out, "END   \n");
    }
+   StatsPhaseEnd();
+
+   StatsAddCount("models", queue.njobs);
+   StatsAddCount("atoms", natoms);
+
+   free(queue.jobs);
+   free(queue.resOrig);
+   return(ok);
 }
 
 
+/************************************************************************/
+/*>int SplitModels(char **files, int nfiles, MODELJOB **jobs)
+   ----------------------------------------------------------
+*//**
+   \param[in]   **files   Minimized PDB files
+   \param[in]   nfiles    Number of files (0 for stdin)
+   \param[out]  **jobs    One job for each model
+   \return                Number of models (0 on error)
+
+   Copies each model into a temporary file so that the models can be
+   read independently. A file with no MODEL records is a single model.
+
+-  19.10.26 Original   By: ACRM
+*/
+int SplitModels(char **files, int nfiles, MODELJOB **jobs)
+{
+   FILE     *fp,
+            *loose;
+   MODELJOB *job     = NULL;
+   char     buffer[MAXBUFF];
+   int      njobs    = 0,
+            maxjobs  = 0,
+            i;
+   BOOL     gotModel,
+            lineStart;
+
+   *jobs = NULL;
+
+   for(i=0; i<((nfiles)?nfiles:1); i++)
+   {
+      if((fp=ZStreamOpen(nfiles?files[i]:NULL, "r", ZSTREAM_PLAIN))
+         ==NULL)
+      {
+         fprintf(stderr,"Error: Unable to open minimized PDB file: %s\n",
+                 nfiles?files[i]:"stdin");
+         return(0);
+      }
+
+      if((loose=tmpfile())==NULL)
+      {
+         fprintf(stderr,"Error: Unable to create temporary file\n");
+         return(0);
+      }
+
+      gotModel  = FALSE;
+      lineStart = TRUE;
+      job       = NULL;
+      while(fgets(buffer, MAXBUFF, fp))
+      {
+         if(lineStart && !strncmp(buffer, "MODEL ", 6))
+         {
+            if((job=AddModelJob(jobs, &njobs, &maxjobs))==NULL)
+               return(0);
+            gotModel = TRUE;
+         }
+         else if(lineStart && !strncmp(buffer, "ENDMDL", 6))
+         {
+            job = NULL;
+         }
+         else if(job != NULL)
+         {
+            fputs(buffer, job->in);
+         }
+         else if(!gotModel)
+         {
+            fputs(buffer, loose);
+         }
+         lineStart = (BOOL)(strchr(buffer, '\n') != NULL);
+      }
+
+      /* A file without MODEL records is a model on its own            */
+      if(gotModel)
+      {
+         fclose(loose);
+      }
+      else
+      {
+         if((job=AddModelJob(jobs, &njobs, &maxjobs))==NULL)
+            return(0);
+         fclose(job->in);
+         job->in = loose;
+      }
+      
+      ZStreamClose(fp);
+   }
+
+   for(i=0; i<njobs; i++)
+      rewind((*jobs)[i].in);
+
+   return(njobs);
+}
+
+
+/************************************************************************/
+/*>MODELJOB *AddModelJob(MODELJOB **jobs, int *njobs, int *maxjobs)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out]  **jobs     Array of jobs (grown as needed)
+   \param[in,out]  *njobs     Number of jobs
+   \param[in,out]  *maxjobs   Space allocated in jobs
+   \return                    The new job (NULL on error)
+
+   Adds a job with a new temporary file to hold the model
+
+-  19.10.26 Original   By: ACRM
+*/
+MODELJOB *AddModelJob(MODELJOB **jobs, int *njobs, int *maxjobs)
+{
+   MODELJOB *job;
+   
+   if(*njobs == *maxjobs)
+   {
+      int newmax = (*maxjobs) ? 2 * (*maxjobs) : 16;
+
+      if((job=(MODELJOB *)realloc(*jobs, newmax*sizeof(MODELJOB)))
+         ==NULL)
+      {
+         fprintf(stderr,"Error: No memory for models\n");
+         return(NULL);
+      }
+      *jobs    = job;
+      *maxjobs = newmax;
+   }
+
+   job         = (*jobs) + (*njobs);
+   job->out    = NULL;
+   job->natoms = 0;
+   job->ok     = FALSE;
+   if((job->in=tmpfile())==NULL)
+   {
+      fprintf(stderr,"Error: Unable to create temporary file\n");
+      return(NULL);
+   }
+   (*njobs)++;
+   
+   return(job);
+}
+
+
+/************************************************************************/
+/*>void *PatchModelThread(void *arg)
+   ---------------------------------
+*//**
+   \param[in,out]  *arg   The MODELQUEUE
+   \return                NULL
+
+   Takes models from the queue until there are none left, patching each
+   and writing it out. Reading is serialized because bioplib's PDB
+   reader sets global flags.
+
+-  19.10.26 Original   By: ACRM
+*/
+void *PatchModelThread(void *arg)
+{
+   MODELQUEUE *queue = (MODELQUEUE *)arg;
+   MODELJOB   *job;
+   PDB        *pdb;
+   int        model;
+
+   for(;;)
+   {
+      pthread_mutex_lock(&queue->lock);
+      if((model=queue->next) >= queue->njobs)
+      {
+         pthread_mutex_unlock(&queue->lock);
+         break;
+      }
+      queue->next++;
+      job = queue->jobs + model;
+      pdb = ReadPDBHy36(job->in, &job->natoms);
+      pthread_mutex_unlock(&queue->lock);
+
+      if(pdb == NULL)
+      {
+         fprintf(stderr,"Error: No atoms read from model %d\n", model+1);
+         continue;
+      }
+
+      if(PatchResidueIds(pdb, queue->resOrig, queue->nres))
+      {
+         job->ok = TRUE;
+         if(queue->cifName != NULL)
+         {
+            if(queue->separate)
+               job->ok = WriteMMCIF(job->out, pdb, queue->cifName);
+            else
+               job->ok = WriteMMCIFAtoms(job->out, pdb, model+1);
+         }
+         else if(queue->separate)
+         {
+            job->ok = WritePDBHy36(job->out, pdb);
+         }
+         else
+         {
+            job->ok = WriteModel(job->out, pdb, model+1);
+         }
+         if(!job->ok)
+            fprintf(stderr,"Error: Model %d could not be written\n",
+                    model+1);
+      }
+      else
+      {
+         fprintf(stderr,"Error: Patching failed for model %d\n", 
+                 model+1);
+      }
+      FREELIST(pdb, PDB);
+   }
+   
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteModel(FILE *out, PDB *pdb, int model)
+   -----------------------------------------------
+*//**
+   \param[in]   *out     Output file
+   \param[in]   *pdb     PDB linked list
+   \param[in]   model    Model number
+   \return               FALSE if a number was too large for the
+                         PDB columns even in hybrid-36
+
+   Writes the atoms as one MODEL of a multi-model file with a TER
+   record after each chain
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Writes hybrid-36 numbers   By: ACRM
+*/
+BOOL WriteModel(FILE *out, PDB *pdb, int model)
+{
+   PDB  *p;
+   BOOL ok = TRUE;
+
+   fprintf(out, "MODEL     %4d\n", model);
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(!WritePDBRecordHy36(out, p))
+         ok = FALSE;
+      if((p->next == NULL) || !CHAINMATCH(p->chain, p->next->chain))
+         fprintf(out, "TER   \n");
+   }
+   fprintf(out, "ENDMDL\n");
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL WritePatched(FILE *out, PDB *pdb, char *cifName)
+   -----------------------------------------------------
+*//**
+   \param[in]   *out       Output file
+   \param[in]   *pdb       Patched PDB linked list
+   \param[in]   *cifName   mmCIF data block name (NULL for PDB)
+   \return                 Success
+
+   Writes the patched structure as PDB or mmCIF
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WritePatched(FILE *out, PDB *pdb, char *cifName)
+{
+   if(cifName != NULL)
+   {
+      StatsPhaseStart("WriteMMCIF");
+      if(!WriteMMCIF(out, pdb, cifName))
+      {
+         fprintf(stderr,"Error: No memory for mmCIF output\n");
+         return(FALSE);
+      }
+   }
+   else
+   {
+      StatsPhaseStart("WritePDB");
+      if(!WritePDBHy36(out, pdb))
+      {
+         fprintf(stderr,"Error: Too many atoms or residues for PDB \
+format\n");
+         return(FALSE);
+      }
+   }
+   StatsPhaseEnd();
+   return(TRUE);
+}
@@ -40,6 +40,27 @@
 
    ONLY WORKS WITH THE AMBER99 PARAMETER FILE
 
+   With -C, or if the output file ends in .cif, the structure is
+   written as mmCIF. This has no limits on the number of atoms, chain
+   label length or residue numbers, so should be used for very large
+   systems.
+
+   In PDB format, atom serial numbers above 99,999 and residue numbers
+   above 9,999 are written in hybrid-36 (see hybrid36.c), which
+   tinkerpatch can read back.
+
+   With -b, the XYZ files named in a list are all converted with the
+   atom types read once from the parameter file. Each line of the list
+   gives an input file, an output file and optionally the chain labels
+   for that file (as for -c):
+
+      in.xyz out.pdb [chain[,chain...]]
+
+   Blank lines and lines starting with # are skipped. The files are
+   shared between -t threads (each conversion uses a single thread)
+   and a status line (OK or ERROR, the input and the output file) is
+   written to standard output for each, in the order of the list.
+
 **************************************************************************
 
    Usage:
@@ -50,44 +71,87 @@
    Revision History:
    =================
    V1.0   17.09.15  Original   By: ACRM
+   V1.1   19.10.26  Atom type handling moved to tinkertypes.c so it can
+                    be shared with pdbtinker. HETATM flag is now set
+                    from the lookup table   By: ACRM
+   V1.2   19.10.26  Reads via ReadTinkerXYZ(). Added -r to relax the
+                    hydrogens in-process   By: ACRM
+   V1.3   19.10.26  Water and ions are converted separately from the
+                    polymer and each is now its own residue   By: ACRM
+   V1.4   19.10.26  Added -S for timing statistics   By: ACRM
+   V1.5   19.10.26  Name fixing, chain and renumbering passes moved to
+                    pdbfixup.c so they can be benchmarked   By: ACRM
+   V1.6   19.10.26  Added -P for hardware performance counters   By: ACRM
+   V1.7   19.10.26  Reads and writes gzip and zstd compressed files.
+                    Added -z   By: ACRM
+   V1.8   19.10.26  Added -C for mmCIF output   By: ACRM
+   V1.9   19.10.26  Writes hybrid-36 atom serial and residue numbers 
+                    when they overflow the PDB columns   By: ACRM
+   V1.10  19.10.26  Added -t to read the Tinker XYZ file with several
+                    threads   By: ACRM
+   V1.11  19.10.26  -t also writes the PDB file with several threads
+                    By: ACRM
+   V1.12  19.10.26  Conversion moved to xyzpdb.c so tinkerd can share
+                    it. The atom types are read here   By: ACRM
+   V1.13  19.10.26  Added -b to convert a list of files with one read
+                    of the parameter file   By: ACRM
+   V1.14  19.10.26  Added -k and -K for CONECT records from the Tinker
+                    bonds   By: ACRM
+   V1.15  19.10.26  -S and -P handled by StatsSetup()   By: ACRM
 
 *************************************************************************/
+/* pthreads are not ANSI                                                */
+#define _XOPEN_SOURCE 500
+
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/fsscanf.h"
+#include "tinkertypes.h"
+#include "pdbfixup.h"
+#include "stats.h"
+#include "zstream.h"
+#include "cifwrite.h"
+#include "xyzpdb.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF        240
-#define MAXATOMTYPES  5000
-#define MAXTYPELABEL    32
-#define MAXLABEL         8
-#define MAXWORDS         8
-#define MAXCHAINLABEL    8
-#define CNDISTSQ       3.5
-#define CADISTSQ      16.0
 #define TINKERDATA    "TINKERDATA"
+#define MAXTHREADS     256
+#define MAXBATCHLINE  1024
+#define MAXBATCHCHAINS  64
 
-/* Used to store information about fields to look up from the Tinker
-   parameter file
-*/
-typedef struct _lookup
+/* A file to be converted in batch mode                                 */
+typedef struct
 {
-   char *input1;
-   int  input1Len;
-   char *input2;
-   int  input2Len;
-   int  outField;
-   char *output;
-   int  atomField;
-   BOOL het;
-   int  nfields;
-}  LOOKUP;
+   char *infile,
+        *outfile,
+        *chainSpec;       /* Chain labels (NULL for the -c default)     */
+   BOOL ok;
+}  BATCHJOB;
+
+/* The files shared between the threads that convert them              */
+typedef struct
+{
+   BATCHJOB        *jobs;
+   TINKERTYPES     *types;
+   char            **chains;
+   int             njobs,
+                   next,
+                   format;
+   int             conect;
+   BOOL            relax,
+                   cif;
+   pthread_mutex_t lock;
+}  BATCHQUEUE;
 
 
 /************************************************************************/
@@ -95,29 +159,18 @@ typedef struct _lookup
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *paramFile, 
-                  char *infile, char *outfile, char ***chains);
-BOOL tinker2pdb(FILE *in, FILE *paramFp, char **chains, FILE *out);
-void ReadTinkerAtomTypes(FILE *fp, char resnam[MAXATOMTYPES][MAXLABEL], 
-                         char atnam[MAXATOMTYPES][MAXLABEL],
-                         BOOL isHet[MAXATOMTYPES], int maxTypes);
+                  char *infile, char *outfile, char ***chains,
+                  BOOL *relax, char *statsFile, BOOL *perfCounters,
+                  BOOL *compress, BOOL *cif, int *nthreads,
+                  char *batchFile, int *conect);
 void Usage(void);
-void ExtractTypesFromTinkerAtomRecord(char *buffer, char *resnam, 
-                                      char *atnam, BOOL *isHet);
-BOOL ConvertTinkerDescriptionToResnamAndAtnam(
-   char words[MAXWORDS][MAXTYPELABEL], int nwords,
-   char *resnam, char *atnam, BOOL *isHet);
-void PopulatePDBRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
-                       char *resnam, char *atnam, BOOL isHet);
-PDB *ReadTinkerAsPDB(FILE *in, FILE *paramFp, char *header);
-void FixHydrogens(PDB *pdb);
-void FixCterOxygens(PDB *pdb);
-void FixAtomNames(PDB *pdb);
-void FixILECD1(PDB *pdb);
-void InsertNumberInAtnam(PDB *q, int hydrogenNumber);
-char *GetChainLabel(int ChainNum);
-void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet);
-void doFixAtomName(PDB *start, PDB *stop, char *atom, int nChars);
-void RenumberResidues(PDB *pdb);
+BOOL RunBatch(char *batchFile, TINKERTYPES *types, char **chains,
+              BOOL relax, int conect, BOOL cif, int format, 
+              int nthreads);
+int  ReadBatchList(FILE *fp, BATCHJOB **jobs);
+char *CopyWord(char **line);
+void *BatchThread(void *arg);
+BOOL ConvertBatchJob(BATCHQUEUE *queue, BATCHJOB *job);
 
 
 /************************************************************************/
@@ -126,15 +179,30 @@ int main(int argc, char **argv)
    char infile[MAXBUFF],
         outfile[MAXBUFF],
         paramFile[MAXBUFF],
+        statsFile[MAXBUFF],
+        batchFile[MAXBUFF],
+        cifName[MAXCIFNAME],
         **chains = NULL;
    FILE *in  = stdin,
         *out = stdout,
         *pFp = NULL;
-   BOOL noEnv = FALSE;
+   TINKERTYPES *types;
+   BOOL noEnv = FALSE,
+        relax = FALSE,
+        perfCounters = FALSE,
+        compress     = FALSE,
+        cif          = FALSE;
+   int  nthreads     = 1,
+        conect       = CONECT_NONE;
    
     
-   if(ParseCmdLine(argc, argv, paramFile, infile, outfile, &chains))
+   if(ParseCmdLine(argc, argv, paramFile, infile, outfile, &chains,
+                   &relax, statsFile, &perfCounters, &compress, &cif,
+                   &nthreads, batchFile, &conect))
    {
+      if(!StatsSetup("tinkerpdb", statsFile, perfCounters))
+         return(1);
+
       if((pFp=blOpenFile(paramFile, TINKERDATA, "r", &noEnv))==NULL)
       {
          fprintf(stderr,"Error: Unable to open Tinker parameter \
@@ -147,14 +215,42 @@ variable.\n", TINKERDATA);
          
          return(1);
       }
+
+      if(batchFile[0])
+      {
+         if((types=ReadTinkerAtomTypes(pFp))==NULL)
+         {
+            fprintf(stderr,"Error: No memory for Tinker atom types\n");
+            return(1);
+         }
+         return(RunBatch(batchFile, types, chains, relax, conect, cif,
+                         compress?ZSTREAM_GZIP:ZSTREAM_PLAIN, 
+                         nthreads) ? 0 : 1);
+      }
       
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(ZStreamOpenStdFiles(infile, outfile, &in, &out,
+                             compress?ZSTREAM_GZIP:ZSTREAM_PLAIN))
       {
-         if(!tinker2pdb(in, pFp, chains, out))
+         if(cif || IsMMCIFFilename(outfile))
+            MMCIFBlockName(infile, cifName);
+         else
+            cifName[0] = '\0';
+         
+         StatsPhaseStart("ReadTinkerAtomTypes");
+         if((types=ReadTinkerAtomTypes(pFp))==NULL)
+         {
+            fprintf(stderr,"Error: No memory for Tinker atom types\n");
+            return(1);
+         }
+
+         if(!tinker2pdb(in, types, chains, relax, conect, out,
+                        (cifName[0]?cifName:NULL), nthreads))
          {
             fprintf(stderr,"Error: Conversion failed\n");
             return(1);
          }
+         if(!StatsReport())
+            return(1);
       }
       else
       {
@@ -173,7 +269,10 @@ variable.\n", TINKERDATA);
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *paramFile, 
-                     char *infile, char *outfile, char ***chains)
+                     char *infile, char *outfile, char ***chains,
+                     BOOL *relax, char *statsFile, BOOL *perfCounters,
+                     BOOL *compress, BOOL *cif, int *nthreads,
+                     char *batchFile, int *conect)
    --------------------------------------------------------------
    Input:   int    argc          Argument count
             char   **argv        Argument array
@@ -181,19 +280,41 @@ variable.\n", TINKERDATA);
             char   *infile       Input file (or blank string)
             char   *outfile      Output file (or blank string)
             char   ***chains     Chain labels
+            BOOL   *relax        Relax hydrogens before conversion
+            char   *statsFile    Statistics file (or blank string)
+            BOOL   *perfCounters Add hardware performance counters
+            BOOL   *compress     Compress output with no .gz/.zst name
+            BOOL   *cif          Write mmCIF rather than PDB
+            int    *nthreads     Threads for reading and writing, or
+                                 for converting files with -b
+            char   *batchFile    List of files to convert (or blank
+                                 string)
+            int    *conect       CONECT_NONE, CONECT_HET or CONECT_ALL
    Returns: BOOL                 Success?
 
    Parse the command line
 
    17.09.15  Original   By: ACRM  
+   19.10.26  Added -r   By: ACRM
+   19.10.26  Added -S   By: ACRM
+   19.10.26  Added -P   By: ACRM
+   19.10.26  Added -z   By: ACRM
+   19.10.26  Added -C   By: ACRM
+   19.10.26  Added -t   By: ACRM
+   19.10.26  Added -b   By: ACRM
+   19.10.26  Added -k and -K   By: ACRM
 */
 BOOL ParseCmdLine(int argc, char **argv, char *paramFile, 
-                  char *infile, char *outfile, char ***chains)
+                  char *infile, char *outfile, char ***chains,
+                  BOOL *relax, char *statsFile, BOOL *perfCounters,
+                  BOOL *compress, BOOL *cif, int *nthreads,
+                  char *batchFile, int *conect)
 {
    argc--;
    argv++;
 
-   infile[0]   = outfile[0] = paramFile[0] = '\0';
+   infile[0]   = outfile[0] = paramFile[0] = statsFile[0] = '\0';
+   batchFile[0] = '\0';
    
    if(argc < 1)
    {
@@ -231,6 +352,47 @@ BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
                }
                
                break;
+            case 'r':
+               *relax = TRUE;
+               break;
+            case 'S':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(statsFile, argv[0], MAXBUFF-1);
+               statsFile[MAXBUFF-1] = '\0';
+               break;
+            case 'P':
+               *perfCounters = TRUE;
+               break;
+            case 'z':
+               *compress = TRUE;
+               break;
+            case 'C':
+               *cif = TRUE;
+               break;
+            case 'k':
+               *conect = CONECT_HET;
+               break;
+            case 'K':
+               *conect = CONECT_ALL;
+               break;
+            case 'b':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               strncpy(batchFile, argv[0], MAXBUFF-1);
+               batchFile[MAXBUFF-1] = '\0';
+               break;
+            case 't':
+               if(!(--argc))
+                  return(FALSE);
+               argv++;
+               if(!sscanf(argv[0], "%d", nthreads) || (*nthreads < 1))
+                  return(FALSE);
+               if(*nthreads > MAXTHREADS)
+                  *nthreads = MAXTHREADS;
+               break;
             default:
                return(FALSE);
                break;
@@ -242,6 +404,14 @@ BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
          /* Check that there are 1, 2 or 3 arguments left               */
          if(argc < 1 || argc > 3)
             return(FALSE);
+
+         /* With -b, the files come from the list. The statistics are
+            per phase of a single conversion so can't be gathered from
+            several at once
+         */
+         if(batchFile[0] && 
+            ((argc > 1) || statsFile[0] || *perfCounters))
+            return(FALSE);
          
          /* Copy the first to paramFile                                 */
          strcpy(paramFile, argv[0]);
@@ -273,786 +443,325 @@ BOOL ParseCmdLine(int argc, char **argv, char *paramFile,
    return(TRUE);
 }
 
-/************************************************************************/
-BOOL tinker2pdb(FILE *in, FILE *paramFp, char **chains, FILE *out)
-{
-   PDB  *pdb;
-   char header[MAXBUFF];
-   
-   if((pdb=ReadTinkerAsPDB(in, paramFp, header))==NULL)
-      return(FALSE);
-
-   /* Apply chain labels                                                */
-   DoChain(pdb, chains, FALSE);
-   RenumberResidues(pdb);
-
-   WritePDB(out, pdb);
-
-   return(TRUE);
-}
-
-/************************************************************************/
-void ReadTinkerAtomTypes(FILE *fp, char resnam[MAXATOMTYPES][MAXLABEL], 
-                         char atnam[MAXATOMTYPES][MAXLABEL],
-                         BOOL isHet[MAXATOMTYPES], int maxTypes)
-{
-   char buffer[MAXBUFF],
-        atomType[MAXTYPELABEL];
-   int  atnum;
-
-   /* Clear the output arrays                                           */
-   for(atnum=0; atnum<MAXATOMTYPES; atnum++)
-   {
-      resnam[atnum][0] = '\0';
-      atnam[atnum][0]  = '\0';
-   }
-
-   /* Read the 'atom' records from the file                             */
-   while(fgets(buffer, MAXBUFF, fp))
-   {
-      if(!strncmp(buffer,"atom   ", 7))
-      {
-         fsscanf(buffer,"%10x%5d%15x%27s",&atnum, atomType);
-         ExtractTypesFromTinkerAtomRecord(atomType, 
-                                          resnam[atnum], atnam[atnum],
-                                          &(isHet[atnum]));
-
-#ifdef DEBUG
-         fprintf(stdout, "%5d \"%-4s\" : \"%-4s\"\n", 
-                 atnum, resnam[atnum], atnam[atnum]);
-#endif
-      }
-   }
-}
-
-/************************************************************************/
-void ExtractTypesFromTinkerAtomRecord(char *buffer, 
-                                      char *resnam, 
-                                      char *atnam,
-                                      BOOL *isHet)
-{
-   char *ptr,
-         words[MAXWORDS][MAXTYPELABEL];
-   int   nWords;
-
-   /* Remove the double inverted commas                                 */
-   ptr = buffer+1;
-   TERMAT(ptr, '"');
-
-   /* Blank the words                                                   */
-   for(nWords=0; nWords<MAXWORDS; nWords++)
-      words[nWords][0] = '\0';
-
-   /* Split the string into words                                       */
-   nWords=0;
-   while((ptr=blGetWord(ptr, words[nWords], MAXTYPELABEL))!=NULL)
-   {
-      if(nWords>=MAXWORDS)
-         break;
-      nWords++;
-   }
-   nWords++;
-
-#ifdef DEBUG
-   {
-      int i;
-      for(i=0; i<MAXWORDS; i++)
-      {
-         fprintf(stdout,"%s :", words[i]);
-      }
-      fprintf(stdout,"\n");
-   }
-#endif
-
-   ConvertTinkerDescriptionToResnamAndAtnam(words, nWords, 
-                                            resnam, atnam, isHet);
-}
-
-
-
-
-/************************************************************************/
-BOOL ConvertTinkerDescriptionToResnamAndAtnam(
-   char words[MAXWORDS][MAXTYPELABEL], int nwords,
-   char *resnam, char *atnam, BOOL *isHet)
-{
-   static LOOKUP
-      lookup[] = {{"Gly",      3, NULL,    0, 0, "GLY ", 1, FALSE, 2},
-                  {"Ala",      3, NULL,    0, 0, "ALA ", 1, FALSE, 2},
-                  {"Val",      3, NULL,    0, 0, "VAL ", 1, FALSE, 2},
-                  {"Leu",      3, NULL,    0, 0, "LEU ", 1, FALSE, 2},
-                  {"Iso",      3, NULL,    0, 0, "ILE ", 1, FALSE, 2},
-                  {"Ser",      3, NULL,    0, 0, "SER ", 1, FALSE, 2},
-                  {"Thr",      3, NULL,    0, 0, "THR ", 1, FALSE, 2},
-                  {"Cys",      3, NULL,    0, 0, "CYS ", 2, FALSE, 3},
-                  {"Pro",      3, NULL,    0, 0, "PRO ", 1, FALSE, 2},
-                  {"Phe",      3, NULL,    0, 0, "PHE ", 1, FALSE, 2},
-                  {"Tyr",      3, NULL,    0, 0, "TYR ", 1, FALSE, 2},
-                  {"Try",      3, NULL,    0, 0, "TRP ", 1, FALSE, 2},
-                  {"His",      3, NULL,    0, 0, "HIS ", 2, FALSE, 3},
-                  {"Aspartic", 8, NULL,    0, 0, "ASP ", 2, FALSE, 3},
-                  {"Asparagi", 8, NULL,    0, 0, "ASN ", 1, FALSE, 2},
-                  {"Glutamic", 8, NULL,    0, 0, "GLU ", 2, FALSE, 3},
-                  {"Glutamin", 8, NULL,    0, 0, "GLN ", 1, FALSE, 2},
-                  {"Methioni", 8, NULL,    0, 0, "MET ", 1, FALSE, 2},
-                  {"Lys",      3, NULL,    0, 0, "LYS ", 1, FALSE, 2},
-                  {"Arg",      3, NULL,    0, 0, "ARG ", 1, FALSE, 2},
-                  {"Orn",      3, NULL,    0, 0, "ORN ", 1, TRUE,  2},
-                  {"MethylAl", 8, NULL,    0, 0, "AIB ", 1, TRUE,  2},
-                  {"Pyr",      3, NULL,    0, 0, "GLU ", 1, FALSE, 2},
-                  {"Formyl",   6, NULL,    0, 0, "FOR ", 1, TRUE,  2},
-                  {"Acetyl",   6, NULL,    0, 0, "ACE ", 1, TRUE,  2},
-                  {"N-MeAmid", 8, NULL,    0, 0, "VAL ", 1, TRUE,  2},
-                  {"N-Term",   6, "AIB",   3, 1, NULL,   2, TRUE,  3},
-                  {"N-Term",   6, NULL,    0, 1, NULL,   2, FALSE, 3},
-                  {"N-Term",   6, NULL,    0, 1, NULL,   3, FALSE, 4},
-                  {"C-Term",   6, "Amide", 5, 0, "CTER", 2, FALSE, 3},
-                  {"C-Term",   6, "AIB",   3, 1, NULL,   2, TRUE,  3},
-                  {"C-Term",   6, "ORN",   3, 1, NULL,   2, TRUE,  3},
-                  {"C-Term",   6, NULL,    0, 1, NULL,   2, FALSE, 3},
-                  {"C-Term",   6, NULL,    0, 1, NULL,   3, FALSE, 4},
-                  {"R-Aden",   6, NULL,    0, 0, "  A ", 1, FALSE, 2},
-                  {"R-Guan",   6, NULL,    0, 0, "  G ", 1, FALSE, 2},
-                  {"R-Cyto",   6, NULL,    0, 0, "  C ", 1, FALSE, 2},
-                  {"R-Urac",   6, NULL,    0, 0, "  U ", 1, FALSE, 2},
-                  {"D-Aden",   6, NULL,    0, 0, " DA ", 1, FALSE, 2},
-                  {"D-Guan",   6, NULL,    0, 0, " DG ", 1, FALSE, 2},
-                  {"D-Cyto",   6, NULL,    0, 0, " DC ", 1, FALSE, 2},
-                  {"D-Urac",   6, NULL,    0, 0, " DU ", 1, FALSE, 2},
-                  {"D-Thym",   6, NULL,    0, 0, " DT ", 1, FALSE, 2},
-                  
-                  {"R-Phos",   6, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  {"R-5'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
-                  {"R-5'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  {"R-3'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
-                  {"R-3'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  {"D-Phos",   6, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  {"D-5'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
-                  {"D-5'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  {"D-3'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
-                  {"D-3'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
-                  
-                  {"TIP3P",    5, NULL,    0, 0, "HOH ", 1, TRUE,  2},
-                  {"Li+",      3, NULL,    0, 0, "LI  ", 0, TRUE,  3},
-                  {"Na+",      3, NULL,    0, 0, "NA  ", 0, TRUE,  3},
-                  {"K+",       2, NULL,    0, 0, "K   ", 0, TRUE,  3},
-                  {"Rb+",      3, NULL,    0, 0, "RB  ", 0, TRUE,  3},
-                  {"Cs+",      3, NULL,    0, 0, "CS  ", 0, TRUE,  3},
-                  {"Mg+",      3, NULL,    0, 0, "MG  ", 0, TRUE,  3},
-                  {"Ca+",      3, NULL,    0, 0, "CA  ", 0, TRUE,  3},
-                  {"Zn+",      3, NULL,    0, 0, "ZN  ", 0, TRUE,  3},
-                  {"Ba+",      3, NULL,    0, 0, "BA  ", 0, TRUE,  3},
-                  {"Cl-",      3, NULL,    0, 0, "CL  ", 0, TRUE,  3},
-                  {NULL,       0, NULL,    0, 0, NULL,   0, TRUE,  0}
-   };
-
-   int i;
-   for(i=0; lookup[i].input1!=NULL; i++)
-   {
-      LOOKUP *l = &(lookup[i]);
-      
-      /* If we have the right number of fields                          */
-      if(l->nfields == nwords)
-      {
-         /* If the first field matches                                  */
-         if(!strncmp(l->input1, words[0], l->input1Len))
-         {
-            /* If we don't need to check the second field, or we do
-               and it matches    
-            */
-            if((l->input2Len == 0) ||
-               !strncmp(l->input2, words[1], l->input2Len))
-            {
-               /* We have a match.
-                  If we have an output field specified, use that, 
-                  otherwise use the one in the lookup structure
-               */
-               if(l->outField)
-               {
-                  strcpy(resnam, words[l->outField]);
-               }
-               else
-               {
-                  strcpy(resnam, l->output);
-               }
-               PADMINTERM(resnam, 4);
-               
-
-               /* Now get the atom field                                */
-               if(!strncmp(words[l->atomField], "Oxygen", 6))
-               {
-                  strcpy(atnam, " O  ");
-               }
-               else if(!strncmp(words[l->atomField], "Hydrogen", 8))
-               {
-                  strcpy(atnam, " H  ");
-               }
-               else
-               {
-                  BOOL ion = FALSE;
-                  char inputAtnam[MAXLABEL];
-                  
-                  strncpy(inputAtnam, words[l->atomField], MAXLABEL);
-
-                  /* See if it's an ion                                 */
-                  if(strchr(inputAtnam, '+') || strchr(inputAtnam, '-'))
-                     ion = TRUE;
-                  
-                  /* Remove any charge information and up-case          */
-                  TERMAT(inputAtnam, '+');
-                  TERMAT(inputAtnam, '-');
-                  UPPER(inputAtnam);
-
-                  if(ion)    /* It's an ion                             */
-                  {
-                     /* If it's one character, we need a leading space  */
-                     if(strlen(inputAtnam) == 1)
-                     {
-                        strcpy(atnam, " ");
-                     }
-                     strcat(atnam, inputAtnam);
-                  }
-                  else       /* It's a normal atom                      */
-                  {
-                     if(strlen(inputAtnam) == 4)
-                     {
-                        /* If it's 4 characters, move the last to the
-                           start
-                        */
-                        atnam[0] = inputAtnam[3];
-                        atnam[1] = '\0';
-                        inputAtnam[3] = '\0';
-                        strcat(atnam, inputAtnam);
-                     }
-                     else
-                     {
-                        /* Insert a leading space                       */
-                        strcpy(atnam, " ");
-                        strcat(atnam, inputAtnam);
-                     }
-                  }
-                  
-               }
-               PADMINTERM(atnam, 4);
-
-               return(TRUE);
-            }
-         }
-      }
-      
-   }
-
-   return(FALSE);
-}
-
-
-
-
 /************************************************************************/
 void Usage(void)
 {
-   fprintf(stderr,"Usage: \n");
+   fprintf(stderr,"Usage: tinkerpdb [-c chain[,chain...]] [-r] [-S file] \
+[-P] [-z] [-C]\n");
+   fprintf(stderr,"                 [-k|-K] [-t nthreads] paramfile \
+[in.xyz [out.pdb]]\n");
+   fprintf(stderr,"       tinkerpdb -b listfile [-c chain[,chain...]] \
+[-r] [-z] [-C] [-k|-K]\n");
+   fprintf(stderr,"                 [-t nthreads] paramfile\n");
+   fprintf(stderr,"       -c  Specify chain labels\n");
+   fprintf(stderr,"       -r  Relax the hydrogen positions (a fast \
+alternative to running\n");
+   fprintf(stderr,"           Tinker minimize on the hydrogens)\n");
+   StatsUsage();
+   ZStreamUsage();
+   fprintf(stderr,"       -C  Write mmCIF rather than PDB (the default \
+if out.pdb ends in .cif)\n");
+   fprintf(stderr,"       -k  Write CONECT records for HETATMs (other \
+than water) from the\n");
+   fprintf(stderr,"           Tinker bonds\n");
+   fprintf(stderr,"       -K  Write CONECT records for all atoms from \
+the Tinker bonds\n");
+   fprintf(stderr,"       -t  Read the Tinker XYZ file and write the PDB \
+file using this many\n");
+   fprintf(stderr,"           threads\n");
+   fprintf(stderr,"       -b  Convert each 'in.xyz out.pdb [chains]' \
+line of listfile (- for\n");
+   fprintf(stderr,"           stdin), reading the parameter file once. \
+-t sets the number\n");
+   fprintf(stderr,"           of files converted at once\n");
 }
 
 
-
 /************************************************************************/
-PDB *ReadTinkerAsPDB(FILE *in, FILE *paramFp, char *header)
+/*>BOOL RunBatch(char *batchFile, TINKERTYPES *types, char **chains,
+                 BOOL relax, int conect, BOOL cif, int format, 
+                 int nthreads)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   *batchFile  List of files to convert (- for stdin)
+   \param[in]   *types      Tinker atom types
+   \param[in]   **chains    Default chain labels (or NULL)
+   \param[in]   relax       Relax the hydrogens?
+   \param[in]   conect      CONECT_NONE, CONECT_HET or CONECT_ALL
+   \param[in]   cif         Write mmCIF?
+   \param[in]   format      ZSTREAM_ format for the output files
+   \param[in]   nthreads    Number of files converted at once
+   \return                  Were all the files converted?
+
+   Converts each file in the list using nthreads threads and reports
+   the status of each on stdout in the order of the list.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Added conect   By: ACRM
+*/
+BOOL RunBatch(char *batchFile, TINKERTYPES *types, char **chains,
+              BOOL relax, int conect, BOOL cif, int format, 
+              int nthreads)
 {
-   char buffer[MAXBUFF];
-   PDB  *pdb = NULL,
-        *p   = NULL;
-   char tinkerAtomTypesResnam[MAXATOMTYPES][MAXLABEL],
-        tinkerAtomTypesAtnam[MAXATOMTYPES][MAXLABEL];
-   BOOL tinkerAtomTypesIsHet[MAXATOMTYPES];
-   int atnum, atomType;
-   char tinkerAtnam[MAXLABEL];
-   REAL x, y, z;
-      
-
-   ReadTinkerAtomTypes(paramFp, 
-                       tinkerAtomTypesResnam, 
-                       tinkerAtomTypesAtnam, 
-                       tinkerAtomTypesIsHet, MAXATOMTYPES);
-
-   
-   /* Read the header line                                              */
-   fgets(buffer, MAXBUFF, in);
-   strcpy(header, buffer+8);
-
-   /* Read the coordinates. We will put the atom type in formal_charge  */
-   while(fgets(buffer, MAXBUFF, in))
+   BATCHQUEUE queue;
+   pthread_t  threads[MAXTHREADS];
+   FILE       *fp;
+   int        i, 
+              nstarted = 0;
+   BOOL       ok       = TRUE;
+
+   if(!strcmp(batchFile, "-"))
    {
-      if(pdb==NULL)
-      {
-         INIT(pdb, PDB);
-         p=pdb;
-      }
-      else
-      {
-         ALLOCNEXT(p, PDB);
-      }
-
-      if(p==NULL)
-      {
-         FREELIST(pdb, PDB);
-         return(FALSE);
-      }
-         
-      fsscanf(buffer,"%6d%2x%2s%1x%12.6lf%12.6lf%12.6lf%1x%5d",
-              &atnum, tinkerAtnam, &x, &y, &z, &atomType);
-
-      PopulatePDBRecord(p, atnum, x, y, z, 
-                        tinkerAtomTypesResnam[atomType],
-                        tinkerAtomTypesAtnam[atomType],
-                        tinkerAtomTypesIsHet[atomType]);
+      fp = stdin;
    }
-
-   FixHydrogens(pdb);
-   FixCterOxygens(pdb);
-   FixAtomNames(pdb);
-   FixILECD1(pdb);
-   
-   return(pdb);
-}
-
-void FixHydrogens(PDB *pdb)
-{
-   PDB *p, 
-       *firstHydrogen;
-
-   BOOL inHydrogens    = FALSE;
-   int  hydrogenNumber = 2;
-
-   for(p=pdb; p!=NULL; NEXT(p))
+   else if((fp=fopen(batchFile, "r"))==NULL)
    {
-      if(!inHydrogens)    /* Not currently in a block of hydrogens   */
-      {
-         if(p->atnam[0] == 'H')
-         {
-            inHydrogens    = TRUE;
-            firstHydrogen  = p;
-            hydrogenNumber = 2;
-         }
-      }
-      else                /* Already in a block of hydrogens         */
-      {
-         if(p->atnam[0] != 'H')
-         {
-            /* Just come out of a block of hydrogens                 
-               If this wasn't the atom immediately after the current
-               firstHydrogen, then we need to put a '1' into the
-               name of the firstHydrogen
-            */
-#ifdef DEBUG
-            fprintf(stdout,"START\n");
-            blWritePDBRecord(stdout,firstHydrogen);
-            blWritePDBRecord(stdout,p);
-            fprintf(stdout,"STOP\n");
-#endif
-            
-            if(firstHydrogen->next != p)
-            {
-               InsertNumberInAtnam(firstHydrogen, 1);
-            }
-            
-            inHydrogens    = FALSE;
-            hydrogenNumber = 2;
-         }
-         else /* Still in hydrogens, but check if label has changed  */
-         {
-            if(strncmp(p->atnam, firstHydrogen->atnam, 4))
-            {
-               /* Label has changed
-                  If this wasn't the atom immediately after the current
-                  firstHydrogen, then we need to put a '1' into the
-                  name of the firstHydrogen
-               */
-               if(firstHydrogen->next != p)
-               {
-                  InsertNumberInAtnam(firstHydrogen, 1);
-               }
-               /* Update the firstHydrogen to this atom since it's the
-                  start of a new block
-               */
-               firstHydrogen  = p;
-               hydrogenNumber = 2;
-            }
-            else  /* Label is the same                               */
-            {
-               /* We need to update the hydrogen atom label          */
-               InsertNumberInAtnam(p, hydrogenNumber++);
-            }
-         }
-      }
+      fprintf(stderr,"Error: Unable to open list file: %s\n", batchFile);
+      return(FALSE);
    }
-}
-
-/************************************************************************/
-void InsertNumberInAtnam(PDB *p, int hydrogenNumber)
-{
-   char buffer[MAXLABEL],
-        *ptr;
 
-   sprintf(buffer, "%d", hydrogenNumber);
-
-   if((ptr=strchr(p->atnam, ' '))!=NULL)
+   queue.njobs = ReadBatchList(fp, &queue.jobs);
+   if(fp != stdin)
+      fclose(fp);
+   if(queue.njobs <= 0)
    {
-      *ptr = buffer[0];
+      if(queue.njobs == 0)
+         fprintf(stderr,"Error: No files listed in %s\n", batchFile);
+      return(FALSE);
    }
 
-   if((ptr=strchr(p->atnam_raw+1, ' '))!=NULL)
+   queue.types  = types;
+   queue.chains = chains;
+   queue.relax  = relax;
+   queue.conect = conect;
+   queue.cif    = cif;
+   queue.format = format;
+   queue.next   = 0;
+   pthread_mutex_init(&queue.lock, NULL);
+   if(nthreads > queue.njobs)
+      nthreads = queue.njobs;
+
+   /* The calling thread does its share too                            */
+   for(i=1; i<nthreads; i++)
    {
-      *ptr = buffer[0];
-   }
-   else if((ptr=strchr(p->atnam_raw, ' '))!=NULL)
-   {
-      *ptr = buffer[0];
+      if(pthread_create(&threads[nstarted], NULL, BatchThread, 
+                        (void *)&queue))
+         break;
+      nstarted++;
    }
-}
-
+   BatchThread((void *)&queue);
+   for(i=0; i<nstarted; i++)
+      pthread_join(threads[i], NULL);
+   pthread_mutex_destroy(&queue.lock);
 
-
-/************************************************************************/
-void FixCterOxygens(PDB *pdb)
-{
-   PDB *p, *q, 
-       *nextRes;
-
-   for(p=pdb; p!=NULL; p=nextRes)
+   for(i=0; i<queue.njobs; i++)
    {
-      BOOL GotOXT = FALSE;
-      
-      nextRes = blFindNextResidue(p);
-      for(q=p; q!=nextRes; NEXT(q))
-      {
-         if(!strncmp(q->atnam, "OXT ", 4))
-         {
-            if(!GotOXT)
-            {
-               strcpy(q->atnam,     "O   ");
-               strcpy(q->atnam_raw, " O  ");
-            }
-            GotOXT = TRUE;
-         }
-      }
+      printf("%s %s %s\n", (queue.jobs[i].ok?"OK":"ERROR"),
+             queue.jobs[i].infile, queue.jobs[i].outfile);
+      if(!queue.jobs[i].ok)
+         ok = FALSE;
+      free(queue.jobs[i].infile);
+      free(queue.jobs[i].outfile);
+      if(queue.jobs[i].chainSpec != NULL)
+         free(queue.jobs[i].chainSpec);
    }
+   free(queue.jobs);
+   
+   return(ok);
 }
 
 
 /************************************************************************/
-void FixILECD1(PDB *pdb)
-{
-   PDB *p;
-   for(p=pdb; p!=NULL; NEXT(p))
-   {
-      if(!strncmp(p->resnam, "ILE", 3) &&
-         !strncmp(p->atnam,  "CD  ", 4))
-      {
-         strcpy(p->atnam,     "CD1 ");
-         strcpy(p->atnam_raw, " CD1");
-      }
-   }
-}
+/*>int ReadBatchList(FILE *fp, BATCHJOB **jobs)
+   --------------------------------------------
+*//**
+   \param[in]   *fp      List file
+   \param[out]  **jobs   Malloc'd array of files to convert
+   \return               Number of files (-1 on error)
 
+   Reads the 'in.xyz out.pdb [chains]' lines of the list. Blank lines
+   and lines starting with # are skipped.
 
-/************************************************************************/
-void FixAtomNames(PDB *pdb)
+-  19.10.26 Original   By: ACRM
+*/
+int ReadBatchList(FILE *fp, BATCHJOB **jobs)
 {
-   PDB *p, *q, 
-       *nextRes;
-
-   for(p=pdb; p!=NULL; p=nextRes)
+   char     buffer[MAXBATCHLINE],
+            *line;
+   BATCHJOB *job;
+   int      njobs   = 0,
+            maxjobs = 0,
+            lineNum = 0;
+
+   *jobs = NULL;
+   while(fgets(buffer, MAXBATCHLINE, fp))
    {
-      nextRes = blFindNextResidue(p);
-
-      if(!strncmp(p->resnam, "ASP", 3) ||
-         !strncmp(p->resnam, "GLU", 3))
+      lineNum++;
+      line = buffer;
+      while(isspace(*line))
+         line++;
+      if((*line == '\0') || (*line == '#'))
+         continue;
+
+      if(njobs == maxjobs)
       {
-         for(q=p; q!=nextRes; NEXT(q))
+         maxjobs = maxjobs ? 2*maxjobs : 64;
+         if((job=(BATCHJOB *)realloc(*jobs, maxjobs*sizeof(BATCHJOB)))
+            == NULL)
          {
-            doFixAtomName(p, nextRes, "OD  ", 4);
-            doFixAtomName(p, nextRes, "OE  ", 4);
+            fprintf(stderr,"Error: No memory for list of files\n");
+            return(-1);
          }
+         *jobs = job;
       }
 
-      if(!strncmp(p->resnam, "TYR", 3) ||
-         !strncmp(p->resnam, "PHE", 3))
+      job            = *jobs + njobs;
+      job->ok        = FALSE;
+      job->infile    = CopyWord(&line);
+      job->outfile   = CopyWord(&line);
+      job->chainSpec = CopyWord(&line);
+      if((job->infile == NULL) || (job->outfile == NULL))
       {
-         doFixAtomName(p, nextRes, "CD  ", 4);
-         doFixAtomName(p, nextRes, "CE  ", 4);
+         fprintf(stderr,"Error: Line %d of the list file needs an \
+input and an output file\n", lineNum);
+         return(-1);
       }
-      
-      if(!strncmp(p->resnam, "ARG", 3))
+      if(CopyWord(&line) != NULL)
       {
-         doFixAtomName(p, nextRes, "NH  ", 4);
+         fprintf(stderr,"Error: Line %d of the list file has too many \
+fields\n", lineNum);
+         return(-1);
       }
-      
+      njobs++;
    }
-}
 
-void doFixAtomName(PDB *start, PDB *stop, char *atom, int nChars)
-{
-   PDB *p;
-   int count = 1;
-   
-   for(p=start; p!=stop; NEXT(p))
-   {
-      if(!strncmp(p->atnam, atom, nChars))
-      {
-         InsertNumberInAtnam(p, count++);
-      }
-   }
+   return(njobs);
 }
 
 
-
 /************************************************************************/
-void PopulatePDBRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
-                       char *resnam, char *atnam, BOOL isHet)
+/*>char *CopyWord(char **line)
+   ---------------------------
+*//**
+   \param[in,out] **line   Line being split (moved past the word)
+   \return                 Malloc'd copy of the next white space 
+                           delimited word (NULL if none or no memory)
+
+-  19.10.26 Original   By: ACRM
+*/
+char *CopyWord(char **line)
 {
-   static int resnum = 0;
-   CLEAR_PDB(p);
-   strcpy(p->record_type, (isHet?"HETATM":"ATOM  "));
-   p->atnum = atnum;
-   strcpy(p->atnam_raw, atnam);
-   strcpy(p->atnam, (atnam[0]==' '?atnam+1:atnam));
-   PADMINTERM(p->atnam, 4);
-   strcpy(p->resnam, resnam);
-   PADMINTERM(p->resnam, 4);
-   if(!strncmp(atnam, " N  ", 4))
-      resnum++;
-   p->resnum = resnum;
-   p->x = x;   p->y = y;   p->z = z;
-   p->occ = 1.0;
-   blSetElementSymbolFromAtomName(p->element, atnam);
+   char *start,
+        *word;
+   int  len;
+
+   while(isspace(**line))
+      (*line)++;
+   start = *line;
+   while(**line && !isspace(**line))
+      (*line)++;
+   if((len = *line - start) == 0)
+      return(NULL);
+
+   if((word=(char *)malloc(len+1))==NULL)
+      return(NULL);
+   strncpy(word, start, len);
+   word[len] = '\0';
+   return(word);
 }
 
 
 /************************************************************************/
-/*>void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet)
-   ---------------------------------------------------------
+/*>void *BatchThread(void *arg)
+   ----------------------------
 *//**
+   \param[in,out]  *arg   The BATCHQUEUE
+   \return                NULL
 
-   \param[in,out]  *pdb            PDB linked list
-   \param[in]      *chains         Chain labels (or blank string)
-   \param[in]      BumpChainOnHet  Bump the chain label when a HETATM
-                                   is found
-
-   Do the actual chain naming.
+   Takes files from the queue until there are none left, converting
+   each.
 
-   *** CODE TAKEN FROM pdbchain.c ***
-
--  12.07.94 Original    By: ACRM
--  25.07.94 Only increments ch if *ch != \0
--  04.01.95 Added check on HETATM records
--  27.01.95 ChainNum count now mod 26 so labels will cycle A-Z
--  16.10.95 Handles BumpChainOnHet
--  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
--  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
--  10.03.15 Chains is now an array
+-  19.10.26 Original   By: ACRM
 */
-void DoChain(PDB *pdb, char **chains, BOOL BumpChainOnHet)
+void *BatchThread(void *arg)
 {
-   PDB  *p,
-        *start,
-        *end,
-        *LastStart = NULL,
-        *N         = NULL,
-        *C         = NULL,
-        *CPrev     = NULL,
-        *CAPrev    = NULL,
-        *CA        = NULL;
-   int  ChainNum   = 0,
-        ChainIndex = 0;
-   char chain[MAXCHAINLABEL];
-   BOOL NewChain;
-   
+   BATCHQUEUE *queue = (BATCHQUEUE *)arg;
+   BATCHJOB   *job;
 
-   if((chains!=NULL) && chains[ChainIndex][0])
-      strcpy(chain, chains[ChainIndex++]);
-   else
-      strcpy(chain, "A");
-   
-   for(start=pdb; start!=NULL; start=end)
+   for(;;)
    {
-      NewChain = FALSE;
-      end = blFindNextResidue(start);
-
-      CA = N = C = NULL;
-      
-      for(p=start; p!=end; NEXT(p))
+      pthread_mutex_lock(&queue->lock);
+      if(queue->next >= queue->njobs)
       {
-         if(!strncmp(p->atnam,"CA  ",4)) CA  = p;
-         if(!strncmp(p->atnam,"N   ",4)) N   = p;
-         if(!strncmp(p->atnam,"C   ",4)) C   = p;
-      }
-
-      if(CPrev != NULL && N != NULL)
-      {
-         /* A C was defined in the last residue and an N in this one
-            Calc C-N distance
-         */
-         if(DISTSQ(CPrev, N) > CNDISTSQ)
-            NewChain = TRUE;
-      }
-      else if(CAPrev != NULL && CA != NULL)
-      {
-         /* No C-N connection, but a CAs found
-            Calc CA-CA distance
-         */
-         if(DISTSQ(CAPrev, CA) > CADISTSQ)
-            NewChain = TRUE;
-      }
-      else if(LastStart != NULL)
-      {
-         char buffer[80],
-              atoms[80];
-         
-         /* Build string specifying faulty residues                     */
-         if((CPrev == NULL || CAPrev == NULL) &&
-            (N     == NULL || CA     == NULL))
-            sprintf(buffer,"residues %s.%d%c and %s.%d%c",
-                    LastStart->chain,LastStart->resnum,
-                    LastStart->insert[0],
-                    start->chain,start->resnum,start->insert[0]);
-         else if(CPrev == NULL || CAPrev == NULL)
-            sprintf(buffer,"residue %s.%d%c",
-                    LastStart->chain,LastStart->resnum,
-                    LastStart->insert[0]);
-         else
-            sprintf(buffer,"residue %s.%d%c",
-                    start->chain,start->resnum,start->insert[0]);
-
-         /* Build string specifying faulty atoms                        */
-         atoms[0] = '\0';
-         if(CAPrev == NULL || CA == NULL) strcat(atoms,"CA ");
-         if(N      == NULL)               strcat(atoms,"N ");
-         if(CPrev  == NULL)               strcat(atoms,"C ");
-
-         /* Print warning message                                       */
-         if((LastStart != NULL && 
-             strncmp(LastStart->record_type, "HETATM", 6)) &&
-            (start     != NULL && 
-             strncmp(start->record_type,     "HETATM", 6)))
-            fprintf(stderr, "Warning: Atoms missing in %s: %s\n",
-                    buffer, atoms);
-
-         if(BumpChainOnHet &&
-            (LastStart != NULL && 
-             !strncmp(LastStart->record_type, "HETATM", 6)) &&
-            (start     != NULL && 
-             !strncmp(start->record_type,     "ATOM  ",6)))
-            NewChain = TRUE;
-      }
-
-      /* If we've changed chain, set the new chain name                 */
-      if(NewChain)
-      {
-         ChainNum++;
-         
-         if((chains!=NULL) && chains[ChainIndex][0])
-         {
-            strcpy(chain,chains[ChainIndex++]);
-         }
-         else
-         {
-            strcpy(chain, GetChainLabel(ChainNum));
-         }
+         pthread_mutex_unlock(&queue->lock);
+         break;
       }
+      job = queue->jobs + queue->next++;
+      pthread_mutex_unlock(&queue->lock);
 
-      /* Copy the name into this residue                                */
-      for(p=start; p!=end; NEXT(p))
-         strcpy(p->chain, chain);
-      
-      /* Set pointers for next residue                                  */
-      CAPrev    = CA;
-      CPrev     = C;
-      LastStart = start;
+      job->ok = ConvertBatchJob(queue, job);
    }
+   
+   return(NULL);
 }
 
 
 /************************************************************************/
-/*>char *GetChainLabel(int ChainNum)
-   ---------------------------------
+/*>BOOL ConvertBatchJob(BATCHQUEUE *queue, BATCHJOB *job)
+   ------------------------------------------------------
 *//**
-   \param[in]  ChainNum    Chain number
-   \return                 Chain label 
+   \param[in]   *queue   The BATCHQUEUE with the shared settings
+   \param[in]   *job     The file to convert
+   \return               Success
 
-   Converts a chain number (>=0) into a chain label. Chain labels run
-   from A-Z, a-z, 1-9, 0, and then 63 onwards as multi-character strings
+   Converts one listed file, using its own chain labels if it has any.
 
-   *** CODE TAKEN FROM pdbchain.c ***
-
--  10.03.15 Original   By: ACRM
+-  19.10.26 Original   By: ACRM
 */
-char *GetChainLabel(int ChainNum)
+BOOL ConvertBatchJob(BATCHQUEUE *queue, BATCHJOB *job)
 {
-   static char chain[MAXCHAINLABEL];
-   
-   if(ChainNum < 26)
+   char chainLabels[MAXBATCHCHAINS+1][MAXCHAINLABEL],
+        *chainList[MAXBATCHCHAINS+1],
+        cifName[MAXCIFNAME],
+        **chains = queue->chains;
+   FILE *in,
+        *out;
+   BOOL ok;
+
+   if(job->chainSpec != NULL)
    {
-      chain[0] = (char)(65 + ChainNum);
-      chain[1] = '\0';
+      ParseChainLabels(job->chainSpec, chainLabels, chainList,
+                       MAXBATCHCHAINS);
+      chains = chainList;
    }
-   else if(ChainNum < 52)
-   {
-      chain[0] = (char)(97 + (ChainNum-26));
-      chain[1] = '\0';
-   }
-   else if(ChainNum < 61)
-   {
-      sprintf(chain,"%d", ChainNum-51);
-   }
-   else if(ChainNum == 61)
+
+   if((in=ZStreamOpen(job->infile, "r", ZSTREAM_PLAIN))==NULL)
    {
-      strcpy(chain,"0");
+      fprintf(stderr,"Error: Unable to open input file: %s\n",
+              job->infile);
+      return(FALSE);
    }
-   else
+   if((out=ZStreamOpen(job->outfile, "w", queue->format))==NULL)
    {
-      sprintf(chain,"%d", ChainNum);
+      fprintf(stderr,"Error: Unable to open output file: %s\n",
+              job->outfile);
+      ZStreamClose(in);
+      return(FALSE);
    }
-   
-   return(chain);
-}
-
-/************************************************************************/
-void RenumberResidues(PDB *pdb)
-{
-   PDB  *p;
-   int  resnum   = 0,
-        LastRes;
-   char LastInsert[MAXLABEL],
-        LastChain[MAXCHAINLABEL];
-
-   LastRes       = (-9999);
-   LastInsert[0] = '\0';
-   LastChain[0]  = '\0';
-   
-   for(p=pdb; p!=NULL; NEXT(p))
-   {
-      /* Increment resnum if we have changed residue                    */
-      if((p->resnum != LastRes) ||
-         !INSERTMATCH(p->insert, LastInsert))
-      {
-         LastRes = p->resnum;
-         strcpy(LastInsert, p->insert);
-         
-         resnum++;
-      }
-
-      /* See if we've changed chain                                     */
-      if(!CHAINMATCH(p->chain, LastChain))
-      {
-         resnum = 1;
-         strcpy(LastChain, p->chain);
-      }
-      
-      /* Set the residue number                                         */
-      p->resnum = resnum;
 
-      /* Set the insert code to a blank                                 */
-      strcpy(p->insert, " ");
-   }
+   if(queue->cif || IsMMCIFFilename(job->outfile))
+      MMCIFBlockName(job->infile, cifName);
+   else
+      cifName[0] = '\0';
+
+   ok = tinker2pdb(in, queue->types, chains, queue->relax, 
+                   queue->conect, out,
+                   (cifName[0]?cifName:NULL), 1);
+   ZStreamClose(in);
+   if(!ZStreamClose(out))
+      ok = FALSE;
+   if(!ok)
+      fprintf(stderr,"Error: Conversion failed: %s\n", job->infile);
+
+   return(ok);
 }
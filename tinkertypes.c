@@ -0,0 +1,980 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       tinkertypes.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Reading the atom types from a Tinker parameter file and
+               mapping them to and from PDB residue and atom names
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   ONLY WORKS WITH THE AMBER99 PARAMETER FILE
+
+   The forward mapping (Tinker type to PDB residue and atom name) is
+   used by tinkerpdb. The reverse mapping is used by pdbtinker to
+   assign Tinker types to the atoms of a PDB file.
+
+   Tinker often gives the same label to several atoms in a residue
+   (e.g. the HB atoms of most residues or the OD atoms of Asp) and
+   some of its labels differ from the PDB names. The naming templates
+   give the PDB name for the n'th atom with each label in a residue.
+   Each type is linked to its template when the parameter file is read
+   so naming an atom is a single indexed lookup.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c and added the
+                    reverse mapping   By: ACRM
+   V1.1   19.10.26  Flags water and ion types so tinkerpdb can handle
+                    them separately   By: ACRM
+   V1.2   19.10.26  Added the atom naming templates. N-methyl amide caps
+                    are now NME rather than VAL   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "bioplib/fsscanf.h"
+#include "tinkertypes.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF        240
+#define MAXKEY          32
+
+/* Used to store information about fields to look up from the Tinker
+   parameter file
+*/
+typedef struct _lookup
+{
+   char *input1;
+   int  input1Len;
+   char *input2;
+   int  input2Len;
+   int  outField;
+   char *output;
+   int  atomField;
+   BOOL het;
+   int  nfields;
+}  LOOKUP;
+
+/* PDB names for the atoms of a residue which share a Tinker label (or
+   whose Tinker label isn't the PDB name). A NULL residue name matches
+   any residue and TERM_NONE matches any terminus
+*/
+typedef struct
+{
+   char *resnam,
+        *atnam;
+   int  terminus;
+   char *names[MAXTEMPLATENAMES];
+}  NAMETEMPLATE;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static void BuildTypeHash(TINKERTYPES *types);
+static unsigned int HashTypeKey(char *key);
+static void MakeTypeKey(char *key, char *resnam, char *atnam,
+                        int terminus);
+static int LookupTypeKey(TINKERTYPES *types, char *key);
+static void StripDigits(char *out, char *in);
+static int  ClassifySolvent(char *resnam, char *atnam, BOOL isHet);
+static void LinkNameTemplates(TINKERTYPES *types);
+static char *FindTemplateLabel(char *resnam, char *atnam, int terminus);
+static BOOL SameAtomName(char *atnam1, char *atnam2);
+static int  FindTypeByName(TINKERTYPES *types, char *resnam,
+                           char *atnam, int terminus);
+
+
+/************************************************************************/
+/* Globals
+*/
+/* Templates are searched in order so residue-specific entries must come
+   before the wildcards
+*/
+static NAMETEMPLATE sNameTemplates[] = 
+{
+   /* Amino acids                                                       */
+   {"GLY ", " HA ", TERM_NONE, {" HA1", " HA2"}},
+   {"ALA ", " HB ", TERM_NONE, {" HB1", " HB2", " HB3"}},
+   {"VAL ", " HG1", TERM_NONE, {"1HG1", "2HG1", "3HG1"}},
+   {"VAL ", " HG2", TERM_NONE, {"1HG2", "2HG2", "3HG2"}},
+   {"LEU ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"LEU ", " HD1", TERM_NONE, {"1HD1", "2HD1", "3HD1"}},
+   {"LEU ", " HD2", TERM_NONE, {"1HD2", "2HD2", "3HD2"}},
+   {"ILE ", " HG1", TERM_NONE, {"1HG1", "2HG1"}},
+   {"ILE ", " HG2", TERM_NONE, {"1HG2", "2HG2", "3HG2"}},
+   {"ILE ", " CD ", TERM_NONE, {" CD1"}},
+   {"ILE ", " HD ", TERM_NONE, {" HD1", " HD2", " HD3"}},
+   {"SER ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"THR ", " HG2", TERM_NONE, {"1HG2", "2HG2", "3HG2"}},
+   {"CYS ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"PRO ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"PRO ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"PRO ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"PHE ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"PHE ", " CD ", TERM_NONE, {" CD1", " CD2"}},
+   {"PHE ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"PHE ", " CE ", TERM_NONE, {" CE1", " CE2"}},
+   {"PHE ", " HE ", TERM_NONE, {" HE1", " HE2"}},
+   {"TYR ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"TYR ", " CD ", TERM_NONE, {" CD1", " CD2"}},
+   {"TYR ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"TYR ", " CE ", TERM_NONE, {" CE1", " CE2"}},
+   {"TYR ", " HE ", TERM_NONE, {" HE1", " HE2"}},
+   {"TRP ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"HIS ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"ASP ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"ASP ", " OD ", TERM_NONE, {" OD1", " OD2"}},
+   {"ASN ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"ASN ", " HD2", TERM_NONE, {"1HD2", "2HD2"}},
+   {"GLU ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"GLU ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"GLU ", " OE ", TERM_NONE, {" OE1", " OE2"}},
+   {"GLN ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"GLN ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"GLN ", " HE2", TERM_NONE, {"1HE2", "2HE2"}},
+   {"MET ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"MET ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"MET ", " HE ", TERM_NONE, {" HE1", " HE2", " HE3"}},
+   {"LYS ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"LYS ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"LYS ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"LYS ", " HE ", TERM_NONE, {" HE1", " HE2"}},
+   {"LYS ", " HZ ", TERM_NONE, {" HZ1", " HZ2", " HZ3"}},
+   {"ARG ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"ARG ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"ARG ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"ARG ", " NH ", TERM_NONE, {" NH1", " NH2"}},
+   {"ARG ", " HH ", TERM_NONE, {"1HH1", "2HH1", "1HH2", "2HH2"}},
+   {"ORN ", " HB ", TERM_NONE, {" HB1", " HB2"}},
+   {"ORN ", " HG ", TERM_NONE, {" HG1", " HG2"}},
+   {"ORN ", " HD ", TERM_NONE, {" HD1", " HD2"}},
+   {"ORN ", " HE ", TERM_NONE, {" HE1", " HE2", " HE3"}},
+   {"AIB ", " CB ", TERM_NONE, {" CB1", " CB2"}},
+   {"AIB ", " HB ", TERM_NONE, {"1HB1", "2HB1", "3HB1",
+                                "1HB2", "2HB2", "3HB2"}},
+
+   /* Caps                                                              */
+   {"ACE ", " H  ", TERM_NONE, {" H1 ", " H2 ", " H3 "}},
+   {"NME ", " HN ", TERM_NONE, {" H  "}},
+   {"NME ", " CH3", TERM_NONE, {" C  "}},
+   {"NME ", " H  ", TERM_NONE, {" H1 ", " H2 ", " H3 "}},
+   {"CTER", " HN ", TERM_NONE, {" HN1", " HN2"}},
+   {"CTER", " H  ", TERM_NONE, {" HN1", " HN2"}},
+
+   /* Nucleic acid bases                                                */
+   {"  A ", " H6 ", TERM_NONE, {" H61", " H62"}},
+   {" DA ", " H6 ", TERM_NONE, {" H61", " H62"}},
+   {"  G ", " H2 ", TERM_NONE, {" H21", " H22"}},
+   {" DG ", " H2 ", TERM_NONE, {" H21", " H22"}},
+   {"  C ", " H4 ", TERM_NONE, {" H41", " H42"}},
+   {" DC ", " H4 ", TERM_NONE, {" H41", " H42"}},
+   {" DT ", " H7 ", TERM_NONE, {" H71", " H72", " H73"}},
+
+   /* Phosphates and terminal hydroxyls                                 */
+   {"PHO ", " OP ", TERM_NONE, {" OP1", " OP2", " OP3"}},
+   {"HYD ", " H5T", TERM_NONE, {"HO5'"}},
+   {"HYD ", " H3T", TERM_NONE, {"HO3'"}},
+
+   /* Sugars - Tinker labels the pairs either H5' or H5'1/H5'2        */
+   {NULL,   " H5'", TERM_NONE, {" H5'", "H5''"}},
+   {NULL,   "1H5'", TERM_NONE, {" H5'"}},
+   {NULL,   "2H5'", TERM_NONE, {"H5''"}},
+   {NULL,   " H2'", TERM_NONE, {" H2'", "H2''"}},
+   {NULL,   "1H2'", TERM_NONE, {" H2'"}},
+   {NULL,   "2H2'", TERM_NONE, {"H2''"}},
+   {NULL,   " HO'", TERM_NONE, {"HO2'"}},
+   {NULL,   "2HO'", TERM_NONE, {"HO2'"}},
+
+   /* Terminal amino acids                                              */
+   {NULL,   " H  ", TERM_N,    {" H1 ", " H2 ", " H3 "}},
+   {NULL,   " OXT", TERM_C,    {" O  ", " OXT"}},
+   {NULL,   NULL,   TERM_NONE, {NULL}}
+};
+
+
+/************************************************************************/
+/*>TINKERTYPES *ReadTinkerAtomTypes(FILE *fp)
+   ------------------------------------------
+*//**
+   \param[in]   *fp     Tinker parameter file
+   \return              Allocated atom type tables (NULL if no memory)
+
+   Reads the 'atom' records from a Tinker parameter file and converts
+   each description into a PDB residue and atom name.
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Now returns an allocated TINKERTYPES structure, records the
+            terminus and solvent flag and builds the reverse mapping hash
+-  19.10.26 Links each type to its atom naming template   By: ACRM
+*/
+TINKERTYPES *ReadTinkerAtomTypes(FILE *fp)
+{
+   TINKERTYPES *types;
+   char        buffer[MAXBUFF],
+               atomType[MAXTYPELABEL];
+   int         atnum;
+
+   if((types=(TINKERTYPES *)malloc(sizeof(TINKERTYPES)))==NULL)
+      return(NULL);
+
+   /* Clear the output arrays                                           */
+   for(atnum=0; atnum<MAXATOMTYPES; atnum++)
+   {
+      types->resnam[atnum][0] = '\0';
+      types->atnam[atnum][0]  = '\0';
+      types->isHet[atnum]     = FALSE;
+      types->terminus[atnum]  = TERM_NONE;
+      types->solvent[atnum]   = SOLV_NONE;
+      types->nameTemplate[atnum] = (-1);
+   }
+   types->maxType = 0;
+
+   /* Read the 'atom' records from the file                             */
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      if(!strncmp(buffer,"atom   ", 7))
+      {
+         fsscanf(buffer,"%10x%5d%15x%27s",&atnum, atomType);
+         if((atnum < 0) || (atnum >= MAXATOMTYPES))
+         {
+            fprintf(stderr,"Warning: Tinker atom type %d ignored - \
+increase MAXATOMTYPES\n", atnum);
+            continue;
+         }
+
+         ExtractTypesFromTinkerAtomRecord(atomType,
+                                          types->resnam[atnum],
+                                          types->atnam[atnum],
+                                          &(types->isHet[atnum]),
+                                          &(types->terminus[atnum]));
+         types->solvent[atnum] = ClassifySolvent(types->resnam[atnum],
+                                                 types->atnam[atnum],
+                                                 types->isHet[atnum]);
+         if(atnum > types->maxType)
+            types->maxType = atnum;
+
+#ifdef DEBUG
+         fprintf(stdout, "%5d \"%-4s\" : \"%-4s\"\n",
+                 atnum, types->resnam[atnum], types->atnam[atnum]);
+#endif
+      }
+   }
+
+   BuildTypeHash(types);
+   LinkNameTemplates(types);
+
+   return(types);
+}
+
+/************************************************************************/
+void ExtractTypesFromTinkerAtomRecord(char *buffer,
+                                      char *resnam,
+                                      char *atnam,
+                                      BOOL *isHet,
+                                      int  *terminus)
+{
+   char *ptr,
+         words[MAXWORDS][MAXTYPELABEL];
+   int   nWords;
+
+   /* Remove the double inverted commas                                 */
+   ptr = buffer+1;
+   TERMAT(ptr, '"');
+
+   /* Blank the words                                                   */
+   for(nWords=0; nWords<MAXWORDS; nWords++)
+      words[nWords][0] = '\0';
+
+   /* Split the string into words                                       */
+   nWords=0;
+   while((ptr=blGetWord(ptr, words[nWords], MAXTYPELABEL))!=NULL)
+   {
+      if(nWords>=MAXWORDS)
+         break;
+      nWords++;
+   }
+   nWords++;
+
+#ifdef DEBUG
+   {
+      int i;
+      for(i=0; i<MAXWORDS; i++)
+      {
+         fprintf(stdout,"%s :", words[i]);
+      }
+      fprintf(stdout,"\n");
+   }
+#endif
+
+   /* Record whether this is a terminal residue type                    */
+   if(!strncmp(words[0], "N-Term", 6))
+      *terminus = TERM_N;
+   else if(!strncmp(words[0], "C-Term", 6))
+      *terminus = TERM_C;
+   else
+      *terminus = TERM_NONE;
+
+   ConvertTinkerDescriptionToResnamAndAtnam(words, nWords,
+                                            resnam, atnam, isHet);
+}
+
+
+
+
+/************************************************************************/
+BOOL ConvertTinkerDescriptionToResnamAndAtnam(
+   char words[MAXWORDS][MAXTYPELABEL], int nwords,
+   char *resnam, char *atnam, BOOL *isHet)
+{
+   static LOOKUP
+      lookup[] = {{"Gly",      3, NULL,    0, 0, "GLY ", 1, FALSE, 2},
+                  {"Ala",      3, NULL,    0, 0, "ALA ", 1, FALSE, 2},
+                  {"Val",      3, NULL,    0, 0, "VAL ", 1, FALSE, 2},
+                  {"Leu",      3, NULL,    0, 0, "LEU ", 1, FALSE, 2},
+                  {"Iso",      3, NULL,    0, 0, "ILE ", 1, FALSE, 2},
+                  {"Ser",      3, NULL,    0, 0, "SER ", 1, FALSE, 2},
+                  {"Thr",      3, NULL,    0, 0, "THR ", 1, FALSE, 2},
+                  {"Cys",      3, NULL,    0, 0, "CYS ", 2, FALSE, 3},
+                  {"Pro",      3, NULL,    0, 0, "PRO ", 1, FALSE, 2},
+                  {"Phe",      3, NULL,    0, 0, "PHE ", 1, FALSE, 2},
+                  {"Tyr",      3, NULL,    0, 0, "TYR ", 1, FALSE, 2},
+                  {"Try",      3, NULL,    0, 0, "TRP ", 1, FALSE, 2},
+                  {"His",      3, NULL,    0, 0, "HIS ", 2, FALSE, 3},
+                  {"Aspartic", 8, NULL,    0, 0, "ASP ", 2, FALSE, 3},
+                  {"Asparagi", 8, NULL,    0, 0, "ASN ", 1, FALSE, 2},
+                  {"Glutamic", 8, NULL,    0, 0, "GLU ", 2, FALSE, 3},
+                  {"Glutamin", 8, NULL,    0, 0, "GLN ", 1, FALSE, 2},
+                  {"Methioni", 8, NULL,    0, 0, "MET ", 1, FALSE, 2},
+                  {"Lys",      3, NULL,    0, 0, "LYS ", 1, FALSE, 2},
+                  {"Arg",      3, NULL,    0, 0, "ARG ", 1, FALSE, 2},
+                  {"Orn",      3, NULL,    0, 0, "ORN ", 1, TRUE,  2},
+                  {"MethylAl", 8, NULL,    0, 0, "AIB ", 1, TRUE,  2},
+                  {"Pyr",      3, NULL,    0, 0, "GLU ", 1, FALSE, 2},
+                  {"Formyl",   6, NULL,    0, 0, "FOR ", 1, TRUE,  2},
+                  {"Acetyl",   6, NULL,    0, 0, "ACE ", 1, TRUE,  2},
+                  {"N-MeAmid", 8, NULL,    0, 0, "NME ", 1, TRUE,  2},
+                  {"N-Term",   6, "AIB",   3, 1, NULL,   2, TRUE,  3},
+                  {"N-Term",   6, NULL,    0, 1, NULL,   2, FALSE, 3},
+                  {"N-Term",   6, NULL,    0, 1, NULL,   3, FALSE, 4},
+                  {"C-Term",   6, "Amide", 5, 0, "CTER", 2, FALSE, 3},
+                  {"C-Term",   6, "AIB",   3, 1, NULL,   2, TRUE,  3},
+                  {"C-Term",   6, "ORN",   3, 1, NULL,   2, TRUE,  3},
+                  {"C-Term",   6, NULL,    0, 1, NULL,   2, FALSE, 3},
+                  {"C-Term",   6, NULL,    0, 1, NULL,   3, FALSE, 4},
+                  {"R-Aden",   6, NULL,    0, 0, "  A ", 1, FALSE, 2},
+                  {"R-Guan",   6, NULL,    0, 0, "  G ", 1, FALSE, 2},
+                  {"R-Cyto",   6, NULL,    0, 0, "  C ", 1, FALSE, 2},
+                  {"R-Urac",   6, NULL,    0, 0, "  U ", 1, FALSE, 2},
+                  {"D-Aden",   6, NULL,    0, 0, " DA ", 1, FALSE, 2},
+                  {"D-Guan",   6, NULL,    0, 0, " DG ", 1, FALSE, 2},
+                  {"D-Cyto",   6, NULL,    0, 0, " DC ", 1, FALSE, 2},
+                  {"D-Urac",   6, NULL,    0, 0, " DU ", 1, FALSE, 2},
+                  {"D-Thym",   6, NULL,    0, 0, " DT ", 1, FALSE, 2},
+
+                  {"R-Phos",   6, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+                  {"R-5'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
+                  {"R-5'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+                  {"R-3'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
+                  {"R-3'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+                  {"D-Phos",   6, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+                  {"D-5'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
+                  {"D-5'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+                  {"D-3'-Hyd", 8, NULL,    0, 0, "HYD ", 1, TRUE,  2},
+                  {"D-3'-Pho", 8, NULL,    0, 0, "PHO ", 1, TRUE,  2},
+
+                  {"TIP3P",    5, NULL,    0, 0, "HOH ", 1, TRUE,  2},
+                  {"Li+",      3, NULL,    0, 0, "LI  ", 0, TRUE,  3},
+                  {"Na+",      3, NULL,    0, 0, "NA  ", 0, TRUE,  3},
+                  {"K+",       2, NULL,    0, 0, "K   ", 0, TRUE,  3},
+                  {"Rb+",      3, NULL,    0, 0, "RB  ", 0, TRUE,  3},
+                  {"Cs+",      3, NULL,    0, 0, "CS  ", 0, TRUE,  3},
+                  {"Mg+",      3, NULL,    0, 0, "MG  ", 0, TRUE,  3},
+                  {"Ca+",      3, NULL,    0, 0, "CA  ", 0, TRUE,  3},
+                  {"Zn+",      3, NULL,    0, 0, "ZN  ", 0, TRUE,  3},
+                  {"Ba+",      3, NULL,    0, 0, "BA  ", 0, TRUE,  3},
+                  {"Cl-",      3, NULL,    0, 0, "CL  ", 0, TRUE,  3},
+                  {NULL,       0, NULL,    0, 0, NULL,   0, TRUE,  0}
+   };
+
+   int i;
+   for(i=0; lookup[i].input1!=NULL; i++)
+   {
+      LOOKUP *l = &(lookup[i]);
+
+      /* If we have the right number of fields                          */
+      if(l->nfields == nwords)
+      {
+         /* If the first field matches                                  */
+         if(!strncmp(l->input1, words[0], l->input1Len))
+         {
+            /* If we don't need to check the second field, or we do
+               and it matches
+            */
+            if((l->input2Len == 0) ||
+               !strncmp(l->input2, words[1], l->input2Len))
+            {
+               /* We have a match.
+                  If we have an output field specified, use that,
+                  otherwise use the one in the lookup structure
+               */
+               if(l->outField)
+               {
+                  strcpy(resnam, words[l->outField]);
+               }
+               else
+               {
+                  strcpy(resnam, l->output);
+               }
+               PADMINTERM(resnam, 4);
+               *isHet = l->het;
+
+               /* Now get the atom field                                */
+               if(!strncmp(words[l->atomField], "Oxygen", 6))
+               {
+                  strcpy(atnam, " O  ");
+               }
+               else if(!strncmp(words[l->atomField], "Hydrogen", 8))
+               {
+                  strcpy(atnam, " H  ");
+               }
+               else
+               {
+                  BOOL ion = FALSE;
+                  char inputAtnam[MAXLABEL];
+
+                  strncpy(inputAtnam, words[l->atomField], MAXLABEL-1);
+                  inputAtnam[MAXLABEL-1] = '\0';
+
+                  /* See if it's an ion                                 */
+                  if(strchr(inputAtnam, '+') || strchr(inputAtnam, '-'))
+                     ion = TRUE;
+
+                  /* Remove any charge information and up-case          */
+                  TERMAT(inputAtnam, '+');
+                  TERMAT(inputAtnam, '-');
+                  UPPER(inputAtnam);
+
+                  if(ion)    /* It's an ion                             */
+                  {
+                     /* If it's one character, we need a leading space  */
+                     if(strlen(inputAtnam) == 1)
+                     {
+                        strcpy(atnam, " ");
+                     }
+                     else
+                     {
+                        atnam[0] = '\0';
+                     }
+                     strcat(atnam, inputAtnam);
+                  }
+                  else       /* It's a normal atom                      */
+                  {
+                     if(strlen(inputAtnam) == 4)
+                     {
+                        /* If it's 4 characters, move the last to the
+                           start
+                        */
+                        atnam[0] = inputAtnam[3];
+                        atnam[1] = '\0';
+                        inputAtnam[3] = '\0';
+                        strcat(atnam, inputAtnam);
+                     }
+                     else
+                     {
+                        /* Insert a leading space                       */
+                        strcpy(atnam, " ");
+                        strcat(atnam, inputAtnam);
+                     }
+                  }
+
+               }
+               PADMINTERM(atnam, 4);
+
+               return(TRUE);
+            }
+         }
+      }
+
+   }
+
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>int FindTinkerAtomType(TINKERTYPES *types, char *resnam, char *atnam,
+                          int terminus)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   *types     Tinker atom types
+   \param[in]   *resnam    PDB residue name
+   \param[in]   *atnam     PDB atom name (raw or left-justified)
+   \param[in]   terminus   TERM_NONE, TERM_N or TERM_C
+   \return                 Tinker atom type (0 if not found)
+
+   Finds the Tinker atom type for a PDB atom. Tinker gives the same type
+   to chemically equivalent atoms (e.g. HB2/HB3, OD1/OD2) so if the full
+   name isn't found we try again with digits removed. Terminal
+   residues fall back to the internal types for atoms which don't have
+   a terminal-specific type. Where the parameter file has several types
+   mapping to the same names (e.g. histidine protonation states) the
+   first one in the file is used. Names which only come from the
+   naming templates (e.g. HO5' or H5'') are mapped back to their Tinker
+   label.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Falls back to the naming templates   By: ACRM
+*/
+int FindTinkerAtomType(TINKERTYPES *types, char *resnam, char *atnam,
+                       int terminus)
+{
+   char *label;
+   int  type;
+
+   if((type=FindTypeByName(types, resnam, atnam, terminus)) != 0)
+      return(type);
+
+   if((label=FindTemplateLabel(resnam, atnam, terminus)) != NULL)
+      return(FindTypeByName(types, resnam, label, terminus));
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>void InitAtomNamer(ATOMNAMER *namer)
+   ------------------------------------
+*//**
+   \param[out]  *namer   Atom naming state
+
+   Clears the naming state before the first atom of a structure.
+
+-  19.10.26 Original   By: ACRM
+*/
+void InitAtomNamer(ATOMNAMER *namer)
+{
+   int i;
+
+   namer->resnam[0] = '\0';
+   namer->resnum    = 0;
+   namer->residue   = 0;
+   for(i=0; i<MAXNAMETEMPLATES; i++)
+   {
+      namer->tmplResidue[i] = 0;
+      namer->tmplCount[i]   = 0;
+   }
+}
+
+
+/************************************************************************/
+/*>char *NameTinkerAtom(TINKERTYPES *types, ATOMNAMER *namer, int type,
+                        char *resnam, int resnum)
+   --------------------------------------------------------------------
+*//**
+   \param[in]      *types    Tinker atom types
+   \param[in,out]  *namer    Atom naming state
+   \param[in]      type      Tinker atom type
+   \param[in]      *resnam   Residue name of the atom
+   \param[in]      resnum    Residue number of the atom
+   \return                   PDB atom name (raw, 4 characters)
+
+   Gives the PDB name for the next atom of a structure. Atoms must be
+   given in order. The n'th atom in a residue using a type's template
+   gets the n'th name from the template. Types without a template (or
+   atoms beyond the end of the template) keep the name made from the
+   Tinker label.
+
+-  19.10.26 Original   By: ACRM
+*/
+char *NameTinkerAtom(TINKERTYPES *types, ATOMNAMER *namer, int type,
+                     char *resnam, int resnum)
+{
+   int  tmpl,
+        ordinal;
+   char *name;
+
+   /* A new residue starts at a new residue number or name              */
+   if((resnum != namer->resnum) || strncmp(resnam, namer->resnam, 4))
+   {
+      namer->residue++;
+      namer->resnum = resnum;
+      strncpy(namer->resnam, resnam, MAXLABEL-1);
+      namer->resnam[MAXLABEL-1] = '\0';
+   }
+
+   if((tmpl = types->nameTemplate[type]) < 0)
+      return(types->atnam[type]);
+
+   if(namer->tmplResidue[tmpl] != namer->residue)
+   {
+      namer->tmplResidue[tmpl] = namer->residue;
+      namer->tmplCount[tmpl]   = 0;
+   }
+   ordinal = ++(namer->tmplCount[tmpl]);
+
+   if((ordinal < MAXTEMPLATENAMES) &&
+      ((name=sNameTemplates[tmpl].names[ordinal-1]) != NULL))
+      return(name);
+
+   return(types->atnam[type]);
+}
+
+
+/************************************************************************/
+/*>static int FindTypeByName(TINKERTYPES *types, char *resnam,
+                             char *atnam, int terminus)
+   ------------------------------------------------------------
+*//**
+   \param[in]   *types     Tinker atom types
+   \param[in]   *resnam    PDB residue name
+   \param[in]   *atnam     PDB atom name (raw or left-justified)
+   \param[in]   terminus   TERM_NONE, TERM_N or TERM_C
+   \return                 Tinker atom type (0 if not found)
+
+   Does the work for FindTinkerAtomType() using the hash table alone.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Split out of FindTinkerAtomType()   By: ACRM
+*/
+static int FindTypeByName(TINKERTYPES *types, char *resnam,
+                          char *atnam, int terminus)
+{
+   char key[MAXKEY],
+        trimmed[MAXLABEL],
+        stripped[MAXLABEL];
+   int  type,
+        len;
+
+   StripDigits(stripped, atnam);
+
+   for(;;)
+   {
+      /* Try the name as given, then with trailing digits removed one
+         at a time (HD21 -> HD2 -> HD), then with all digits removed
+         (for old-style names like 1HB)
+      */
+      MakeTypeKey(key, "", atnam, 0);
+      strcpy(trimmed, key+1);
+      len = strlen(trimmed) - 2;
+      trimmed[len] = '\0';
+
+      for(;;)
+      {
+         MakeTypeKey(key, resnam, trimmed, terminus);
+         if((type=LookupTypeKey(types, key)) != 0)
+            return(type);
+
+         if((len < 2) || !isdigit((int)trimmed[len-1]))
+            break;
+         trimmed[--len] = '\0';
+      }
+
+      MakeTypeKey(key, resnam, stripped, terminus);
+      if((type=LookupTypeKey(types, key)) != 0)
+         return(type);
+
+      if(terminus == TERM_NONE)
+         break;
+      terminus = TERM_NONE;
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static void BuildTypeHash(TINKERTYPES *types)
+   ---------------------------------------------
+*//**
+   \param[in,out]  *types   Tinker atom types
+
+   Builds the open-addressed hash table giving the reverse mapping from
+   residue name, atom name and terminus to Tinker atom type.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void BuildTypeHash(TINKERTYPES *types)
+{
+   char         key[MAXKEY];
+   int          type;
+   unsigned int h;
+
+   for(h=0; h<TYPEHASHSIZE; h++)
+      types->hash[h] = 0;
+
+   for(type=1; type<=types->maxType; type++)
+   {
+      if(types->resnam[type][0] == '\0')
+         continue;
+
+      MakeTypeKey(key, types->resnam[type], types->atnam[type],
+                  types->terminus[type]);
+
+      /* Keep the first type for any given key                          */
+      if(LookupTypeKey(types, key))
+         continue;
+
+      for(h=HashTypeKey(key); types->hash[h]; h=(h+1)%TYPEHASHSIZE);
+      types->hash[h] = type;
+   }
+}
+
+
+/************************************************************************/
+static int LookupTypeKey(TINKERTYPES *types, char *key)
+{
+   char         typeKey[MAXKEY];
+   unsigned int h;
+   int          type;
+
+   for(h=HashTypeKey(key); (type=types->hash[h])!=0;
+       h=(h+1)%TYPEHASHSIZE)
+   {
+      MakeTypeKey(typeKey, types->resnam[type], types->atnam[type],
+                  types->terminus[type]);
+      if(!strcmp(typeKey, key))
+         return(type);
+   }
+   return(0);
+}
+
+
+/************************************************************************/
+static unsigned int HashTypeKey(char *key)
+{
+   unsigned int h = 5381;
+
+   while(*key)
+      h = (h * 33) ^ (unsigned char)(*key++);
+
+   return(h % TYPEHASHSIZE);
+}
+
+
+/************************************************************************/
+/*>static void MakeTypeKey(char *key, char *resnam, char *atnam,
+                           int terminus)
+   -------------------------------------------------------------
+*//**
+   Builds a lookup key of the form "RES/ATM/t" with all spaces removed
+   so that raw and left-justified atom names give the same key.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void MakeTypeKey(char *key, char *resnam, char *atnam,
+                        int terminus)
+{
+   int i;
+
+   for(i=0; *resnam && i<MAXLABEL; resnam++, i++)
+   {
+      if(*resnam != ' ')
+         *(key++) = *resnam;
+   }
+   *(key++) = '/';
+
+   for(i=0; *atnam && i<MAXLABEL; atnam++, i++)
+   {
+      if(*atnam != ' ')
+         *(key++) = *atnam;
+   }
+   *(key++) = '/';
+   *(key++) = (char)('0' + terminus);
+   *key     = '\0';
+}
+
+
+/************************************************************************/
+static void StripDigits(char *out, char *in)
+{
+   int i;
+
+   for(i=0; *in && i<MAXLABEL-1; in++, i++)
+   {
+      if(!isdigit((int)*in))
+         *(out++) = *in;
+   }
+   *out = '\0';
+}
+
+
+/************************************************************************/
+/*>static int ClassifySolvent(char *resnam, char *atnam, BOOL isHet)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   *resnam   PDB residue name for the type
+   \param[in]   *atnam    PDB atom name for the type
+   \param[in]   isHet     HETATM flag for the type
+   \return                SOLV_WATER, SOLV_ION or SOLV_NONE
+
+   Water is recognized from the residue name. Ions are the HETATM types
+   whose atom name is the same as the residue name.
+
+-  19.10.26 Original   By: ACRM
+*/
+static int ClassifySolvent(char *resnam, char *atnam, BOOL isHet)
+{
+   char res[MAXLABEL],
+        atm[MAXLABEL],
+        *r, *a;
+
+   if(!strncmp(resnam, "HOH", 3))
+      return(SOLV_WATER);
+
+   if(isHet)
+   {
+      strcpy(res, resnam);
+      strcpy(atm, atnam);
+      KILLTRAILSPACES(res);
+      KILLTRAILSPACES(atm);
+      KILLLEADSPACES(r, res);
+      KILLLEADSPACES(a, atm);
+      if(*r && !strcmp(r, a))
+         return(SOLV_ION);
+   }
+   return(SOLV_NONE);
+}
+
+
+/************************************************************************/
+/*>static void LinkNameTemplates(TINKERTYPES *types)
+   -------------------------------------------------
+*//**
+   \param[in,out]  *types   Tinker atom types
+
+   Links each type to the first naming template which matches its
+   residue name, atom name and terminus.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void LinkNameTemplates(TINKERTYPES *types)
+{
+   NAMETEMPLATE *t;
+   int          type,
+                i;
+
+   for(type=1; type<=types->maxType; type++)
+   {
+      if(types->resnam[type][0] == '\0')
+         continue;
+
+      for(i=0; (i<MAXNAMETEMPLATES) && (sNameTemplates[i].atnam!=NULL); 
+          i++)
+      {
+         t = &(sNameTemplates[i]);
+         if(((t->resnam == NULL) || 
+             !strncmp(t->resnam, types->resnam[type], 4)) &&
+            ((t->terminus == TERM_NONE) ||
+             (t->terminus == types->terminus[type])) &&
+            !strncmp(t->atnam, types->atnam[type], 4))
+         {
+            types->nameTemplate[type] = i;
+            break;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static char *FindTemplateLabel(char *resnam, char *atnam, 
+                                  int terminus)
+   ---------------------------------------------------------
+*//**
+   \param[in]   *resnam    PDB residue name
+   \param[in]   *atnam     PDB atom name (raw or left-justified)
+   \param[in]   terminus   TERM_NONE, TERM_N or TERM_C
+   \return                 Tinker atom label (NULL if not found)
+
+   The reverse of the naming templates - finds the Tinker label for a
+   PDB atom name.
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *FindTemplateLabel(char *resnam, char *atnam, int terminus)
+{
+   NAMETEMPLATE *t;
+   int          i, j;
+
+   for(i=0; (i<MAXNAMETEMPLATES) && (sNameTemplates[i].atnam!=NULL); i++)
+   {
+      t = &(sNameTemplates[i]);
+      if(((t->resnam == NULL) || !strncmp(t->resnam, resnam, 4)) &&
+         ((t->terminus == TERM_NONE) || (t->terminus == terminus)))
+      {
+         for(j=0; (j<MAXTEMPLATENAMES) && (t->names[j]!=NULL); j++)
+         {
+            if(SameAtomName(t->names[j], atnam) &&
+               !SameAtomName(t->atnam, atnam))
+               return(t->atnam);
+         }
+      }
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static BOOL SameAtomName(char *atnam1, char *atnam2)
+   ----------------------------------------------------
+*//**
+   Compares two atom names ignoring spaces so raw and left-justified
+   names match.
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL SameAtomName(char *atnam1, char *atnam2)
+{
+   for(;;)
+   {
+      while(*atnam1 == ' ') atnam1++;
+      while(*atnam2 == ' ') atnam2++;
+      if(*atnam1 != *atnam2)
+         return(FALSE);
+      if(*atnam1 == '\0')
+         return(TRUE);
+      atnam1++;
+      atnam2++;
+   }
+}
@@ -0,0 +1,119 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       tinkertypes.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Reading the atom types from a Tinker parameter file and
+               mapping them to and from PDB residue and atom names
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c   By: ACRM
+   V1.1   19.10.26  Added solvent flag   By: ACRM
+   V1.2   19.10.26  Added atom naming templates   By: ACRM
+
+*************************************************************************/
+#ifndef _TINKERTYPES_H
+#define _TINKERTYPES_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXATOMTYPES  5000
+#define MAXTYPELABEL    32
+#define MAXLABEL         8
+#define MAXWORDS         8
+#define TYPEHASHSIZE  8191    /* Prime > MAXATOMTYPES                   */
+#define MAXNAMETEMPLATES 128  /* Entries in the atom naming templates   */
+#define MAXTEMPLATENAMES   7  /* Names per template (NULL terminated)   */
+
+/* Values for the terminus flag                                         */
+#define TERM_NONE        0
+#define TERM_N           1
+#define TERM_C           2
+
+/* Values for the solvent flag                                          */
+#define SOLV_NONE        0
+#define SOLV_WATER       1
+#define SOLV_ION         2
+
+/* The atom types read from a Tinker parameter file, indexed by the
+   Tinker type number. The hash table gives the reverse mapping from
+   residue name, atom name and terminus back to a type. nameTemplate
+   gives the atom naming template for each type (-1 if there isn't one)
+*/
+typedef struct
+{
+   char resnam[MAXATOMTYPES][MAXLABEL],
+        atnam[MAXATOMTYPES][MAXLABEL];
+   BOOL isHet[MAXATOMTYPES];
+   int  terminus[MAXATOMTYPES],
+        solvent[MAXATOMTYPES],
+        nameTemplate[MAXATOMTYPES],
+        hash[TYPEHASHSIZE],
+        maxType;
+}  TINKERTYPES;
+
+/* Counts the atoms named from each template in the current residue    */
+typedef struct
+{
+   char resnam[MAXLABEL];
+   int  resnum,
+        residue,
+        tmplResidue[MAXNAMETEMPLATES],
+        tmplCount[MAXNAMETEMPLATES];
+}  ATOMNAMER;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+TINKERTYPES *ReadTinkerAtomTypes(FILE *fp);
+void ExtractTypesFromTinkerAtomRecord(char *buffer, char *resnam,
+                                      char *atnam, BOOL *isHet,
+                                      int *terminus);
+BOOL ConvertTinkerDescriptionToResnamAndAtnam(
+   char words[MAXWORDS][MAXTYPELABEL], int nwords,
+   char *resnam, char *atnam, BOOL *isHet);
+int FindTinkerAtomType(TINKERTYPES *types, char *resnam, char *atnam,
+                       int terminus);
+void InitAtomNamer(ATOMNAMER *namer);
+char *NameTinkerAtom(TINKERTYPES *types, ATOMNAMER *namer, int type,
+                     char *resnam, int resnum);
+
+#endif
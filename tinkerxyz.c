@@ -0,0 +1,1051 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       tinkerxyz.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Reading and writing Tinker XYZ files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2019-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A Tinker XYZ file has a header line containing the number of atoms
+   and a title, followed by one line per atom:
+
+      atnum  atnam  x  y  z  type  connect...
+
+   A periodic system has a line after the header giving the unit cell
+   edge lengths and angles (a b c alpha beta gamma). This is kept in an
+   XYZBOX, written back out, and FixOverlaps() then looks for overlaps
+   between periodic images.
+
+   Once the header has been read the atom lines are independent, so
+   ReadTinkerXYZThreaded() splits them between threads, each parsing
+   straight into its own part of a single array. Likewise
+   WriteTinkerXYZThreaded() formats ranges of atom lines on separate
+   threads.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of fixoverlap.c. Now keeps
+                    the title and handles up to MAXXYZCONNECT
+                    connections   By: ACRM
+   V1.1   19.10.26  Added IndexTinkerXYZ()   By: ACRM
+   V1.2   19.10.26  Atom line parsing split out as ParseTinkerXYZAtom().
+                    FixOverlaps() moved here from fixoverlap.c   By: ACRM
+   V1.3   19.10.26  Atom number fields are widened as Tinker does for
+                    more than 999,999 atoms and always separated from
+                    the atom type   By: ACRM
+   V1.4   19.10.26  Added ReadTinkerXYZThreaded() and FreeTinkerXYZ().
+                    Lists read from a file are now a single array and
+                    the atom count is checked against the header
+                    By: ACRM
+   V1.5   19.10.26  Atom lines parsed with numparse.c   By: ACRM
+   V1.6   19.10.26  Added WriteTinkerXYZThreaded() and 
+                    FormatTinkerXYZAtom()   By: ACRM
+   V1.7   19.10.26  FixOverlaps() searches a Morton sorted cell grid
+                    rather than all pairs   By: ACRM
+   V1.8   19.10.26  Reads and writes the periodic box line. FixOverlaps()
+                    finds overlaps between periodic images   By: ACRM
+   V1.9   19.10.26  FixOverlaps() moves an atom to its new cell when it
+                    is fixed, so overlaps that this causes are found
+                    By: ACRM
+   V1.10  19.10.26  A box line may give just the edge lengths   By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "tinkerxyz.h"
+#include "filemap.h"
+#include "numparse.h"
+#include "parwrite.h"
+#include "cellgrid.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SMALL      0.00001
+#define MINCHUNK     65536     /* Smallest chunk worth a thread (bytes) */
+#define OVERLAPCELL    2.0     /* Cell size for FixOverlaps(). Big 
+                                  enough that an atom moved twice is
+                                  still found from its old cell         */
+#ifndef PI
+#define PI (4.0 * atan(1.0))
+#endif
+
+/* The part of a Tinker XYZ file handled by one thread                  */
+typedef struct
+{
+   char      *start,           /* First line of the chunk               */
+             *end;             /* Start of the next chunk               */
+   TINKERXYZ *atoms;           /* Where to parse to (NULL to count)     */
+   int       natoms;           /* Number of atom lines (when counting)  */
+}  XYZCHUNK;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL RunChunks(XYZCHUNK *chunk, pthread_t *tid, int nthreads);
+static void *ParseChunk(void *arg);
+static char *NextLine(char *line, char *end, char *buffer);
+static BOOL IsBlank(char *buffer);
+static BOOL ParseXYZBox(char *buffer, XYZBOX *box);
+static int  WriteTinkerXYZHeader(FILE *fp, int natoms, char *title,
+                                 XYZBOX *box);
+static BOOL FormatXYZLine(void *items, long i, void *data, 
+                          char *buffer, int *length);
+static void FixOverlapsAllPairs(TINKERXYZ *xyz);
+static BOOL BoxMatrix(XYZBOX *box, REAL *h);
+static BOOL PeriodicOverlap(REAL *si, REAL *sj, XYZBOX *box, REAL *h);
+
+
+/************************************************************************/
+/*>void WriteTinkerXYZ(FILE *fp, int natoms, char *title, XYZBOX *box,
+                       TINKERXYZ *xyz)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   *fp      Output file pointer
+   \param[in]   natoms   Number of atoms
+   \param[in]   *title   Title for the header line (or NULL)
+   \param[in]   *box     Periodic box (or NULL)
+   \param[in]   *xyz     Tinker XYZ linked list
+
+   Writes a Tinker XYZ file. Atom numbers are written in fields of at
+   least 6 characters, widened (as Tinker does) to fit the number of
+   atoms. Connections are always preceded by a space so that the atom
+   type and atom numbers above 99,999 don't run together.
+
+-  19.12.19 Original   By: ACRM
+-  19.10.26 Added title and writes all connections
+-  19.10.26 Widens the atom number fields for large systems   By: ACRM
+-  19.10.26 Atom lines formatted by FormatTinkerXYZAtom()   By: ACRM
+-  19.10.26 Added box   By: ACRM
+*/
+void WriteTinkerXYZ(FILE *fp, int natoms, char *title, XYZBOX *box,
+                    TINKERXYZ *xyz)
+{
+   TINKERXYZ *t;
+   char      buffer[PW_MAXLINE];
+   int       width;
+
+   width = WriteTinkerXYZHeader(fp, natoms, title, box);
+   for(t=xyz; t!=NULL; NEXT(t))
+   {
+      FormatTinkerXYZAtom(buffer, t, width);
+      fputs(buffer, fp);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL WriteTinkerXYZThreaded(FILE *fp, int natoms, char *title, 
+                               XYZBOX *box, TINKERXYZ *xyz, int nthreads)
+   -------------------------------------------------------------------------
+*//**
+   \param[in]   *fp        Output file pointer
+   \param[in]   natoms     Number of atoms
+   \param[in]   *title     Title for the header line (or NULL)
+   \param[in]   *box       Periodic box (or NULL)
+   \param[in]   *xyz       Tinker XYZ linked list
+   \param[in]   nthreads   Number of threads
+   \return                 FALSE if out of memory or the write failed
+
+   As WriteTinkerXYZ() but the atom lines are formatted on nthreads
+   threads and written to their place in the file by 
+   ParallelWriteLines()
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Added box   By: ACRM
+-  19.10.26 Also fails if a line couldn't be formatted   By: ACRM
+*/
+BOOL WriteTinkerXYZThreaded(FILE *fp, int natoms, char *title, 
+                            XYZBOX *box, TINKERXYZ *xyz, int nthreads)
+{
+   TINKERXYZ **idx;
+   int       width,
+             nindex;
+   BOOL      formatOK,
+             ok;
+
+   if((nthreads <= 1) || (xyz == NULL))
+   {
+      WriteTinkerXYZ(fp, natoms, title, box, xyz);
+      return(TRUE);
+   }
+   
+   if((idx=IndexTinkerXYZ(xyz, &nindex))==NULL)
+   {
+      fprintf(stderr,"Error: No memory for output\n");
+      return(FALSE);
+   }
+
+   width = WriteTinkerXYZHeader(fp, natoms, title, box);
+   ok    = ParallelWriteLines(fp, (void *)idx, (long)nindex, FormatXYZLine,
+                              (void *)&width, nthreads, &formatOK);
+   free(idx);
+   
+   return(ok && formatOK);
+}
+
+
+/************************************************************************/
+/*>int FormatTinkerXYZAtom(char *buffer, TINKERXYZ *t, int width)
+   ---------------------------------------------------------------
+*//**
+   \param[out]  *buffer   The atom line (at least PW_MAXLINE chars)
+   \param[in]   *t        The atom
+   \param[in]   width     Width of the atom number fields
+   \return                Length of the line
+
+   Formats one Tinker XYZ atom line including the newline
+
+-  19.10.26 Original - split out of WriteTinkerXYZ()   By: ACRM
+*/
+int FormatTinkerXYZAtom(char *buffer, TINKERXYZ *t, int width)
+{
+   int i,
+       length;
+
+   length = sprintf(buffer, "%*d  %-3s%12.6f%12.6f%12.6f%6d",
+                    width, t->atnum, t->atnam,
+                    t->x, t->y, t->z,
+                    t->type);
+   for(i=0; i<MAXXYZCONNECT; i++)
+   {
+      if(!t->connect[i])
+         break;
+
+      length += sprintf(buffer+length, " %*d", width-1, t->connect[i]);
+   }
+   buffer[length++] = '\n';
+   buffer[length]   = '\0';
+
+   return(length);
+}
+
+
+/************************************************************************/
+/*>static int WriteTinkerXYZHeader(FILE *fp, int natoms, char *title,
+                                   XYZBOX *box)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   *fp      Output file pointer
+   \param[in]   natoms   Number of atoms
+   \param[in]   *title   Title for the header line (or NULL)
+   \param[in]   *box     Periodic box (or NULL)
+   \return               Width of the atom number fields
+
+   Writes the header line of a Tinker XYZ file followed, if there is a
+   box, by the box line in Tinker's (1x,6f11.6) format
+
+-  19.10.26 Original - split out of WriteTinkerXYZ()   By: ACRM
+-  19.10.26 Writes the box line   By: ACRM
+*/
+static int WriteTinkerXYZHeader(FILE *fp, int natoms, char *title,
+                                XYZBOX *box)
+{
+   int i,
+       width = 6;
+
+   for(i=natoms; i>=1000000; i/=10)
+      width++;
+
+   if((title != NULL) && title[0])
+      fprintf(fp, "%*d  %s\n", width, natoms, title);
+   else
+      fprintf(fp, "%*d\n", width, natoms);
+
+   if((box != NULL) && (box->a > 0.0))
+      fprintf(fp, " %11.6f%11.6f%11.6f%11.6f%11.6f%11.6f\n",
+              box->a, box->b, box->c, box->alpha, box->beta, box->gamma);
+
+   return(width);
+}
+
+
+/************************************************************************/
+/*>static BOOL FormatXYZLine(void *items, long i, void *data, 
+                             char *buffer, int *length)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *items    Index of Tinker XYZ atoms
+   \param[in]   i         The atom to format
+   \param[in]   *data     Width of the atom number fields
+   \param[out]  *buffer   The atom line
+   \param[out]  *length   Length of the line
+   \return                TRUE
+
+   PWFORMATFUNC for ParallelWriteLines()
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL FormatXYZLine(void *items, long i, void *data, 
+                          char *buffer, int *length)
+{
+   TINKERXYZ **idx = (TINKERXYZ **)items;
+
+   *length = FormatTinkerXYZAtom(buffer, idx[i], *(int *)data);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>TINKERXYZ *ReadTinkerXYZ(FILE *fp, int *natoms, char *title)
+   ------------------------------------------------------------
+*//**
+   \param[in]   *fp       Input file pointer
+   \param[out]  *natoms   Number of atoms from the header line
+   \param[out]  *title    Title from the header line (may be NULL)
+   \return                Tinker XYZ linked list
+
+   Reads a Tinker XYZ file on a single thread, skipping any periodic box
+   line. The list must be freed with FreeTinkerXYZ()
+
+-  19.12.19 Original   By: ACRM
+-  19.10.26 Added title. Checks number of connections
+-  19.10.26 Now calls ReadTinkerXYZThreaded()   By: ACRM
+-  19.10.26 Skips any box line   By: ACRM
+*/
+TINKERXYZ *ReadTinkerXYZ(FILE *fp, int *natoms, char *title)
+{
+   return(ReadTinkerXYZThreaded(fp, natoms, title, NULL, 1));
+}
+
+
+/************************************************************************/
+/*>TINKERXYZ *ReadTinkerXYZThreaded(FILE *fp, int *natoms, char *title,
+                                    XYZBOX *box, int nthreads)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *fp        Input file pointer
+   \param[out]  *natoms    Number of atoms from the header line
+   \param[out]  *title     Title from the header line (may be NULL)
+   \param[out]  *box       Periodic box; box->a is 0.0 if there isn't
+                           one (may be NULL)
+   \param[in]   nthreads   Number of threads to parse with
+   \return                 Tinker XYZ linked list (NULL if no memory, no
+                           atoms or the wrong number of atoms)
+
+   Reads a Tinker XYZ file. The file is read into memory and the atom
+   lines are split into one chunk per thread at line boundaries. Each
+   thread counts the atom lines in its chunk; the counts give the
+   position of each chunk's first atom in a single array of natoms
+   records, and each thread then parses its chunk straight into place.
+   The records are linked in order so the result is an ordinary linked
+   list, but it is one allocation and must be freed with
+   FreeTinkerXYZ()
+
+   A periodic box line after the header is recognised by its three or
+   six numbers and is not counted as an atom.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Added box   By: ACRM
+*/
+TINKERXYZ *ReadTinkerXYZThreaded(FILE *fp, int *natoms, char *title,
+                                 XYZBOX *box, int nthreads)
+{
+   TINKERXYZ *xyz   = NULL;
+   XYZCHUNK  *chunk = NULL;
+   pthread_t *tid   = NULL;
+   FILEMAP   fm;
+   XYZBOX    boxLine;
+   char      buffer[MAXXYZBUFF],
+             *body, *end, *chp, *next;
+   long      size;
+   int       i, 
+             nlines  = 0;
+   BOOL      ok      = TRUE;
+
+   if(title != NULL)
+      title[0] = '\0';
+   if(box != NULL)
+      box->a = box->b = box->c = box->alpha = box->beta = box->gamma = 0.0;
+   *natoms = 0;
+
+   if(nthreads < 1)
+      nthreads = 1;
+
+   if(!MapFile(fp, &fm))
+      return(NULL);
+   end = fm.data + fm.size;
+
+   /* Header line                                                       */
+   if((body = NextLine(fm.data, end, buffer)) == NULL)
+   {
+      UnmapFile(&fm);
+      return(NULL);
+   }
+   if((sscanf(buffer, "%d", natoms) != 1) || (*natoms < 1))
+   {
+      UnmapFile(&fm);
+      return(NULL);
+   }
+
+   /* The title follows the atom count                                  */
+   if(title != NULL)
+   {
+      for(chp=buffer; *chp==' '; chp++);
+      for(; *chp && (*chp!=' '); chp++);
+      for(; *chp==' '; chp++);
+      strcpy(title, chp);
+   }
+
+   /* An atom line can't parse as three or six numbers so this is a box
+      line
+   */
+   if(((next = NextLine(body, end, buffer)) != NULL) &&
+      ParseXYZBox(buffer, &boxLine))
+   {
+      if(box != NULL)
+         *box = boxLine;
+      body = next;
+   }
+
+   /* Don't start threads for a few lines each                          */
+   size = (long)(end - body);
+   if(size < (long)nthreads * MINCHUNK)
+      nthreads = (int)(size / MINCHUNK) + 1;
+
+   if(((xyz   = (TINKERXYZ *)malloc((*natoms) * sizeof(TINKERXYZ)))
+       == NULL) ||
+      ((chunk = (XYZCHUNK *)malloc(nthreads * sizeof(XYZCHUNK)))
+       == NULL) ||
+      ((tid   = (pthread_t *)malloc(nthreads * sizeof(pthread_t)))
+       == NULL))
+   {
+      fprintf(stderr,"Error: No memory for Tinker XYZ atoms\n");
+      ok = FALSE;
+   }
+
+   if(ok)
+   {
+      /* Split at the first line break after each equal division        */
+      for(i=0; i<nthreads; i++)
+      {
+         chunk[i].start = (i==0) ? body : chunk[i-1].end;
+         chunk[i].end   = (i==nthreads-1) ? end : 
+                          body + (size * (i+1)) / nthreads;
+         if(chunk[i].end < chunk[i].start)
+            chunk[i].end = chunk[i].start;
+         while((chunk[i].end < end) && (chunk[i].end[-1] != '\n'))
+            chunk[i].end++;
+         chunk[i].atoms  = NULL;
+         chunk[i].natoms = 0;
+      }
+
+      /* Count the atom lines in each chunk                             */
+      ok = RunChunks(chunk, tid, nthreads);
+   }
+   
+   if(ok)
+   {
+      for(i=0; i<nthreads; i++)
+      {
+         chunk[i].atoms = xyz + nlines;
+         nlines += chunk[i].natoms;
+      }
+
+      if(nlines != *natoms)
+      {
+         fprintf(stderr,"Error: Tinker XYZ header gives %d atoms but \
+the file contains %d\n", *natoms, nlines);
+         ok = FALSE;
+      }
+   }
+
+   /* Parse each chunk into place                                       */
+   if(ok)
+      ok = RunChunks(chunk, tid, nthreads);
+
+   if(ok)
+   {
+      for(i=0; i<(*natoms)-1; i++)
+         xyz[i].next = xyz + i + 1;
+      xyz[(*natoms)-1].next = NULL;
+   }
+
+   if(chunk != NULL) free(chunk);
+   if(tid   != NULL) free(tid);
+   UnmapFile(&fm);
+
+   if(!ok)
+   {
+      if(xyz != NULL) free(xyz);
+      return(NULL);
+   }
+   
+   return(xyz);
+}
+
+
+/************************************************************************/
+/*>void FreeTinkerXYZ(TINKERXYZ *xyz)
+   ----------------------------------
+*//**
+   \param[in]   *xyz   List from ReadTinkerXYZ() or 
+                       ReadTinkerXYZThreaded()
+
+   Frees a list read from a file
+
+-  19.10.26 Original   By: ACRM
+*/
+void FreeTinkerXYZ(TINKERXYZ *xyz)
+{
+   if(xyz != NULL)
+      free(xyz);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseXYZBox(char *buffer, XYZBOX *box)
+   --------------------------------------------------
+*//**
+   \param[in]   *buffer   A line from a Tinker XYZ file
+   \param[out]  *box      The periodic box
+   \return                Is this a box line?
+
+   A box line holds the three edge lengths and three angles and nothing
+   else. The angles may be left out for a rectangular box.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Angles are optional   By: ACRM
+*/
+static BOOL ParseXYZBox(char *buffer, XYZBOX *box)
+{
+   REAL value[6];
+   char *chp = buffer,
+        *next;
+   int  i;
+
+   for(i=0; i<6; i++)
+   {
+      if((next=ParseRealToken(chp, &value[i]))==NULL)
+         break;
+      chp = next;
+   }
+   if(((i != 3) && (i != 6)) || !IsBlank(chp) || (value[0] <= 0.0))
+      return(FALSE);
+
+   if(i == 3)
+      value[3] = value[4] = value[5] = 90.0;
+
+   box->a     = value[0];
+   box->b     = value[1];
+   box->c     = value[2];
+   box->alpha = value[3];
+   box->beta  = value[4];
+   box->gamma = value[5];
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunChunks(XYZCHUNK *chunk, pthread_t *tid, int nthreads)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out]  *chunk     The chunks
+   \param[out]     *tid       Space for the thread IDs
+   \param[in]      nthreads   Number of chunks
+   \return                    FALSE if a thread could not be started
+
+   Runs ParseChunk() on each chunk, on the calling thread if there is
+   only one. Chunks with no atom array are counted, the others parsed.
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL RunChunks(XYZCHUNK *chunk, pthread_t *tid, int nthreads)
+{
+   int  i,
+        nstarted = 0;
+   BOOL ok       = TRUE;
+
+   if(nthreads == 1)
+   {
+      ParseChunk((void *)chunk);
+      return(TRUE);
+   }
+   
+   for(i=0; i<nthreads; i++)
+   {
+      if(pthread_create(&(tid[i]), NULL, ParseChunk, 
+                        (void *)&(chunk[i])) != 0)
+      {
+         fprintf(stderr,"Error: Unable to start thread\n");
+         ok = FALSE;
+         break;
+      }
+      nstarted++;
+   }
+   for(i=0; i<nstarted; i++)
+      pthread_join(tid[i], NULL);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static void *ParseChunk(void *arg)
+   ----------------------------------
+*//**
+   \param[in,out]  *arg   The XYZCHUNK to work on
+   \return                NULL
+
+   Thread function. Without an atom array, counts the non-blank lines
+   in the chunk. With one, parses each line into the next record.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *ParseChunk(void *arg)
+{
+   XYZCHUNK  *chunk = (XYZCHUNK *)arg;
+   TINKERXYZ *t     = chunk->atoms;
+   char      buffer[MAXXYZBUFF],
+             *line  = chunk->start;
+   int       n      = 0;
+   
+   while((line = NextLine(line, chunk->end, buffer)) != NULL)
+   {
+      if(IsBlank(buffer))
+         continue;
+      if(t != NULL)
+         ParseTinkerXYZAtom(buffer, t++);
+      n++;
+   }
+
+   if(chunk->atoms == NULL)
+      chunk->natoms = n;
+   
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>void ParseTinkerXYZAtom(char *buffer, TINKERXYZ *t)
+   ---------------------------------------------------
+*//**
+   \param[in]   *buffer   Atom line from a Tinker XYZ file (without the
+                          newline)
+   \param[out]  *t        Atom record to fill in
+
+   Parses one atom line. Unused connections are set to zero. The
+   fields are separated by white space; everything after the atom type
+   is a connection.
+
+-  19.10.26 Original - split out of ReadTinkerXYZ()   By: ACRM
+-  19.10.26 Uses the numparse.c routines rather than sscanf()
+            By: ACRM
+*/
+void ParseTinkerXYZAtom(char *buffer, TINKERXYZ *t)
+{
+   char *chp;
+   int  i;
+
+   for(i=0; i<MAXXYZCONNECT; i++)
+   {
+      t->connect[i] = 0;
+   }
+   t->atnum    = t->type = 0;
+   t->x        = t->y = t->z = (REAL)0.0;
+   t->atnam[0] = '\0';
+
+   if((chp=ParseIntToken(buffer, &(t->atnum)))==NULL)
+      return;
+
+   /* Atom name                                                         */
+   for(; isspace(*chp); chp++);
+   for(i=0; *chp && !isspace(*chp); chp++)
+   {
+      if(i < MAXXYZLABEL-1)
+         t->atnam[i++] = *chp;
+   }
+   t->atnam[i] = '\0';
+
+   if(((chp=ParseRealToken(chp, &(t->x)))==NULL)  ||
+      ((chp=ParseRealToken(chp, &(t->y)))==NULL)  ||
+      ((chp=ParseRealToken(chp, &(t->z)))==NULL)  ||
+      ((chp=ParseIntToken(chp,  &(t->type)))==NULL))
+      return;
+
+   for(i=0; i<MAXXYZCONNECT; i++)
+   {
+      if((chp=ParseIntToken(chp, &(t->connect[i])))==NULL)
+         break;
+   }
+}
+
+
+/************************************************************************/
+/*>TINKERXYZ **IndexTinkerXYZ(TINKERXYZ *xyz, int *natoms)
+   -------------------------------------------------------
+*//**
+   \param[in]   *xyz      Tinker XYZ linked list
+   \param[out]  *natoms   Number of atoms in the list
+   \return                Array of pointers into the list (NULL if no
+                          memory or no atoms)
+
+   Creates an array of pointers to the atoms in the linked list in the
+   same way as blIndexPDB(). Since Tinker numbers atoms sequentially
+   from 1, the atom referred to by a connection c is index[c-1].
+
+-  19.10.26 Original   By: ACRM
+*/
+TINKERXYZ **IndexTinkerXYZ(TINKERXYZ *xyz, int *natoms)
+{
+   TINKERXYZ *t,
+             **index;
+   int       i;
+
+   *natoms = 0;
+   for(t=xyz; t!=NULL; NEXT(t))
+      (*natoms)++;
+
+   if(!(*natoms))
+      return(NULL);
+
+   if((index=(TINKERXYZ **)malloc((*natoms)*sizeof(TINKERXYZ *)))==NULL)
+      return(NULL);
+
+   for(t=xyz, i=0; t!=NULL; NEXT(t), i++)
+      index[i] = t;
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void FixOverlaps(TINKERXYZ *xyz, XYZBOX *box)
+   ----------------------------------------------
+*//**
+   \param[in,out]  *xyz   Tinker XYZ linked list
+   \param[in]      *box   Periodic box (or NULL)
+
+   Moves the second of any pair of atoms with identical coordinates by
+   1A along x
+
+   Overlapping atoms are found with a cell grid sorted along a Morton
+   curve so, for each atom, only its neighbours are checked and they
+   are close together in memory. The atoms are still visited in file
+   order, and a moved atom is put in its new cell, so the same atoms
+   are moved as by an all-pairs search, including atoms that are moved
+   more than once. That is only used if there is no memory for the grid.
+
+   If there is a box, atoms also overlap if one lies on a periodic image
+   of the other (minimum image convention). The grid is then built on
+   the fractional coordinates scaled by the cell edges, so it fills the
+   box and wraps round, and works for triclinic as well as orthogonal
+   cells. The all-pairs fallback ignores the box.
+
+-  19.12.19 Original   By: ACRM
+-  19.10.26 Moved from fixoverlap.c
+-  19.10.26 Uses a sorted cell grid   By: ACRM
+-  19.10.26 Added box   By: ACRM
+-  19.10.26 Moved atoms change cell   By: ACRM
+*/
+void FixOverlaps(TINKERXYZ *xyz, XYZBOX *box)
+{
+   TINKERXYZ **idx     = NULL;
+   CELLGRID  *grid     = NULL;
+   REAL      *coor     = NULL,
+             *c,
+             h[6]      = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+             edge[3],
+             fx, fy, fz;
+   int       cells[MAXNEIGHBOURCELLS],
+             natoms,
+             ncells,
+             i, j, k, l, nextL;
+   BOOL      periodic  = FALSE,
+             overlap;
+
+   if((box != NULL) && (box->a > 0.0))
+   {
+      if(BoxMatrix(box, h))
+         periodic = TRUE;
+      else
+         fprintf(stderr,"Warning: Invalid periodic box ignored\n");
+   }
+
+   if(((idx=IndexTinkerXYZ(xyz, &natoms))==NULL) ||
+      ((coor=(REAL *)malloc(3*natoms*sizeof(REAL)))==NULL))
+      goto cleanup;
+
+   for(i=0; i<natoms; i++)
+   {
+      if(periodic)
+      {
+         /* Fractional coordinates wrapped into the box and scaled by
+            the edge lengths
+         */
+         fz = idx[i]->z / h[5];
+         fy = (idx[i]->y - h[4]*fz) / h[2];
+         fx = (idx[i]->x - h[1]*fy - h[3]*fz) / h[0];
+         coor[3*i]   = (fx - floor(fx)) * box->a;
+         coor[3*i+1] = (fy - floor(fy)) * box->b;
+         coor[3*i+2] = (fz - floor(fz)) * box->c;
+      }
+      else
+      {
+         coor[3*i]   = idx[i]->x;
+         coor[3*i+1] = idx[i]->y;
+         coor[3*i+2] = idx[i]->z;
+      }
+   }
+
+   if(periodic)
+   {
+      edge[0] = box->a;
+      edge[1] = box->b;
+      edge[2] = box->c;
+      grid = BuildPeriodicCellGrid(coor, natoms, OVERLAPCELL, edge);
+   }
+   else
+   {
+      grid = BuildSortedCellGrid(coor, natoms, OVERLAPCELL);
+   }
+   if(grid == NULL)
+      goto cleanup;
+
+   for(i=0; i<natoms; i++)
+   {
+      ncells = GetNeighbourCells(grid,
+                                 GetCellIndex(grid, coor[3*i],
+                                              coor[3*i+1], coor[3*i+2]),
+                                 cells);
+      for(k=0; k<ncells; k++)
+      {
+         for(l=grid->head[cells[k]]; l!=(-1); l=nextL)
+         {
+            nextL = grid->next[l];
+            if((j = grid->order[l]) <= i)
+               continue;
+
+            c = grid->coor + 3*l;
+            if(periodic)
+            {
+               overlap = PeriodicOverlap(coor+3*i, c, box, h);
+            }
+            else
+            {
+               overlap = ((ABS(coor[3*i]   - c[0]) < SMALL) &&
+                          (ABS(coor[3*i+1] - c[1]) < SMALL) &&
+                          (ABS(coor[3*i+2] - c[2]) < SMALL));
+            }
+
+            if(overlap)
+            {
+               /* 1A along x is also 1 along the first scaled axis      */
+               fprintf(stderr, "Fixing %d\n", idx[j]->atnum);
+               idx[j]->x   += 1.0;
+               coor[3*j]   += 1.0;
+               c[0]        += 1.0;
+
+               /* It may now overlap an atom in another cell            */
+               MoveCellGridAtom(grid, l, cells[k],
+                                GetCellIndex(grid, c[0], c[1], c[2]));
+            }
+         }
+      }
+   }
+
+cleanup:
+   if(grid == NULL)
+      FixOverlapsAllPairs(xyz);
+   FreeCellGrid(grid);
+   if(coor != NULL) free(coor);
+   if(idx  != NULL) free(idx);
+}
+
+
+/************************************************************************/
+/*>static BOOL BoxMatrix(XYZBOX *box, REAL *h)
+   -------------------------------------------
+*//**
+   \param[in]   *box   Periodic box
+   \param[out]  *h     The cell vectors a=(h[0],0,0), b=(h[1],h[2],0)
+                       and c=(h[3],h[4],h[5])
+   \return             FALSE if the box is impossible
+
+   Converts the edge lengths and angles to cell vectors with a along x
+   and b in the xy plane
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Missing angles are filled in by ParseXYZBox()   By: ACRM
+*/
+static BOOL BoxMatrix(XYZBOX *box, REAL *h)
+{
+   REAL cosAlpha, cosBeta, cosGamma, sinGamma, czSq;
+
+   cosAlpha = cos(box->alpha * PI / 180.0);
+   cosBeta  = cos(box->beta  * PI / 180.0);
+   cosGamma = cos(box->gamma * PI / 180.0);
+   sinGamma = sqrt(1.0 - cosGamma*cosGamma);
+
+   if((box->b <= 0.0) || (box->c <= 0.0) || (sinGamma < SMALL))
+      return(FALSE);
+
+   h[0] = box->a;
+   h[1] = box->b * cosGamma;
+   h[2] = box->b * sinGamma;
+   h[3] = box->c * cosBeta;
+   h[4] = box->c * (cosAlpha - cosBeta*cosGamma) / sinGamma;
+   czSq = box->c*box->c - h[3]*h[3] - h[4]*h[4];
+   if(czSq <= 0.0)
+      return(FALSE);
+   h[5] = sqrt(czSq);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL PeriodicOverlap(REAL *si, REAL *sj, XYZBOX *box, REAL *h)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   *si    Scaled fractional coordinates of one atom
+   \param[in]   *sj    Scaled fractional coordinates of the other
+   \param[in]   *box   Periodic box
+   \param[in]   *h     Cell vectors from BoxMatrix()
+   \return             Do the atoms overlap under the minimum image
+                       convention?
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL PeriodicOverlap(REAL *si, REAL *sj, XYZBOX *box, REAL *h)
+{
+   REAL fx, fy, fz;
+
+   fx = (sj[0] - si[0]) / box->a;
+   fy = (sj[1] - si[1]) / box->b;
+   fz = (sj[2] - si[2]) / box->c;
+   fx -= floor(fx + 0.5);
+   fy -= floor(fy + 0.5);
+   fz -= floor(fz + 0.5);
+
+   return((ABS(h[0]*fx + h[1]*fy + h[3]*fz) < SMALL) &&
+          (ABS(h[2]*fy + h[4]*fz)           < SMALL) &&
+          (ABS(h[5]*fz)                     < SMALL));
+}
+
+
+/************************************************************************/
+/*>static void FixOverlapsAllPairs(TINKERXYZ *xyz)
+   -----------------------------------------------
+*//**
+   \param[in,out]  *xyz   Tinker XYZ linked list
+
+   FixOverlaps() without the cell grid
+
+-  19.12.19 Original   By: ACRM
+-  19.10.26 Renamed from FixOverlaps()   By: ACRM
+*/
+static void FixOverlapsAllPairs(TINKERXYZ *xyz)
+{
+   TINKERXYZ *a, *b;
+   for(a=xyz; a!=NULL; NEXT(a))
+   {
+      for(b=a->next; b!=NULL; NEXT(b))
+      {
+         if((ABS(a->x - b->x) < SMALL) &&
+            (ABS(a->y - b->y) < SMALL) &&
+            (ABS(a->z - b->z) < SMALL))
+         {
+            fprintf(stderr, "Fixing %d\n", b->atnum);
+            b->x += 1.0;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static char *NextLine(char *line, char *end, char *buffer)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *line     Start of a line in memory
+   \param[in]   *end      End of the data
+   \param[out]  *buffer   The line without its line ending, truncated
+                          to MAXXYZBUFF-1 characters
+   \return                Start of the following line (NULL if line 
+                          was already at the end)
+
+-  19.10.26 Original   By: ACRM
+*/
+static char *NextLine(char *line, char *end, char *buffer)
+{
+   char *eol;
+   int  len;
+
+   buffer[0] = '\0';
+   if(line >= end)
+      return(NULL);
+
+   if((eol = memchr(line, '\n', end-line)) == NULL)
+      eol = end;
+   len = (int)(eol - line);
+   if(len > MAXXYZBUFF-1)
+      len = MAXXYZBUFF-1;
+   memcpy(buffer, line, len);
+   buffer[len] = '\0';
+   if(len && (buffer[len-1] == '\r'))
+      buffer[len-1] = '\0';
+
+   return((eol < end) ? eol+1 : end);
+}
+
+
+/************************************************************************/
+/*>static BOOL IsBlank(char *buffer)
+   ---------------------------------
+*//**
+   \param[in]   *buffer   A string
+   \return                Does it contain only white space?
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL IsBlank(char *buffer)
+{
+   for(; *buffer; buffer++)
+   {
+      if(!isspace(*buffer))
+         return(FALSE);
+   }
+   return(TRUE);
+}
@@ -0,0 +1,102 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       tinkerxyz.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Reading and writing Tinker XYZ files
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2019-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of fixoverlap.c   By: ACRM
+   V1.1   19.10.26  Added IndexTinkerXYZ()   By: ACRM
+   V1.2   19.10.26  Added ParseTinkerXYZAtom() and FixOverlaps()
+                    By: ACRM
+   V1.3   19.10.26  Added ReadTinkerXYZThreaded() and FreeTinkerXYZ()
+                    By: ACRM
+   V1.4   19.10.26  Added WriteTinkerXYZThreaded() and 
+                    FormatTinkerXYZAtom()   By: ACRM
+   V1.5   19.10.26  Added XYZBOX for periodic boxes   By: ACRM
+
+*************************************************************************/
+#ifndef _TINKERXYZ_H
+#define _TINKERXYZ_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXXYZBUFF       240
+#define MAXXYZLABEL        8
+#define MAXXYZCONNECT      8
+
+typedef struct _tinkerxyz
+{
+   struct _tinkerxyz *next;
+   REAL x,y,z;
+   int  atnum,
+        type,
+        connect[MAXXYZCONNECT];
+   char atnam[MAXXYZLABEL];
+}  TINKERXYZ;
+
+/* Periodic box from the line after the header (a is 0.0 if none).
+   Edge lengths in A and angles in degrees
+*/
+typedef struct
+{
+   REAL a, b, c,
+        alpha, beta, gamma;
+}  XYZBOX;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+TINKERXYZ *ReadTinkerXYZ(FILE *fp, int *natoms, char *title);
+TINKERXYZ *ReadTinkerXYZThreaded(FILE *fp, int *natoms, char *title,
+                                 XYZBOX *box, int nthreads);
+void FreeTinkerXYZ(TINKERXYZ *xyz);
+void WriteTinkerXYZ(FILE *fp, int natoms, char *title, XYZBOX *box,
+                    TINKERXYZ *xyz);
+BOOL WriteTinkerXYZThreaded(FILE *fp, int natoms, char *title, 
+                            XYZBOX *box, TINKERXYZ *xyz, int nthreads);
+int  FormatTinkerXYZAtom(char *buffer, TINKERXYZ *t, int width);
+TINKERXYZ **IndexTinkerXYZ(TINKERXYZ *xyz, int *natoms);
+void ParseTinkerXYZAtom(char *buffer, TINKERXYZ *t);
+void FixOverlaps(TINKERXYZ *xyz, XYZBOX *box);
+
+#endif
@@ -0,0 +1,687 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       xyzpdb.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Convert a Tinker XYZ structure to a PDB linked list
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The conversion used by tinkerpdb. The atom types are read by the
+   caller, so a long-running program (tinkerd) can read each parameter
+   file once and convert many structures with it. Nothing is kept
+   between calls, so conversions may run on several threads at once.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c   By: ACRM
+   V1.1   19.10.26  Chains are assigned from the bonds in the XYZ file
+                    By: ACRM
+   V1.2   19.10.26  Added CONECT output from the bonds   By: ACRM
+   V1.3   19.10.26  Atoms are named from the residue templates as they
+                    are converted rather than by the fixup passes
+                    By: ACRM
+   V1.4   19.10.26  Solvent takes the chain of the polymer before it
+                    By: ACRM
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "tinkertypes.h"
+#include "tinkerxyz.h"
+#include "hrelax.h"
+#include "pdbfixup.h"
+#include "stats.h"
+#include "cifwrite.h"
+#include "hybrid36.h"
+#include "bondgraph.h"
+#include "parwrite.h"
+#include "xyzpdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXCONECTBONDS 24     /* Most bonds written for an atom         */
+
+/* A HETATM that gets CONECT records with CONECT_HET. As in PDB files,
+   waters don't
+*/
+#define CONECTHET(p) (!strncmp((p)->record_type, "HETATM", 6) && \
+                      strncmp((p)->resnam, "HOH", 3))
+
+/* What FormatConectLine() needs to know                               */
+typedef struct
+{
+   BONDGRAPH *bonds;
+   int       conect;
+}  CONECTDATA;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL FormatConectLine(void *items, long i, void *data, 
+                             char *buffer, int *length);
+static void SetAtomName(PDB *p, char *atnam);
+
+
+/************************************************************************/
+/*>BOOL tinker2pdb(FILE *in, TINKERTYPES *types, char **chains, 
+                   BOOL relax, int conect, FILE *out, char *cifName,
+                   int nthreads)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   *in        Tinker XYZ file
+   \param[in]   *types     Atom types from the Tinker parameter file
+   \param[in]   **chains   Chain labels (or NULL)
+   \param[in]   relax      Relax the hydrogens
+   \param[in]   conect     CONECT_NONE, CONECT_HET or CONECT_ALL
+   \param[in]   *out       Output file
+   \param[in]   *cifName   mmCIF data block name (NULL for PDB output)
+   \param[in]   nthreads   Threads for reading and writing
+   \return                 Success
+
+   Converts a Tinker XYZ file to PDB (or mmCIF). The structure is freed
+   afterwards, so this can be called repeatedly with the same types
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Added cifName   By: ACRM
+-  19.10.26 Writes hybrid-36 numbers   By: ACRM
+-  19.10.26 Added nthreads   By: ACRM
+-  19.10.26 Writes with nthreads threads   By: ACRM
+-  19.10.26 Moved from tinkerpdb.c. Takes the atom types rather than
+            the parameter file and frees the structure   By: ACRM
+-  19.10.26 Chains from DoChainFromBonds(). DoChain() is only used if
+            the file has no bonds   By: ACRM
+-  19.10.26 Added conect   By: ACRM
+*/
+BOOL tinker2pdb(FILE *in, TINKERTYPES *types, char **chains, 
+                BOOL relax, int conect, FILE *out, char *cifName,
+                int nthreads)
+{
+   PDB       *pdb,
+             *solvent;
+   BONDGRAPH *bonds;
+   char      header[MAXXYZBUFF];
+   BOOL      ok = TRUE;
+   
+   if(!ReadTinkerAsPDB(in, types, header, relax, nthreads, &pdb,
+                       &solvent, &bonds))
+      return(FALSE);
+
+   /* Apply chain labels to the polymer, put the solvent in the chain
+      before it and then restore the original atom order
+   */
+   StatsPhaseStart("AssignChains");
+   if((bonds == NULL) || !bonds->nbonds ||
+      !DoChainFromBonds(pdb, bonds, chains, nthreads))
+      DoChain(pdb, chains, FALSE);
+   SetSolventChain(pdb, solvent, chains);
+   StatsPhaseStart("MergeSolvent");
+   pdb = MergeByAtomNumber(pdb, solvent);
+   StatsPhaseStart("RenumberResidues");
+   RenumberResidues(pdb);
+
+   if(StatsEnabled())
+   {
+      PDB *p;
+      int nres = 0;
+      for(p=pdb; p!=NULL; p=blFindNextResidue(p))
+         nres++;
+      StatsAddCount("residues", nres);
+   }
+
+   if(cifName != NULL)
+   {
+      if(conect != CONECT_NONE)
+         fprintf(stderr,"Warning: CONECT records are not written in \
+mmCIF files\n");
+      StatsPhaseStart("WriteMMCIF");
+      if(!WriteMMCIF(out, pdb, cifName))
+      {
+         fprintf(stderr,"Error: No memory for mmCIF output\n");
+         ok = FALSE;
+      }
+   }
+   else
+   {
+      StatsPhaseStart("WritePDB");
+      if(!WritePDBHy36Atoms(out, pdb, nthreads))
+      {
+         fprintf(stderr,"Error: Too many atoms or residues for PDB \
+format\n");
+         ok = FALSE;
+      }
+      if(ok && (conect != CONECT_NONE))
+      {
+         StatsPhaseStart("WriteConect");
+         if(bonds == NULL)
+         {
+            fprintf(stderr,"Warning: No bonds for CONECT records\n");
+         }
+         else if(!WriteConect(out, pdb, bonds, conect, nthreads))
+         {
+            fprintf(stderr,"Error: Unable to write CONECT records\n");
+            ok = FALSE;
+         }
+      }
+      fprintf(out, "END   \n");
+   }
+   StatsPhaseEnd();
+   FreeBondGraph(bonds);
+   FREELIST(pdb, PDB);
+
+   return(ok);
+}
+
+/************************************************************************/
+/*>BOOL ReadTinkerAsPDB(FILE *in, TINKERTYPES *types, char *header,
+                        BOOL relax, int nthreads, PDB **polymer,
+                        PDB **solvent, BONDGRAPH **bonds)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   *in        Tinker XYZ file
+   \param[in]   *types     Atom types from the Tinker parameter file
+   \param[out]  *header    Title from the XYZ file
+   \param[in]   relax      Relax the hydrogens before conversion
+   \param[in]   nthreads   Threads for reading the XYZ file
+   \param[out]  **polymer  PDB linked list of polymer atoms
+   \param[out]  **solvent  PDB linked list of water and ions
+   \param[out]  **bonds    Bonds from the XYZ file (NULL if no memory)
+   \return                 Success
+
+   Reads a Tinker XYZ file and converts it to PDB format. 
+
+   Water and ions (most of the atoms in a solvated system) are split
+   off into their own list as they are read. Their names are fixed so
+   they don't need the naming templates and each molecule is given its
+   own (negative, so it can't clash with the polymer) residue number.
+   Polymer atoms are named from the residue templates in tinkertypes.c
+   as they are converted.
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Reads with ReadTinkerXYZ() and optionally relaxes the
+            hydrogens with RelaxHydrogens()
+-  19.10.26 Returns the polymer and solvent separately
+-  19.10.26 Reads with ReadTinkerXYZThreaded()   By: ACRM
+-  19.10.26 Moved from tinkerpdb.c. Takes the atom types rather than
+            the parameter file   By: ACRM
+-  19.10.26 Added bonds   By: ACRM
+-  19.10.26 Names atoms with NameTinkerAtom() in place of the fixup
+            passes   By: ACRM
+*/
+BOOL ReadTinkerAsPDB(FILE *in, TINKERTYPES *types, char *header, 
+                     BOOL relax, int nthreads, PDB **polymer, 
+                     PDB **solvent, BONDGRAPH **bonds)
+{
+   PDB         *pdb     = NULL,
+               *p       = NULL,
+               *solv    = NULL,
+               *s       = NULL;
+   TINKERXYZ   *xyz, 
+               *t;
+   ATOMNAMER   namer;
+   char        *name;
+   int         natoms, 
+               atomType,
+               solvType,
+               solvResnum = 0,
+               waterO     = 0,
+               nWaterH    = 0,
+               nSolvent   = 0,
+               resnum     = 0,
+               hNumber;
+
+   *polymer = *solvent = NULL;
+   *bonds   = NULL;
+
+   StatsPhaseStart("ReadTinkerXYZ");
+   if((xyz=ReadTinkerXYZThreaded(in, &natoms, header, NULL,
+                                 nthreads))==NULL)
+      return(FALSE);
+
+   if(relax)
+   {
+      StatsPhaseStart("RelaxHydrogens");
+      if(!RelaxHydrogens(xyz, HRELAX_MAXITER, HRELAX_RMSGRAD, FALSE))
+         fprintf(stderr,"Warning: Hydrogen relaxation failed\n");
+   }
+
+   StatsPhaseStart("BuildBondGraph");
+   if((*bonds=BuildBondGraph(xyz))!=NULL)
+      StatsAddCount("bonds", (*bonds)->nbonds);
+
+   StatsPhaseStart("ConvertAtoms");
+   InitAtomNamer(&namer);
+   for(t=xyz; t!=NULL; NEXT(t))
+   {
+      atomType = t->type;
+      if((atomType < 0) || (atomType >= MAXATOMTYPES))
+         atomType = 0;
+
+      if((solvType = types->solvent[atomType]) != SOLV_NONE)
+      {
+         /* Water and ions                                              */
+         if(solv==NULL)
+         {
+            INIT(solv, PDB);
+            s=solv;
+         }
+         else
+         {
+            ALLOCNEXT(s, PDB);
+         }
+         if(s==NULL)
+            break;
+
+         /* A water hydrogen stays in the residue of the oxygen it is
+            bonded to. Anything else starts a new residue
+         */
+         hNumber = 0;
+         if((solvType == SOLV_WATER) && (types->atnam[atomType][1]=='H'))
+         {
+            if((waterO == 0) || (t->connect[0] != waterO) ||
+               (nWaterH >= 2))
+            {
+               solvResnum++;
+               waterO = 0;
+            }
+            hNumber = ++nWaterH;
+         }
+         else
+         {
+            solvResnum++;
+            waterO  = (solvType == SOLV_WATER) ? t->atnum : 0;
+            nWaterH = 0;
+         }
+
+         nSolvent++;
+         PopulateSolventRecord(s, t->atnum, t->x, t->y, t->z,
+                               types->resnam[atomType],
+                               types->atnam[atomType],
+                               solvType, -solvResnum, hNumber);
+      }
+      else
+      {
+         /* Everything else                                             */
+         if(pdb==NULL)
+         {
+            INIT(pdb, PDB);
+            p=pdb;
+         }
+         else
+         {
+            ALLOCNEXT(p, PDB);
+         }
+         if(p==NULL)
+            break;
+
+         PopulatePDBRecord(p, t->atnum, t->x, t->y, t->z, 
+                           types->resnam[atomType],
+                           types->atnam[atomType],
+                           types->isHet[atomType], &resnum);
+
+         /* Replace the Tinker label with the name from the template     */
+         name = NameTinkerAtom(types, &namer, atomType, p->resnam,
+                               p->resnum);
+         if(name != types->atnam[atomType])
+            SetAtomName(p, name);
+      }
+   }
+   StatsPhaseEnd();
+   FreeTinkerXYZ(xyz);
+
+   StatsAddCount("atoms", natoms);
+   StatsAddCount("solvent_atoms", nSolvent);
+
+   if(t != NULL)   /* Ran out of memory                                 */
+   {
+      FREELIST(pdb,  PDB);
+      FREELIST(solv, PDB);
+      FreeBondGraph(*bonds);
+      *bonds = NULL;
+      return(FALSE);
+   }
+
+   *polymer = pdb;
+   *solvent = solv;
+   
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void PopulatePDBRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                          char *resnam, char *atnam, BOOL isHet,
+                          int *resnum)
+   ------------------------------------------------------------------
+*//**
+   \param[out]     *p        PDB record to fill in
+   \param[in]      atnum     Atom number
+   \param[in]      x,y,z     Coordinates
+   \param[in]      *resnam   Residue name
+   \param[in]      *atnam    Atom name
+   \param[in]      isHet     HETATM rather than ATOM
+   \param[in,out]  *resnum   Residue number, incremented at each N
+
+   Fills in a record for a polymer atom
+
+-  17.09.15 Original   By: ACRM
+-  19.10.26 Residue number is kept by the caller rather than in a
+            static so each conversion starts again from 1   By: ACRM
+-  19.10.26 Uses SetAtomName()   By: ACRM
+*/
+void PopulatePDBRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                       char *resnam, char *atnam, BOOL isHet, 
+                       int *resnum)
+{
+   CLEAR_PDB(p);
+   strcpy(p->record_type, (isHet?"HETATM":"ATOM  "));
+   p->atnum = atnum;
+   SetAtomName(p, atnam);
+   strcpy(p->resnam, resnam);
+   PADMINTERM(p->resnam, 4);
+   if(!strncmp(atnam, " N  ", 4))
+      (*resnum)++;
+   p->resnum = *resnum;
+   p->x = x;   p->y = y;   p->z = z;
+   p->occ = 1.0;
+   blSetElementSymbolFromAtomName(p->element, atnam);
+}
+
+
+/************************************************************************/
+/*>void PopulateSolventRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                              char *resnam, char *atnam, int solvType,
+                              int resnum, int hydrogenNumber)
+   ---------------------------------------------------------------------
+*//**
+   \param[out]  *p               PDB record to fill in
+   \param[in]   atnum            Atom number
+   \param[in]   x,y,z            Coordinates
+   \param[in]   *resnam          Residue name
+   \param[in]   *atnam           Atom name
+   \param[in]   solvType         SOLV_WATER or SOLV_ION
+   \param[in]   resnum           Residue number
+   \param[in]   hydrogenNumber   Number for a water hydrogen (or 0)
+
+   Fills in a record for a water or ion atom. Unlike PopulatePDBRecord()
+   the residue number is given and the names are final so the naming
+   templates aren't needed.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses SetAtomName()   By: ACRM
+*/
+void PopulateSolventRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                           char *resnam, char *atnam, int solvType,
+                           int resnum, int hydrogenNumber)
+{
+   CLEAR_PDB(p);
+   strcpy(p->record_type, "HETATM");
+   p->atnum  = atnum;
+   p->resnum = resnum;
+   p->x = x;   p->y = y;   p->z = z;
+   p->occ    = 1.0;
+   strcpy(p->resnam, resnam);
+   PADMINTERM(p->resnam, 4);
+
+   if(hydrogenNumber)
+   {
+      sprintf(p->atnam_raw, " H%d ", hydrogenNumber % 10);
+      sprintf(p->atnam,     "H%d  ", hydrogenNumber % 10);
+      strcpy(p->element, "H");
+   }
+   else
+   {
+      SetAtomName(p, atnam);
+      if(solvType == SOLV_WATER)
+      {
+         strcpy(p->element, "O");
+      }
+      else
+      {
+         /* An ion's element is its name                                */
+         strncpy(p->element, p->atnam, 2);
+         p->element[2] = '\0';
+         KILLTRAILSPACES(p->element);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void SetAtomName(PDB *p, char *atnam)
+   --------------------------------------------
+*//**
+   \param[in,out]  *p       PDB record
+   \param[in]      *atnam   Raw (4 character) atom name
+
+   Sets the raw and left-justified atom names of a record.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void SetAtomName(PDB *p, char *atnam)
+{
+   strcpy(p->atnam_raw, atnam);
+   strcpy(p->atnam, (atnam[0]==' '?atnam+1:atnam));
+   PADMINTERM(p->atnam, 4);
+}
+
+
+/************************************************************************/
+/*>void SetSolventChain(PDB *polymer, PDB *solvent, char **chains)
+   ---------------------------------------------------------------
+*//**
+   \param[in]      *polymer   Polymer atoms with chain labels applied
+   \param[in,out]  *solvent   Water and ions
+   \param[in]      **chains   Chain labels (or NULL)
+
+   Each run of water and ions goes in the same chain as the polymer atom
+   just before it in the file (or the first polymer atom if there is
+   none before it). If there is no polymer then they get the first chain
+   label. Both lists must be in atom number order.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Uses the chain of the polymer atom before each solvent atom
+            rather than the last polymer atom   By: ACRM
+*/
+void SetSolventChain(PDB *polymer, PDB *solvent, char **chains)
+{
+   PDB  *p,
+        *s;
+   char chain[MAXCHAINLABEL];
+
+   if(polymer != NULL)
+      strcpy(chain, polymer->chain);
+   else if((chains!=NULL) && chains[0][0])
+      strcpy(chain, chains[0]);
+   else
+      strcpy(chain, "A");
+
+   for(p=polymer, s=solvent; s!=NULL; NEXT(s))
+   {
+      for(; (p!=NULL) && (p->atnum < s->atnum); NEXT(p))
+         strcpy(chain, p->chain);
+      strcpy(s->chain, chain);
+   }
+}
+
+
+/************************************************************************/
+/*>PDB *MergeByAtomNumber(PDB *a, PDB *b)
+   --------------------------------------
+*//**
+   \param[in]   *a    PDB linked list in atom number order
+   \param[in]   *b    PDB linked list in atom number order
+   \return            Merged list
+
+   Merges two linked lists into atom number order. No memory is
+   allocated; the lists are relinked.
+
+-  19.10.26 Original   By: ACRM
+*/
+PDB *MergeByAtomNumber(PDB *a, PDB *b)
+{
+   PDB *pdb  = NULL,
+       *last = NULL,
+       *next;
+
+   while((a != NULL) || (b != NULL))
+   {
+      if((b == NULL) || ((a != NULL) && (a->atnum <= b->atnum)))
+      {
+         next = a;
+         NEXT(a);
+      }
+      else
+      {
+         next = b;
+         NEXT(b);
+      }
+
+      if(last == NULL)
+         pdb = next;
+      else
+         last->next = next;
+      last = next;
+   }
+   if(last != NULL)
+      last->next = NULL;
+
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteConect(FILE *out, PDB *pdb, BONDGRAPH *bonds, int conect,
+                    int nthreads)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   *out       Output file
+   \param[in]   *pdb       PDB linked list of all the atoms
+   \param[in]   *bonds     Bonds from the Tinker XYZ file
+   \param[in]   conect     CONECT_HET or CONECT_ALL
+   \param[in]   nthreads   Threads for formatting the records
+   \return                 FALSE if out of memory, a number was too 
+                           large or the write failed
+
+   Writes CONECT records straight from the Tinker bonds rather than
+   guessing them from distances as blBuildConectData() does. With 
+   CONECT_HET, only bonds involving a HETATM other than water are 
+   written, from both ends. With CONECT_ALL, every bond is.
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL WriteConect(FILE *out, PDB *pdb, BONDGRAPH *bonds, int conect,
+                 int nthreads)
+{
+   PDB        **atoms,
+              *p;
+   CONECTDATA data;
+   BOOL       formatOK,
+              ok;
+
+   if((atoms=(PDB **)calloc(bonds->natoms+1, sizeof(PDB *)))==NULL)
+      return(FALSE);
+
+   /* Atom i in the graph has atom number i+1                           */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((p->atnum >= 1) && (p->atnum <= bonds->natoms))
+         atoms[p->atnum-1] = p;
+   }
+
+   data.bonds  = bonds;
+   data.conect = conect;
+   ok = ParallelWriteLines(out, (void *)atoms, (long)bonds->natoms, 
+                           FormatConectLine, (void *)&data, nthreads, 
+                           &formatOK);
+   free(atoms);
+
+   return(ok && formatOK);
+}
+
+
+/************************************************************************/
+/*>static BOOL FormatConectLine(void *items, long i, void *data, 
+                                char *buffer, int *length)
+   -------------------------------------------------------------
+*//**
+   \param[in]   *items    PDB atoms indexed by bond graph atom
+   \param[in]   i         The atom to format
+   \param[in]   *data     The CONECTDATA
+   \param[out]  *buffer   The CONECT records for the atom (if any)
+   \param[out]  *length   Length of the records
+   \return                FALSE if a number was out of range
+
+   PWFORMATFUNC for ParallelWriteLines()
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL FormatConectLine(void *items, long i, void *data, 
+                             char *buffer, int *length)
+{
+   PDB        **atoms  = (PDB **)items,
+              *q;
+   CONECTDATA *cdata   = (CONECTDATA *)data;
+   BONDGRAPH  *bonds   = cdata->bonds;
+   int        bonded[MAXCONECTBONDS],
+              nbonded  = 0,
+              b;
+   BOOL       ok       = TRUE,
+              isHet;
+
+   *length = 0;
+   if(atoms[i] == NULL)
+      return(TRUE);
+
+   isHet = CONECTHET(atoms[i]);
+   for(b=bonds->first[i]; 
+       (b<bonds->first[i+1]) && (nbonded<MAXCONECTBONDS); 
+       b++)
+   {
+      if((q = atoms[bonds->partner[b]]) == NULL)
+         continue;
+      if((cdata->conect == CONECT_ALL) || isHet || CONECTHET(q))
+         bonded[nbonded++] = q->atnum;
+   }
+   *length = FormatConectHy36(buffer, atoms[i]->atnum, bonded, nbonded,
+                              &ok);
+
+   return(ok);
+}
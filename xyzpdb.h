@@ -0,0 +1,83 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       xyzpdb.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Convert a Tinker XYZ structure to a PDB linked list
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2015-2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+   Revision History:
+   =================
+   V1.0   19.10.26  Original - split out of tinkerpdb.c   By: ACRM
+   V1.1   19.10.26  ReadTinkerAsPDB() returns the bonds   By: ACRM
+   V1.2   19.10.26  Added WriteConect() and the conect option to
+                    tinker2pdb()   By: ACRM
+
+*************************************************************************/
+#ifndef _XYZPDB_H
+#define _XYZPDB_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+#include "tinkertypes.h"
+#include "bondgraph.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CONECT_NONE 0         /* No CONECT records                      */
+#define CONECT_HET  1         /* CONECT records for HETATMs             */
+#define CONECT_ALL  2         /* CONECT records for all atoms           */
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL tinker2pdb(FILE *in, TINKERTYPES *types, char **chains, 
+                BOOL relax, int conect, FILE *out, char *cifName,
+                int nthreads);
+BOOL ReadTinkerAsPDB(FILE *in, TINKERTYPES *types, char *header,
+                     BOOL relax, int nthreads, PDB **polymer, 
+                     PDB **solvent, BONDGRAPH **bonds);
+void PopulatePDBRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                       char *resnam, char *atnam, BOOL isHet, 
+                       int *resnum);
+void PopulateSolventRecord(PDB *p, int atnum, REAL x, REAL y, REAL z,
+                           char *resnam, char *atnam, int solvType,
+                           int resnum, int hydrogenNumber);
+void SetSolventChain(PDB *polymer, PDB *solvent, char **chains);
+PDB *MergeByAtomNumber(PDB *a, PDB *b);
+BOOL WriteConect(FILE *out, PDB *pdb, BONDGRAPH *bonds, int conect,
+                 int nthreads);
+
+#endif
@@ -0,0 +1,661 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       zstream.c
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Transparent gzip and zstd compressed streams
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Lets the programs read and write gzip (.gz) and zstd (.zst) files
+   directly rather than through an external zcat/gzip stage. The
+   caller gets an ordinary FILE pointer, so bioplib routines such as
+   blReadPDB() can be used unchanged. Behind it is a pipe and a thread
+   which runs the codec, so decompression overlaps with parsing and
+   compression overlaps with formatting.
+
+   Input is treated as compressed if the filename has a .gz or .zst
+   extension or, for regular files including a redirected standard
+   input, if it starts with the gzip or zstd magic number. Output is
+   compressed according to the extension, or in the default format
+   given by the caller (normally set by a -z flag) if the name has no
+   compression extension or is standard output.
+
+   Output streams are flushed and their threads finished by
+   ZStreamClose() or, if the program simply returns, by an atexit()
+   handler. The table of streams is locked so that streams may be
+   opened and closed from any thread.
+
+   zstd support needs HAVE_ZSTD to be defined and -lzstd.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Stream table is locked for use from several threads.
+                    MAXZSTREAMS increased from 16   By: ACRM
+   V1.2   19.10.26  Added ZStreamUsage()   By: ACRM
+
+*************************************************************************/
+/* pipe(), fdopen(), pthreads etc. are not ANSI                         */
+#define _XOPEN_SOURCE 500
+
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#endif
+#include "zstream.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXZSTREAMS    512
+#define ZCHUNK       65536
+
+/* A compressed file being read or written through a pipe              */
+typedef struct
+{
+   FILE      *fp;         /* Our end of the pipe, given to the caller   */
+   int       fileFd,      /* The compressed file                        */
+             pipeFd,      /* The codec thread's end of the pipe         */
+             format;
+   BOOL      writing,
+             inUse;
+   pthread_t thread;
+}  ZSTREAM;
+
+/************************************************************************/
+/* Globals
+*/
+static ZSTREAM sStreams[MAXZSTREAMS];
+static BOOL    sAtExit = FALSE;
+static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+
+/************************************************************************/
+/* Prototypes
+*/
+static int  SniffFormat(int fd);
+static BOOL WriteAll(int fd, char *buffer, long nbytes);
+static void *GzipReader(void *arg);
+static void *GzipWriter(void *arg);
+#ifdef HAVE_ZSTD
+static void *ZstdReader(void *arg);
+static void *ZstdWriter(void *arg);
+#endif
+static void CloseAllStreams(void);
+
+
+/************************************************************************/
+/*>int ZStreamFormat(char *filename)
+   ---------------------------------
+*//**
+   \param[in]   *filename   A filename
+   \return                  Compression format implied by the extension
+
+-  19.10.26 Original   By: ACRM
+*/
+int ZStreamFormat(char *filename)
+{
+   int len;
+
+   if(filename == NULL)
+      return(ZSTREAM_PLAIN);
+   
+   len = strlen(filename);
+   if((len > 3) && !strcmp(filename+len-3, ".gz"))
+      return(ZSTREAM_GZIP);
+   if((len > 4) && !strcmp(filename+len-4, ".zst"))
+      return(ZSTREAM_ZSTD);
+   return(ZSTREAM_PLAIN);
+}
+
+
+/************************************************************************/
+/*>FILE *ZStreamOpen(char *filename, char *mode, int defFormat)
+   ------------------------------------------------------------
+*//**
+   \param[in]   *filename   File to open (NULL, blank or - for standard
+                            input or output)
+   \param[in]   *mode       "r" or "w"
+   \param[in]   defFormat   Compression for output whose name has no
+                            compression extension
+   \return                  Stream to read or write (NULL on error)
+
+   Opens a file, decompressing or compressing it on a separate thread
+   if needed
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Claims a slot in the stream table under the lock   By: ACRM
+*/
+FILE *ZStreamOpen(char *filename, char *mode, int defFormat)
+{
+   ZSTREAM *zs = NULL;
+   BOOL    writing,
+           isStd;
+   int     fd, i,
+           format,
+           fds[2];
+   void    *(*codec)(void *);
+
+   writing = (BOOL)(mode[0] == 'w');
+   isStd   = (BOOL)((filename == NULL) || (filename[0] == '\0') ||
+                    !strcmp(filename, "-"));
+
+   /* Find the format and open the file itself                         */
+   if(writing)
+   {
+      if((format=ZStreamFormat(isStd?NULL:filename)) == ZSTREAM_PLAIN)
+         format = defFormat;
+      if(format == ZSTREAM_PLAIN)
+         return(isStd ? stdout : fopen(filename, mode));
+
+      fd = isStd ? dup(STDOUT_FILENO) : 
+                   open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+   }
+   else
+   {
+      fd = isStd ? dup(STDIN_FILENO) : open(filename, O_RDONLY);
+      if(fd < 0)
+         return(NULL);
+      if((format=ZStreamFormat(isStd?NULL:filename)) == ZSTREAM_PLAIN)
+         format = SniffFormat(fd);
+      if(format == ZSTREAM_PLAIN)
+      {
+         if(isStd)
+         {
+            close(fd);
+            return(stdin);
+         }
+         return(fdopen(fd, mode));
+      }
+   }
+   if(fd < 0)
+      return(NULL);
+
+#ifdef HAVE_ZSTD
+   if(format == ZSTREAM_ZSTD)
+      codec = writing ? ZstdWriter : ZstdReader;
+   else
+#else
+   if(format == ZSTREAM_ZSTD)
+   {
+      fprintf(stderr,"Error: zstd compression is not supported. \
+Rebuild with -DHAVE_ZSTD\n");
+      close(fd);
+      return(NULL);
+   }
+#endif
+   codec = writing ? GzipWriter : GzipReader;
+
+   /* Claim a slot and set up the pipe to the codec thread            */
+   pthread_mutex_lock(&sLock);
+   for(i=0; i<MAXZSTREAMS; i++)
+   {
+      if(!sStreams[i].inUse)
+      {
+         zs        = sStreams + i;
+         zs->inUse = TRUE;
+         zs->fp    = NULL;
+         break;
+      }
+   }
+   if(!sAtExit)
+   {
+      atexit(CloseAllStreams);
+      sAtExit = TRUE;
+   }
+   pthread_mutex_unlock(&sLock);
+
+   if((zs == NULL) || pipe(fds))
+   {
+      fprintf(stderr,"Error: Unable to set up compressed stream\n");
+      if(zs != NULL)
+         zs->inUse = FALSE;
+      close(fd);
+      return(NULL);
+   }
+
+   zs->fileFd  = fd;
+   zs->format  = format;
+   zs->writing = writing;
+   zs->pipeFd  = writing ? fds[0] : fds[1];
+   if((zs->fp=fdopen(writing?fds[1]:fds[0], mode)) == NULL)
+   {
+      close(fds[0]);
+      close(fds[1]);
+      close(fd);
+      zs->inUse = FALSE;
+      return(NULL);
+   }
+
+   if(pthread_create(&(zs->thread), NULL, codec, (void *)zs))
+   {
+      fprintf(stderr,"Error: Unable to start compression thread\n");
+      fclose(zs->fp);
+      close(zs->pipeFd);
+      close(fd);
+      zs->fp    = NULL;
+      zs->inUse = FALSE;
+      return(NULL);
+   }
+   
+   return(zs->fp);
+}
+
+
+/************************************************************************/
+/*>BOOL ZStreamOpenStdFiles(char *infile, char *outfile, FILE **in,
+                            FILE **out, int defFormat)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   *infile     Input filename (blank for stdin)
+   \param[in]   *outfile    Output filename (blank for stdout)
+   \param[out]  **in        Input stream
+   \param[out]  **out       Output stream
+   \param[in]   defFormat   Compression for output whose name has no
+                            compression extension
+   \return                  Success
+
+   Equivalent of blOpenStdFiles() for possibly compressed files
+
+-  19.10.26 Original   By: ACRM
+*/
+BOOL ZStreamOpenStdFiles(char *infile, char *outfile, FILE **in,
+                         FILE **out, int defFormat)
+{
+   if((*in=ZStreamOpen(infile, "r", ZSTREAM_PLAIN)) == NULL)
+      return(FALSE);
+   if((*out=ZStreamOpen(outfile, "w", defFormat)) == NULL)
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void ZStreamUsage(void)
+   -----------------------
+*//**
+   Prints the usage lines for the -z option of the programs
+
+-  19.10.26 Original   By: ACRM
+*/
+void ZStreamUsage(void)
+{
+   fprintf(stderr,"       -z  Compress the output with gzip (.gz and \
+.zst output files are\n");
+   fprintf(stderr,"           always compressed and compressed input is \
+detected automatically)\n");
+}
+
+
+/************************************************************************/
+/*>BOOL ZStreamClose(FILE *fp)
+   ---------------------------
+*//**
+   \param[in]   *fp    Stream from ZStreamOpen()
+   \return             Success
+
+   Closes the stream. For a compressed stream, waits for the codec
+   thread to finish. Any input that hasn't been read is skipped.
+
+-  19.10.26 Original   By: ACRM
+-  19.10.26 Looks up the stream under the lock   By: ACRM
+*/
+BOOL ZStreamClose(FILE *fp)
+{
+   char buffer[ZCHUNK];
+   int  i;
+   BOOL ok;
+
+   pthread_mutex_lock(&sLock);
+   for(i=0; i<MAXZSTREAMS; i++)
+   {
+      if(sStreams[i].inUse && (sStreams[i].fp == fp))
+         break;
+   }
+   pthread_mutex_unlock(&sLock);
+
+   if(i == MAXZSTREAMS)
+   {
+      if((fp == stdin) || (fp == stdout))
+         return(fflush(fp) == 0);
+      return(fclose(fp) == 0);
+   }
+
+   /* Let a reader finish rather than leaving it writing to a closed
+      pipe
+   */
+   if(!sStreams[i].writing)
+   {
+      while(fread(buffer, 1, ZCHUNK, fp) > 0)
+         continue;
+   }
+   
+   ok = (BOOL)(fclose(fp) == 0);
+   pthread_join(sStreams[i].thread, NULL);
+   pthread_mutex_lock(&sLock);
+   sStreams[i].fp    = NULL;
+   sStreams[i].inUse = FALSE;
+   pthread_mutex_unlock(&sLock);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static void CloseAllStreams(void)
+   ---------------------------------
+*//**
+   atexit() handler to make sure that compressed output is complete.
+   Readers are left alone as the program may not have read everything.
+
+-  19.10.26 Original   By: ACRM
+*/
+static void CloseAllStreams(void)
+{
+   int i;
+
+   for(i=0; i<MAXZSTREAMS; i++)
+   {
+      if(sStreams[i].inUse && sStreams[i].writing)
+         ZStreamClose(sStreams[i].fp);
+   }
+}
+
+
+/************************************************************************/
+/*>static int SniffFormat(int fd)
+   ------------------------------
+*//**
+   \param[in]   fd    Input file descriptor
+   \return            Compression format from the magic number
+
+   Only regular files are checked as the file has to be rewound
+
+-  19.10.26 Original   By: ACRM
+*/
+static int SniffFormat(int fd)
+{
+   struct stat   st;
+   unsigned char magic[4];
+   int           nread,
+                 format = ZSTREAM_PLAIN;
+
+   if((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode))
+      return(ZSTREAM_PLAIN);
+
+   nread = (int)read(fd, magic, 4);
+   if((nread >= 2) && (magic[0] == 0x1f) && (magic[1] == 0x8b))
+      format = ZSTREAM_GZIP;
+   else if((nread == 4) && (magic[0] == 0x28) && (magic[1] == 0xb5) &&
+           (magic[2] == 0x2f) && (magic[3] == 0xfd))
+      format = ZSTREAM_ZSTD;
+
+   lseek(fd, (off_t)0, SEEK_SET);
+   return(format);
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteAll(int fd, char *buffer, long nbytes)
+   -------------------------------------------------------
+*//**
+   \param[in]   fd        File descriptor
+   \param[in]   *buffer   Data to write
+   \param[in]   nbytes    Number of bytes
+   \return                Success
+
+   write() which copes with partial writes
+
+-  19.10.26 Original   By: ACRM
+*/
+static BOOL WriteAll(int fd, char *buffer, long nbytes)
+{
+   long nwritten;
+
+   while(nbytes > 0)
+   {
+      if((nwritten=(long)write(fd, buffer, (size_t)nbytes)) <= 0)
+         return(FALSE);
+      buffer += nwritten;
+      nbytes -= nwritten;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void *GzipReader(void *arg)
+   ----------------------------------
+*//**
+   \param[in]   *arg    The ZSTREAM
+   \return              NULL
+
+   Codec thread which decompresses a gzip file into the pipe
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *GzipReader(void *arg)
+{
+   ZSTREAM *zs = (ZSTREAM *)arg;
+   gzFile  gz;
+   char    buffer[ZCHUNK];
+   int     nread = 0;
+
+   if((gz=gzdopen(zs->fileFd, "rb")) == NULL)
+   {
+      fprintf(stderr,"Error: Unable to read gzip input\n");
+      close(zs->fileFd);
+   }
+   else
+   {
+      while((nread=gzread(gz, buffer, ZCHUNK)) > 0)
+      {
+         if(!WriteAll(zs->pipeFd, buffer, (long)nread))
+            break;
+      }
+      if(nread < 0)
+         fprintf(stderr,"Error: Corrupt gzip input\n");
+      gzclose(gz);
+   }
+   
+   close(zs->pipeFd);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *GzipWriter(void *arg)
+   ----------------------------------
+*//**
+   \param[in]   *arg    The ZSTREAM
+   \return              NULL
+
+   Codec thread which compresses what comes down the pipe into a gzip
+   file
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *GzipWriter(void *arg)
+{
+   ZSTREAM *zs = (ZSTREAM *)arg;
+   gzFile  gz;
+   char    buffer[ZCHUNK];
+   long    nread;
+   BOOL    ok  = TRUE;
+
+   if((gz=gzdopen(zs->fileFd, "wb")) == NULL)
+   {
+      close(zs->fileFd);
+      ok = FALSE;
+   }
+
+   while((nread=(long)read(zs->pipeFd, buffer, ZCHUNK)) > 0)
+   {
+      if(ok && (gzwrite(gz, buffer, (unsigned)nread) != (int)nread))
+         ok = FALSE;
+   }
+
+   if((gz != NULL) && (gzclose(gz) != Z_OK))
+      ok = FALSE;
+   if(!ok)
+      fprintf(stderr,"Error: Writing gzip output failed\n");
+   
+   close(zs->pipeFd);
+   return(NULL);
+}
+
+
+#ifdef HAVE_ZSTD
+/************************************************************************/
+/*>static void *ZstdReader(void *arg)
+   ----------------------------------
+*//**
+   \param[in]   *arg    The ZSTREAM
+   \return              NULL
+
+   Codec thread which decompresses a zstd file into the pipe
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *ZstdReader(void *arg)
+{
+   ZSTREAM        *zs = (ZSTREAM *)arg;
+   ZSTD_DCtx      *dctx;
+   ZSTD_inBuffer  zin;
+   ZSTD_outBuffer zout;
+   char           inbuff[ZCHUNK],
+                  outbuff[ZCHUNK];
+   long           nread;
+   size_t         ret = 0;
+   BOOL           ok  = TRUE;
+
+   if((dctx=ZSTD_createDCtx()) == NULL)
+      ok = FALSE;
+
+   while(ok && ((nread=(long)read(zs->fileFd, inbuff, ZCHUNK)) > 0))
+   {
+      zin.src  = inbuff;
+      zin.size = (size_t)nread;
+      zin.pos  = 0;
+      while(ok && (zin.pos < zin.size))
+      {
+         zout.dst  = outbuff;
+         zout.size = ZCHUNK;
+         zout.pos  = 0;
+         ret = ZSTD_decompressStream(dctx, &zout, &zin);
+         if(ZSTD_isError(ret) ||
+            !WriteAll(zs->pipeFd, outbuff, (long)zout.pos))
+            ok = FALSE;
+      }
+   }
+   if(!ok || (ret != 0))
+      fprintf(stderr,"Error: Corrupt zstd input\n");
+
+   if(dctx != NULL)
+      ZSTD_freeDCtx(dctx);
+   close(zs->fileFd);
+   close(zs->pipeFd);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *ZstdWriter(void *arg)
+   ----------------------------------
+*//**
+   \param[in]   *arg    The ZSTREAM
+   \return              NULL
+
+   Codec thread which compresses what comes down the pipe into a zstd
+   file
+
+-  19.10.26 Original   By: ACRM
+*/
+static void *ZstdWriter(void *arg)
+{
+   ZSTREAM        *zs = (ZSTREAM *)arg;
+   ZSTD_CCtx      *cctx;
+   ZSTD_inBuffer  zin;
+   ZSTD_outBuffer zout;
+   ZSTD_EndDirective mode;
+   char           inbuff[ZCHUNK],
+                  outbuff[ZCHUNK];
+   long           nread;
+   size_t         remaining;
+   BOOL           ok  = TRUE;
+
+   if((cctx=ZSTD_createCCtx()) == NULL)
+      ok = FALSE;
+
+   do
+   {
+      nread    = (long)read(zs->pipeFd, inbuff, ZCHUNK);
+      mode     = (nread > 0) ? ZSTD_e_continue : ZSTD_e_end;
+      zin.src  = inbuff;
+      zin.size = (nread > 0) ? (size_t)nread : 0;
+      zin.pos  = 0;
+      do
+      {
+         if(!ok)
+            break;
+         zout.dst  = outbuff;
+         zout.size = ZCHUNK;
+         zout.pos  = 0;
+         remaining = ZSTD_compressStream2(cctx, &zout, &zin, mode);
+         if(ZSTD_isError(remaining) ||
+            !WriteAll(zs->fileFd, outbuff, (long)zout.pos))
+            ok = FALSE;
+      }  while((mode == ZSTD_e_end) ? (remaining != 0) 
+                                     : (zin.pos < zin.size));
+   }  while(nread > 0);
+
+   if(!ok)
+      fprintf(stderr,"Error: Writing zstd output failed\n");
+
+   if(cctx != NULL)
+      ZSTD_freeCCtx(cctx);
+   close(zs->fileFd);
+   close(zs->pipeFd);
+   return(NULL);
+}
+#endif
@@ -0,0 +1,70 @@
+/*************************************************************************
+
+   Program:    tinkerSupport
+   File:       zstream.h
+
+   Version:    V1.0
+   Date:       19.10.26
+   Function:   Transparent gzip and zstd compressed streams
+
+   Copyright:  (c) UCL / Prof. Andrew C. R. Martin 2026
+   Author:     Prof. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Institute of Structural & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew.martin@ucl.ac.uk
+               andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0   19.10.26  Original   By: ACRM
+   V1.1   19.10.26  Added ZStreamUsage()   By: ACRM
+
+*************************************************************************/
+#ifndef _ZSTREAM_H
+#define _ZSTREAM_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ZSTREAM_PLAIN   0
+#define ZSTREAM_GZIP    1
+#define ZSTREAM_ZSTD    2
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int  ZStreamFormat(char *filename);
+FILE *ZStreamOpen(char *filename, char *mode, int defFormat);
+BOOL ZStreamOpenStdFiles(char *infile, char *outfile, FILE **in,
+                         FILE **out, int defFormat);
+BOOL ZStreamClose(FILE *fp);
+void ZStreamUsage(void);
+
+#endif